@@ -30,6 +30,8 @@ tGPIBReadWriteStatus GPIBasyncWriteBinary( gint, const void *, gint , gint *, gd
 tGPIBReadWriteStatus GPIBasyncSRQwrite( gint , void *, gint, gint *, gdouble );
 tGPIBReadWriteStatus enableSRQonOPC( gint , gint * );
 gint checkMessageQueue (GAsyncQueue *);
+gint GPIBclose (gint *);
+gint open_Parameter_GPIBdevice (tGlobal *, gchar *, gint *);
 gint HP8970getFreqNoiseGain (gint descGPIB_HP8970, gint timeout, gint *pGPIBstatus, tNoiseAndGain *pResult, gint *pError);
 
 #define NULL_STR	-1
@@ -19,6 +19,7 @@
 
 void CB_edit_filterFloat    (GtkEditable*, gchar*, gint, gint*, gpointer);
 void CB_DrawingArea_Draw    (GtkDrawingArea *, cairo_t *, gint, gint, gpointer);
+void CB_DrawingArea_LiveMarker_Draw (GtkDrawingArea *, cairo_t *, gint, gint, gpointer);
 
 void CB_btn_Print           (GtkButton *, gpointer);
 void CB_btn_PDF             (GtkButton *, gpointer);
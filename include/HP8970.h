@@ -57,11 +57,14 @@ enum _debug {
 
 #define GINT_MSTIME_TO_DOUBLE( x ) ((gdouble)(x) / 1000.0)
 
+// frequency (sweep) or time (spot frequency) of a measurement
+typedef union {
+    gdouble freq;
+    gint64 time;
+} tAbscissaValue;
+
 typedef struct {
-    union {
-        gdouble freq;
-        gint64 time;
-    } abscissa;
+    tAbscissaValue abscissa;
     gdouble gain, noise;
     union {
         struct {
@@ -70,6 +73,7 @@ typedef struct {
             guint32 bNoiseOverflow :1;
             guint32 bGainOverflow :1;
             guint32 bCalPoint :1;
+            guint32 bbSeries :3;        // which of the multi-spot frequencies (spot frequency plot)
         } each;
         guint32 all;
     } flags;
@@ -160,34 +164,172 @@ typedef struct {
     gdouble x, y;
 } tCoordinate;
 
+// head and tail of a circular buffer (published together as one word)
+typedef union {
+    struct {
+        guint head, tail;
+    };
+    guint64 word;
+} tBufferIndices;
+
 typedef struct {
-    tNoiseAndGain *measurementData;
+    // The measurements are held as columns (structure of arrays) so that the loops
+    // over them (extremes, plotting, export) run over contiguous memory.
+    // getItemFromCircularBuffer() gathers the columns into a tNoiseAndGain.
+    tAbscissaValue *abscissa;
+    gdouble *noise, *gain;
+    guint32 *itemFlags;     // tNoiseAndGain flags.all
     // tail is the index of the *next* item location (not the last one inserted)
     // i.e. the first item index is head, the last is tail-1
     // If there is nothing in the buffer, head == tail
-    guint head, tail, rewriteTail;
+    // Only the acquisition thread moves head & tail (see PUBLISH_BUFFER_INDICES)
+    union {
+        struct {
+            guint head, tail;
+        };
+        tBufferIndices indices;
+    };
+    guint rewriteTail;
     guint size;
+    guint generation;       // incremented each time the buffer is (re)initialized
+    guint itemSequence;     // odd while the columns of an item are being written (see getItemFromCircularBuffer)
+
+    // positions rewritten since the plot last took them (see TAKE_REWRITTEN_RANGE)
+    guint64 rewritten;
 
     // index ( 0 to size of measurement that is (say) 60 seconds before the measurement at the tail
     gint idxTimeBeforeTail;
 
-    // Current plot data extremes
+    // Current plot data extremes (read with circularBufferExtremes while measuring)
     gdouble minNoise, maxNoise, minGain, maxGain;
-    union     {
-        gdouble freq;
-        gint64 time;
-    } minAbscissa, maxAbscissa;
+    guint extremesSequence;     // odd while the extremes are being changed
+    tAbscissaValue minAbscissa, maxAbscissa;
 
     struct     {
         guint32 bValidNoiseData         :1;
         guint32 bValidGainData          :1;
         guint32 bTime :1;
+        guint32 bYfactor                :1;     // the noise is the Y factor (not the noise factor)
     } flags;
 
+    // held while the columns are (re)allocated .. not to add or rewrite items
     GMutex mBuffer;
 
+    // shared columns (copy on write) .. number of buffers using them (NULL if not shared)
+    gatomicrefcount *pColumnRefs;
+
 } tCircularBuffer;
 
+// The items of a circular buffer lie in (at most) two contiguous runs of the columns,
+// from the head to the end of the columns and then from the start
+typedef struct {
+    guint start, count;
+} tBufferSpan;
+
+// A measurement of the log of a spot frequency plot (16 bytes) .. see HP8970log.c
+typedef struct {
+    gint32 msOffset;            // time (ms) after the first record of its block
+    gfloat noise, gain;         // (linear noise) .. 0 if an HP8970 error
+    guint32 packed;             // flags and HP8970 error codes
+} tCompactMeasurement;
+
+#define MEASUREMENT_LOG_BLOCK   1024    // records of a block (each block has the full time of its first)
+
+typedef struct {
+    tCompactMeasurement *records;
+    gint64 *blockTime;          // time (ms) of the first record of each block
+    guint nRecords, size;       // records used and allocated
+    // held while a record is added or the log is copied
+    GMutex mLog;
+} tMeasurementLog;
+
+// position in the columns of an item (0 is the oldest) of a circular buffer
+#define CIRCULAR_BUFFER_POSN( pCircBuffer, item ) (((pCircBuffer)->head + (item)) % (pCircBuffer)->size)
+
+// The acquisition thread is the only one to add items to the measurement buffer (single producer).
+// It writes the columns of an item and then publishes the new head and tail as one word (release);
+// a reader loads them (acquire) and so sees a consistent set of items without waiting on the writer.
+#define PUBLISH_BUFFER_INDICES( pCircBuffer, newIndices ) \
+                __atomic_store_n( &(pCircBuffer)->indices.word, (newIndices).word, __ATOMIC_RELEASE )
+#define ACQUIRE_BUFFER_INDICES( pCircBuffer ) \
+                ((tBufferIndices){ .word = __atomic_load_n( &(pCircBuffer)->indices.word, __ATOMIC_ACQUIRE ) })
+
+// The positions rewritten by a repeated sweep are kept as one range (first << 32 | last) so the plot
+// only draws again the part of the trace that changed. The acquisition thread widens the range
+// (after the columns are written) and the plot takes it (leaving it empty) before it draws.
+#define NO_REWRITTEN_RANGE                      (((guint64)G_MAXUINT32) << 32)
+#define REWRITTEN_FIRST( range )                ((guint)((range) >> 32))
+#define REWRITTEN_LAST( range )                 ((guint)((range) & G_MAXUINT32))
+#define TAKE_REWRITTEN_RANGE( pRange )          __atomic_exchange_n( (pRange), NO_REWRITTEN_RANGE, __ATOMIC_ACQUIRE )
+
+// Statistics for one quantity (noise or gain) at one frequency, accumulated over repeated sweeps
+typedef struct {
+    gdouble exponential;        // exponential average (cumulative mean until N sweeps have been seen)
+    gdouble windowSum;          // sum of the last N values (for the running average)
+    gdouble mean, sumSqDiff;    // Welford running mean and sum of squared differences (for std. deviation)
+    gdouble max, min;           // max-hold and min-hold
+    guint   n;                  // number of valid values accumulated
+    gdouble *history;           // last N values (ring indexed by n % N)
+} tAccumulator;
+
+typedef struct {
+    gdouble freq;
+    tAccumulator noise, gain;
+} tAccumulatorBin;
+
+typedef enum {
+    eAccumNone = 0, eAccumExponential = 1, eAccumRunning = 2, eAccumMaxMinHold = 3, eAccumStdDeviation = 4,
+    eMAX_ACCUM_DISPLAY = 5
+} tAccumulatorDisplay;
+
+// Per-frequency accumulators updated as each point of an (auto) sweep arrives
+typedef struct {
+    tAccumulatorBin *bins;
+    gdouble *historyStore;      // storage for the history rings of all bins
+    guint nBins;
+    guint length;               // N, the averaging length
+    guint nSweeps;
+
+    struct {
+        guint32 bValid          :1;
+    } flags;
+
+    GMutex mAccumulators;
+} tTraceAccumulators;
+
+#define N_SMOOTHING_FACTORS     10      // smoothing of 1, 2, 4 .. 512
+// Timing of sweep points, learned as the measurements are made (for progress and the measurement timeout)
+typedef struct {
+    gdouble measurementTime[ eMode_Max ][ N_SMOOTHING_FACTORS ];  // trigger to data (s) .. 0 until learned
+    gdouble pointTime[ eMode_Max ][ N_SMOOTHING_FACTORS ];        // complete point, including LO & settling (s)
+
+    tMode   mode;
+    gint    smoothing;              // index (log2 of the smoothing factor)
+    gdouble defaultPointTime;       // until we learn the point time
+    guint   nPoints, nDone;         // points in the sweep and points completed
+    guint   nMeasured;              // points measured since the start (for the rate)
+    gint64  startTime, triggerTime, lastPointTime;  // monotonic time (us)
+} tSweepEstimate;
+
+// Strings made at each point of a measurement .. see HP8970arena.c
+typedef struct {
+    gchar *pBase;
+    gsize size, used;
+    GSList *pOverflow;          // strings that did not fit (from the heap)
+} tArena;
+
+#define ACQUISITION_ARENA_SIZE  4096
+
+// Use of the arena and the message pool (since last logged)
+typedef struct {
+    gint arenaStrings, heapStrings;
+    gint poolMessages, heapMessages;
+} tAllocationCounters;
+
+// why the plot is to be drawn (see requestPlotRefresh in messageEvent.c)
+#define PLOT_DIRTY_DATA     0x01    // the data has changed
+#define PLOT_DIRTY_MARKER   0x02    // the live marker has moved
+
 #define MAX_NOISE_SOURCE_NAME_LENGTH       50
 #define MAX_NOISE_SOURCE_ENR_DATA_LENGTH    35
 #define MAX_NOISE_SOURCE_ENR_DATA_LENGTH_A  27       // HP8970A has 27 points only
@@ -243,22 +385,162 @@ typedef struct {
     gdouble fixedGridFreq[eMAX_LIMITS], // Unused ... placeholder
             fixedGridNoise[eMAX_NOISE_UNITS][eMAX_LIMITS], fixedGridGain[eMAX_LIMITS];
 
+    // Spot frequencies measured in turn (if there are two or more) .. ascending MHz
+#define MAX_MULTI_SPOT  8
+    gdouble multiSpotMHz[ MAX_MULTI_SPOT ];
+    gint nMultiSpot;
+
     gchar *sConfigurationName;
+    guint32 calibrationKey;     // calibrationKey() when last calibrated with these settings (0 - never)
 } tHP8970settings;
 
+// The calibration held by the HP8970 (and the sweep made to obtain it)
+typedef struct {
+    guint32 key;                // calibrationKey() of the settings when calibrated (0 - not calibrated)
+    gchar *sDateTime;
+    tNoiseAndGain *data;        // final pass of the calibration sweep (linear noise)
+    guint nPoints;
+    tNoiseType noiseUnits;      // units the HP8970 was set to
+} tCalibration;
+
 typedef struct {
     // The min and max values will be quantized to a 2, 5, 10 grid
     // so a data min/max frequency of 121/149 will become 120/150 with MHz/Div of 2
     gdouble min, max, offset, perDiv;
 } tAxis;
 
+// measurements transformed to the grid at a time (see transformToGrid)
+#define TRACE_CHUNK     1024
+
+// Where an interrupted sweep got to, so that it can be resumed from the next point
+typedef struct {
+    gdouble freqStartMHz, freqStopMHz, freqStepMHz;
+    tMode mode;
+    guint nextPoint;            // index (in the pass) of the next point to be measured
+    guint nPass;                // pass of a repeated (auto) sweep (counted against the sequencer's limit)
+    // the points measured after the resume must be comparable with those before
+    guint32 calibrationKey;     // IF, LO, sideband, attenuation, ENR .. (see calibrationKey())
+    gint smoothingFactor;
+
+    struct {
+        guint32 bValid          :1;
+        guint32 bInitialSweep   :1;     // interrupted in the first pass (adding) or a later one (rewriting)
+        guint32 bDescending     :1;     // interrupted in a descending pass of a serpentine sweep
+        guint32 bAutoSweep      :1;
+        guint32 bYfactor        :1;     // the noise is the Y factor (not the noise factor)
+        guint32 bCorrectedNFAndGain :1;
+        guint32 bLossCompensation   :1;
+    } flags;
+} tSweepCheckpoint;
+
+// Outer (external parameter) loop of a two dimensional sweep
+typedef struct {
+    gchar *sDevice;             // GPIB device name or address (NULL - the external LO)
+    gchar *sSetCommand;         // printf template to set the parameter e.g. "VSET %.3lf"
+    gdouble start, stop, step;
+} tParameterSweep;
+
+#define MAX_2D_ROWS     256
+// Two dimensional (parameter x frequency) sweep .. a frequency sweep at each value of the parameter
+typedef struct {
+    tParameterSweep parameter;
+    guint nRows, nColumns;      // parameter values x frequencies
+    guint nRowsDone;
+    gdouble *frequencies;       // nColumns (Hz)
+    tNoiseAndGain *data;        // nRows x nColumns (row major .. row 0 is the first parameter value)
+
+    cairo_surface_t *heatMap;   // image of the noise (a pixel per point) .. NULL until drawn or when changed
+    gdouble heatMapMin, heatMapMax;     // noise at the ends of the color scale
+    tNoiseType heatMapUnits;            // units of the noise of the heat map
+
+    struct {
+        guint32 bValid          :1;
+    } flags;
+
+    GMutex mSweep2D;
+} tSweep2D;
+
+typedef enum {
+    eTraceDashed = 0, eTraceSolid = 1, eTraceDotted = 2, eMAX_TRACE_STYLES = 3
+} tTraceStyle;
+
+// A change to the selected trace of the trace library (F10 keys or the Memory Traces buttons)
+typedef enum {
+    eTraceNext = 0, eTraceVisible = 1, eTraceStyle = 2, eTraceColor = 3
+} tTraceChange;
+
+// A trace of the trace library .. a stored measurement, a plot loaded from a file or a calibration sweep.
+// It is reference counted and never changed once stored. The data shares the columns of the
+// measurement it was stored from until the measurement is next changed (copy on write).
+typedef struct {
+    tCircularBuffer data;
+    gchar *sName;
+} tTrace;
+
+// path of a trace (relative to the grid origin) .. reused while the grid is unchanged
+typedef struct {
+    cairo_path_t *path;
+    gdouble gridWidth, gridHeight, minFreq, maxFreq, min, max;
+    tNoiseType units;
+} tTracePath;
+
+// How a trace of the library is shown
+typedef struct {
+    tTrace *pTrace;
+    gint color;                 // 0 - memory colors (plot page), otherwise an entry of traceColors
+    tTraceStyle style;
+
+    struct {
+        guint32 bVisible        :1;
+    } flags;
+
+    tTracePath paths[ eMAX_AXES ];
+} tTraceSlot;
+
+#define MAX_TRACES      20
+#define N_TRACE_COLORS  8
+typedef struct {
+    tTraceSlot slots[ MAX_TRACES ];     // oldest first
+    gint nTraces;
+    gint selected;                      // the trace the F10 keys (and Memory Traces buttons) change
+
+    GMutex mTraces;                     // held to change or copy the list (the GUI thread draws without it)
+} tTraceLibrary;
+
+// Index from the pixel columns of the grid to the measurements .. so the live marker
+// finds the measurements either side of it without a search. Rebuilt (by the GUI thread)
+// when the measurements or the abscissa axis change.
+typedef struct {
+    gint *before;                       // for each column, the last measurement at or before it (-1 if none)
+    gint nColumns;
+    gboolean bUniform;                  // evenly spaced sweep .. no table, the measurement is calculated
+    gdouble first, step;                // abscissa of the first measurement and the spacing (if uniform)
+
+    // what the index was built for
+    tAbscissaValue *abscissa;
+    guint head, tail, size;
+    tAbscissa freqOrTime;
+    gdouble min, scale;
+} tMarkerIndex;
+
+// Noise and gain of the measurement at the live marker
+typedef struct {
+    gdouble x, noise, gain;             // x is INVALID if there is no measurement at the marker
+} tMarkerReading;
+
 // This structure holds the data and metadata for the plot.
 // When data is read from the HP8970 it is placed in a circular buffer.
 // This is so when in spot frequency mode an unknown length number of points
 // are read and it is not necessary to move around data to accommodate.
 typedef struct {
+    GMutex mPlotUpdate;             // held while the acquisition thread changes the data (see BEGIN_PLOT_UPDATE)
     tCircularBuffer measurementBuffer;
-    tCircularBuffer memoryBuffer;
+    tMeasurementLog spotLog;        // every measurement of a spot frequency plot (the buffer only has the latest)
+    tTraceLibrary traceLibrary;
+    tTraceAccumulators accumulators;
+    tSweepCheckpoint sweepCheckpoint;
+    tSweep2D sweep2D;
+    tMarkerIndex markerIndex;
 
     gdouble spotFrequency;
 
@@ -288,6 +570,8 @@ typedef struct {
     gdouble freqStopMHz;
     gdouble freqStepCalMHz;
     gdouble freqStepSweepMHz;
+    gdouble multiSpotMHz[ MAX_MULTI_SPOT ];    // series of a multi-spot plot (nMultiSpot == 0 for a single spot)
+    gint nMultiSpot;
     tMode mode;
 
     gint extLOfreqIF, extLOfreqLO, settlingTime_ms; // for modes 1-4
@@ -319,6 +603,10 @@ typedef struct {
         guint32 bNoLOcontrol            :1;
         guint32 bCalibrationNotPossible :1;
         guint32 bShowAdditionalSP       :1;
+        guint32 bHeadless               :1;     // no GUI (command line acquisition)
+        guint32 bStreamMeasurements     :1;     // write each measurement to stdout as it arrives
+        guint32 bForceCalibration       :1;     // calibrate even though the calibration is still valid
+        guint32 bShowHeatMap            :1;     // show the two dimensional sweep (rather than the traces)
 #define N_VARIANTS 3
         guint32 bbHP8970Bmodel          :2;
     } flags;
@@ -336,6 +624,12 @@ typedef struct {
     tNoiseSource noiseSourceCache;
 
     tCoordinate liveMarkerPosnRatio;
+    tAccumulatorDisplay accumulatorDisplay;
+
+    guint  sweepPassLimit;      // end an auto-sweep after this many passes (0 - until stopped)
+    gint64 spotEndTime;         // monotonic time at which to end a spot measurement (0 - until stopped)
+    tSweepEstimate sweepEstimate;
+    tCalibration calibration;
 
 #define N_PAPER_SIZES 4
     gint PDFpaperSize;
@@ -351,7 +645,7 @@ typedef struct {
     GHashTable *widgetHashTable;
 
     GSource *messageEventSource;
-    GAsyncQueue *messageQueueToMain;
+    // (the queue to the main loop is in messageEvent.c)
     GAsyncQueue *messageQueueToGPIB;
 
     GList *configurationList;
@@ -363,6 +657,18 @@ typedef struct {
 
 } tGlobal;
 
+// The acquisition thread changes the plot data (points, accumulators, log, flags ..) between BEGIN_PLOT_UPDATE
+// and END_PLOT_UPDATE, a point at a time. snapshotPlot copies the plot holding the same mutex.
+#define BEGIN_PLOT_UPDATE( pPlot )      g_mutex_lock( &(pPlot)->mPlotUpdate )
+#define END_PLOT_UPDATE( pPlot )        g_mutex_unlock( &(pPlot)->mPlotUpdate )
+
+// A copy of the plot taken between two points of a measurement (see snapshotPlot).
+// Printing and the files are made only from this. The view has the data columns, axes & metadata of the
+// plot with the settings, calibration and display options needed to draw it (no widgets, queues etc.)
+typedef struct {
+    tGlobal view;
+} tPlotSnapshot;
+
 typedef struct {
     guint areaWidth;
     guint areaHeight;
@@ -408,7 +714,22 @@ typedef struct {
     gdouble margin;
 } tPaperDimensions;
 
+enum eFileType { ePDF, eSVG, ePNG, eCSV, eJSON };
+
+// One step of an unattended measurement sequence
+typedef enum {
+    eSeqConfiguration = 0, eSeqCalibrate = 1, eSeqSweep = 2, eSeqSpot = 3, eSeqSave = 4, eSeqParameter = 5
+} tSequenceAction;
+
+typedef struct {
+    tSequenceAction action;
+    gint count;                 // number of sweeps or seconds of spot measurement
+    enum eFileType fileType;    // for eSeqSave
+    gchar *sArgument;           // configuration name, filename pattern, spot frequencies or parameter sweep
+} tSequenceStep;
+
 extern tGlobal globalData;
+extern tAllocationCounters allocationCounters;
 
 extern tPaperDimensions paperDimensions[];
 
@@ -417,6 +738,7 @@ extern GdkRGBA plotElementColorsFactory[ eMAX_COLORS ];
 
 extern gchar  *sNoiseLabel[ eMAX_NOISE_UNITS ];
 extern gchar  *sNoiseUnits[ eMAX_NOISE_UNITS ];
+extern gchar  *sAccumulatorDisplay[ eMAX_ACCUM_DISPLAY ];
 
 extern gdouble maxInputFreq[ e8970_MAXmodels ];
 extern gchar  *sHP89709models[];
@@ -430,15 +752,42 @@ extern gchar  *sHP89709models[];
                 postDataToGPIBThread (TG_SEND_SETTINGS_to_HP8970, NULL); \
     })
 
+void        accumulateMeasurement           (tTraceAccumulators *, guint, tNoiseAndGain *);
+gboolean    accumulatedValue                (tTraceAccumulators *, guint, tAccumulatorDisplay, tGridAxes, gdouble *, gdouble *);
+gboolean    accumulatorExtremes             (tTraceAccumulators *, tAccumulatorDisplay, tGridAxes, gdouble *, gdouble *);
+gdouble     accumulatorStdDeviation         (tAccumulator *);
 gboolean    addItemToCircularBuffer         (tCircularBuffer *, tNoiseAndGain *, gboolean );
+gboolean    addMultiSpotFrequency           (tHP8970settings *, gdouble);
+void        addSpotToMultiSpot              (tGlobal *);
+gint        appendToMeasurementLog          (tMeasurementLog *, tNoiseAndGain *);
+gchar *     arenaPrintf                     (tArena *, const gchar *, ...);
 void        buildWidgetList                 (tGlobal *,  GtkBuilder *);
 void        CB_edit_Title                   (GtkEditable*, gpointer);
 void        CB_notes_changed                (GtkTextBuffer*, gpointer);
 gboolean    calibrateHP8970                 (tGlobal *, gint, gint, gint *);
+guint32     calibrationKey                  (tGlobal *, tHP8970settings *);
+gboolean    canResumeSweepHP8970            (tGlobal *, const gchar **);
+void        cachedCairoTextExtents          (cairo_t *, const gchar *, cairo_text_extents_t *);
 void        cairo_renderHewlettPackardLogo  (cairo_t *, gboolean, gboolean, gdouble, gdouble );
 void        catalogWidgets                  (tGlobal *);
 void        centreJustifiedCairoText        (cairo_t *, gchar *, gdouble, gdouble, gdouble);
+void        changeSelectedTrace             (tGlobal *, tTraceChange);
+void        chooseSequenceFile              (tGlobal *);
+void        chooseTraceFile                 (tGlobal *);
+gint        circularBufferSpans             (tCircularBuffer *, tBufferSpan *);
+void        circularBufferExtremes          (tCircularBuffer *, gdouble *, gdouble *, gdouble *, gdouble *);
+void        clearMeasurementLog             (tMeasurementLog *);
+void        clearMemoryTraces               (tGlobal *);
+void        clearMultiSpot                  (tGlobal *);
+void        clearTraceLibrary               (tTraceLibrary *);
+gint        compareFindConfiguration        (gconstpointer, gconstpointer);
 gint        compareSortConfiguration        (gconstpointer, gconstpointer);
+void        copyCircularBuffer              (tCircularBuffer *, tCircularBuffer *);
+void        copyMeasurementLog              (tMeasurementLog *, tMeasurementLog *);
+void        copySweep2D                     (tSweep2D *, tSweep2D *);
+void        copyTraceLibrary                (tTraceLibrary *, tTraceLibrary *);
+void        completePointEstimate           (tSweepEstimate *, guint);
+void        convertNoiseColumn              (const gdouble *, gdouble *, guint, tNoiseType);
 gint        createNoiseFigureColumnView     (GtkColumnView *, tGlobal * );
 gboolean    determineTimeExtremesInCircularBuffer
                                             (tCircularBuffer *);
@@ -446,12 +795,22 @@ void        drawHPlogo 					    (cairo_t *, gdouble, gdouble, gdouble, gboolean
 void        drawModeDiagram                 (cairo_t *, tMode, gint, gdouble, gdouble, gdouble);
 void        enablePageExtLOwidgets          (tGlobal *, tMode);
 gint        findTimeDeltaInCircularBuffer   (tCircularBuffer *, gdouble);
+void        freeCircularBuffer              (tCircularBuffer *);
 void        freeConfigurationItemContent      (gpointer);
+void        freeArena                       (tArena *);
+void        freeMarkerIndex                 (tMarkerIndex *);
+void        freeMeasurementLog              (tMeasurementLog *);
+void        freeSequence                    (GList *);
 void        freeSVGhandles                  (void);
+void        freeSweep2D                     (tSweep2D *);
+void        freeTraceLibrary                (tTraceLibrary *);
 tNoiseAndGain *
-            getItemFromCircularBuffer       (tCircularBuffer *, guint);
+            getItemFromCircularBuffer       (tCircularBuffer *, guint, tNoiseAndGain *);
 gint        getTimeStamp                    (gchar **);
+GList *     headlessSequence                (gchar *, gboolean, gint, gint, gchar *, gchar **, gboolean *);
+void        initArena                       (tArena *, gsize);
 void        initCircularBuffer              (tCircularBuffer *, guint, tAbscissa);
+void        initTraceAccumulators           (tTraceAccumulators *, guint, guint);
 void        initializeMainDialog            (tGlobal *);
 void        initializePageExtLO             (tGlobal *);
 void        initializePageGPIB              (tGlobal *);
@@ -460,35 +819,87 @@ void        initializePageOptions           (tGlobal *);
 void        initializePageNotes             (tGlobal *);
 void        initializePagePlot              (tGlobal *);
 void        initializePageSource            (tGlobal *);
+void        invalidateCalibration           (tGlobal *);
+gboolean    isCalibrationValid              (tGlobal *);
 gdouble     LOfrequency                     (tGlobal *, gdouble);
 void        leftJustifiedCairoText          (cairo_t *, gchar *, gdouble, gdouble, gboolean);
+gdouble     linearNoise                     (gdouble, tNoiseType);
+void        logAllocationCounters           (gchar *);
+void        logPlotDrawTimes                (void);
 void        logVersion						(void);
-gchar *     msTimeToString                  (gint64, gboolean);
+void        measuredPointEstimate           (tSweepEstimate *);
+tNoiseAndGain *
+            measurementFromLog              (tMeasurementLog *, guint, tNoiseAndGain *);
+gchar *     msTimeToLabel                   (gchar *, gint64, gboolean);
 gint        nItemsInCircularBuffer          (tCircularBuffer *);
+gdouble     noiseInUnits                    (gdouble, tNoiseType);
+gboolean    parameterSweepHP8970            (tGlobal *, tParameterSweep *, gint, gint, gint *);
+gdouble     parameterValue                  (tSweep2D *, guint);
+gint        parseParameterSweep             (gchar *, tParameterSweep *, gboolean);
 gboolean    plotNoiseFigureAndGain          (cairo_t *, gint, gint, tGlobal *, gboolean);
 void        quarantineControlsOnSweep       (tGlobal *, gboolean, gboolean);
+GList *     readSequenceFile                (gchar *);
+void        recalculateBoundaries           (tCircularBuffer *);
+void        recordCalibrationInConfigurations
+                                            (tGlobal *, guint32);
 gint        recoverConfigurations           (tGlobal *);
+tPlotSnapshot *refPlotSnapshot              (tPlotSnapshot *);
 gint        recoverSettings                 (tGlobal *);
 void        refreshMainDialog               (tGlobal *);
+void        refreshMultiSpotLabel           (tGlobal *);
 void        refreshPageHP8970               (tGlobal *);
+void        releasePlotSnapshot             (tPlotSnapshot *);
+void        requestPlotRefresh              (tGlobal *, guint);
+void        resetAccumulatedTraces          (tGlobal *);
+void        resumeInterruptedSweep          (tGlobal *);
+void        resetArena                      (tArena *);
+void        restoreSettingsFromPlot         (tGlobal *);
+gint        retrievePlot                    (gchar *, tGlobal *);
+gint        retrieveTrace                   (gchar *, tGlobal *);
+gboolean    rewriteCircularBuffer           (tCircularBuffer *, tNoiseAndGain *);
+void        rewritePointInCircularBuffer    (tCircularBuffer *, guint, tNoiseAndGain *);
 void         rightJustifiedCairoText        (cairo_t *, gchar *, gdouble, gdouble, gboolean);
+gint        runHeadless                     (tGlobal *, GList *, gboolean);
+gboolean    runSequenceHP8970               (tGlobal *, GList *, gint, gint, gint *);
+gint        saveCSV                         (gchar *, tGlobal *);
 gint        savePlot                        (gchar *filePath, tGlobal *);
 gint        saveConfigurations              (tGlobal *);
+gint        savePlotImage                   (gchar *, tGlobal *, enum eFileType);
 gint        saveSettings                    (tGlobal *);
+void        sendSettingsHP8970              (tGlobal *, gint, gint, gint *);
+void        setAccumulatorWidgets           (tGlobal *);
 void        setFixedRangePlotWidgets        (tGlobal *);
+gint        setMultiSpotFrequencies         (tHP8970settings *, gchar *);
 void        setPageExtLOwidgets             (tGlobal *);
 void        setSpinGainRange                (tGlobal *);
 void        setSpinNoiseRange               (tGlobal *);
+void        shareCircularBuffer             (tCircularBuffer *, tCircularBuffer *);
+void        showCachedCairoText             (cairo_t *, const gchar *);
+tPlotSnapshot *snapshotPlot                 (tGlobal *);
 void        snapshotSettings                (tGlobal *);
 gint        splashCreate 					(tGlobal *);
 gint        splashDestroy 					(tGlobal *);
 gboolean    spotFrequencyHP8970             (tGlobal *, gint, gint, gint *);
+void        startSweepEstimate              (tSweepEstimate *, tHP8970settings *, guint, guint);
+void        storeCalibrationTrace           (tGlobal *);
+gint        storeTrace                      (tTraceLibrary *, tCircularBuffer *, gboolean, gchar *);
+gint        storeTraceData                  (tTraceLibrary *, tNoiseAndGain *, guint, gboolean, gchar *);
+void        streamMeasurement               (tGlobal *, tNoiseAndGain *, gboolean);
 gchar *     suggestFilename                 (tGlobal *, gchar *, gchar *);
-gboolean    sweepHP8970                     (tGlobal *, gint, gint, gint *);
+gboolean    sweepHP8970                     (tGlobal *, gint, gint, gint *, gboolean);
+guint       sweepPointCount                 (gdouble, gdouble, gdouble);
+gdouble     sweepPointFrequency             (gdouble, gdouble, gdouble, guint);
+void        sweepProgress                   (tSweepEstimate *, gint *, gdouble *, gint *);
+gboolean    traceLibraryExtremes            (tTraceLibrary *, tGridAxes, tNoiseType, gdouble *, gdouble *);
+void        transformToGrid                 (tCircularBuffer *, const gdouble *, guint, guint, gboolean, gdouble, gdouble, tAxis *, gdouble, gdouble *, gdouble *, guint8 *);
 gpointer    threadGPIB					    (gpointer);
+void        toggleHeatMap                   (tGlobal *);
+gdouble     triggerPointEstimate            (tSweepEstimate *, gint);
 void        updateBoundaries                (gdouble, gdouble *, gdouble *);
 void        validateCalibrationOperation    (tGlobal *);
+void        waitForSnapshotWriter           (void);
 void        warnFrequencyRangeOutOfBounds   (tGlobal *);
+void        writePlotSnapshot               (tPlotSnapshot *, enum eFileType, gchar *);
 
 
 
@@ -511,6 +922,12 @@ void        warnFrequencyRangeOutOfBounds   (tGlobal *);
 #define IS_HP8970_ERROR(x) ((x) >= ERROR_INDICATOR_HP8970)
 #define IS_HP8970_OVERFLOW(x) ((x) == ERROR_INDICATOR_HP8970 + 99.0E06)
 
+// The noise is held linear (noise factor or Y factor) .. see HP8970units.c
+#define T0_KELVIN           290.0       // standard temperature of the noise factor & noise temperature
+#define MIN_LINEAR_NOISE    1.0e-6      // floor of a linear noise shown in dB (e.g. mean - σ)
+#define IS_Y_FACTOR(units)  ((units) == eYdB || (units) == eY)
+#define NOISE_UNITS_COMPATIBLE(a, b)    (IS_Y_FACTOR(a) == IS_Y_FACTOR(b))
+
 #define MIN_RANGE_FREQ      4.0
 
 #define MIN_RANGE_GAINdB    0.2
@@ -534,12 +951,18 @@ void        warnFrequencyRangeOutOfBounds   (tGlobal *);
 #define LOG1    0
 
 #define TIME_PLOT_LENGTH    60.0
+// time shown on a spot frequency plot (s) .. longer with smoothing and with several frequencies measured in turn
+#define TIME_PLOT_SPAN( pPlot ) (TIME_PLOT_LENGTH * (pPlot)->smoothingFactor * MAX( (pPlot)->nMultiSpot, 1 ))
 #define TIME_DIVISIONS_PER_GRID 10
 
 #define CAL_POINTS_8970A    81
 #define CAL_POINTS_8970B    181
 
 #define MAX_SPOT_POINTS    2000
+
+#define DEFAULT_ACCUMULATOR_LENGTH  8
+#define MIN_ACCUMULATOR_LENGTH      2
+#define MAX_ACCUMULATOR_LENGTH      64
 #define SMIG 0.001
 
 
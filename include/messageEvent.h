@@ -34,6 +34,8 @@ enum _threadmessage
 
 	TM_COMPLETE_GPIB,					// update widgets based on GPIB connection
 	TM_REFRESH_PLOT,
+	TM_REFRESH_SETTINGS,                // settings changed by the GPIB thread (sequencer) .. update widgets
+	TM_CALIBRATED,                      // the HP8970 was calibrated (data is the calibration key)
 	TM_SAVE_SETUP,						// save calibration and setup to database
 
 	TG_SETUP_GPIB,						// configure GPIB
@@ -41,10 +43,12 @@ enum _threadmessage
 	TG_SETUP_EXT_LO_GPIB,               // configure GPIB for the LO
 	TG_SEND_SETTINGS_to_HP8970,         // Send changed settings to the HP8970
 	TG_SWEEP_HP8970,			        // Get Frequency, Gain, Noise Figure data from HP8970
+	TG_RESUME_SWEEP_HP8970,             // Continue an interrupted sweep from the next point
     TG_SPOT_HP8970,                     // Get Frequency, Gain, Noise Figure data from HP8970
 	TG_SEND_ENR_TABLE_TO_HP8970,        // Send ENR table to HP8970
     TG_CALIBRATE,                       // Run HP8970 calibration
     TG_FREQUENCY_CALIBRATE,             // Run HP8970 frequency calibration
+    TG_RUN_SEQUENCE,                    // Run a sequence of configurations & measurements
 
 	TG_UTILITY,
 	TG_ABORT,
@@ -52,14 +56,44 @@ enum _threadmessage
 	TG_END								// end thread
 };
 
-typedef struct
+typedef struct _messageEventData
 {
     enum _threadmessage command;
     gchar *		sMessage;
     void  *		data;
     gint		dataLength;
+
+    // messages to the main loop come from a pool and are queued through this link
+    struct _messageEventData *pNext;
+    gboolean    bPooled;
+    gchar       sText[ MSG_STRING_SIZE ];   // sMessage (if it fits)
+    guint       nProgress;                  // progress events posted before this message
 } messageEventData;
 
+#define MESSAGE_POOL_SIZE   64
+
+// Progress of a measurement, posted by the GPIB thread for each point (see postProgress)
+typedef enum {
+    eProgressSweep, eProgressSpot, eProgressCalibration, eProgressLO
+} tProgressType;
+
+typedef struct {
+    tProgressType type;
+    guint       nPoint;         // point of the measurement (calibration point)
+    gdouble     freqMHz;        // frequency of the point (or of the LO)
+    gdouble     elapsed;        // seconds since the measurement began (spot)
+    gint        HP8970error;    // HP8970 error code of the point (0 if none)
+    gint        percent;        // progress of the sweep
+    gdouble     pointsPerSec;
+    gint        ETA;            // seconds to the end of the sweep
+    gboolean    bRefreshPlot;   // the point has been added to the plot
+} tProgressEvent;
+
+#define PROGRESS_RING_SIZE  32
+// what takeLatestProgress found
+#define PROGRESS_STATUS     0x01
+#define PROGRESS_LO         0x02
+
 
 extern GSourceFuncs 	messageEventFunctions;
 
@@ -68,6 +102,12 @@ void postMessageToMainLoop (enum _threadmessage Command, gchar *sMessage);
 void postInfoWithCount(gchar *sMessageWithFormat, gint number, gint number2);
 void postDataToMainLoop (enum _threadmessage Command, void *data);
 void postDataToGPIBThread (enum _threadmessage Command, void *data);
+messageEventData *getMessageForMainLoop (gint64 timeout);
+gint nMessagesForMainLoop (void);
+void releaseMessage (messageEventData *message);
+void postProgress (tProgressEvent *pEvent);
+gint takeLatestProgress (tProgressEvent *pStatus, tProgressEvent *pLO, guint *pnRefreshPlot);
+gchar *progressText (tProgressEvent *pEvent, gchar *sText, gsize size);
 
 #define postInfo(x)		postMessageToMainLoop( TM_INFO, (x) )
 #define postInfoLO(x)   postMessageToMainLoop( TM_INFO_LO, (x) )
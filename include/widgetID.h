@@ -12,19 +12,32 @@
 typedef enum {
     eW_aspect_Plot,
     eW_box_Spot,
+    eW_btn_AccumulatorReset,
     eW_btn_Calibrate,
     eW_btn_ColorReset,
     eW_btn_CSV,
+    eW_btn_HeatMap,
     eW_btn_Memory,
+    eW_btn_MultiSpotAdd,
+    eW_btn_MultiSpotClear,
     eW_btn_PDF,
     eW_btn_PNG,
     eW_btn_Print,
     eW_btn_RestoreJSON,
+    eW_btn_ResumeSweep,
     eW_btn_SaveJSON,
+    eW_btn_Sequence,
     eW_btn_SettingsDelete,
     eW_btn_SettingsRestore,
     eW_btn_SettingsSave,
     eW_btn_SVG,
+    eW_btn_TraceAdd,
+    eW_btn_TraceCalibration,
+    eW_btn_TraceClear,
+    eW_btn_TraceColor,
+    eW_btn_TraceNext,
+    eW_btn_TraceStyle,
+    eW_btn_TraceVisible,
     eW_chk_AutoScale,
     eW_chk_Correction,
     eW_chk_LossOn,
@@ -46,7 +59,10 @@ typedef enum {
     eW_combo_SettingsConfigurations,
     eW_Controls,
     eW_CV_NoiseSource,
+    eW_drawing_LiveMarker,
     eW_drawing_Plot,
+    eW_drop_Accumulated,
+    eW_drop_AccumulatorLength,
     eW_drop_IF_Attenuation,
     eW_drop_NoiseUnits,
     eW_drop_InputGainCalibration,
@@ -63,6 +79,7 @@ typedef enum {
     eW_frm_Sweep,
     eW_HP8970_application,
     eW_lbl_LOnotice,
+    eW_lbl_MultiSpot,
     eW_lbl_version,
     eW_lbl_Status,
     eW_lbl_Status_LO,
@@ -27,6 +27,7 @@
 #include <gtk/gtk.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <cairo/cairo.h>
@@ -53,6 +54,19 @@ GdkRGBA plotElementColorsFactory[ eMAX_COLORS ] = {
 };
 GdkRGBA plotElementColors[ eMAX_COLORS ];
 
+// Traces of the frequencies of a multi-spot plot (noise is solid, gain is dashed)
+static GdkRGBA multiSpotColors[ MAX_MULTI_SPOT ] = {
+        {0.00, 0.00, 0.40, 1.0},  // dark blue
+        {0.70, 0.10, 0.10, 1.0},  // red
+        {0.00, 0.45, 0.00, 1.0},  // green
+        {0.80, 0.45, 0.00, 1.0},  // orange
+        {0.45, 0.00, 0.55, 1.0},  // purple
+        {0.00, 0.50, 0.55, 1.0},  // teal
+        {0.55, 0.35, 0.15, 1.0},  // brown
+        {0.40, 0.40, 0.40, 1.0}   // grey
+};
+#define ALL_SERIES  (-1)
+
 /*!     \brief  Determine the noise and gain grid based max/min values set by user
  *
  * Determine the noise and gain grid based user limits
@@ -294,33 +308,56 @@ setCairoFontSize( cairo_t *cr, gdouble fSize ) {
     cairo_set_font_matrix(cr, &fMatrix);
 }
 
-/*!     \brief  Generate a time string (minutes and seconds of an hour only) from milliseconds since Unix epoch.
+/*!     \brief  Generate a time label (minutes and seconds of an hour only) from milliseconds since Unix epoch.
  *
- * Generate a time string (minutes and seconds of an hour only) from milliseconds since Unix epoch. 1/1/1970
+ * Generate a time label (minutes and seconds of an hour only) from milliseconds since Unix epoch. 1/1/1970
+ * The label is made in the caller's buffer and the local time zone is only looked up once
+ * (the labels are made for each frame).
  *
  * \ingroup drawing
  *
+ * \param sLabel     buffer for the label (SHORT_STRING)
  * \param msTime     ms since 1/1/1970
- * \param bShort     TRUE if no fractional seconds returned in string
- * \return           malloced string with mm:ss (or mm:ss.ss)
+ * \param bShort     TRUE if no fractional seconds (or hours) in the label
+ * \return           sLabel with mm:ss (or hh:mm:ss.s)
  *
  */
 gchar *
-msTimeToString( gint64 msTime, gboolean bShort ) {
-    gchar *sTime = NULL;
+msTimeToLabel( gchar *sLabel, gint64 msTime, gboolean bShort ) {
+    static GTimeZone *tzLocal = NULL;
+    const gint64 secondsPerDay = G_TIME_SPAN_DAY / G_TIME_SPAN_SECOND;
+    gint64 seconds = msTime / 1000, local;
+
+    if( g_once_init_enter( &tzLocal ) )
+        g_once_init_leave( &tzLocal, g_time_zone_new_local() );
+
+    local = seconds + g_time_zone_get_offset( tzLocal,
+                        g_time_zone_find_interval( tzLocal, G_TIME_TYPE_UNIVERSAL, seconds ) );
+    local = ((local % secondsPerDay) + secondsPerDay) % secondsPerDay;
 
-    GDateTime   *msTimeGD = g_date_time_new_from_unix_local ( msTime / 1000 );
     if( bShort )
-        sTime = g_strdup_printf( "%02d:%02d", g_date_time_get_minute( msTimeGD ), g_date_time_get_second( msTimeGD ) );
+        g_snprintf( sLabel, SHORT_STRING, "%02d:%02d", (gint)(local / 60 % 60), (gint)(local % 60) );
     else
-        sTime = g_strdup_printf( "%02d:%02d:%02d.%01ld", g_date_time_get_hour( msTimeGD ), g_date_time_get_minute( msTimeGD ),
-                                 g_date_time_get_second( msTimeGD ), (msTime / 100) % 10  );
+        g_snprintf( sLabel, SHORT_STRING, "%02d:%02d:%02d.%01ld", (gint)(local / 3600), (gint)(local / 60 % 60),
+                    (gint)(local % 60), (msTime / 100) % 10 );
 
-    g_date_time_unref( msTimeGD );
-    return sTime;
+    return sLabel;
 }
 
 
+/*!     \brief  Is there a trace of the trace library to show
+ *
+ * \param pGlobal       pointer to the global data structure
+ * \param axis          eFreq (any data), eNoise or eGain
+ * \return              TRUE if memory is shown and a visible trace has data for the axis
+ */
+static gboolean
+showTraceLibrary( tGlobal *pGlobal, tGridAxes axis ) {
+    gdouble min = G_MAXDOUBLE, max = -G_MAXDOUBLE;
+
+    return pGlobal->flags.bShowMemory && traceLibraryExtremes( &pGlobal->plot.traceLibrary, axis, pGlobal->plot.noiseUnits, &min, &max );
+}
+
 /*!     \brief  Determine the X and Y plot scales based on the data and settings
  *
  * Determine the X and Y plot scales based on the data and settings (like autoscale or limits)
@@ -332,59 +369,77 @@ gint
 setPlotBoundaries( tGlobal *pGlobal ) {
     gint rtnStatus = 0;
     tCircularBuffer *pMeasurementBuffer = &pGlobal->plot.measurementBuffer;
-    tCircularBuffer *pMemoryBuffer = &pGlobal->plot.memoryBuffer;
+    tTraceLibrary *pLibrary = &pGlobal->plot.traceLibrary;
+    gboolean bShowLibrary = pGlobal->flags.bShowMemory
+            && !pGlobal->plot.flags.bCalibrationPlot && !pGlobal->plot.flags.bSpotFrequencyPlot;
+    gdouble minFreq = G_MAXDOUBLE, maxFreq = -G_MAXDOUBLE;
 
     gdouble minFreqMHz = G_MAXDOUBLE, maxFreqMHz = G_MINDOUBLE, minNoise = G_MAXDOUBLE, maxNoise = G_MINDOUBLE, minGain = G_MAXDOUBLE, maxGain = G_MINDOUBLE;
+    gdouble minAccum = UNINITIALIZED_DOUBLE, maxAccum = UNINITIALIZED_DOUBLE;
+    gboolean bShowAccumulators = pGlobal->accumulatorDisplay != eAccumNone
+            && !pGlobal->plot.flags.bCalibrationPlot && !pGlobal->plot.flags.bSpotFrequencyPlot;
 
     if( pGlobal->plot.flags.bSpotFrequencyPlot ) {
         // the ord.time us a gint64 (milliseconds)
-        gdouble endTime = GINT_MSTIME_TO_DOUBLE( getItemFromCircularBuffer( pMeasurementBuffer, LAST_ITEM )->abscissa.time );    // in ms
+        tNoiseAndGain last;
+        gdouble endTime = GINT_MSTIME_TO_DOUBLE( getItemFromCircularBuffer( pMeasurementBuffer, LAST_ITEM, &last )->abscissa.time );    // in ms
 
         determineTimeExtremesInCircularBuffer( pMeasurementBuffer );
 
         // plot maximum is the last sample received
         // plot minimum is the maximum - TIME_PLOT_LENGTH
-        pGlobal->plot.axis[ eFreqOrTime ].min = endTime - (TIME_PLOT_LENGTH * pGlobal->plot.smoothingFactor);
+        pGlobal->plot.axis[ eFreqOrTime ].min = endTime - TIME_PLOT_SPAN( &pGlobal->plot );
         pGlobal->plot.axis[ eFreqOrTime ].max = endTime;
         // the internal time grid has an offset from the edges
-        pGlobal->plot.axis[ eFreqOrTime ].offset = (TIME_PLOT_LENGTH / TIME_DIVISIONS_PER_GRID * pGlobal->plot.smoothingFactor)
-                                                        - fmod( endTime, (TIME_PLOT_LENGTH / TIME_DIVISIONS_PER_GRID) * pGlobal->plot.smoothingFactor );
+        pGlobal->plot.axis[ eFreqOrTime ].offset = (TIME_PLOT_SPAN( &pGlobal->plot ) / TIME_DIVISIONS_PER_GRID)
+                                                        - fmod( endTime, TIME_PLOT_SPAN( &pGlobal->plot ) / TIME_DIVISIONS_PER_GRID );
 
-        pGlobal->plot.axis[ eFreqOrTime ].perDiv = (TIME_PLOT_LENGTH / TIME_DIVISIONS_PER_GRID) * pGlobal->plot.smoothingFactor;
+        pGlobal->plot.axis[ eFreqOrTime ].perDiv = TIME_PLOT_SPAN( &pGlobal->plot ) / TIME_DIVISIONS_PER_GRID;
     } else {
         if( pMeasurementBuffer->flags.bValidNoiseData || pMeasurementBuffer->flags.bValidGainData) {
             minFreqMHz = MIN( minFreqMHz, pMeasurementBuffer->minAbscissa.freq / MHz(1.0) );
             maxFreqMHz = MAX( maxFreqMHz, pMeasurementBuffer->maxAbscissa.freq / MHz(1.0) );
         }
-        if( pGlobal->flags.bShowMemory &&
-                (pMemoryBuffer->flags.bValidNoiseData || pMemoryBuffer->flags.bValidGainData)) {
-            minFreqMHz = MIN( minFreqMHz, pMemoryBuffer->minAbscissa.freq / MHz(1.0) );
-            maxFreqMHz = MAX( maxFreqMHz, pMemoryBuffer->maxAbscissa.freq / MHz(1.0) );
+        if( pGlobal->flags.bShowMemory && traceLibraryExtremes( pLibrary, eFreq, pGlobal->plot.noiseUnits, &minFreq, &maxFreq ) ) {
+            minFreqMHz = MIN( minFreqMHz, minFreq / MHz(1.0) );
+            maxFreqMHz = MAX( maxFreqMHz, maxFreq / MHz(1.0) );
         }
 
         quantizePlotFrequencyRange( pGlobal, minFreqMHz, maxFreqMHz );
     }
 
     if( pGlobal->HP8970settings.switches.bAutoScaling || pGlobal->plot.flags.bCalibrationPlot ) {
+        gdouble minBufferNoise, maxBufferNoise, minBufferGain, maxBufferGain;
+
+        // (the acquisition thread may be changing them)
+        circularBufferExtremes( pMeasurementBuffer, &minBufferNoise, &maxBufferNoise, &minBufferGain, &maxBufferGain );
+        // the noise is held linear .. the extremes are converted to the units of the plot (keeping their order)
         if( pMeasurementBuffer->flags.bValidNoiseData ) {
-            minNoise = MIN( minNoise, pMeasurementBuffer->minNoise );
-            maxNoise = MAX( maxNoise, pMeasurementBuffer->maxNoise );
+            minNoise = MIN( minNoise, noiseInUnits( minBufferNoise, pGlobal->plot.noiseUnits ) );
+            maxNoise = MAX( maxNoise, noiseInUnits( maxBufferNoise, pGlobal->plot.noiseUnits ) );
         }
-        if( !pGlobal->plot.flags.bCalibrationPlot && !pGlobal->plot.flags.bSpotFrequencyPlot &&
-                pGlobal->flags.bShowMemory && pMemoryBuffer->flags.bValidNoiseData) {
-            minNoise = MIN( minNoise, pMemoryBuffer->minNoise );
-            maxNoise = MAX( maxNoise, pMemoryBuffer->maxNoise );
+        if( bShowLibrary )
+            traceLibraryExtremes( pLibrary, eNoise, pGlobal->plot.noiseUnits, &minNoise, &maxNoise );
+        if( bShowAccumulators
+                && accumulatorExtremes( &pGlobal->plot.accumulators, pGlobal->accumulatorDisplay,
+                                        eNoise, &minAccum, &maxAccum ) ) {
+            minNoise = MIN( minNoise, noiseInUnits( minAccum, pGlobal->plot.noiseUnits ) );
+            maxNoise = MAX( maxNoise, noiseInUnits( maxAccum, pGlobal->plot.noiseUnits ) );
         }
         quantizePlotRange( pGlobal, minNoise, maxNoise, eNoise );
 
         if( pMeasurementBuffer->flags.bValidGainData ) {
-            minGain = MIN( minGain, pMeasurementBuffer->minGain );
-            maxGain = MAX( maxGain, pMeasurementBuffer->maxGain );
+            minGain = MIN( minGain, minBufferGain );
+            maxGain = MAX( maxGain, maxBufferGain );
         }
-        if( !pGlobal->plot.flags.bCalibrationPlot && !pGlobal->plot.flags.bSpotFrequencyPlot
-                && pGlobal->flags.bShowMemory && pMemoryBuffer->flags.bValidGainData) {
-            minGain = MIN( minGain, pMemoryBuffer->minGain );
-            maxGain = MAX( maxGain, pMemoryBuffer->maxGain );
+        if( bShowLibrary )
+            traceLibraryExtremes( pLibrary, eGain, pGlobal->plot.noiseUnits, &minGain, &maxGain );
+        minAccum = maxAccum = UNINITIALIZED_DOUBLE;
+        if( bShowAccumulators
+                && accumulatorExtremes( &pGlobal->plot.accumulators, pGlobal->accumulatorDisplay,
+                                        eGain, &minAccum, &maxAccum ) ) {
+            minGain = MIN( minGain, minAccum );
+            maxGain = MAX( maxGain, maxAccum );
         }
         quantizePlotRange( pGlobal, minGain, maxGain, eGain );
     } else {
@@ -433,7 +488,7 @@ showTitleAndTime( cairo_t *cr, tGridParameters *pGrid, gchar *sTitle, gchar *sTi
         // Title
         cairo_select_font_face(cr, LABEL_FONT, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
         setCairoFontSize(cr, pGrid->fontSize * 1.3); // initially 10 pixels
-        cairo_show_text (cr, sTitle);
+        showCachedCairoText (cr, sTitle);
 
         // Time
         if( pGlobal->flags.bShowTime ) {
@@ -450,7 +505,7 @@ gchar *sNoiseUnits[ eMAX_NOISE_UNITS ] = {"dB", "", "dB", "", "K"};
 
 /*!     \brief  Plot grid
  *
- * Draw the grid
+ * Draw the grid (the plot boundaries must have been set)
  *
  * \param cr            pointer to cairo structure
  * \param pGrid         pointer to grid settings
@@ -477,8 +532,6 @@ plotGrid( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
     gdouble x, y;
     gint dp = 0;
 
-    setPlotBoundaries( pGlobal );
-
     gboolean bDifferentGrids = fabs((pNoiseAxis->max - pNoiseAxis->min) / pNoiseAxis->perDiv
                                         - (pGainAxis->max - pGainAxis->min) / pGainAxis->perDiv)
                                                 > VERY_SMALL
@@ -501,7 +554,7 @@ plotGrid( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
 //  X frequency or time (spot frequency) grid
 
         if( bSpotFreqency ) {
-            pixelsPerUnit = pGrid->gridWidth / (TIME_PLOT_LENGTH * pGlobal->plot.smoothingFactor);
+            pixelsPerUnit = pGrid->gridWidth / TIME_PLOT_SPAN( &pGlobal->plot );
         } else {
             pixelsPerUnit = pGrid->gridWidth / (pFreqAxis->max - pFreqAxis->min);
             bAdditionalLines = (pFreqAxis->max - pFreqAxis->min) / pFreqAxis->perDiv < 10;
@@ -558,9 +611,7 @@ plotGrid( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
                 continue;
 
             if( bSpotFreqency ) {
-                gchar * sTime = msTimeToString( (gint64)(freqOrTime * 1000.0), TRUE );
-                g_snprintf( sLegend, SHORT_STRING, "%s", sTime );
-                g_free( sTime );
+                msTimeToLabel( sLegend, (gint64)(freqOrTime * 1000.0), TRUE );
             }
             else {
                 g_snprintf( sLegend, SHORT_STRING, "%.*lf", pFreqAxis->perDiv < 1.0 ? 1:0, freqOrTime );
@@ -572,9 +623,7 @@ plotGrid( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
         }
 // left hand frequency/time annotation (min)
         if( bSpotFreqency ) {
-            gchar * sTime = msTimeToString( (gint64)(pFreqAxis->min * 1000.0), TRUE );
-            g_snprintf( sLegend, SHORT_STRING, "%s", sTime );
-            g_free( sTime );
+            msTimeToLabel( sLegend, (gint64)(pFreqAxis->min * 1000.0), TRUE );
         } else {
             g_snprintf( sLegend, SHORT_STRING, "%.*lf", pFreqAxis->perDiv < 1.0 ? 1:0,
                     pFreqAxis->min );
@@ -582,9 +631,7 @@ plotGrid( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
         centreJustifiedCairoText(cr, sLegend, pGrid->leftGridPosn, pGrid->bottomGridPosn - 1.6 * pGrid->fontSize, 1.0 );
 // right hand frequency/time annotation (max)
         if( bSpotFreqency ) {
-            gchar * sTime = msTimeToString( (gint64)(pFreqAxis->max * 1000.0), TRUE );
-            g_snprintf( sLegend, SHORT_STRING, "%s", sTime );
-            g_free( sTime );
+            msTimeToLabel( sLegend, (gint64)(pFreqAxis->max * 1000.0), TRUE );
         } else {
             g_snprintf( sLegend, SHORT_STRING, "%.*lf", pFreqAxis->perDiv < 1.0 ? 1:0, pFreqAxis->max );
         }
@@ -595,7 +642,17 @@ plotGrid( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
         centreJustifiedCairoText(cr, bSpotFreqency ? "Time (mm:ss)" : "Frequency (MHz)", pGrid->leftGridPosn + pGrid->gridWidth / 2.0,
                                  pGrid->bottomGridPosn - 4.0 * pGrid->fontSize, 0.0 );
         setCairoFontSize(cr, pGrid->fontSize);
-        if( bSpotFreqency ) {
+        if( bSpotFreqency && pGlobal->plot.nMultiSpot >= 2 ) {
+            // each frequency in the color of its trace
+            leftJustifiedCairoText(cr, "Frequency:", pGrid->leftGridPosn, pGrid->bottomGridPosn - 4.0 * pGrid->fontSize, 1.0 );
+            for( gint series = 0; series < pGlobal->plot.nMultiSpot; series++ ) {
+                g_snprintf( sLegend, SHORT_STRING, " %.0lf", pGlobal->plot.multiSpotMHz[ series ] );
+                gdk_cairo_set_source_rgba (cr, &multiSpotColors[ series ] );
+                showCachedCairoText( cr, sLegend );
+            }
+            gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorFrequency   ] );
+            showCachedCairoText( cr, " MHz" );
+        } else if( bSpotFreqency ) {
             g_snprintf( sLegend, SHORT_STRING, "Frequency: %.0lf MHz", pGlobal->plot.freqSpotMHz );
             leftJustifiedCairoText(cr, sLegend, pGrid->leftGridPosn, pGrid->bottomGridPosn - 4.0 * pGrid->fontSize, 1.0 );
         }
@@ -685,8 +742,7 @@ plotGrid( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
 
 // Y (right) gain grid
 
-        if( pGlobal->plot.measurementBuffer.flags.bValidGainData ||
-                (pGlobal->flags.bShowMemory && pGlobal->plot.memoryBuffer.flags.bValidGainData )) {
+        if( pGlobal->plot.measurementBuffer.flags.bValidGainData || showTraceLibrary( pGlobal, eGain ) ) {
             if( pGainAxis->perDiv < 0.1 )
                 dp = 2;
             else if ( pGainAxis->perDiv < 1.0 )
@@ -840,10 +896,98 @@ setGrid( tGridParameters *pGrid, gint areaWidth, gint areaHeight, gboolean bSupp
     pGrid->bSuppressLiveMarker = bSuppressLiveMarker;
 }
 
+/*!     \brief  Abscissa of a measurement in a circular buffer
+ *
+ * \param pDataBuffer     pointer to the circular buffer
+ * \param item            item (0 is the oldest)
+ * \param freqOrTime      frequency or time x
+ * \return                frequency (Hz) or time (ms)
+ */
+static inline gdouble
+abscissaOfItem( tCircularBuffer *pDataBuffer, gint item, tAbscissa freqOrTime ) {
+    tAbscissaValue *pAbscissa = &pDataBuffer->abscissa[ CIRCULAR_BUFFER_POSN( pDataBuffer, item ) ];
+
+    return freqOrTime == eFreqAbscissa ? pAbscissa->freq : GINT_MSTIME_TO_DOUBLE( pAbscissa->time );
+}
+
+/*!     \brief  Free the marker index
+ *
+ * \param pIndex          pointer to the marker index
+ */
+void
+freeMarkerIndex( tMarkerIndex *pIndex ) {
+    g_free( pIndex->before );
+    bzero( pIndex, sizeof( tMarkerIndex ) );
+}
+
+/*!     \brief  Make sure the marker index is current
+ *
+ * The index is rebuilt only if measurements were added (or the buffer was reinitialized)
+ * or the abscissa axis or the grid width changed. An evenly spaced frequency sweep needs
+ * no table; otherwise each pixel column holds the last measurement at or before it.
+ *
+ * \ingroup drawing
+ *
+ * \param pIndex          pointer to the marker index
+ * \param pDataBuffer     pointer to the circular buffer
+ * \param freqOrTimeScale scale value for the abscissa (pixels per unit)
+ * \param min             minimum of the abscissa axis
+ * \param gridWidth       width of the grid
+ * \param freqOrTime      frequency or time x
+ */
+static void
+updateMarkerIndex( tMarkerIndex *pIndex, tCircularBuffer *pDataBuffer, gdouble freqOrTimeScale,
+                   gdouble min, gdouble gridWidth, tAbscissa freqOrTime ) {
+    tBufferIndices indices = ACQUIRE_BUFFER_INDICES( pDataBuffer );
+    guint head = indices.head, tail = indices.tail;
+    gdouble unit = (freqOrTime == eFreqAbscissa ? MHz(1.0) : 1.0);
+    gint nItems, nColumns = (gint)ceil( gridWidth ) + 1;
+
+    if( pIndex->abscissa == pDataBuffer->abscissa && pIndex->head == head && pIndex->tail == tail
+            && pIndex->size == pDataBuffer->size && pIndex->freqOrTime == freqOrTime
+            && pIndex->min == min && pIndex->scale == freqOrTimeScale && pIndex->nColumns == nColumns )
+        return;
+
+    pIndex->abscissa = pDataBuffer->abscissa;
+    pIndex->head = head;
+    pIndex->tail = tail;
+    pIndex->size = pDataBuffer->size;
+    pIndex->freqOrTime = freqOrTime;
+    pIndex->min = min;
+    pIndex->scale = freqOrTimeScale;
+    pIndex->nColumns = nColumns;
+
+    nItems = nItemsInCircularBuffer( pDataBuffer );
+
+    // A frequency sweep is (usually) evenly spaced .. the measurement is then calculated
+    pIndex->bUniform = FALSE;
+    if( freqOrTime == eFreqAbscissa && nItems > 1 ) {
+        pIndex->first = abscissaOfItem( pDataBuffer, 0, eFreqAbscissa );
+        pIndex->step = (abscissaOfItem( pDataBuffer, nItems - 1, eFreqAbscissa ) - pIndex->first) / (nItems - 1);
+        pIndex->bUniform = (pIndex->step > 0.0);
+        for( gint i = 1; pIndex->bUniform && i < nItems; i++ )
+            if( fabs( abscissaOfItem( pDataBuffer, i, eFreqAbscissa ) - (pIndex->first + i * pIndex->step) )
+                    > pIndex->step * 1.0e-6 )
+                pIndex->bUniform = FALSE;
+    }
+    if( pIndex->bUniform )
+        return;
+
+    // one pass over the columns and measurements together
+    pIndex->before = g_realloc( pIndex->before, nColumns * sizeof( gint ) );
+    for( gint column = 0, item = -1; column < nColumns; column++ ) {
+        gdouble ordinate = (column / freqOrTimeScale + min) * unit;
+        while( item + 1 < nItems && abscissaOfItem( pDataBuffer, item + 1, freqOrTime ) <= ordinate )
+            item++;
+        pIndex->before[ column ] = item;
+    }
+}
+
 /*!     \brief  Interpolate the trace between measuring points
  *
  * Interpolate the trace between measuring points, The live marker may be between measurement points but
- * we still wish to show the interpolated value.
+ * we still wish to show the interpolated value. The measurements either side are found from the marker
+ * index (the pixel column of the marker), so noise and gain are read in the one lookup.
  *
  * \ingroup drawing
  *
@@ -851,110 +995,84 @@ setGrid( tGridParameters *pGrid, gint areaWidth, gint areaHeight, gboolean bSupp
  * \param targetX         x position that we wish to get the interpolated ordinate for
  * \param freqOrTimeScale scale value for the abscissa
  * \param freqOrTime      frequency or time x
- * \param whichGrid       noise or gain to return
- * \return                noise or gain interploated value
+ * \param series          frequency of a multi-spot plot (or ALL_SERIES)
+ * \return                noise and gain interpolated values (x is INVALID if not over the measurements)
  */
-tCoordinate
-interpolate( tGlobal *pGlobal, gdouble targetX, gdouble freqOrTimeScale, tAbscissa freqOrTime, tGridAxes whichGrid ) {
-    gdouble targetOrdinate;
+tMarkerReading
+interpolate( tGlobal *pGlobal, gdouble targetX, gdouble freqOrTimeScale, tAbscissa freqOrTime, gint series ) {
     tCircularBuffer *pDataBuffer = &pGlobal->plot.measurementBuffer;
-    gint    nearestIndex = 0;
+    tMarkerIndex *pIndex = &pGlobal->plot.markerIndex;
+    tAxis *pFreqOrTimeAxis = &pGlobal->plot.axis[ eFreqOrTime ];
+    gdouble targetOrdinate, fraction;
+    gint nMeasurements = nItemsInCircularBuffer( pDataBuffer );
+    gint before, after;
+    tNoiseAndGain measurementBefore, measurementAfter;
+    tNoiseAndGain *pBefore = &measurementBefore, *pAfter = &measurementAfter;
 
-    gdouble nearestOrdinate, testOrdinate;
+    tMarkerReading reading = {INVALID, 0.0, 0.0};
 
-    tCoordinate interpolatedPoint = {INVALID, 0.0};
-    // We start our search for the nearest frequency or time between the first and last
-    // items in the circular buffer
-    gint start = 0, end = nItemsInCircularBuffer( pDataBuffer ) - 1 , mid = 0;
+    if( nMeasurements == 0 || targetX < 0.0 )
+        return reading;
 
     // If the x position of the mouse is not in range, ignore
-    if( freqOrTime == eFreqAbscissa ) {
-        targetOrdinate = (targetX / freqOrTimeScale + pGlobal->plot.axis[ eFreqOrTime ].min) * MHz(1.0);
-        if( targetOrdinate < getItemFromCircularBuffer( pDataBuffer, 0 )->abscissa.freq
-        		|| targetOrdinate > getItemFromCircularBuffer( pDataBuffer, end )->abscissa.freq )
-        	return interpolatedPoint;
-    } else {
-        targetOrdinate = (targetX / freqOrTimeScale + pGlobal->plot.axis[ eFreqOrTime ].min);
-        if( targetOrdinate < GINT_MSTIME_TO_DOUBLE( getItemFromCircularBuffer( pDataBuffer, 0 )->abscissa.time )
-        		|| targetOrdinate > GINT_MSTIME_TO_DOUBLE( getItemFromCircularBuffer( pDataBuffer, end )->abscissa.time ) )
-            return interpolatedPoint;
-    }
-
-    // do the binary search (max log n times)
-    while(start <= end){
-        mid = (start + end) / 2;
-        if( freqOrTime == eFreqAbscissa ) {
-            nearestOrdinate = getItemFromCircularBuffer( pDataBuffer, nearestIndex )->abscissa.freq;
-            testOrdinate    = getItemFromCircularBuffer( pDataBuffer, mid )->abscissa.freq;
-        } else {
-            nearestOrdinate = GINT_MSTIME_TO_DOUBLE( getItemFromCircularBuffer( pDataBuffer, nearestIndex )->abscissa.time);
-            testOrdinate    = GINT_MSTIME_TO_DOUBLE( getItemFromCircularBuffer( pDataBuffer, mid )->abscissa.time);
-        }
-
-        if( fabs(testOrdinate - targetOrdinate) < fabs(nearestOrdinate - targetOrdinate)){
-            nearestIndex = mid;
-        } else if( fabs(testOrdinate - targetOrdinate) == fabs(nearestOrdinate - targetOrdinate) ){
-            if( testOrdinate > nearestOrdinate )
-                nearestIndex = mid;
-        }
-
-        if(testOrdinate == targetOrdinate ){
-            nearestIndex = mid;
-             break;
-        } else if( testOrdinate < targetOrdinate ){
-             start = mid + 1;
-        } else{
-             end = mid - 1;
-        }
-    }
-
-    gdouble noiseInterpolation, gainInterpolation;
-    gdouble fraction;
-    tNoiseAndGain *pMeasurementNearest = getItemFromCircularBuffer( pDataBuffer, nearestIndex );
-
-    // we have found the nearest sample, now interpolate between the samples or either side of the target
     if( freqOrTime == eFreqAbscissa )
-        nearestOrdinate = pMeasurementNearest->abscissa.freq;
+        targetOrdinate = (targetX / freqOrTimeScale + pFreqOrTimeAxis->min) * MHz(1.0);
     else
-        nearestOrdinate = GINT_MSTIME_TO_DOUBLE( pMeasurementNearest->abscissa.time );
+        targetOrdinate = (targetX / freqOrTimeScale + pFreqOrTimeAxis->min);
+    if( targetOrdinate < abscissaOfItem( pDataBuffer, 0, freqOrTime )
+            || targetOrdinate > abscissaOfItem( pDataBuffer, nMeasurements - 1, freqOrTime ) )
+        return reading;
 
-    if( nearestOrdinate > targetOrdinate ) {
-        tNoiseAndGain *pMeasurementBeforeNearest = getItemFromCircularBuffer( pDataBuffer, nearestIndex - 1 );
-        if( freqOrTime == eFreqAbscissa )
-            fraction = (targetOrdinate  - pMeasurementBeforeNearest->abscissa.freq) /
-                                   (nearestOrdinate - pMeasurementBeforeNearest->abscissa.freq);
-        else
-            fraction = (targetOrdinate  - GINT_MSTIME_TO_DOUBLE( pMeasurementBeforeNearest->abscissa.time )) /
-                                   (nearestOrdinate - GINT_MSTIME_TO_DOUBLE( pMeasurementBeforeNearest->abscissa.time ));
-
-        noiseInterpolation = (pMeasurementBeforeNearest->noise * (1.0 - fraction))
-                                + (fraction * pMeasurementNearest->noise);
-        gainInterpolation = (pMeasurementBeforeNearest->gain * (1.0 - fraction))
-                                + (fraction * pMeasurementNearest->gain);
-    } else if( nearestOrdinate < targetOrdinate ) {
-        tNoiseAndGain *pMeasurementAfterNearest = getItemFromCircularBuffer( pDataBuffer, nearestIndex + 1 );
-        if( freqOrTime == eFreqAbscissa )
-            fraction = (targetOrdinate - nearestOrdinate) /
-                       (pMeasurementAfterNearest->abscissa.freq - nearestOrdinate);
-        else
-            fraction = (targetOrdinate - nearestOrdinate) /
-                       (GINT_MSTIME_TO_DOUBLE(pMeasurementAfterNearest->abscissa.time) - nearestOrdinate);
+    updateMarkerIndex( pIndex, pDataBuffer, freqOrTimeScale, pFreqOrTimeAxis->min,
+                       (pFreqOrTimeAxis->max - pFreqOrTimeAxis->min) * freqOrTimeScale, freqOrTime );
 
-        noiseInterpolation = (pMeasurementNearest->noise * (1.0 - fraction))
-                                        + (fraction * pMeasurementAfterNearest->noise);
-        gainInterpolation = (pMeasurementNearest->gain * (1.0 - fraction))
-                                        + (fraction * pMeasurementAfterNearest->gain);
+    // the last measurement at or before the target
+    if( pIndex->bUniform )
+        before = (gint)floor( (targetOrdinate - pIndex->first) / pIndex->step );
+    else
+        before = pIndex->before[ MIN( (gint)targetX, pIndex->nColumns - 1 ) ];
+    before = CLAMP( before, 0, nMeasurements - 1 );
+    // (only the measurements within the pixel column .. if any)
+    while( before + 1 < nMeasurements && abscissaOfItem( pDataBuffer, before + 1, freqOrTime ) <= targetOrdinate )
+        before++;
+    while( before > 0 && abscissaOfItem( pDataBuffer, before, freqOrTime ) > targetOrdinate )
+        before--;
+
+    // The frequencies of a multi-spot plot are interleaved .. interpolate between the samples of
+    // the one frequency either side of the target (at most a round of the frequencies away)
+    if( series != ALL_SERIES ) {
+        for( ; before >= 0; before-- ) {
+            getItemFromCircularBuffer( pDataBuffer, before, pBefore );
+            if( pBefore->flags.each.bbSeries == series
+                    && GINT_MSTIME_TO_DOUBLE( pBefore->abscissa.time ) <= targetOrdinate )
+                break;
+        }
+        for( after = MAX( before, 0 ); after < nMeasurements; after++ ) {
+            getItemFromCircularBuffer( pDataBuffer, after, pAfter );
+            if( pAfter->flags.each.bbSeries == series
+                    && GINT_MSTIME_TO_DOUBLE( pAfter->abscissa.time ) >= targetOrdinate )
+                break;
+        }
+        if( before < 0 || after >= nMeasurements )
+            return reading;
     } else {
-        noiseInterpolation = pMeasurementNearest->noise;
-        gainInterpolation  = pMeasurementNearest->gain;
+        after = MIN( before + 1, nMeasurements - 1 );
+        getItemFromCircularBuffer( pDataBuffer, before, pBefore );
+        getItemFromCircularBuffer( pDataBuffer, after, pAfter );
     }
 
-    interpolatedPoint.x = targetOrdinate;
-    if( whichGrid == eNoise )
-        interpolatedPoint.y = noiseInterpolation;
+    if( after == before || abscissaOfItem( pDataBuffer, before, freqOrTime ) == targetOrdinate )
+        fraction = 0.0;
     else
-        interpolatedPoint.y = gainInterpolation;
-    return( interpolatedPoint );
+        fraction = (targetOrdinate - abscissaOfItem( pDataBuffer, before, freqOrTime )) /
+                   (abscissaOfItem( pDataBuffer, after, freqOrTime ) - abscissaOfItem( pDataBuffer, before, freqOrTime ));
+
+    // between the points of the trace as drawn (in the units of the plot)
+    reading.x = targetOrdinate;
+    reading.noise = noiseInUnits( pBefore->noise, pGlobal->plot.noiseUnits ) * (1.0 - fraction)
+                        + fraction * noiseInUnits( pAfter->noise, pGlobal->plot.noiseUnits );
+    reading.gain  = pBefore->gain  * (1.0 - fraction) + fraction * pAfter->gain;
+    return( reading );
 }
 
 /*!     \brief  Draw a floating number aligned to the decimal point
@@ -1008,61 +1126,499 @@ clipData( gdouble data, gdouble minimum, gdouble maximum ) {
 #define UNIT_OFFSET_FdB 2
 
 
-/*!     \brief  Draw trace
+/*!     \brief  Choose the frequency of a multi-spot plot for the live marker
  *
- * Plot gain vs frequency onto drawing area
+ * The live marker follows the noise trace closest to the mouse.
+ *
+ * \param pGlobal         pointer to global data
+ * \param pGrid           pointer to grid parameters
+ * \param xLM             x position of the live marker (from the left of the grid)
+ * \param yLM             y position of the live marker (from the bottom of the grid)
+ * \return                series (index of the frequency) or ALL_SERIES if not a multi-spot plot
+ */
+static gint
+liveMarkerSeries( tGlobal *pGlobal, tGridParameters *pGrid, gdouble xLM, gdouble yLM ) {
+    tAxis *pNoiseAxis = &pGlobal->plot.axis[ eNoise ];
+    tAxis *pFreqOrTimeAxis = &pGlobal->plot.axis[ eFreqOrTime ];
+    gdouble timeScale = pGrid->gridWidth / ( pFreqOrTimeAxis->max - pFreqOrTimeAxis->min );
+    gdouble noiseScale = pGrid->gridHeight /( pNoiseAxis->max - pNoiseAxis->min );
+    gdouble distance = G_MAXDOUBLE;
+    gint nearest = 0;
+
+    if( !pGlobal->plot.flags.bSpotFrequencyPlot || pGlobal->plot.nMultiSpot < 2 )
+        return ALL_SERIES;
+
+    for( gint series = 0; series < pGlobal->plot.nMultiSpot; series++ ) {
+        tMarkerReading intercept = interpolate( pGlobal, xLM, timeScale, eTimeAbscissa, series );
+        if( intercept.x != INVALID && fabs( (intercept.noise - pNoiseAxis->min) * noiseScale - yLM ) < distance ) {
+            distance = fabs( (intercept.noise - pNoiseAxis->min) * noiseScale - yLM );
+            nearest = series;
+        }
+    }
+    return nearest;
+}
+
+// Where the path of a trace has got to .. so that it can be continued by the measurements that follow
+typedef struct {
+    gdouble x, y;
+    gdouble length;             // along the trace since it (re)started (the offset of a dashed trace)
+    gboolean bRestartTrace;
+} tTracePen;
+
+/*!     \brief  Start the pens of the traces afresh
+ *
+ * \param pens          array of MAX_MULTI_SPOT pens
+ */
+static void
+resetTracePens( tTracePen *pens ) {
+    for( gint series = 0; series < MAX_MULTI_SPOT; series++ ) {
+        bzero( &pens[ series ], sizeof( tTracePen ) );
+        pens[ series ].bRestartTrace = TRUE;
+    }
+}
+
+/*!     \brief  Position on the grid of a measurement (x)
+ *
+ * \param pGlobal       pointer to the global data structure
+ * \param pDataBuffer   pointer to data circular buffer
+ * \param posn          position of the measurement in the columns
+ * \param ordinateScaling  pixels per unit of the frequency or time axis
+ * \return              x position (from the left of the grid)
+ */
+static inline gdouble
+xOfMeasurement( tGlobal *pGlobal, tCircularBuffer *pDataBuffer, guint posn, gdouble ordinateScaling ) {
+    tAxis *pFreqOrTimeAxis = &pGlobal->plot.axis[ eFreqOrTime ];
+
+    if( pGlobal->plot.flags.bSpotFrequencyPlot )
+        return ( GINT_MSTIME_TO_DOUBLE( pDataBuffer->abscissa[ posn ].time ) - pFreqOrTimeAxis->min ) * ordinateScaling;
+    else
+        return ( pDataBuffer->abscissa[ posn ].freq/MHz(1.0) - pFreqOrTimeAxis->min ) * ordinateScaling;
+}
+
+/*!     \brief  The contiguous runs of a range of the items of a circular buffer
+ *
+ * \param spans         the runs of all the items (see circularBufferSpans)
+ * \param nSpans        number of runs
+ * \param first         first item of the range (0 is the oldest)
+ * \param n             number of items in the range
+ * \param range         array of two spans (filled)
+ * \return              number of spans of the range (0, 1 or 2)
+ */
+static gint
+itemRangeSpans( tBufferSpan *spans, gint nSpans, guint first, guint n, tBufferSpan *range ) {
+    gint nRange = 0;
+
+    for( gint span = 0; span < nSpans && n > 0; span++ ) {
+        if( first >= spans[ span ].count ) {
+            first -= spans[ span ].count;
+            continue;
+        }
+        range[ nRange ].start = spans[ span ].start + first;
+        range[ nRange ].count = MIN( n, spans[ span ].count - first );
+        n -= range[ nRange ].count;
+        first = 0;
+        nRange++;
+    }
+    return nRange;
+}
+
+// The measurements of a trace that fall in one pixel column (other than the first, which is already
+// in the path). Only the extremes and the last are added to the path when the trace leaves the column.
+typedef struct {
+    gint column;                        // pixel column (from the left of the grid)
+    gint n;                             // measurements held
+    gint iMin, iMax;                    // .. which of them are the extremes
+    gdouble xMin, yMin, xMax, yMax;     // positions of the extremes
+    gdouble xLast, yLast;
+} tPixelColumn;
+
+/*!     \brief  Add a line to the path of a trace
+ *
+ * \param cr            pointer to cairo structure
+ * \param pPen          where the trace has got to (updated)
+ * \param xPos          x position
+ * \param yPos          y position
+ */
+static inline void
+penLineTo( cairo_t *cr, tTracePen *pPen, gdouble xPos, gdouble yPos ) {
+    cairo_line_to( cr, xPos, yPos );
+    pPen->length += hypot( xPos - pPen->x, yPos - pPen->y );
+    pPen->x = xPos;
+    pPen->y = yPos;
+}
+
+/*!     \brief  Add the measurements held for a pixel column to the path of a trace
+ *
+ * The minimum and maximum (in the order they were measured) and then the last measurement
+ * are added, so peaks are kept however many measurements share the column.
+ *
+ * \param cr            pointer to cairo structure
+ * \param pColumn       pointer to the measurements of the column (emptied)
+ * \param pPen          where the trace has got to (updated)
+ */
+static void
+flushPixelColumn( cairo_t *cr, tPixelColumn *pColumn, tTracePen *pPen ) {
+    gint iLast = pColumn->n - 1;
+
+    if( pColumn->n == 0 )
+        return;
+
+    if( pColumn->iMin < pColumn->iMax ) {
+        penLineTo( cr, pPen, pColumn->xMin, pColumn->yMin );
+        penLineTo( cr, pPen, pColumn->xMax, pColumn->yMax );
+    } else {
+        penLineTo( cr, pPen, pColumn->xMax, pColumn->yMax );
+        if( pColumn->iMin != pColumn->iMax )
+            penLineTo( cr, pPen, pColumn->xMin, pColumn->yMin );
+    }
+    if( iLast > MAX( pColumn->iMin, pColumn->iMax ) )
+        penLineTo( cr, pPen, pColumn->xLast, pColumn->yLast );
+    pColumn->n = 0;
+}
+
+/*!     \brief  Add the measurements of some runs of a buffer to the path of a trace
+ *
+ * The runs are transformed to positions on the grid TRACE_CHUNK measurements at a time
+ * (see transformToGrid) and the path is made from those. The path continues from where the pen is
+ * (and the pen is left at the last measurement).
+ *
+ * When drawn to pixels (the screen or an image) a trace is reduced to (at most) the first, minimum,
+ * maximum and last of the measurements in each pixel column, so the path of a long spot frequency
+ * plot or a fine sweep is bounded by the width of the grid rather than the number of measurements.
+ * Vector output (printing, PDF & SVG) may be enlarged and keeps every measurement.
  *
  * \param cr            pointer to cairo structure
  * \param pGlobal       pointer to the global data structure
  * \param pDataBuffer   pointer to data circular buffer
+ * \param spans         the runs of the measurements to add
+ * \param nSpans        number of runs
  * \param width         width of grid space
  * \param height        height of grid space
  * \param axis          which axis
+ * \param series        only this frequency of a multi-spot plot (or ALL_SERIES)
+ * \param pPen          where the trace has got to (updated)
  */
-void
-drawTrace( cairo_t *cr, tGlobal * pGlobal, tCircularBuffer *pDataBuffer,
-           gdouble gridWidth, gdouble gridHeight, tGridAxes axis ) {
+static void
+spansToPath( cairo_t *cr, tGlobal * pGlobal, tCircularBuffer *pDataBuffer, tBufferSpan *spans, gint nSpans,
+             gdouble gridWidth, gdouble gridHeight, tGridAxes axis, gint series, tTracePen *pPen ) {
 
-    tNoiseAndGain *pMeasurement;
-    gdouble xPos;
-    gboolean bRestartTrace = TRUE;
-    gint nMeasurements = nItemsInCircularBuffer( pDataBuffer );
-    gboolean bSpotFrequency = pGlobal->plot.flags.bSpotFrequencyPlot;
+    gdouble xPos[ TRACE_CHUNK ], yPos[ TRACE_CHUNK ], converted[ TRACE_CHUNK ];
+    guint8 bValid[ TRACE_CHUNK ];
     tAxis *pFreqOrTimeAxis = &pGlobal->plot.axis[ eFreqOrTime ];
-
     tAxis *pCoordinateAxis = &pGlobal->plot.axis[ axis ];
+    gboolean bTime = pGlobal->plot.flags.bSpotFrequencyPlot;
+
     gdouble ordinateScaling  = gridWidth / ( pFreqOrTimeAxis->max - pFreqOrTimeAxis->min );
-    gdouble scale = gridHeight /( pCoordinateAxis->max - pCoordinateAxis->min );
-    gdouble coordinate;
+    // x = abscissa (Hz or ms) * xScale + xOffset
+    gdouble xScale = ordinateScaling / (bTime ? 1000.0 : MHz(1.0));
+    gdouble xOffset = -pFreqOrTimeAxis->min * ordinateScaling;
+    gdouble yScale = gridHeight /( pCoordinateAxis->max - pCoordinateAxis->min );
+    const gdouble *pCoordinates;
+
+    cairo_surface_type_t surfaceType = cairo_surface_get_type( cairo_get_target( cr ) );
+    gboolean bDecimate = surfaceType != CAIRO_SURFACE_TYPE_PDF && surfaceType != CAIRO_SURFACE_TYPE_PS
+                            && surfaceType != CAIRO_SURFACE_TYPE_SVG;
+    gdouble pixelsPerUnit = 1.0, dy = 0.0;
+    tPixelColumn column = { G_MININT, 0 };
+    gint pixelColumn;
+
+    // (device pixels .. the screen may be scaled)
+    cairo_user_to_device_distance( cr, &pixelsPerUnit, &dy );
+    pixelsPerUnit = fabs( pixelsPerUnit );
+
+#define PIXEL_COLUMN( x ) (bDecimate ? (gint)floor( (x) * pixelsPerUnit ) : G_MININT)
+    // carry on from the last measurement
+    if( !pPen->bRestartTrace ) {
+        cairo_move_to( cr, pPen->x, pPen->y );
+        column.column = PIXEL_COLUMN( pPen->x );
+    }
+
+    // walk the columns (in at most two contiguous runs) a chunk at a time
+    for( gint span = 0; span < nSpans; span++ ) {
+        for( guint chunk = spans[ span ].start; chunk < spans[ span ].start + spans[ span ].count; chunk += TRACE_CHUNK ) {
+            guint n = MIN( TRACE_CHUNK, spans[ span ].start + spans[ span ].count - chunk );
+
+            if( axis == eNoise ) {
+                convertNoiseColumn( &pDataBuffer->noise[ chunk ], converted, n, pGlobal->plot.noiseUnits );
+                pCoordinates = converted;
+            } else {
+                pCoordinates = &pDataBuffer->gain[ chunk ];
+            }
+            transformToGrid( pDataBuffer, pCoordinates, chunk, n, bTime, xScale, xOffset,
+                             pCoordinateAxis, yScale, xPos, yPos, bValid );
+
+            for( guint i = 0; i < n; i++ ) {
+                tNoiseAndGain point;
+
+                point.flags.all = pDataBuffer->itemFlags[ chunk + i ];
+                // the other frequencies (of a multi-spot plot) are not a break in the trace
+                if( series != ALL_SERIES && point.flags.each.bbSeries != series )
+                    continue;
+
+                // Ignore what is off screen ...
+                if( pPen->bRestartTrace || xPos[ i ] <= 0.0 ) {
+                    flushPixelColumn( cr, &column, pPen );
+                    pPen->x = xPos[ i ];
+                    pPen->y = yPos[ i ];
+                    cairo_move_to( cr, pPen->x, pPen->y );
+                    pPen->bRestartTrace = FALSE;
+                    pPen->length = 0.0;
+                    column.column = PIXEL_COLUMN( xPos[ i ] );
+                } else if( bValid[ i ] ) {
+                    pixelColumn = PIXEL_COLUMN( xPos[ i ] );
+                    if( bDecimate && pixelColumn == column.column ) {
+                        // another in the same pixel column .. keep the extremes
+                        if( column.n == 0 || yPos[ i ] < column.yMin ) {
+                            column.iMin = column.n;
+                            column.xMin = xPos[ i ];
+                            column.yMin = yPos[ i ];
+                        }
+                        if( column.n == 0 || yPos[ i ] > column.yMax ) {
+                            column.iMax = column.n;
+                            column.xMax = xPos[ i ];
+                            column.yMax = yPos[ i ];
+                        }
+                        column.xLast = xPos[ i ];
+                        column.yLast = yPos[ i ];
+                        column.n++;
+                    } else {
+                        flushPixelColumn( cr, &column, pPen );
+                        penLineTo( cr, pPen, xPos[ i ], yPos[ i ] );
+                        column.column = pixelColumn;
+                    }
+                } else {
+                    // a gap in the trace
+                    flushPixelColumn( cr, &column, pPen );
+                    pPen->bRestartTrace = TRUE;
+                }
+            }
+        }
+    }
+    flushPixelColumn( cr, &column, pPen );
+#undef PIXEL_COLUMN
+}
+
+/*!     \brief  Make the path of a trace
+ *
+ * \param cr            pointer to cairo structure
+ * \param pGlobal       pointer to the global data structure
+ * \param pDataBuffer   pointer to data circular buffer
+ * \param width         width of grid space
+ * \param height        height of grid space
+ * \param axis          which axis
+ * \param series        only this frequency of a multi-spot plot (or ALL_SERIES)
+ */
+static void
+traceToPath( cairo_t *cr, tGlobal * pGlobal, tCircularBuffer *pDataBuffer,
+             gdouble gridWidth, gdouble gridHeight, tGridAxes axis, gint series ) {
+    tBufferSpan spans[ 2 ];
+    gint nSpans = circularBufferSpans( pDataBuffer, spans );
+    tTracePen pen = { 0.0, 0.0, 0.0, TRUE };
 
     cairo_new_path( cr );
+    spansToPath( cr, pGlobal, pDataBuffer, spans, nSpans, gridWidth, gridHeight, axis, series, &pen );
+}
 
-    for( int i=0; i < nMeasurements; i++ ) {
-        pMeasurement = getItemFromCircularBuffer( pDataBuffer, i );
-        coordinate = axis == eNoise ? pMeasurement->noise: pMeasurement->gain;
+/*!     \brief  Draw the measurement traces of an axis (or a range of their measurements)
+ *
+ * The lines have round caps and joins, so a trace drawn a few measurements at a time
+ * (continuing from its pen) is no different from one drawn in one go.
+ *
+ * \param cr            pointer to cairo structure (origin at the bottom left of the grid)
+ * \param pGlobal       pointer to the global data structure
+ * \param pGrid         pointer to grid parameters
+ * \param axis          eNoise or eGain
+ * \param spans         the runs of the measurements to draw
+ * \param nSpans        number of runs
+ * \param pens          where the trace of each series has got to (updated)
+ */
+static void
+strokeMeasurementTraces( cairo_t *cr, tGlobal *pGlobal, tGridParameters *pGrid, tGridAxes axis,
+                         tBufferSpan *spans, gint nSpans, tTracePen *pens ) {
+    tCircularBuffer *pDataBuffer = &pGlobal->plot.measurementBuffer;
 
-        if( bSpotFrequency )
-            xPos = ( GINT_MSTIME_TO_DOUBLE( pMeasurement->abscissa.time) - pFreqOrTimeAxis->min ) * ordinateScaling;
-        else
-            xPos = (pMeasurement->abscissa.freq/MHz(1.0) - pFreqOrTimeAxis->min ) * ordinateScaling;
+    cairo_save( cr ); {
+        cairo_set_line_cap( cr, CAIRO_LINE_CAP_ROUND );
+        cairo_set_line_join( cr, CAIRO_LINE_JOIN_ROUND );
+
+        if( pGlobal->plot.flags.bSpotFrequencyPlot && pGlobal->plot.nMultiSpot >= 2 ) {
+            // each frequency in its own color .. gain is dashed (noise is solid)
+            gdouble dash[] = { pGrid->gridHeight / 100.0, pGrid->gridHeight / 200.0 };
+            for( gint series = 0; series < pGlobal->plot.nMultiSpot; series++ ) {
+                gdk_cairo_set_source_rgba (cr, &multiSpotColors[ series ] );
+                if( axis == eGain )
+                    cairo_set_dash( cr, dash, 2, pens[ series ].bRestartTrace ? 0.0 : pens[ series ].length );
+                cairo_new_path( cr );
+                spansToPath( cr, pGlobal, pDataBuffer, spans, nSpans,
+                             pGrid->gridWidth, pGrid->gridHeight, axis, series, &pens[ series ] );
+                cairo_stroke( cr );
+            }
+        } else {
+            gdk_cairo_set_source_rgba (cr, &plotElementColors[ axis == eNoise ? eColorNoise : eColorGain ] );
+            cairo_new_path( cr );
+            spansToPath( cr, pGlobal, pDataBuffer, spans, nSpans,
+                         pGrid->gridWidth, pGrid->gridHeight, axis, ALL_SERIES, &pens[ 0 ] );
+            cairo_stroke( cr );
+        }
+    } cairo_restore( cr );
+}
 
-        // Ignore what is off screen ...
-        if( bRestartTrace || xPos <= 0.0 ) {
-            cairo_move_to( cr, xPos,
-                           (clipData( coordinate, pCoordinateAxis->min, pCoordinateAxis->max ) - pCoordinateAxis->min ) * scale );
-            bRestartTrace = FALSE;
+/*!     \brief  Draw the visible traces of the trace library
+ *
+ * The path of each trace is kept and reused until the size of the grid, the
+ * range of the axes or the noise units change, so an overlay of many traces is not recalculated on each redraw.
+ *
+ * \param cr            pointer to cairo structure (origin at the bottom left of the grid)
+ * \param pGlobal       pointer to the global data structure
+ * \param pGrid         pointer to grid parameters
+ * \param axis          eNoise or eGain
+ */
+static void
+drawTraceLibrary( cairo_t *cr, tGlobal *pGlobal, tGridParameters *pGrid, tGridAxes axis ) {
+    tTraceLibrary *pLibrary = &pGlobal->plot.traceLibrary;
+    tAxis *pFreqAxis = &pGlobal->plot.axis[ eFreqOrTime ], *pAxis = &pGlobal->plot.axis[ axis ];
+    gdouble dashes[ eMAX_TRACE_STYLES ][ 2 ] = {
+            [ eTraceDashed ] = { pGrid->gridHeight / 400.0, pGrid->gridHeight / 400.0 },
+            [ eTraceSolid ]  = { 0.0, 0.0 },
+            [ eTraceDotted ] = { pGrid->gridHeight / 2000.0, pGrid->gridHeight / 200.0 } };
+    GdkRGBA color;
+
+    for( gint i = 0; i < pLibrary->nTraces; i++ ) {
+        tTraceSlot *pSlot = &pLibrary->slots[ i ];
+        tCircularBuffer *pData = &pSlot->pTrace->data;
+        tTracePath *pPath = &pSlot->paths[ axis ];
+
+        if( !pSlot->flags.bVisible
+                || !(axis == eNoise ? pData->flags.bValidNoiseData : pData->flags.bValidGainData) )
             continue;
+        // a Y factor cannot be shown as a noise figure (or the reverse)
+        if( pData->flags.bYfactor != IS_Y_FACTOR( pGlobal->plot.noiseUnits ) )
+            continue;
+
+        // the first color is that of memory (from the plot page) .. the gain is paler
+        if( pSlot->color == 0 ) {
+            color = plotElementColors[ axis == eNoise ? eColorNoiseMem : eColorGainMem ];
+        } else {
+            color = multiSpotColors[ pSlot->color ];
+            if( axis == eGain )
+                color.alpha /= 2.0;
+        }
+        gdk_cairo_set_source_rgba( cr, &color );
+        cairo_set_dash( cr, dashes[ pSlot->style ], pSlot->style == eTraceSolid ? 0 : 2, 0.0 );
+
+        if( pPath->path == NULL
+                || pPath->gridWidth != pGrid->gridWidth || pPath->gridHeight != pGrid->gridHeight
+                || pPath->minFreq != pFreqAxis->min || pPath->maxFreq != pFreqAxis->max
+                || pPath->min != pAxis->min || pPath->max != pAxis->max || pPath->units != pGlobal->plot.noiseUnits ) {
+            traceToPath( cr, pGlobal, pData, pGrid->gridWidth, pGrid->gridHeight, axis, ALL_SERIES );
+            if( pPath->path )
+                cairo_path_destroy( pPath->path );
+            pPath->path = cairo_copy_path( cr );
+            pPath->gridWidth = pGrid->gridWidth;
+            pPath->gridHeight = pGrid->gridHeight;
+            pPath->minFreq = pFreqAxis->min;
+            pPath->maxFreq = pFreqAxis->max;
+            pPath->min = pAxis->min;
+            pPath->max = pAxis->max;
+            pPath->units = pGlobal->plot.noiseUnits;
+        } else {
+            cairo_new_path( cr );
+            cairo_append_path( cr, pPath->path );
         }
+        cairo_stroke( cr );
+    }
+    cairo_set_dash( cr, NULL, 0, 0.0 );
+}
 
-        if( pMeasurement->noise < ERROR_INDICATOR_HP8970)
-            cairo_line_to( cr, xPos,
-                           (clipData( coordinate, pCoordinateAxis->min, pCoordinateAxis->max ) - pCoordinateAxis->min ) * scale );
-        else
-            bRestartTrace = TRUE;
+/*!     \brief  Draw the accumulated (averaged, held or deviation) trace
+ *
+ * Averages are drawn as a single line, max/min hold as two lines (the envelope)
+ * and the standard deviation as a shaded band of mean ± σ.
+ *
+ * \param cr            pointer to cairo structure
+ * \param pGlobal       pointer to the global data structure
+ * \param gridWidth     width of grid space
+ * \param gridHeight    height of grid space
+ * \param axis          which axis (eNoise or eGain)
+ * \param pColor        color of the trace
+ */
+void
+drawAccumulatorTrace( cairo_t *cr, tGlobal * pGlobal,
+                      gdouble gridWidth, gdouble gridHeight, tGridAxes axis, GdkRGBA *pColor ) {
+
+    tTraceAccumulators *pAccum = &pGlobal->plot.accumulators;
+    tAccumulatorDisplay display = pGlobal->accumulatorDisplay;
+    tAxis *pFreqAxis = &pGlobal->plot.axis[ eFreq ];
+    tAxis *pCoordinateAxis = &pGlobal->plot.axis[ axis ];
+    gdouble freqScaling  = gridWidth / ( pFreqAxis->max - pFreqAxis->min );
+    gdouble scale = gridHeight /( pCoordinateAxis->max - pCoordinateAxis->min );
+    gdouble upper, lower, xPos;
+    GdkRGBA color = *pColor;
+    gint i, pass;
+
+    if( display == eAccumNone || !pAccum->flags.bValid )
+        return;
+
+    // (the noise statistics are linear)
+#define Y_POS( v ) ((clipData( axis == eNoise ? noiseInUnits( (v), pGlobal->plot.noiseUnits ) : (v), \
+                               pCoordinateAxis->min, pCoordinateAxis->max ) - pCoordinateAxis->min ) * scale)
+#define X_POS( i ) ((pAccum->bins[ (i) ].freq/MHz(1.0) - pFreqAxis->min ) * freqScaling)
+
+    g_mutex_lock( &pAccum->mAccumulators );
+    if( display == eAccumStdDeviation ) {
+        // band of mean ± σ ... forward along the upper edge and back along the lower
+        // (a gap in the data starts a new band)
+        color.alpha *= 0.3;
+        gdk_cairo_set_source_rgba (cr, &color );
+        for( i = 0; i < pAccum->nBins; ) {
+            gint first;
+            for( ; i < pAccum->nBins && !accumulatedValue( pAccum, i, display, axis, &upper, &lower ); i++ );
+            if( i >= pAccum->nBins )
+                break;
+            cairo_new_path( cr );
+            for( first = i; i < pAccum->nBins && accumulatedValue( pAccum, i, display, axis, &upper, &lower ); i++ )
+                cairo_line_to( cr, X_POS( i ), Y_POS( upper ) );
+            for( gint j = i - 1; j >= first; j-- ) {
+                accumulatedValue( pAccum, j, display, axis, &upper, &lower );
+                cairo_line_to( cr, X_POS( j ), Y_POS( lower ) );
+            }
+            cairo_close_path( cr );
+            cairo_fill( cr );
+        }
+    } else {
+        color.alpha *= 0.6;
+        gdk_cairo_set_source_rgba (cr, &color );
+        // max/min hold needs both the upper and lower traces
+        for( pass = 0; pass < (display == eAccumMaxMinHold ? 2 : 1); pass++ ) {
+            gboolean bRestartTrace = TRUE;
+            cairo_new_path( cr );
+            for( i = 0; i < pAccum->nBins; i++ ) {
+                if( !accumulatedValue( pAccum, i, display, axis, &upper, &lower ) ) {
+                    bRestartTrace = TRUE;
+                    continue;
+                }
+                xPos = X_POS( i );
+                if( bRestartTrace ) {
+                    cairo_move_to( cr, xPos, Y_POS( pass == 0 ? upper : lower ) );
+                    bRestartTrace = FALSE;
+                } else {
+                    cairo_line_to( cr, xPos, Y_POS( pass == 0 ? upper : lower ) );
+                }
+            }
+            cairo_stroke( cr );
+        }
     }
-    cairo_stroke( cr );
+    g_mutex_unlock( &pAccum->mAccumulators );
+#undef Y_POS
+#undef X_POS
 }
 
+// The parts of the plot of the noise or gain (the screen draws the measurement from the trace layer)
+#define TRACE_PART_BACKGROUND   0x01        // memory (trace library) and accumulated traces
+#define TRACE_PART_MEASUREMENT  0x02
+#define TRACE_PART_LIVE_MARKER  0x04
+#define TRACE_PART_ALL          (TRACE_PART_BACKGROUND | TRACE_PART_MEASUREMENT | TRACE_PART_LIVE_MARKER)
+
 /*!     \brief  Plot gain vs frequency onto drawing area
  *
  * Plot gain vs frequency onto drawing area
@@ -1070,9 +1626,10 @@ drawTrace( cairo_t *cr, tGlobal * pGlobal, tCircularBuffer *pDataBuffer,
  * \param cr            pointer to cairo structure
  * \param pGrid         pointer to grid parameters
  * \param pGlobal       pointer to the global data structure
+ * \param parts         which parts to draw (TRACE_PART_...)
  */
 void
-plotGainTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
+plotGainTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal, guint parts ) {
     tGlobal *pGlobal = (tGlobal *)gpGlobal;
     tAxis *pGainAxis = &pGlobal->plot.axis[ eGain ];
     tAxis *pFreqOrTimeAxis = &pGlobal->plot.axis[ eFreqOrTime ];
@@ -1093,39 +1650,42 @@ plotGainTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
         cairo_translate(cr, pGrid->leftGridPosn, pGrid->bottomGridPosn);
         cairo_set_line_width (cr, pGrid->areaWidth / 1000.0 );
 
-        if( pGlobal->flags.bShowMemory && !pGlobal->plot.flags.bSpotFrequencyPlot &&
-                pGlobal->plot.memoryBuffer.flags.bValidGainData ) {
-            gdouble dash[] = { pGrid->gridHeight / 400.0, pGrid->gridHeight / 400.0 };
-        // Draw the memory Gain trace
-            gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorGainMem   ] );
-            cairo_set_dash( cr, dash, 1, 0.0 );
-            drawTrace( cr, pGlobal, &pGlobal->plot.memoryBuffer,
-                           pGrid->gridWidth, pGrid->gridHeight,
-                           eGain );
-            cairo_set_dash( cr, dash, 0, 0.0 );
+        // Draw the memory (trace library) Gain traces
+        if( (parts & TRACE_PART_BACKGROUND) && pGlobal->flags.bShowMemory && !pGlobal->plot.flags.bSpotFrequencyPlot )
+            drawTraceLibrary( cr, pGlobal, pGrid, eGain );
+
+        // Draw the accumulated trace (average, max/min hold or deviation over repeated sweeps)
+        if( (parts & TRACE_PART_BACKGROUND) && !pGlobal->plot.flags.bCalibrationPlot && !pGlobal->plot.flags.bSpotFrequencyPlot ) {
+            drawAccumulatorTrace( cr, pGlobal, pGrid->gridWidth, pGrid->gridHeight,
+                                  eGain, &plotElementColors[ eColorGain ] );
         }
 
         // Draw the gain trace .. but not if it is invalid
         if( !pGlobal->plot.measurementBuffer.flags.bValidGainData )
             break;
 
-        gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorGain   ] );
-        drawTrace( cr, pGlobal, &pGlobal->plot.measurementBuffer,
-                   pGrid->gridWidth, pGrid->gridHeight,
-                   eGain );
+        if( parts & TRACE_PART_MEASUREMENT ) {
+            tBufferSpan spans[ 2 ];
+            tTracePen pens[ MAX_MULTI_SPOT ];
+
+            resetTracePens( pens );
+            strokeMeasurementTraces( cr, pGlobal, pGrid, eGain,
+                                     spans, circularBufferSpans( &pGlobal->plot.measurementBuffer, spans ), pens );
+        }
 
-        if( pGlobal->flags.bLiveMarkerActive && (pGlobal->flags.bHoldLiveMarker || !pGrid->bSuppressLiveMarker) ) {
+        if( (parts & TRACE_PART_LIVE_MARKER) && pGlobal->flags.bLiveMarkerActive && (pGlobal->flags.bHoldLiveMarker || !pGrid->bSuppressLiveMarker) ) {
             cairo_reset_clip( cr );
             gdouble xLM = pGlobal->liveMarkerPosnRatio.x * pGrid->areaWidth - pGrid->leftGridPosn;
             gdouble yLM = (pGrid->areaHeight - pGlobal->liveMarkerPosnRatio.y * pGrid->areaHeight ) - pGrid->bottomGridPosn;
 
             if( xLM > 0.0 && xLM < pGrid->gridWidth ) {
-                tCoordinate intercept = interpolate( pGlobal, xLM, freqOrTimeScale, bSpotFrequency ? eTimeAbscissa : eFreqAbscissa, eGain  );
+                tMarkerReading intercept = interpolate( pGlobal, xLM, freqOrTimeScale, bSpotFrequency ? eTimeAbscissa : eFreqAbscissa,
+                                                        liveMarkerSeries( pGlobal, pGrid, xLM, yLM ) );
 
                 if( intercept.x != INVALID ) {
                     // The x position of the live marker was already calculated, so no need to change it
 			      //xLM = (intercept.x * unitScale - pGlobal->plot.axis[ eFreqOrTime ].min ) * freqOrTimeScale;
-					yLM = (intercept.y - pGainAxis->min ) * gainScale;
+					yLM = (intercept.gain - pGainAxis->min ) * gainScale;
 					// red circle with some transparency
 					cairo_arc (cr, xLM, yLM, pGrid->gridWidth / 100.0, 0.0, 2 * M_PI);
 					cairo_set_line_width (cr, pGrid->areaWidth / 1000.0 );
@@ -1153,9 +1713,9 @@ plotGainTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
 					// Gain: name
 					rightJustifiedCairoText ( cr, "Gain:", xPosLiveMkrText - 2.8 * pGrid->fontSize, yPosLiveMkrText, TRUE);
 					// value
-					centerTextOnDP ( cr, xPosLiveMkrText, yPosLiveMkrText, intercept.y, 2 );
+					centerTextOnDP ( cr, xPosLiveMkrText, yPosLiveMkrText, intercept.gain, 2 );
 					cairo_rel_move_to( cr, pGrid->fontSize * (pGlobal->plot.noiseUnits == eTeK ? UNIT_OFFSET_TEK : UNIT_OFFSET_FdB), 0.0 );
-					cairo_show_text (cr, "dB");
+					showCachedCairoText (cr, "dB");
 				}
             }
         }
@@ -1170,9 +1730,10 @@ plotGainTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
  * \param cr            pointer to cairo structure
  * \param pGrid         pointer to grid parameters
  * \param pGlobal       pointer to the global data structure
+ * \param parts         which parts to draw (TRACE_PART_...)
  */
 void
-plotNoiseTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
+plotNoiseTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal, guint parts ) {
     tGlobal *pGlobal = (tGlobal *)gpGlobal;
     tAxis *pNoiseAxis = &pGlobal->plot.axis[ eNoise ];
     tAxis *pFreqOrTimeAxis = &pGlobal->plot.axis[ eFreqOrTime ];
@@ -1194,29 +1755,32 @@ plotNoiseTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
         cairo_translate(cr, pGrid->leftGridPosn, pGrid->bottomGridPosn);
         cairo_set_line_width (cr, pGrid->areaWidth / 1000.0 );
 
-        if( !pGlobal->plot.flags.bCalibrationPlot && !pGlobal->plot.flags.bSpotFrequencyPlot
-                && pGlobal->flags.bShowMemory && pGlobal->plot.memoryBuffer.flags.bValidNoiseData ) {
-            gdouble dash[] = { pGrid->gridHeight / 400.0, pGrid->gridHeight / 400.0 };
-        // Draw the memory Noise trace
-            gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorNoiseMem   ] );
-            cairo_set_dash( cr, dash, 1, 0.0 );
-            drawTrace( cr, pGlobal, &pGlobal->plot.memoryBuffer,
-                           pGrid->gridWidth, pGrid->gridHeight,
-                           eNoise );
-            cairo_set_dash( cr, dash, 0, 0.0 );
+        // Draw the memory (trace library) Noise traces
+        if( (parts & TRACE_PART_BACKGROUND) && !pGlobal->plot.flags.bCalibrationPlot
+                && !pGlobal->plot.flags.bSpotFrequencyPlot && pGlobal->flags.bShowMemory )
+            drawTraceLibrary( cr, pGlobal, pGrid, eNoise );
+
+        // Draw the accumulated trace (average, max/min hold or deviation over repeated sweeps)
+        if( (parts & TRACE_PART_BACKGROUND) && !pGlobal->plot.flags.bCalibrationPlot && !pGlobal->plot.flags.bSpotFrequencyPlot ) {
+            drawAccumulatorTrace( cr, pGlobal, pGrid->gridWidth, pGrid->gridHeight,
+                                  eNoise, &plotElementColors[ eColorNoise ] );
         }
 
         // Draw the Noise trace .. but not if it is invalid
         if( !pGlobal->plot.measurementBuffer.flags.bValidNoiseData )
             break;
 
-        gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorNoise   ] );
-        drawTrace( cr, pGlobal, &pGlobal->plot.measurementBuffer,
-                   pGrid->gridWidth, pGrid->gridHeight,
-                   eNoise );
+        if( parts & TRACE_PART_MEASUREMENT ) {
+            tBufferSpan spans[ 2 ];
+            tTracePen pens[ MAX_MULTI_SPOT ];
+
+            resetTracePens( pens );
+            strokeMeasurementTraces( cr, pGlobal, pGrid, eNoise,
+                                     spans, circularBufferSpans( &pGlobal->plot.measurementBuffer, spans ), pens );
+        }
 
         // Live marker
-        if( pGlobal->flags.bLiveMarkerActive && (pGlobal->flags.bHoldLiveMarker || !pGrid->bSuppressLiveMarker) ) {
+        if( (parts & TRACE_PART_LIVE_MARKER) && pGlobal->flags.bLiveMarkerActive && (pGlobal->flags.bHoldLiveMarker || !pGrid->bSuppressLiveMarker) ) {
             cairo_reset_clip( cr );
 
             // translate the live marker to the current screen geometry
@@ -1226,15 +1790,17 @@ plotNoiseTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
 
             // only valid if within the grid
             if( xLM > 0.0 && xLM < pGrid->gridWidth ) {
-                // do a binary search for the ordinate (freq. or time) corresponding to the mouse x position on the grid,
-                // and interpolate the coordinate (noise and gain) from the nearest samples.
-                tCoordinate intercept = interpolate( pGlobal, xLM, ordinateScaling, bSpotFreqency ? eTimeAbscissa : eFreqAbscissa, eNoise  );
+                // look up the measurements either side of the mouse x position on the grid (marker index),
+                // and interpolate the coordinate (noise and gain) from them.
+                gint series = liveMarkerSeries( pGlobal, pGrid, xLM, yLM );
+                tMarkerReading intercept = interpolate( pGlobal, xLM, ordinateScaling, bSpotFreqency ? eTimeAbscissa : eFreqAbscissa,
+                                                        series );
 
                 // only valid if the data set covers the ordinate position.
                 if( intercept.x != INVALID ) {
                     // Update xLM and yLM to the interpolated values (xLM doesn't change)
 			     // xLM = (intercept.x * unitScale - pFreqOrTimeAxis->min ) * ordinateScaling;
-					yLM = (intercept.y - pNoiseAxis->min ) * noiseScale;
+					yLM = (intercept.noise - pNoiseAxis->min ) * noiseScale;
 
 					cairo_arc (cr, xLM, yLM, pGrid->gridWidth / 100.0, 0.0, 2 * M_PI);
 					cairo_set_line_width (cr, pGrid->areaWidth / 1000.0 );
@@ -1268,9 +1834,17 @@ plotNoiseTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
                     // ordinate value ... frequency or time
                     if( pGlobal->plot.flags.bSpotFrequencyPlot ) {
                         // Time like 11:06:43.6 (hours, minutes & seconds (decimal seconds))
-                        gchar *sTime = msTimeToString( (gint64)(intercept.x * 1000.0), FALSE );
-                        rightJustifiedCairoText( cr, sTime, xPosLiveMkrText + 1.75 * pGrid->fontSize, yPosLiveMkrText, TRUE );
-                        g_free( sTime );
+                        gchar sTime[ SHORT_STRING ];
+                        rightJustifiedCairoText( cr, msTimeToLabel( sTime, (gint64)(intercept.x * 1000.0), FALSE ),
+                                                 xPosLiveMkrText + 1.75 * pGrid->fontSize, yPosLiveMkrText, TRUE );
+                        // and which of the multi-spot frequencies
+                        if( series != ALL_SERIES ) {
+                            gchar sFrequency[ SHORT_STRING ];
+                            g_snprintf( sFrequency, SHORT_STRING, "  %.0lf MHz", pGlobal->plot.multiSpotMHz[ series ] );
+                            gdk_cairo_set_source_rgba (cr, &multiSpotColors[ series ] );
+                            leftJustifiedCairoText( cr, sFrequency, xPosLiveMkrText + 1.75 * pGrid->fontSize, yPosLiveMkrText, TRUE );
+                            gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorFrequency   ] );
+                        }
                     } else {
                         // Frequency centered on the decimal point
                         centerTextOnDP( cr, xPosLiveMkrText, yPosLiveMkrText, intercept.x/MHz(1.0), 2 );
@@ -1287,11 +1861,11 @@ plotNoiseTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
                     gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorNoise   ] );
                     rightJustifiedCairoText( cr, sLegend, xPosLiveMkrText - 2.8 * pGrid->fontSize, yPosLiveMkrText, TRUE);
 
-                    centerTextOnDP( cr, xPosLiveMkrText, yPosLiveMkrText, intercept.y, pGlobal->plot.noiseUnits == eTeK ? 1:3 );
+                    centerTextOnDP( cr, xPosLiveMkrText, yPosLiveMkrText, intercept.noise, pGlobal->plot.noiseUnits == eTeK ? 1:3 );
                     cairo_rel_move_to( cr, pGrid->fontSize * (pGlobal->plot.noiseUnits == eTeK ? UNIT_OFFSET_TEK : UNIT_OFFSET_FdB), 0.0 );
 
                     if( sNoiseUnits[ pGlobal->plot.noiseUnits ] != 0 )
-                        cairo_show_text (cr, sNoiseUnits[ pGlobal->plot.noiseUnits ]);
+                        showCachedCairoText (cr, sNoiseUnits[ pGlobal->plot.noiseUnits ]);
                 }
             }
         }
@@ -1300,54 +1874,589 @@ plotNoiseTrace( cairo_t *cr, tGridParameters  *pGrid, gpointer gpGlobal ) {
 
 }
 
-/*!     \brief  Plot noise figure and gain onto drawing area
+// color scale of the heat map (low noise is blue, high is red)
+static const gdouble heatMapScale[][4] = {
+        // fraction, red, green, blue
+        { 0.00, 0.00, 0.00, 0.50 },
+        { 0.25, 0.00, 0.50, 1.00 },
+        { 0.50, 0.00, 0.80, 0.30 },
+        { 0.75, 1.00, 0.85, 0.00 },
+        { 1.00, 0.80, 0.00, 0.00 }
+};
+
+/*!     \brief  Color of a point on the heat map
  *
- * Plot noise figure and gain onto drawing area
- * \param cr            pointer to cairo structure
- * \param areaWidth     width
- * \param areaHeight    height
- * \param bSuppressLiveMarker whether to suppress the live marker (say when printing)
+ * \param fraction      position on the color scale (0 to 1)
+ * \return              pixel (xRGB)
+ */
+static guint32
+heatMapPixel( gdouble fraction ) {
+    gint i;
+    gdouble f, rgb[ 3 ];
+
+    fraction = CLAMP( fraction, 0.0, 1.0 );
+    for( i = 1; i < G_N_ELEMENTS( heatMapScale ) - 1 && fraction > heatMapScale[ i ][ 0 ]; i++ );
+    f = (fraction - heatMapScale[ i - 1 ][ 0 ]) / (heatMapScale[ i ][ 0 ] - heatMapScale[ i - 1 ][ 0 ]);
+    for( gint c = 0; c < 3; c++ )
+        rgb[ c ] = heatMapScale[ i - 1 ][ c + 1 ] + f * (heatMapScale[ i ][ c + 1 ] - heatMapScale[ i - 1 ][ c + 1 ]);
+
+    return ((guint32)(rgb[ 0 ] * 255.0) << 16) | ((guint32)(rgb[ 1 ] * 255.0) << 8) | (guint32)(rgb[ 2 ] * 255.0);
+}
+
+/*!     \brief  Draw the image of the two dimensional sweep
+ *
+ * The image has a pixel for each point (parameter x frequency). It is kept
+ * until the data changes, so redrawing the plot only scales the image.
+ *
+ * \param pSweep2D      pointer to the two dimensional sweep (locked)
+ * \param units         noise units of the plot
+ */
+static void
+drawHeatMapSurface( tSweep2D *pSweep2D, tNoiseType units ) {
+    guint nPoints = pSweep2D->nRowsDone * pSweep2D->nColumns;
+    guchar *pImage;
+    gint stride;
+
+    pSweep2D->heatMapMin = G_MAXDOUBLE;
+    pSweep2D->heatMapMax = -G_MAXDOUBLE;
+    pSweep2D->heatMapUnits = units;
+    for( guint i = 0; i < nPoints; i++ ) {
+        if( pSweep2D->data[ i ].flags.each.bNoiseInvalid || pSweep2D->data[ i ].noise >= ERROR_INDICATOR_HP8970 )
+            continue;
+        pSweep2D->heatMapMin = MIN( pSweep2D->heatMapMin, pSweep2D->data[ i ].noise );
+        pSweep2D->heatMapMax = MAX( pSweep2D->heatMapMax, pSweep2D->data[ i ].noise );
+    }
+    // the noise is held linear (the conversion keeps the order)
+    pSweep2D->heatMapMin = noiseInUnits( pSweep2D->heatMapMin, units );
+    pSweep2D->heatMapMax = noiseInUnits( pSweep2D->heatMapMax, units );
+    if( pSweep2D->heatMapMax <= pSweep2D->heatMapMin )
+        pSweep2D->heatMapMax = pSweep2D->heatMapMin + 1.0;
+
+    pSweep2D->heatMap = cairo_image_surface_create( CAIRO_FORMAT_RGB24, pSweep2D->nColumns, pSweep2D->nRowsDone );
+    cairo_surface_flush( pSweep2D->heatMap );
+    pImage = cairo_image_surface_get_data( pSweep2D->heatMap );
+    stride = cairo_image_surface_get_stride( pSweep2D->heatMap );
+
+    for( guint row = 0; row < pSweep2D->nRowsDone; row++ ) {
+        guint32 *pPixel = (guint32 *)(pImage + row * stride);
+        for( guint column = 0; column < pSweep2D->nColumns; column++ ) {
+            tNoiseAndGain *pPoint = &pSweep2D->data[ row * pSweep2D->nColumns + column ];
+            if( pPoint->flags.each.bNoiseInvalid || pPoint->noise >= ERROR_INDICATOR_HP8970 )
+                pPixel[ column ] = 0xC0C0C0;    // grey
+            else
+                pPixel[ column ] = heatMapPixel( (noiseInUnits( pPoint->noise, units ) - pSweep2D->heatMapMin)
+                                                 / (pSweep2D->heatMapMax - pSweep2D->heatMapMin) );
+        }
+    }
+    cairo_surface_mark_dirty( pSweep2D->heatMap );
+}
+
+/*!     \brief  Plot the two dimensional sweep as a heat map
+ *
+ * Frequency across, parameter up and the noise as color.
+ *
+ * \param cr            pointer to cairo structure (origin bottom left)
+ * \param pGrid         pointer to grid parameters
  * \param pGlobal       pointer to the global data structure
- * \return           TRUE
  */
-gboolean
-plotNoiseFigureAndGain (cairo_t *cr, gint areaWidth, gint areaHeight, tGlobal *pGlobal, gboolean bSuppressLiveMarker)
-{
-    tGridParameters grid;
+static void
+plotHeatMap( cairo_t *cr, tGridParameters *pGrid, tGlobal *pGlobal ) {
+    tSweep2D *pSweep2D = &pGlobal->plot.sweep2D;
+    gchar sLegend[ SHORT_STRING ];
+    gdouble barLeft = pGrid->rightGridPosn + pGrid->areaWidth * 0.01;
+    gdouble barWidth = pGrid->areaWidth * 0.015;
+    cairo_pattern_t *pBar;
+
+    g_mutex_lock( &pSweep2D->mSweep2D );
+    if( pSweep2D->nRowsDone == 0 || pSweep2D->nColumns == 0 ) {
+        g_mutex_unlock( &pSweep2D->mSweep2D );
+        return;
+    }
+    // the image is redrawn if the noise units have been changed
+    if( pSweep2D->heatMap != NULL && pSweep2D->heatMapUnits != pGlobal->plot.noiseUnits ) {
+        cairo_surface_destroy( pSweep2D->heatMap );
+        pSweep2D->heatMap = NULL;
+    }
+    if( pSweep2D->heatMap == NULL )
+        drawHeatMapSurface( pSweep2D, pGlobal->plot.noiseUnits );
+
+    cairo_save( cr ); {
+        // the image scaled to the grid (each point a block)
+        cairo_translate( cr, pGrid->leftGridPosn, pGrid->bottomGridPosn );
+        cairo_scale( cr, pGrid->gridWidth / pSweep2D->nColumns, pGrid->gridHeight / pSweep2D->nRowsDone );
+        cairo_set_source_surface( cr, pSweep2D->heatMap, 0.0, 0.0 );
+        cairo_pattern_set_filter( cairo_get_source( cr ), CAIRO_FILTER_NEAREST );
+        cairo_rectangle( cr, 0.0, 0.0, pSweep2D->nColumns, pSweep2D->nRowsDone );
+        cairo_fill( cr );
+    } cairo_restore( cr );
+
+    // border
+    gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorGrid   ] );
+    cairo_set_line_width( cr, pGrid->areaWidth / 1000.0 );
+    cairo_rectangle( cr, pGrid->leftGridPosn, pGrid->bottomGridPosn, pGrid->gridWidth, pGrid->gridHeight );
+    cairo_stroke( cr );
+
+    // color scale
+    pBar = cairo_pattern_create_linear( 0.0, pGrid->bottomGridPosn, 0.0, pGrid->topGridPosn );
+    for( gint i = 0; i < G_N_ELEMENTS( heatMapScale ); i++ )
+        cairo_pattern_add_color_stop_rgb( pBar, heatMapScale[ i ][ 0 ],
+                                          heatMapScale[ i ][ 1 ], heatMapScale[ i ][ 2 ], heatMapScale[ i ][ 3 ] );
+    cairo_rectangle( cr, barLeft, pGrid->bottomGridPosn, barWidth, pGrid->gridHeight );
+    cairo_set_source( cr, pBar );
+    cairo_fill( cr );
+    cairo_pattern_destroy( pBar );
+
+    showTitleAndTime( cr, pGrid, pGlobal->plot.sTitle, pGlobal->plot.sDateTime, pGlobal );
+
+    cairo_select_font_face(cr, LABEL_FONT, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    setCairoFontSize(cr, pGrid->fontSize);
+
+    // noise at the ends of the color scale
+    gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorNoise   ] );
+    g_snprintf( sLegend, SHORT_STRING, "%.2lf", pSweep2D->heatMapMax );
+    leftJustifiedCairoText( cr, sLegend, barLeft, pGrid->topGridPosn + 0.5 * pGrid->fontSize, FALSE );
+    g_snprintf( sLegend, SHORT_STRING, "%.2lf", pSweep2D->heatMapMin );
+    leftJustifiedCairoText( cr, sLegend, barLeft, pGrid->bottomGridPosn - 1.2 * pGrid->fontSize, FALSE );
+    g_snprintf( sLegend, SHORT_STRING, "%s%s%s", sNoiseLabel[ pGlobal->plot.noiseUnits ],
+                sNoiseUnits[ pGlobal->plot.noiseUnits ][ 0 ] ? " " : "", sNoiseUnits[ pGlobal->plot.noiseUnits ] );
+    rightJustifiedCairoText( cr, sLegend, pGrid->areaWidth - pGrid->fontSize, pGrid->topGridPosn + 1.6 * pGrid->fontSize, FALSE );
+
+    // frequency (across)
+    gdk_cairo_set_source_rgba (cr, &plotElementColors[ eColorFrequency   ] );
+    g_snprintf( sLegend, SHORT_STRING, "%.0lf", pSweep2D->frequencies[ 0 ] / MHz(1.0) );
+    centreJustifiedCairoText( cr, sLegend, pGrid->leftGridPosn, pGrid->bottomGridPosn - 1.6 * pGrid->fontSize, 1.0 );
+    g_snprintf( sLegend, SHORT_STRING, "%.0lf", pSweep2D->frequencies[ pSweep2D->nColumns - 1 ] / MHz(1.0) );
+    centreJustifiedCairoText( cr, sLegend, pGrid->rightGridPosn, pGrid->bottomGridPosn - 1.6 * pGrid->fontSize, 1.0 );
+    setCairoFontSize(cr, pGrid->fontSize * 1.2);
+    centreJustifiedCairoText( cr, "Frequency (MHz)", pGrid->leftGridPosn + pGrid->gridWidth / 2.0,
+                              pGrid->bottomGridPosn - 4.0 * pGrid->fontSize, 0.0 );
+
+    // parameter (up) .. the values are at the centre of the rows
+    setCairoFontSize(cr, pGrid->fontSize);
+    g_snprintf( sLegend, SHORT_STRING, "%g", parameterValue( pSweep2D, 0 ) );
+    rightJustifiedCairoText( cr, sLegend, pGrid->leftGridPosn - 0.5 * pGrid->fontSize,
+                             pGrid->bottomGridPosn + pGrid->gridHeight / pSweep2D->nRowsDone / 2.0, FALSE );
+    g_snprintf( sLegend, SHORT_STRING, "%g", parameterValue( pSweep2D, pSweep2D->nRowsDone - 1 ) );
+    rightJustifiedCairoText( cr, sLegend, pGrid->leftGridPosn - 0.5 * pGrid->fontSize,
+                             pGrid->topGridPosn - pGrid->gridHeight / pSweep2D->nRowsDone / 2.0, FALSE );
+    leftJustifiedCairoText( cr, pSweep2D->parameter.sSetCommand, pGrid->leftGridPosn,
+                            pGrid->topGridPosn + 0.5 * pGrid->fontSize, FALSE );
+
+    g_mutex_unlock( &pSweep2D->mSweep2D );
+}
+
+// Everything the grid layer shows (other than the title and time strings)
+typedef struct {
+    gint areaWidth, areaHeight, scale;
+    tAxis axis[ eMAX_AXES ];
+    tNoiseType noiseUnits;
+    gboolean bSpotFrequencyPlot, bCalibrationPlot, bGainGrid;
+    gboolean bShowHPlogo, bShowTime, bbHP8970Bmodel;
+    gdouble freqSpotMHz;
+    gdouble multiSpotMHz[ MAX_MULTI_SPOT ];
+    gint nMultiSpot;
+    GdkRGBA colors[ eMAX_COLORS ];
+} tGridLayerKey;
+
+// The grid, annotation, title, time and logo of the plot on the screen are drawn into an offscreen
+// surface and only drawn again when something they show changes (size, axes, colors, title or options).
+// The traces and live marker are drawn over it.
+typedef struct {
+    cairo_surface_t *surface;
+    tGridLayerKey key;
+    gchar *sTitle, *sDateTime;
+    gboolean bPainted;          // the layer was used for this frame
+    gboolean bRedrawn;          // .. and was drawn again
+} tGridLayer;
+
+static tGridLayer gridLayer = { 0 };
+
+// The measurement traces on the screen are drawn into a transparent offscreen surface that is kept from
+// frame to frame. Each frame only draws the segments to the measurements added since the last and, when a
+// repeated sweep has rewritten measurements, the band of the grid they lie in. The layer is drawn again
+// in full when the grid changes (size, axes, units ..) or the measurement buffer is started afresh.
+typedef struct {
+    cairo_surface_t *surface;
+    tGridLayerKey key;                          // the grid the traces were drawn for
+    gboolean bNoise, bGain;                     // the traces drawn
+    guint generation, head;                     // the measurement buffer drawn
+    guint nItems;                               // .. and how many of its measurements
+    tTracePen pens[ eMAX_AXES ][ MAX_MULTI_SPOT ];  // where each trace has got to
+} tTraceLayer;
+
+static tTraceLayer traceLayer = { 0 };
+
+// Time to draw the plot on the screen (with the grid layer as it was or drawn again)
+// and how the trace layer was brought up to date
+static struct {
+    guint nCached, nRedrawn;
+    gint64 cachedTime, redrawnTime;     // us
+    guint nTraceRedrawn, nTraceBands, nTracePoints;
+} plotDrawTimes = { 0 };
+
+/*!     \brief  Paint the grid layer (drawing it again if it is out of date)
+ *
+ * The plot boundaries must have been set.
+ *
+ * \param cr            pointer to cairo structure (not flipped)
+ * \param pGrid         pointer to grid settings
+ * \param scale         scale of the screen (device pixels to a unit)
+ * \param pGlobal       pointer to the global data structure
+ * \param pLayer        pointer to the grid layer
+ */
+static void
+paintGridLayer( cairo_t *cr, tGridParameters *pGrid, gint scale, tGlobal *pGlobal, tGridLayer *pLayer ) {
+    tGridLayerKey key;
+
+    bzero( &key, sizeof( tGridLayerKey ) );
+    key.areaWidth = pGrid->areaWidth;
+    key.areaHeight = pGrid->areaHeight;
+    key.scale = scale;
+    memcpy( key.axis, pGlobal->plot.axis, sizeof( key.axis ) );
+    key.noiseUnits = pGlobal->plot.noiseUnits;
+    key.bSpotFrequencyPlot = pGlobal->plot.flags.bSpotFrequencyPlot;
+    key.bCalibrationPlot = pGlobal->plot.flags.bCalibrationPlot;
+    key.bGainGrid = pGlobal->plot.measurementBuffer.flags.bValidGainData || showTraceLibrary( pGlobal, eGain );
+    key.bShowHPlogo = pGlobal->flags.bShowHPlogo;
+    key.bShowTime = pGlobal->flags.bShowTime;
+    key.bbHP8970Bmodel = pGlobal->flags.bbHP8970Bmodel;
+    key.freqSpotMHz = pGlobal->plot.freqSpotMHz;
+    memcpy( key.multiSpotMHz, pGlobal->plot.multiSpotMHz, sizeof( key.multiSpotMHz ) );
+    key.nMultiSpot = pGlobal->plot.nMultiSpot;
+    memcpy( key.colors, plotElementColors, sizeof( key.colors ) );
+
+    pLayer->bRedrawn = pLayer->surface == NULL
+            || memcmp( &key, &pLayer->key, sizeof( tGridLayerKey ) ) != 0
+            || g_strcmp0( pLayer->sTitle, pGlobal->plot.sTitle ) != 0
+            || g_strcmp0( pLayer->sDateTime, pGlobal->plot.sDateTime ) != 0;
+
+    if( pLayer->bRedrawn ) {
+        cairo_font_options_t *pFontOptions = cairo_font_options_create();
+        cairo_t *crLayer;
+
+        if( pLayer->surface == NULL || key.areaWidth != pLayer->key.areaWidth
+                || key.areaHeight != pLayer->key.areaHeight || key.scale != pLayer->key.scale ) {
+            if( pLayer->surface )
+                cairo_surface_destroy( pLayer->surface );
+            pLayer->surface = cairo_image_surface_create( CAIRO_FORMAT_RGB24,
+                                                          pGrid->areaWidth * scale, pGrid->areaHeight * scale );
+            cairo_surface_set_device_scale( pLayer->surface, scale, scale );
+        }
+        pLayer->key = key;
+        g_free( pLayer->sTitle );
+        g_free( pLayer->sDateTime );
+        pLayer->sTitle = g_strdup( pGlobal->plot.sTitle );
+        pLayer->sDateTime = g_strdup( pGlobal->plot.sDateTime );
+
+        crLayer = cairo_create( pLayer->surface );
+        // the same font options as the screen
+        cairo_get_font_options( cr, pFontOptions );
+        cairo_set_font_options( crLayer, pFontOptions );
+        cairo_font_options_destroy( pFontOptions );
+
+        cairo_set_source_rgba( crLayer, 1.0, 1.0, 1.0, 1.0 );
+        cairo_paint( crLayer );
+        flipVertical( crLayer, pGrid );
+        plotGrid( crLayer, pGrid, pGlobal );
+        cairo_destroy( crLayer );
+    }
+
+    cairo_save( cr ); {
+        cairo_set_source_surface( cr, pLayer->surface, 0.0, 0.0 );
+        cairo_paint( cr );
+    } cairo_restore( cr );
+    pLayer->bPainted = TRUE;
+}
+
+/*!     \brief  Draw the band of the trace layer holding rewritten measurements
+ *
+ * The band (whole pixels) covers the rewritten measurements and their neighbours, with room for the width
+ * of the line. It is cleared and the traces drawn again within it from the last good measurement before it.
+ *
+ * \param crLayer       pointer to cairo structure of the layer (origin at the bottom left of the grid)
+ * \param pGrid         pointer to grid settings
+ * \param pGlobal       pointer to the global data structure
+ * \param pLayer        pointer to the trace layer
+ * \param spans         the runs of the measurements drawn
+ * \param nSpans        number of runs
+ * \param first         first rewritten measurement (0 is the oldest)
+ * \param last          last rewritten measurement
+ */
+static void
+drawRewrittenBand( cairo_t *crLayer, tGridParameters *pGrid, tGlobal *pGlobal, tTraceLayer *pLayer,
+                   tBufferSpan *spans, gint nSpans, guint first, guint last ) {
+    tCircularBuffer *pDataBuffer = &pGlobal->plot.measurementBuffer;
+    tAxis *pFreqOrTimeAxis = &pGlobal->plot.axis[ eFreqOrTime ];
+    gdouble ordinateScaling = pGrid->gridWidth / ( pFreqOrTimeAxis->max - pFreqOrTimeAxis->min );
+    gdouble margin = pGrid->areaWidth / 1000.0 + 1.0;
+    gdouble xLeft = G_MAXDOUBLE, xRight = -G_MAXDOUBLE;
+    tBufferSpan band[ 2 ];
+    gint nBand;
+    tTracePen pens[ MAX_MULTI_SPOT ];
+
+#define POSN( item ) ((pLayer->head + (item)) % pDataBuffer->size)
+#define X_POS( item ) xOfMeasurement( pGlobal, pDataBuffer, POSN( item ), ordinateScaling )
+    // the segments either side of the rewritten measurements have changed too
+    first = first > 0 ? first - 1 : 0;
+    last = MIN( last + 1, pLayer->nItems - 1 );
+    for( guint item = first; item <= last; item++ ) {
+        xLeft = MIN( xLeft, X_POS( item ) );
+        xRight = MAX( xRight, X_POS( item ) );
+    }
+    // whole pixels (of the layer) .. so the edges are not blended twice
+    xLeft = floor( pGrid->leftGridPosn + xLeft - margin ) - pGrid->leftGridPosn;
+    xRight = ceil( pGrid->leftGridPosn + xRight + margin ) - pGrid->leftGridPosn;
+
+    // every segment that reaches into the band .. starting at a good measurement
+    // (after which the trace is the same however it got there)
+    while( first > 0 && (X_POS( first ) >= xLeft - margin || pDataBuffer->noise[ POSN( first ) ] >= ERROR_INDICATOR_HP8970) )
+        first--;
+    while( last < pLayer->nItems - 1 && X_POS( last ) <= xRight + margin )
+        last++;
+#undef X_POS
+#undef POSN
+
+    cairo_save( crLayer ); {
+        cairo_rectangle( crLayer, xLeft, -pGrid->bottomGridPosn, xRight - xLeft, pGrid->areaHeight );
+        cairo_clip( crLayer );
+        cairo_set_operator( crLayer, CAIRO_OPERATOR_CLEAR );
+        cairo_paint( crLayer );
+        cairo_set_operator( crLayer, CAIRO_OPERATOR_OVER );
+
+        nBand = itemRangeSpans( spans, nSpans, first, last - first + 1, band );
+        if( pLayer->bNoise ) {
+            resetTracePens( pens );
+            strokeMeasurementTraces( crLayer, pGlobal, pGrid, eNoise, band, nBand, pens );
+        }
+        if( pLayer->bGain ) {
+            resetTracePens( pens );
+            strokeMeasurementTraces( crLayer, pGlobal, pGrid, eGain, band, nBand, pens );
+        }
+    } cairo_restore( crLayer );
+}
+
+/*!     \brief  Paint the trace layer (bringing it up to date)
+ *
+ * The grid layer must have been painted (its key is that of the traces) and the measurement buffer locked.
+ *
+ * \param cr            pointer to cairo structure (flipped)
+ * \param pGrid         pointer to grid settings
+ * \param scale         scale of the screen (device pixels to a unit)
+ * \param pGlobal       pointer to the global data structure
+ * \param pGridLayer    pointer to the grid layer
+ * \param pLayer        pointer to the trace layer
+ */
+static void
+paintTraceLayer( cairo_t *cr, tGridParameters *pGrid, gint scale, tGlobal *pGlobal,
+                 tGridLayer *pGridLayer, tTraceLayer *pLayer ) {
+    tCircularBuffer *pDataBuffer = &pGlobal->plot.measurementBuffer;
+    gboolean bNoise = pDataBuffer->flags.bValidNoiseData;
+    gboolean bGain = pDataBuffer->flags.bValidGainData && !pGlobal->plot.flags.bCalibrationPlot;
+    tBufferSpan spans[ 2 ], added[ 2 ];
+    gint nSpans = circularBufferSpans( pDataBuffer, spans ), nAdded;
+    guint nItems = nSpans == 0 ? 0 : spans[ 0 ].count + (nSpans == 2 ? spans[ 1 ].count : 0);
+    guint head = nSpans == 0 ? 0 : spans[ 0 ].start;
+    // (taken even if it is not needed .. so it does not carry over to the next frame)
+    guint64 rewritten = TAKE_REWRITTEN_RANGE( &pDataBuffer->rewritten );
+    gboolean bRedraw;
+    cairo_t *crLayer;
+
+    bRedraw = pLayer->surface == NULL
+            || memcmp( &pGridLayer->key, &pLayer->key, sizeof( tGridLayerKey ) ) != 0
+            || bNoise != pLayer->bNoise || bGain != pLayer->bGain
+            || pDataBuffer->generation != pLayer->generation || head != pLayer->head || nItems < pLayer->nItems;
+
+    // measurements rewritten (the items are in the order of the positions in the columns
+    // unless the buffer has wrapped .. then it is simpler to draw all again)
+    if( !bRedraw && REWRITTEN_FIRST( rewritten ) <= REWRITTEN_LAST( rewritten ) ) {
+        guint first = (REWRITTEN_FIRST( rewritten ) + pDataBuffer->size - head) % pDataBuffer->size;
+        guint last = (REWRITTEN_LAST( rewritten ) + pDataBuffer->size - head) % pDataBuffer->size;
+
+        if( first > last )
+            bRedraw = TRUE;
+        // (a pen at a rewritten measurement no longer knows where the trace is)
+        else if( first < pLayer->nItems && ((last >= pLayer->nItems - 1 && nItems > pLayer->nItems)
+                                              || last - first > pLayer->nItems / 2) )
+            bRedraw = TRUE;
+        else if( first >= pLayer->nItems )
+            rewritten = NO_REWRITTEN_RANGE;     // not yet drawn
+        else
+            rewritten = ((guint64)first << 32) | MIN( last, pLayer->nItems - 1 );
+    }
 
+    if( pLayer->surface == NULL || pGridLayer->key.areaWidth != pLayer->key.areaWidth
+            || pGridLayer->key.areaHeight != pLayer->key.areaHeight || pGridLayer->key.scale != pLayer->key.scale ) {
+        if( pLayer->surface )
+            cairo_surface_destroy( pLayer->surface );
+        pLayer->surface = cairo_image_surface_create( CAIRO_FORMAT_ARGB32,
+                                                      pGrid->areaWidth * scale, pGrid->areaHeight * scale );
+        cairo_surface_set_device_scale( pLayer->surface, scale, scale );
+    }
+
+    crLayer = cairo_create( pLayer->surface );
+    flipVertical( crLayer, pGrid );
+    // box containing grid .. with the origin at its bottom left
+    cairo_rectangle( crLayer, pGrid->leftGridPosn, 0.0, pGrid->gridWidth, pGrid->areaHeight );
+    cairo_clip( crLayer );
+    cairo_translate( crLayer, pGrid->leftGridPosn, pGrid->bottomGridPosn );
+    cairo_set_line_width( crLayer, pGrid->areaWidth / 1000.0 );
+
+    if( bRedraw ) {
+        cairo_save( crLayer ); {
+            cairo_set_operator( crLayer, CAIRO_OPERATOR_CLEAR );
+            cairo_paint( crLayer );
+        } cairo_restore( crLayer );
+
+        pLayer->key = pGridLayer->key;
+        pLayer->bNoise = bNoise;
+        pLayer->bGain = bGain;
+        pLayer->generation = pDataBuffer->generation;
+        pLayer->head = head;
+        pLayer->nItems = 0;
+        for( gint axis = 0; axis < eMAX_AXES; axis++ )
+            resetTracePens( pLayer->pens[ axis ] );
+        plotDrawTimes.nTraceRedrawn++;
+    } else if( REWRITTEN_FIRST( rewritten ) <= REWRITTEN_LAST( rewritten ) ) {
+        drawRewrittenBand( crLayer, pGrid, pGlobal, pLayer, spans, nSpans,
+                           REWRITTEN_FIRST( rewritten ), REWRITTEN_LAST( rewritten ) );
+        plotDrawTimes.nTraceBands++;
+    }
+
+    // the measurements added since the last frame (or all of them)
+    if( nItems > pLayer->nItems ) {
+        nAdded = itemRangeSpans( spans, nSpans, pLayer->nItems, nItems - pLayer->nItems, added );
+        if( bNoise )
+            strokeMeasurementTraces( crLayer, pGlobal, pGrid, eNoise, added, nAdded, pLayer->pens[ eNoise ] );
+        if( bGain )
+            strokeMeasurementTraces( crLayer, pGlobal, pGrid, eGain, added, nAdded, pLayer->pens[ eGain ] );
+        if( !bRedraw )
+            plotDrawTimes.nTracePoints += nItems - pLayer->nItems;
+        pLayer->nItems = nItems;
+    }
+    cairo_destroy( crLayer );
+
+    // (undo the flip to paint the layer)
+    cairo_save( cr ); {
+        cairo_translate( cr, 0.0, pGrid->areaHeight );
+        cairo_scale( cr, 1.0, -1.0 );
+        cairo_set_source_surface( cr, pLayer->surface, 0.0, 0.0 );
+        cairo_paint( cr );
+    } cairo_restore( cr );
+}
+
+/*!     \brief  Log the time taken to draw the plot on the screen (and start timing afresh)
+ */
+void
+logPlotDrawTimes( void ) {
+    if( plotDrawTimes.nCached + plotDrawTimes.nRedrawn == 0 )
+        return;
+
+    DBG( eDEBUG_INFO, "Plot drawn in %.2lf ms with the grid layer cached (%d) and %.2lf ms drawing it (%d)",
+         plotDrawTimes.nCached ? plotDrawTimes.cachedTime / 1000.0 / plotDrawTimes.nCached : 0.0, plotDrawTimes.nCached,
+         plotDrawTimes.nRedrawn ? plotDrawTimes.redrawnTime / 1000.0 / plotDrawTimes.nRedrawn : 0.0, plotDrawTimes.nRedrawn );
+    DBG( eDEBUG_INFO, "Trace layer drawn in full %d times, %d measurements added and %d rewritten bands drawn",
+         plotDrawTimes.nTraceRedrawn, plotDrawTimes.nTracePoints, plotDrawTimes.nTraceBands );
+    bzero( &plotDrawTimes, sizeof( plotDrawTimes ) );
+}
+
+/*!     \brief  Font options of the plot (no hinting .. text is placed as calculated)
+ *
+ * \param cr            pointer to cairo structure
+ */
+static void
+setPlotFontOptions( cairo_t *cr ) {
     cairo_font_options_t *pFontOptions = cairo_font_options_create();
     cairo_get_font_options (cr, pFontOptions);
     cairo_font_options_set_hint_style( pFontOptions, CAIRO_HINT_STYLE_NONE );
     cairo_font_options_set_hint_metrics( pFontOptions, CAIRO_HINT_METRICS_OFF );
     cairo_set_font_options (cr, pFontOptions);
     cairo_font_options_destroy( pFontOptions );
+}
 
+/*!     \brief  Plot noise figure and gain
+ *
+ * \param cr            pointer to cairo structure
+ * \param areaWidth     width
+ * \param areaHeight    height
+ * \param pGlobal       pointer to the global data structure
+ * \param bSuppressLiveMarker whether to suppress the live marker (say when printing)
+ * \param scale         scale of the screen (for the grid and trace layers)
+ * \param pLayer        pointer to the grid layer (NULL to draw the grid and traces directly .. printing etc.)
+ */
+static void
+plotWithGridLayer( cairo_t *cr, gint areaWidth, gint areaHeight, tGlobal *pGlobal, gboolean bSuppressLiveMarker,
+                   gint scale, tGridLayer *pLayer )
+{
+    tGridParameters grid;
+
+    setPlotFontOptions( cr );
     setGrid( &grid, areaWidth, areaHeight, bSuppressLiveMarker );
 
     // clear the screen
     if( pGlobal->flags.bPreviewModeDiagram == FALSE
-            && (pGlobal->plot.measurementBuffer.flags.bValidNoiseData || pGlobal->plot.measurementBuffer.flags.bValidGainData
-                    || (pGlobal->flags.bShowMemory && (pGlobal->plot.memoryBuffer.flags.bValidNoiseData || pGlobal->plot.memoryBuffer.flags.bValidGainData ))
-            ) ) {
+            && pGlobal->flags.bShowHeatMap && pGlobal->plot.sweep2D.flags.bValid ) {
         cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0 );
         cairo_paint( cr );
-        // The memory buffer is not touched by the thread, so no need to protect it
+        flipVertical( cr, &grid );
+        plotHeatMap( cr, &grid, pGlobal );
+    } else if( pGlobal->flags.bPreviewModeDiagram == FALSE
+            && (pGlobal->plot.measurementBuffer.flags.bValidNoiseData || pGlobal->plot.measurementBuffer.flags.bValidGainData
+                    || showTraceLibrary( pGlobal, eFreq )
+            ) ) {
+        // The trace library is not touched by the thread, so no need to protect it.
+        // The lock only stops the measurement buffer being reallocated (a new sweep) while we draw;
+        // the thread adds measurements without it (we draw those published when we look)
         g_mutex_lock ( &pGlobal->plot.measurementBuffer.mBuffer );
 
-        flipVertical( cr, &grid );
-        plotGrid( cr, &grid, pGlobal );
+        setPlotBoundaries( pGlobal );
+        if( pLayer ) {
+            paintGridLayer( cr, &grid, scale, pGlobal, pLayer );
+            flipVertical( cr, &grid );
+        } else {
+            cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0 );
+            cairo_paint( cr );
+            flipVertical( cr, &grid );
+            plotGrid( cr, &grid, pGlobal );
+        }
 
-        if( pGlobal->plot.measurementBuffer.flags.bValidNoiseData || pGlobal->plot.memoryBuffer.flags.bValidNoiseData )
-            plotNoiseTrace( cr, &grid, pGlobal );
-        if( !pGlobal->plot.flags.bCalibrationPlot &&
-                (pGlobal->plot.measurementBuffer.flags.bValidGainData || pGlobal->plot.memoryBuffer.flags.bValidGainData))
-            plotGainTrace( cr, &grid, pGlobal );
+        if( pLayer == NULL ) {
+            if( pGlobal->plot.measurementBuffer.flags.bValidNoiseData || showTraceLibrary( pGlobal, eNoise ) )
+                plotNoiseTrace( cr, &grid, pGlobal, TRACE_PART_ALL );
+            if( !pGlobal->plot.flags.bCalibrationPlot &&
+                    (pGlobal->plot.measurementBuffer.flags.bValidGainData || showTraceLibrary( pGlobal, eGain )))
+                plotGainTrace( cr, &grid, pGlobal, TRACE_PART_ALL );
+        } else {
+            // memory & accumulated traces, then the measurement (from the trace layer) over them
+            // (the live marker is drawn on its own overlay .. see CB_DrawingArea_LiveMarker_Draw)
+            if( pGlobal->plot.measurementBuffer.flags.bValidNoiseData || showTraceLibrary( pGlobal, eNoise ) )
+                plotNoiseTrace( cr, &grid, pGlobal, TRACE_PART_BACKGROUND );
+            if( !pGlobal->plot.flags.bCalibrationPlot &&
+                    (pGlobal->plot.measurementBuffer.flags.bValidGainData || showTraceLibrary( pGlobal, eGain )))
+                plotGainTrace( cr, &grid, pGlobal, TRACE_PART_BACKGROUND );
+            paintTraceLayer( cr, &grid, scale, pGlobal, pLayer, &traceLayer );
+        }
 
         g_mutex_unlock ( &pGlobal->plot.measurementBuffer.mBuffer );
     } else {
         drawHPlogo ( cr, areaWidth / 2.0, areaHeight * 0.90, areaWidth / 1000.0, pGlobal->flags.bbHP8970Bmodel );
         drawModeDiagram( cr, pGlobal->HP8970settings.mode, pGlobal->flags.bbHP8970Bmodel, areaWidth, areaHeight, 0.70 );
     }
+}
+
+/*!     \brief  Plot noise figure and gain onto drawing area
+ *
+ * Plot noise figure and gain onto drawing area (printing, images etc.)
+ * \param cr            pointer to cairo structure
+ * \param areaWidth     width
+ * \param areaHeight    height
+ * \param bSuppressLiveMarker whether to suppress the live marker (say when printing)
+ * \param pGlobal       pointer to the global data structure
+ * \return           TRUE
+ */
+gboolean
+plotNoiseFigureAndGain (cairo_t *cr, gint areaWidth, gint areaHeight, tGlobal *pGlobal, gboolean bSuppressLiveMarker)
+{
+    plotWithGridLayer( cr, areaWidth, areaHeight, pGlobal, bSuppressLiveMarker, 1, NULL );
     return TRUE;
 }
 
@@ -1366,6 +2475,59 @@ CB_DrawingArea_Draw (GtkDrawingArea *widget, cairo_t *cr,
 				gint areaWidth, gint areaHeight, gpointer gpGlobal)
 {
 	tGlobal *pGlobal = (tGlobal *)gpGlobal;
-	plotNoiseFigureAndGain (cr, areaWidth, areaHeight, pGlobal, FALSE);
+	gint64 startTime = g_get_monotonic_time();
+
+	gridLayer.bPainted = gridLayer.bRedrawn = FALSE;
+	plotWithGridLayer( cr, areaWidth, areaHeight, pGlobal, FALSE,
+	                   gtk_widget_get_scale_factor( GTK_WIDGET( widget ) ), &gridLayer );
+
+	// (only the frames with the grid count)
+	if( gridLayer.bRedrawn ) {
+	    plotDrawTimes.nRedrawn++;
+	    plotDrawTimes.redrawnTime += g_get_monotonic_time() - startTime;
+	} else if( gridLayer.bPainted ) {
+	    plotDrawTimes.nCached++;
+	    plotDrawTimes.cachedTime += g_get_monotonic_time() - startTime;
+	}
+
+	// the reading of the live marker may have changed with the plot
+	if( pGlobal->flags.bLiveMarkerActive )
+	    gtk_widget_queue_draw( pGlobal->widgets[ eW_drawing_LiveMarker ] );
+}
+
+/*!     \brief  Signal received to draw the live marker (overlay of the plot)
+ *
+ * The live marker and its readout are drawn on a transparent drawing area over the plot, so moving
+ * the marker draws only the marker (with one lookup of the measurements either side of it) and
+ * the plot below is not drawn again. The axes are those the plot was last drawn with.
+ *
+ * \param widget        pointer to GtkDrawingArea widget (of the overlay)
+ * \param cr            pointer to cairo structure
+ * \param areaWidth     width
+ * \param areaHeight    height
+ * \param pGlobal       pointer to the global data structure
+ */
+void
+CB_DrawingArea_LiveMarker_Draw (GtkDrawingArea *widget, cairo_t *cr,
+                gint areaWidth, gint areaHeight, gpointer gpGlobal)
+{
+    tGlobal *pGlobal = (tGlobal *)gpGlobal;
+    tGridParameters grid;
 
+    // only over the plot of the measurements (not the heat map or mode diagram)
+    if( !pGlobal->flags.bLiveMarkerActive || pGlobal->flags.bPreviewModeDiagram
+            || ( pGlobal->flags.bShowHeatMap && pGlobal->plot.sweep2D.flags.bValid )
+            || !( pGlobal->plot.measurementBuffer.flags.bValidNoiseData || pGlobal->plot.measurementBuffer.flags.bValidGainData ) )
+        return;
+
+    setPlotFontOptions( cr );
+    setGrid( &grid, areaWidth, areaHeight, FALSE );
+
+    g_mutex_lock ( &pGlobal->plot.measurementBuffer.mBuffer );
+    flipVertical( cr, &grid );
+    if( pGlobal->plot.measurementBuffer.flags.bValidNoiseData )
+        plotNoiseTrace( cr, &grid, pGlobal, TRACE_PART_LIVE_MARKER );
+    if( !pGlobal->plot.flags.bCalibrationPlot && pGlobal->plot.measurementBuffer.flags.bValidGainData )
+        plotGainTrace( cr, &grid, pGlobal, TRACE_PART_LIVE_MARKER );
+    g_mutex_unlock ( &pGlobal->plot.measurementBuffer.mBuffer );
 }
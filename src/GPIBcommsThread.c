@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <math.h>
 
@@ -107,9 +108,9 @@ GPIBasyncWriteBinary (gint GPIBdescriptor, const void *sData, gint length, gint
             rtn = eRDWT_CONTINUE;
             waitTime += THIRTY_MS;
             if (waitTime > FIVE_SECONDS && fmod (waitTime, 1.0) < THIRTY_MS) {
-                gchar *sMessage = g_strdup_printf ("✍🏻 Waiting for HP8970: %ds", (gint) (waitTime));
+                gchar sMessage[ MSG_STRING_SIZE ];
+                g_snprintf (sMessage, MSG_STRING_SIZE, "✍🏻 Waiting for HP8970: %ds", (gint) (waitTime));
                 postInfo(sMessage);
-                g_free (sMessage);
             }
         } else {
             // did we have a read error
@@ -182,11 +183,10 @@ GPIBasyncWrite (gint GPIBdescriptor, const void *sData, gint *pGPIBstatus, gdoub
  */
 tGPIBReadWriteStatus
 GPIBasyncWriteNumber (gint GPIBdescriptor, const void *sData, gint number, gint *GPIBstatus, double timeout) {
-    gchar *sCmd = g_strdup_printf (sData, number);
+    gchar sCmd[ MSG_STRING_SIZE ];
+    g_snprintf (sCmd, MSG_STRING_SIZE, sData, number);
     DBG(eDEBUG_EXTREME, "👉 HP8970: %s", sCmd);
-    tGPIBReadWriteStatus rtnStatus = GPIBasyncWrite (GPIBdescriptor, sCmd, GPIBstatus, timeout);
-    g_free (sCmd);
-    return rtnStatus;
+    return GPIBasyncWrite (GPIBdescriptor, sCmd, GPIBstatus, timeout);
 }
 
 /*!     \brief  Read data from the GPIB device asynchronously
@@ -236,9 +236,9 @@ GPIBasyncRead (gint GPIBdescriptor, void *readBuffer, glong maxBytes, glong *pNb
             rtn = eRDWT_CONTINUE;
             waitTime += THIRTY_MS;
             if (waitTime > FIVE_SECONDS && fmod (waitTime, 1.0) < THIRTY_MS) {
-                gchar *sMessage = g_strdup_printf ("👀 Waiting for HP8970: %ds", (gint) (waitTime));
+                gchar sMessage[ MSG_STRING_SIZE ];
+                g_snprintf (sMessage, MSG_STRING_SIZE, "👀 Waiting for HP8970: %ds", (gint) (waitTime));
                 postInfo(sMessage);
-                g_free (sMessage);
             }
         } else {
             // did we have a read error
@@ -314,7 +314,10 @@ void
 freeMessage( messageEventData *pMessage )
 {
     g_free (pMessage->sMessage);
-    g_free (pMessage->data);
+    if( pMessage->command == TG_RUN_SEQUENCE )
+        freeSequence( (GList *)pMessage->data );
+    else
+        g_free (pMessage->data);
     g_free (pMessage);
 }
 
@@ -502,6 +505,48 @@ GPIBclose (gint *pDescGPIB) {
     return GPIBstatusDevice;
 }
 
+/*!     \brief  open the GPIB device that sets the parameter of a two dimensional sweep
+ *
+ * The device is a name (from gpib.conf) or a primary GPIB address on the controller.
+ *
+ * \param pGlobal             pointer to global data structure
+ * \param sDevice             device name or address
+ * \param pDescGPIB_Parameter pointer to GPIB device descriptor
+ * \return                    0 on success or ERROR on failure
+ */
+gint
+open_Parameter_GPIBdevice (tGlobal *pGlobal, gchar *sDevice, gint *pDescGPIB_Parameter) {
+    gint GPIBstatus = 0;
+    gchar *sEnd;
+    glong PID = strtol( sDevice, &sEnd, 10 );
+
+    if( *sEnd == 0 ) {
+        if (pGlobal->GPIBcontrollerIndex < 0 || PID < 0 || PID > 30) {
+            postError("Bad GPIB controller or parameter device number");
+            return ERROR;
+        }
+        *pDescGPIB_Parameter = ibdev (pGlobal->GPIBcontrollerIndex, PID, 0, T3s,
+                                       GPIB_EOI, GPIB_EOS_NONE);
+    } else if( (*pDescGPIB_Parameter = ibfind (sDevice)) != ERROR ) {
+        ibeot (*pDescGPIB_Parameter, GPIB_EOI);
+        ibeos (*pDescGPIB_Parameter, GPIB_EOS_NONE);
+    }
+
+    if (*pDescGPIB_Parameter == ERROR) {
+        *pDescGPIB_Parameter = INVALID;
+        postError("Cannot find the parameter device");
+        return ERROR;
+    }
+
+    if (!pingGPIBdevice (*pDescGPIB_Parameter, &GPIBstatus)) {
+        GPIBclose (pDescGPIB_Parameter);
+        postError("Cannot contact the parameter device");
+        return ERROR;
+    }
+
+    return 0;
+}
+
 /*!     \brief  Get real time in ms
  *
  * Get the time in milliseconds
@@ -515,24 +560,6 @@ now_milliSeconds () {
     return now.tv_sec * 1.0e3 + now.tv_nsec / 1.0e6;
 }
 
-/*!     \brief  Update the min / max values in the circular buffer
- *
- * Update the min / max values based on the current data point
- *
- * \param current data value
- * \param pMin    pointer to the minimum value of the data set
- * \param pMax    pointer to the maximum value of the data set
- */
-void
-updateBoundaries( gdouble current, gdouble *pMin, gdouble *pMax ) {
-    if( current >= ERROR_INDICATOR_HP8970 )
-        return;
-    if( *pMin == UNINITIALIZED_DOUBLE || current < *pMin )
-        *pMin = current;
-    if( *pMax == UNINITIALIZED_DOUBLE || current > *pMax )
-        *pMax = current;
-}
-
 /*!     \brief  Compare two frequencies in the tNoiseAndGain data set
  *
  * Compare two frequencies in the data set
@@ -560,11 +587,16 @@ snapshotSettings( tGlobal *pGlobal ) {
 
     gboolean bExtLO = !(pGlobal->HP8970settings.mode == eMode1_0 || pGlobal->HP8970settings.mode == eMode1_4);
 
+    // (a snapshot of the plot may be copying these .. also called from the main loop)
+    g_mutex_lock( &pGlobal->mUpdate );
     pGlobal->plot.freqSpotMHz = pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz;
     pGlobal->plot.freqStartMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz;
     pGlobal->plot.freqStopMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz;
     pGlobal->plot.freqStepCalMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStepCalMHz;
     pGlobal->plot.freqStepSweepMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStepSweepMHz;
+    // a single frequency in the list is not a multi-spot measurement
+    pGlobal->plot.nMultiSpot = pGlobal->HP8970settings.nMultiSpot >= 2 ? pGlobal->HP8970settings.nMultiSpot : 0;
+    memcpy( pGlobal->plot.multiSpotMHz, pGlobal->HP8970settings.multiSpotMHz, sizeof( pGlobal->plot.multiSpotMHz ) );
 
     pGlobal->plot.mode = pGlobal->HP8970settings.mode;
     pGlobal->plot.noiseUnits = pGlobal->HP8970settings.noiseUnits;
@@ -589,6 +621,136 @@ snapshotSettings( tGlobal *pGlobal ) {
 
     pGlobal->plot.flags.bLossCompensation = pGlobal->HP8970settings.switches.bLossCompensation;
     pGlobal->plot.flags.bDataCorrectedNFAndGain = pGlobal->HP8970settings.switches.bCorrectedNFAndGain;
+    g_mutex_unlock( &pGlobal->mUpdate );
+}
+
+/*!     \brief  Send the changed settings to the HP8970 (and LO)
+ *
+ * Only the settings flagged in updateFlags are sent. If settings are changed
+ * while we are sending, these are sent as well.
+ *
+ * \param pGlobal         pointer to the the global data
+ * \param descGPIB_HP8970 GPIB descriptor for HP8970 device
+ * \param descGPIB_extLO  GPIB descriptor for the external LO
+ * \param pGPIBstatus     pointer to GPIB status
+ */
+void
+sendSettingsHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *pGPIBstatus ) {
+    GString *pstCommands = g_string_new ( NULL );
+    gint LO_GPIBstatus = 0;
+    gboolean bNewSettings;
+    tUpdateFlags updateFlags;
+    tMode mode;
+
+    bNewSettings = TRUE;
+
+    do {
+        gboolean bExtLO;
+        gboolean bLOerror = FALSE;
+        gboolean bErrror  = FALSE;
+
+        // snapshot of the settings we need to send
+        g_mutex_lock ( &pGlobal->mUpdate );
+        updateFlags = pGlobal->HP8970settings.updateFlags;
+        pGlobal->HP8970settings.updateFlags.all = 0;
+        mode = pGlobal->HP8970settings.mode;
+        bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
+        g_mutex_unlock ( &pGlobal->mUpdate );
+
+        // Set the external signal generator (LO) for higher modes
+        if( (updateFlags.each.bSpotFrequency || updateFlags.each.bStartFrequency || updateFlags.each.bStopFrequency)
+                &&  pGlobal->flags.bNoLOcontrol == FALSE && mode != eMode1_0 ) {
+            gchar LOstatus;
+            gdouble signalFrequency = 0.0, LOfreq = 0.0;
+
+            if( updateFlags.each.bSpotFrequency )
+                signalFrequency = pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz;
+            if( updateFlags.each.bStopFrequency )
+                signalFrequency = pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz;
+            else if( updateFlags.each.bStartFrequency )
+                signalFrequency = pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz;
+
+            do {
+                if( pGlobal->HP8970settings.sExtLOsetup ) {
+                    if( GPIBasyncWrite (descGPIB_extLO, pGlobal->HP8970settings.sExtLOsetup, &LO_GPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
+                    	bLOerror = TRUE;
+                    	break;
+                    }
+                }
+
+                if( !(pGlobal->HP8970settings.mode == eMode1_0 || pGlobal->HP8970settings.mode == eMode1_4)
+                		&& ( LOfreq = LOfrequency( pGlobal, signalFrequency ) ) != 0.0 ) {
+                    g_string_printf( pstCommands, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq );
+                    if( GPIBasyncWrite (descGPIB_extLO, pstCommands->str, &LO_GPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
+                    	bLOerror = TRUE;
+                    	break;
+                    }
+                    LO_GPIBstatus = ibrsp (descGPIB_extLO, &LOstatus); // get the status byte from the LO
+                    gchar *sMessage = g_strdup_printf( "Signal Generator (LO): %.0lf MHz", LOfreq );
+                    postInfoLO( sMessage );
+                    g_free( sMessage );
+                }
+            } while FALSE;  // do loop one time so we can break on problem
+
+            if( bLOerror )
+                postErrorLO( "Communications failure with signal generator (LO)" );
+        }
+
+        // Send new settings to the HP8970
+        // always send the mode because if this is wrong (say preset was pressed), the
+        // frequencies may not make sense.
+        g_string_printf( pstCommands, "E%1d", pGlobal->HP8970settings.mode );
+        if( updateFlags.each.bStartFrequency )
+            g_string_append_printf( pstCommands, "FA%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz );
+        if( updateFlags.each.bStopFrequency )
+            g_string_append_printf( pstCommands, "FB%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz );
+        if( updateFlags.each.bStepFrequency )
+            g_string_append_printf( pstCommands, "SS%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqStepCalMHz );
+        if( updateFlags.each.bSmoothing )
+            g_string_append_printf( pstCommands, "F%1d", (gint)round( log2( pGlobal->HP8970settings.smoothingFactor ) ));
+        if( updateFlags.each.bSpotFrequency )
+            g_string_append_printf( pstCommands, "FR%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz );
+        if( updateFlags.each.bNoiseUnits )
+            g_string_append_printf( pstCommands, "N%1d", pGlobal->HP8970settings.noiseUnits );
+        if( updateFlags.each.bCorrection )
+            g_string_append_printf( pstCommands, "M%1d",
+                                    pGlobal->HP8970settings.switches.bCorrectedNFAndGain ? 2 : 1 );
+        if( updateFlags.each.bExternalLO )
+            g_string_append_printf( pstCommands, "IF%dMZLF%dMZB%1d", pGlobal->HP8970settings.extLOfreqIF,
+                                    pGlobal->HP8970settings.extLOfreqLO, pGlobal->HP8970settings.extLOsideband );
+        if( updateFlags.each.bLossCompenstaion )
+            g_string_append_printf( pstCommands, "D0L%1dLA%.3lfENLB%.3lfENLT%.2lfEN",
+                                    pGlobal->HP8970settings.switches.bLossCompensation,
+                                    pGlobal->HP8970settings.lossBeforeDUT, pGlobal->HP8970settings.lossAfterDUT,
+                                    pGlobal->HP8970settings.lossTemp);
+        if( updateFlags.each.bColdTemperature )
+            g_string_append_printf( pstCommands, "TC%.2lfEN", pGlobal->HP8970settings.coldTemp );
+
+        if( updateFlags.each.bRFattenuation )
+            g_string_append_printf( pstCommands, "R%1d", pGlobal->HP8970settings.RFattenuation );
+        if( updateFlags.each.bIFattenuation )
+            g_string_append_printf( pstCommands, "I%1d", pGlobal->HP8970settings.IFattenuation );
+        if( updateFlags.each.bHoldRFattenuator )
+            g_string_append_printf( pstCommands, "RH" );
+        if( updateFlags.each.bHoldIFattenuator )
+            g_string_append_printf( pstCommands, "IH" );
+
+        if( GPIBasyncWrite (descGPIB_HP8970, pstCommands->str, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
+        	bErrror = TRUE;
+        	break;
+        }
+
+        g_mutex_lock ( &pGlobal->mUpdate );
+        bNewSettings = ( pGlobal->HP8970settings.updateFlags.all != 0 );
+        g_mutex_unlock ( &pGlobal->mUpdate );
+
+        if( bErrror ) {
+        	postError( "8970 setting failure" );
+        }
+
+    } while ( bNewSettings );
+
+    g_string_free ( pstCommands, TRUE );
 }
 
 /*!     \brief  Thread to communicate with GPIB
@@ -604,7 +766,7 @@ threadGPIB (gpointer _pGlobal) {
 
     gchar *sGPIBversion = NULL;
     gint verMajor, verMinor, verMicro;
-    gint GPIBstatus, LO_GPIBstatus;
+    gint GPIBstatus;
     gint timeoutHP8970;   				// previous timeout
 
     gint descGPIB_HP8970 = INVALID;
@@ -616,14 +778,11 @@ threadGPIB (gpointer _pGlobal) {
     gulong __attribute__((unused)) datum = 0;
     GString *pstCommands  = g_string_new ( NULL );;
     gchar HP8970status;
+    const gchar *sReason;
 #define DEFAULT_MSG_TIMEOUT 2000
 #define MINIMAL_MSG_TIMEOUT 1
     gint messageTimeout = DEFAULT_MSG_TIMEOUT;
 
-    gboolean bNewSettings;
-    tUpdateFlags updateFlags;
-    tMode mode;
-
     // The HP8970 formats numbers like 3.141 not, the continental European way 3,14159
     setlocale (LC_NUMERIC, "C");
     ibvers (&sGPIBversion);
@@ -735,114 +894,7 @@ threadGPIB (gpointer _pGlobal) {
                     open_ExtLO_GPIBdevice (pGlobal, &descGPIB_extLO);
                     break;
                 case TG_SEND_SETTINGS_to_HP8970:
-                    bNewSettings = TRUE;
-
-                    do {
-                        gboolean bExtLO;
-                        gboolean bLOerror = FALSE;
-                        gboolean bErrror  = FALSE;
-
-                        // snapshot of the settings we need to send
-                        g_mutex_lock ( &pGlobal->mUpdate );
-                        updateFlags = pGlobal->HP8970settings.updateFlags;
-                        pGlobal->HP8970settings.updateFlags.all = 0;
-                        mode = pGlobal->HP8970settings.mode;
-                        bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
-                        g_mutex_unlock ( &pGlobal->mUpdate );
-
-                        // Set the external signal generator (LO) for higher modes
-                        if( (updateFlags.each.bSpotFrequency || updateFlags.each.bStartFrequency || updateFlags.each.bStopFrequency)
-                                &&  pGlobal->flags.bNoLOcontrol == FALSE && mode != eMode1_0 ) {
-                            gchar LOstatus;
-                            gdouble signalFrequency = 0.0, LOfreq = 0.0;
-
-                            if( updateFlags.each.bSpotFrequency )
-                                signalFrequency = pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz;
-                            if( updateFlags.each.bStopFrequency )
-                                signalFrequency = pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz;
-                            else if( updateFlags.each.bStartFrequency )
-                                signalFrequency = pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz;
-
-                            do {
-                                if( pGlobal->HP8970settings.sExtLOsetup ) {
-                                    if( GPIBasyncWrite (descGPIB_extLO, pGlobal->HP8970settings.sExtLOsetup, &LO_GPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
-                                    	bLOerror = TRUE;
-                                    	break;
-                                    }
-                                }
-
-                                if( !(pGlobal->HP8970settings.mode == eMode1_0 || pGlobal->HP8970settings.mode == eMode1_4)
-                                		&& ( LOfreq = LOfrequency( pGlobal, signalFrequency ) ) != 0.0 ) {
-                                    g_string_printf( pstCommands, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq );
-                                    if( GPIBasyncWrite (descGPIB_extLO, pstCommands->str, &LO_GPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
-                                    	bLOerror = TRUE;
-                                    	break;
-                                    }
-                                    LO_GPIBstatus = ibrsp (descGPIB_extLO, &LOstatus); // get the status byte from the LO
-                                    gchar *sMessage = g_strdup_printf( "Signal Generator (LO): %.0lf MHz", LOfreq );
-                                    postInfoLO( sMessage );
-                                    g_free( sMessage );
-                                }
-                            } while FALSE;  // do loop one time so we can break on problem
-
-                            if( bLOerror )
-                                postErrorLO( "Communications failure with signal generator (LO)" );
-                        }
-
-                        // Send new settings to the HP8970
-                        // always send the mode because if this is wrong (say preset was pressed), the
-                        // frequencies may not make sense.
-                        g_string_printf( pstCommands, "E%1d", pGlobal->HP8970settings.mode );
-                        if( updateFlags.each.bStartFrequency )
-                            g_string_append_printf( pstCommands, "FA%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz );
-                        if( updateFlags.each.bStopFrequency )
-                            g_string_append_printf( pstCommands, "FB%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz );
-                        if( updateFlags.each.bStepFrequency )
-                            g_string_append_printf( pstCommands, "SS%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqStepCalMHz );
-                        if( updateFlags.each.bSmoothing )
-                            g_string_append_printf( pstCommands, "F%1d", (gint)round( log2( pGlobal->HP8970settings.smoothingFactor ) ));
-                        if( updateFlags.each.bSpotFrequency )
-                            g_string_append_printf( pstCommands, "FR%dMZ", (gint)pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz );
-                        if( updateFlags.each.bNoiseUnits )
-                            g_string_append_printf( pstCommands, "N%1d", pGlobal->HP8970settings.noiseUnits );
-                        if( updateFlags.each.bCorrection )
-                            g_string_append_printf( pstCommands, "M%1d",
-                                                    pGlobal->HP8970settings.switches.bCorrectedNFAndGain ? 2 : 1 );
-                        if( updateFlags.each.bExternalLO )
-                            g_string_append_printf( pstCommands, "IF%dMZLF%dMZB%1d", pGlobal->HP8970settings.extLOfreqIF,
-                                                    pGlobal->HP8970settings.extLOfreqLO, pGlobal->HP8970settings.extLOsideband );
-                        if( updateFlags.each.bLossCompenstaion )
-                            g_string_append_printf( pstCommands, "D0L%1dLA%.3lfENLB%.3lfENLT%.2lfEN",
-                                                    pGlobal->HP8970settings.switches.bLossCompensation,
-                                                    pGlobal->HP8970settings.lossBeforeDUT, pGlobal->HP8970settings.lossAfterDUT,
-                                                    pGlobal->HP8970settings.lossTemp);
-                        if( updateFlags.each.bColdTemperature )
-                            g_string_append_printf( pstCommands, "TC%.2lfEN", pGlobal->HP8970settings.coldTemp );
-
-                        if( updateFlags.each.bRFattenuation )
-                            g_string_append_printf( pstCommands, "R%1d", pGlobal->HP8970settings.RFattenuation );
-                        if( updateFlags.each.bIFattenuation )
-                            g_string_append_printf( pstCommands, "I%1d", pGlobal->HP8970settings.IFattenuation );
-                        if( updateFlags.each.bHoldRFattenuator )
-                            g_string_append_printf( pstCommands, "RH" );
-                        if( updateFlags.each.bHoldIFattenuator )
-                            g_string_append_printf( pstCommands, "IH" );
-
-                        if( GPIBasyncWrite (descGPIB_HP8970, pstCommands->str, &GPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
-                        	bErrror = TRUE;
-                        	break;
-                        }
-
-                        g_mutex_lock ( &pGlobal->mUpdate );
-                        bNewSettings = ( pGlobal->HP8970settings.updateFlags.all != 0 );
-                        g_mutex_unlock ( &pGlobal->mUpdate );
-
-                        if( bErrror ) {
-                        	postError( "8970 setting failure" );
-                        }
-
-                    } while ( bNewSettings );
-
+                    sendSettingsHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, &GPIBstatus );
                     IBLOC(descGPIB_HP8970, datum, GPIBstatus);
                     break;
                 case TG_CALIBRATE:
@@ -864,10 +916,30 @@ threadGPIB (gpointer _pGlobal) {
 
                 case TG_SWEEP_HP8970:
                     snapshotSettings( pGlobal );
-                    sweepHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, &GPIBstatus );
+                    sweepHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, &GPIBstatus, FALSE );
                     IBLOC(descGPIB_HP8970, datum, GPIBstatus);
                     break;
 
+                case TG_RESUME_SWEEP_HP8970:
+                    // The sweep is continued with the settings snapshot of the interrupted sweep
+                    if( canResumeSweepHP8970( pGlobal, &sReason ) ) {
+                        ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
+                        sweepHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, &GPIBstatus, TRUE );
+                    } else {
+                        gchar *sMessage = g_strdup_printf( "Cannot resume the sweep: %s", sReason );
+                        postError( sMessage );
+                        g_free( sMessage );
+                    }
+                    IBLOC(descGPIB_HP8970, datum, GPIBstatus);
+                    break;
+
+                case TG_RUN_SEQUENCE:
+                    // the sequence is freed with the message
+                    runSequenceHP8970( pGlobal, (GList *)message->data, descGPIB_HP8970, descGPIB_extLO, &GPIBstatus );
+                    IBLOC(descGPIB_HP8970, datum, GPIBstatus);
+                    ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
+                    break;
+
                 case TG_SPOT_HP8970:
                     snapshotSettings( pGlobal );
                     spotFrequencyHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, &GPIBstatus );
@@ -897,9 +969,11 @@ threadGPIB (gpointer _pGlobal) {
                             break;
                     } while FALSE;
 
-                    if( GPIBsucceeded( GPIBstatus ) )
+                    if( GPIBsucceeded( GPIBstatus ) ) {
                     	postInfo( "ENR table uploaded to HP8970");
-                    else
+                    	// the calibration was made with the old table
+                    	invalidateCalibration( pGlobal );
+                    } else
                     	postError( "Failed to upload ENR table to HP8970");
                     IBLOC(descGPIB_HP8970, datum, GPIBstatus);
                     ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
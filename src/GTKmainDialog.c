@@ -23,10 +23,315 @@
  *
  *           F2:    send all settings to the HP8970 (useful if HP8970 has been preset or re-powered)
  *
+ *           F5:    resume an interrupted sweep
+ *
+ *           F6:    choose and run a measurement sequence file
+ *
+ *           F7:    add the spot frequency to the multi-spot list
+ *     Shift F7:    clear the multi-spot list
+ *
+ *           F8:    toggle the heat map of a two dimensional (parameter) sweep
+ *
+ *           F9:    show memory traces
+ *     Shift F9:    hide memory traces
+ *      Ctrl F9:    save measurement to memory (trace library)
+ *       Alt F9:    clear memory traces
+ *
+ *          F10:    add a saved plot (JSON file) to the memory traces
+ *    Shift F10:    add the calibration sweep to the memory traces
+ *     Ctrl F10:    select the next memory trace
+ *      Alt F10:    show / hide the selected memory trace
+ *    Super F10:    change the line style of the selected memory trace
+ *  Ctrl Sh F10:    change the color of the selected memory trace
+ *
  *           F12:   enlarge to max screen height
  *     Shift F12: make default size
  */
 
+static void CB_tgl_Sweep (GtkToggleButton *, gpointer);
+
+/*!     \brief  Callback when a sequence file is chosen
+ *
+ * Read the sequence and pass it to the GPIB thread to run
+ *
+ * \param  source_object     GtkFileDialog object
+ * \param  res               result of opening file
+ * \param  gpGlobal          pointer to global data
+ */
+static void
+CB_SequenceOpen( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
+    GtkFileDialog *dialog = GTK_FILE_DIALOG (source_object);
+    tGlobal *pGlobal = (tGlobal *)gpGlobal;
+    GFile *file;
+    GError *err = NULL;
+    GList *sequence;
+
+    if (((file = gtk_file_dialog_open_finish (dialog, res, &err)) != NULL) ) {
+        gchar *sChosenFilename = g_file_get_path( file );
+
+        if( (sequence = readSequenceFile( sChosenFilename )) != NULL ) {
+            postDataToGPIBThread (TG_RUN_SEQUENCE, sequence);
+            quarantineControlsOnSweep( pGlobal, FALSE, FALSE );
+        }
+
+        g_object_unref( file );
+        g_free( sChosenFilename );
+    } else {
+        g_clear_error (&err);
+    }
+}
+
+/*!     \brief  Choose a sequence file to run
+ *
+ * (F6 or the 'Sequence…' button on the Special Fns. page)
+ *
+ * \param  pGlobal          pointer to global data
+ */
+void
+chooseSequenceFile( tGlobal *pGlobal ) {
+    if( !gtk_widget_get_sensitive( pGlobal->widgets[ eW_frm_Sweep ] ) )
+        return;     // already busy
+
+    GtkFileDialog *fileDialogSequence = gtk_file_dialog_new ();
+
+    g_autoptr (GListModel) filters = (GListModel *)g_list_store_new (GTK_TYPE_FILE_FILTER);
+    g_autoptr (GtkFileFilter) filter = NULL;
+    filter = gtk_file_filter_new ();
+    gtk_file_filter_add_pattern (filter, "*.[Ss][Ee][Qq]");
+    gtk_file_filter_add_pattern (filter, "*.[Tt][Xx][Tt]");
+    gtk_file_filter_set_name (filter, "Sequence");
+    g_list_store_append ( (GListStore*)filters, filter);
+
+    // All files
+    filter = gtk_file_filter_new ();
+    gtk_file_filter_add_pattern (filter, "*");
+    gtk_file_filter_set_name (filter, "All Files");
+    g_list_store_append ( (GListStore*) filters, filter);
+
+    gtk_file_dialog_set_filters (fileDialogSequence, G_LIST_MODEL (filters));
+    gtk_file_dialog_set_title (fileDialogSequence, "Run measurement sequence");
+    if( pGlobal->sLastDirectory ) {
+        GFile *dir = g_file_new_for_path( pGlobal->sLastDirectory );
+        gtk_file_dialog_set_initial_folder( fileDialogSequence, dir );
+        g_object_unref( dir );
+    }
+
+    gtk_file_dialog_open ( fileDialogSequence, GTK_WINDOW( pGlobal->widgets[ eW_HP8970_application ] ),
+                           NULL, CB_SequenceOpen, pGlobal);
+    g_object_unref (fileDialogSequence);
+}
+
+static gchar *sTraceStyles[ eMAX_TRACE_STYLES ] = { "dashed", "solid", "dotted" };
+
+/*!     \brief  Callback when a plot (JSON) file is chosen to add to the trace library
+ *
+ * \param  source_object     GtkFileDialog object
+ * \param  res               result of opening file
+ * \param  gpGlobal          pointer to global data
+ */
+static void
+CB_TraceOpen( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
+    GtkFileDialog *dialog = GTK_FILE_DIALOG (source_object);
+    tGlobal *pGlobal = (tGlobal *)gpGlobal;
+    GFile *file;
+    GError *err = NULL;
+    gchar *sMessage;
+    gint nTraces;
+
+    if (((file = gtk_file_dialog_open_finish (dialog, res, &err)) != NULL) ) {
+        gchar *sChosenFilename = g_file_get_path( file );
+
+        if( (nTraces = retrieveTrace( sChosenFilename, pGlobal )) != ERROR ) {
+            sMessage = g_strdup_printf( "Trace %d of %d loaded from %s", nTraces, MAX_TRACES, sChosenFilename );
+            postInfo( sMessage );
+            g_free( sMessage );
+            gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
+            gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+        } else {
+            postError( "There is no swept plot in the file" );
+        }
+
+        g_object_unref( file );
+        g_free( sChosenFilename );
+    } else {
+        g_clear_error (&err);
+    }
+}
+
+/*!     \brief  Choose a plot (JSON) file to add to the trace library
+ *
+ * \param  pGlobal          pointer to global data
+ */
+void
+chooseTraceFile( tGlobal *pGlobal ) {
+    GtkFileDialog *fileDialogTrace = gtk_file_dialog_new ();
+
+    g_autoptr (GListModel) filters = (GListModel *)g_list_store_new (GTK_TYPE_FILE_FILTER);
+    g_autoptr (GtkFileFilter) filter = NULL;
+    filter = gtk_file_filter_new ();
+    gtk_file_filter_add_pattern (filter, "*.[Jj][Ss][Oo][Nn]");
+    gtk_file_filter_set_name (filter, "JSON");
+    g_list_store_append ( (GListStore*)filters, filter);
+
+    // All files
+    filter = gtk_file_filter_new ();
+    gtk_file_filter_add_pattern (filter, "*");
+    gtk_file_filter_set_name (filter, "All Files");
+    g_list_store_append ( (GListStore*) filters, filter);
+
+    gtk_file_dialog_set_filters (fileDialogTrace, G_LIST_MODEL (filters));
+    gtk_file_dialog_set_title (fileDialogTrace, "Add plot to the trace memory");
+    if( pGlobal->sLastDirectory ) {
+        GFile *dir = g_file_new_for_path( pGlobal->sLastDirectory );
+        gtk_file_dialog_set_initial_folder( fileDialogTrace, dir );
+        g_object_unref( dir );
+    }
+
+    gtk_file_dialog_open ( fileDialogTrace, GTK_WINDOW( pGlobal->widgets[ eW_HP8970_application ] ),
+                           NULL, CB_TraceOpen, pGlobal);
+    g_object_unref (fileDialogTrace);
+}
+
+/*!     \brief  Store the measurement in the trace library (memory)
+ *
+ * \param  pGlobal          pointer to global data
+ */
+static void
+storeMeasurementTrace( tGlobal *pGlobal ) {
+    tCircularBuffer *pMeasurement = &pGlobal->plot.measurementBuffer;
+    gchar *sName, *sMessage;
+    gint nTraces;
+
+    if( pGlobal->plot.flags.bSpotFrequencyPlot
+            || !(pMeasurement->flags.bValidNoiseData || pMeasurement->flags.bValidGainData) )
+        return;
+
+    if( pGlobal->plot.sTitle && *pGlobal->plot.sTitle )
+        sName = g_strdup( pGlobal->plot.sTitle );
+    else if( pGlobal->plot.sDateTime )
+        sName = g_strdup( pGlobal->plot.sDateTime );
+    else
+        sName = g_strdup_printf( "Trace %d", pGlobal->plot.traceLibrary.nTraces + 1 );
+
+    // The data is shared (not copied) unless the GPIB thread is still acquiring (a sweep or spot run)
+    nTraces = storeTrace( &pGlobal->plot.traceLibrary, pMeasurement,
+                          !pGlobal->flags.bGPIBcommsActive, sName );
+    sMessage = g_strdup_printf( "Stored trace %d of %d: %s", nTraces, MAX_TRACES, sName );
+    postInfo( sMessage );
+    g_free( sMessage );
+    g_free( sName );
+
+    gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
+    gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+}
+
+/*!     \brief  Report (on the status line) the trace selected in the trace library
+ *
+ * \param  pGlobal          pointer to global data
+ */
+static void
+showSelectedTrace( tGlobal *pGlobal ) {
+    tTraceLibrary *pLibrary = &pGlobal->plot.traceLibrary;
+    tTraceSlot *pSlot = &pLibrary->slots[ pLibrary->selected ];
+    gchar *sMessage;
+
+    sMessage = g_strdup_printf( "Trace %d of %d: %s (%s, color %d%s)", pLibrary->selected + 1, pLibrary->nTraces,
+                                pSlot->pTrace->sName ? pSlot->pTrace->sName : "",
+                                sTraceStyles[ pSlot->style ], pSlot->color + 1,
+                                pSlot->flags.bVisible ? "" : ", hidden" );
+    postInfo( sMessage );
+    g_free( sMessage );
+    gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+}
+
+/*!     \brief  Add the calibration sweep to the trace library
+ *
+ * \param  pGlobal          pointer to global data
+ */
+void
+storeCalibrationTrace( tGlobal *pGlobal ) {
+    gchar *sName = g_strdup_printf( "Calibration %s",
+                                    pGlobal->calibration.sDateTime ? pGlobal->calibration.sDateTime : "" );
+
+    if( pGlobal->calibration.data == NULL
+            || storeTraceData( &pGlobal->plot.traceLibrary, pGlobal->calibration.data, pGlobal->calibration.nPoints,
+                               IS_Y_FACTOR( pGlobal->calibration.noiseUnits ), sName ) == ERROR ) {
+        postInfo( "There is no calibration sweep" );
+    } else {
+        gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
+        showSelectedTrace( pGlobal );
+    }
+    g_free( sName );
+}
+
+/*!     \brief  Clear the trace library (memory)
+ *
+ * \param  pGlobal          pointer to global data
+ */
+void
+clearMemoryTraces( tGlobal *pGlobal ) {
+    clearTraceLibrary( &pGlobal->plot.traceLibrary );
+    gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], FALSE );
+    gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+}
+
+/*!     \brief  Select the next trace of the trace library or change how the selected trace is shown
+ *
+ * \param  pGlobal          pointer to global data
+ * \param  change           next trace, show / hide, line style or color
+ */
+void
+changeSelectedTrace( tGlobal *pGlobal, tTraceChange change ) {
+    tTraceLibrary *pLibrary = &pGlobal->plot.traceLibrary;
+
+    if( pLibrary->nTraces == 0 ) {
+        postInfo( "There are no memory traces" );
+        return;
+    }
+    g_mutex_lock( &pLibrary->mTraces );
+    switch( change ) {
+    case eTraceNext:
+        pLibrary->selected = (pLibrary->selected + 1) % pLibrary->nTraces;
+        break;
+    case eTraceVisible:
+        pLibrary->slots[ pLibrary->selected ].flags.bVisible = !pLibrary->slots[ pLibrary->selected ].flags.bVisible;
+        break;
+    case eTraceStyle:
+        pLibrary->slots[ pLibrary->selected ].style = (pLibrary->slots[ pLibrary->selected ].style + 1) % eMAX_TRACE_STYLES;
+        break;
+    case eTraceColor:
+        pLibrary->slots[ pLibrary->selected ].color = (pLibrary->slots[ pLibrary->selected ].color + 1) % N_TRACE_COLORS;
+        break;
+    }
+    g_mutex_unlock( &pLibrary->mTraces );
+    showSelectedTrace( pGlobal );
+}
+
+/*!     \brief  Resume an interrupted sweep from the next frequency
+ *
+ * (F5 or the 'Resume Sweep' button on the Special Fns. page)
+ *
+ * \param  pGlobal          pointer to global data
+ */
+void
+resumeInterruptedSweep( tGlobal *pGlobal ) {
+    if( !gtk_widget_get_sensitive( pGlobal->widgets[ eW_frm_Sweep ] ) )
+        return;     // already busy
+    if( !pGlobal->plot.sweepCheckpoint.flags.bValid ) {
+        postInfo( "There is no interrupted sweep to resume" );
+        return;
+    }
+    pGlobal->HP8970settings.switches.bAutoSweep = pGlobal->plot.sweepCheckpoint.flags.bAutoSweep;
+    if( pGlobal->HP8970settings.switches.bAutoSweep ) {
+        GtkToggleButton *wSweep = GTK_TOGGLE_BUTTON( pGlobal->widgets[ eW_tgl_Sweep ] );
+        g_signal_handlers_block_by_func( wSweep, CB_tgl_Sweep, NULL );
+        gtk_toggle_button_set_active (wSweep, TRUE);
+        g_signal_handlers_unblock_by_func( wSweep, CB_tgl_Sweep, NULL );
+    }
+    postDataToGPIBThread (TG_RESUME_SWEEP_HP8970, NULL);
+    quarantineControlsOnSweep( pGlobal, FALSE, FALSE );
+}
+
 /*!     \brief  Callback button press
  *
  * Callback button press
@@ -43,8 +348,8 @@ CB_KeyPressed (GtkEventControllerKey *self, guint keyval, guint keycode,
                GdkModifierType state, gpointer udata) {
 
     tGlobal *pGlobal = (tGlobal*) g_object_get_data ( G_OBJECT(self), "data");
-    tCircularBuffer *pMemory = &pGlobal->plot.memoryBuffer;
     tCircularBuffer *pMeasurement = &pGlobal->plot.measurementBuffer;
+    guint newLength;
 
 //  if (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK))
 //      return FALSE;
@@ -58,12 +363,32 @@ CB_KeyPressed (GtkEventControllerKey *self, guint keyval, guint keycode,
      *
      *        F2: send all settings to HP8970 (useful if HP8970 has been reset)
      *
+     *        F5: resume an interrupted sweep from the next frequency
+     *
+     *        F6: choose and run a sequence file (configurations, calibrate, sweep, spot & save steps)
+     *
+     *        F7: add the spot frequency to the multi-spot list (two or more are measured in turn)
+     *  shift F7: clear the multi-spot list
+     *
+     *        F8: toggle the heat map of a two dimensional (parameter) sweep
+     *
      *        F9: show memory trace(s) if saved
      *  shift F9: hide memory trace(s) if saved
-     *   ctrl F9: save measurement to memory and activate 'show' memory checkbox
+     *   ctrl F9: save measurement to memory (a new trace of the trace library) and activate 'show' memory checkbox
      *    alt F9: clear memory traces and deactivate 'show' memory checkbox
      *  super F9: clear measurement trace(s) but not the title or notes
      *
+     *       F10: add a saved plot (JSON file) to the memory traces
+     * shift F10: add the calibration sweep to the memory traces
+     *  ctrl F10: select the next memory trace
+     *   alt F10: show / hide the selected memory trace
+     * super F10: change the line style of the selected memory trace (dashed, solid, dotted)
+     * ctrl shift F10: change the color of the selected memory trace
+     *
+     *       F11: cycle the accumulated trace display (none, average, running average, max/min hold, std. deviation)
+     * shift F11: reset the accumulators
+     *  ctrl F11: double the averaging length N (wraps back to 2) and reset the accumulators
+     *
      *       F12: enlarge to max screen height
      * shift F12: make default size
     */
@@ -79,17 +404,30 @@ CB_KeyPressed (GtkEventControllerKey *self, guint keyval, guint keycode,
                     postDataToGPIBThread (TG_ABORT_CLEAR, NULL);
                     break;
                 case GDK_ALT_MASK:
+                    // the GPIB thread adds to the buffer while it measures
+                    if( pGlobal->flags.bGPIBcommsActive ) {
+                        postError( "Stop the measurement (ESC) before clearing the plot" );
+                        break;
+                    }
                     pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
                     pGlobal->plot.measurementBuffer.flags.bValidGainData  = FALSE;
+                    pGlobal->plot.sweepCheckpoint.flags.bValid = FALSE;
                     initCircularBuffer( &pGlobal->plot.measurementBuffer, 0, eTimeAbscissa );
+                    clearMeasurementLog( &pGlobal->plot.spotLog );
                     gtk_text_buffer_set_text( gtk_text_view_get_buffer(GTK_TEXT_VIEW( pGlobal->widgets[ eW_textView_Notes ] )), "", -1 );
                     gtk_editable_set_text( GTK_EDITABLE( pGlobal->widgets[ eW_entry_Title ] ), "" );
                     gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
                     break;
                 case GDK_SUPER_MASK:
+                    if( pGlobal->flags.bGPIBcommsActive ) {
+                        postError( "Stop the measurement (ESC) before clearing the plot" );
+                        break;
+                    }
                     pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
                     pGlobal->plot.measurementBuffer.flags.bValidGainData  = FALSE;
+                    pGlobal->plot.sweepCheckpoint.flags.bValid = FALSE;
                     initCircularBuffer( &pGlobal->plot.measurementBuffer, 0, eTimeAbscissa );
+                    clearMeasurementLog( &pGlobal->plot.spotLog );
                     gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
                     break;
                 case 0:
@@ -153,6 +491,60 @@ CB_KeyPressed (GtkEventControllerKey *self, guint keyval, guint keycode,
                         break;
                     }
                 break;
+            case GDK_KEY_F5:
+                switch (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK | GDK_SUPER_MASK))
+                    {
+                    case GDK_SHIFT_MASK:
+                        break;
+                    case GDK_CONTROL_MASK:
+                        break;
+                    case GDK_ALT_MASK:
+                        break;
+                    case GDK_SUPER_MASK:
+                        break;
+                    case 0:
+                        // Resume an interrupted sweep F5
+                        resumeInterruptedSweep( pGlobal );
+                        break;
+                    }
+                break;
+            case GDK_KEY_F6:
+                switch (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK | GDK_SUPER_MASK))
+                    {
+                    case 0:
+                        // Run a measurement sequence F6
+                        chooseSequenceFile( pGlobal );
+                        break;
+                    default:
+                        break;
+                    }
+                break;
+            case GDK_KEY_F7:
+                switch (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK | GDK_SUPER_MASK))
+                    {
+                    case GDK_SHIFT_MASK:
+                        // Clear the multi-spot list Shift F7
+                        clearMultiSpot( pGlobal );
+                        break;
+                    case 0:
+                        // Add the spot frequency to the multi-spot list F7
+                        addSpotToMultiSpot( pGlobal );
+                        break;
+                    default:
+                        break;
+                    }
+                break;
+            case GDK_KEY_F8:
+                switch (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK | GDK_SUPER_MASK))
+                    {
+                    case 0:
+                        // Toggle the heat map of the two dimensional sweep F8
+                        toggleHeatMap( pGlobal );
+                        break;
+                    default:
+                        break;
+                    }
+                break;
             case GDK_KEY_F9:
                 switch (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK | GDK_SUPER_MASK))
                     {
@@ -162,24 +554,22 @@ CB_KeyPressed (GtkEventControllerKey *self, guint keyval, guint keycode,
                         break;
                     case GDK_CONTROL_MASK:
                         // Save measurement to memory Ctrl F9
-                        if( pMeasurement->flags.bValidNoiseData || pMeasurement->flags.bValidGainData ) {
-                            g_free( pMemory->measurementData );
-                            pMemory->measurementData = 0;
-                            *pMemory = *pMeasurement;
-                            pMemory->measurementData = g_memdup2( pMeasurement->measurementData, pMeasurement->size * sizeof(tNoiseAndGain) );
-                            gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
-                        }
+                        storeMeasurementTrace( pGlobal );
                         break;
                     case GDK_ALT_MASK:
                         // Clear the memory Alt F9
-                        g_free( pMemory->measurementData );
-                        bzero( pMemory, sizeof( tCircularBuffer ) );
-                        gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], FALSE );
+                        clearMemoryTraces( pGlobal );
                         break;
                     case GDK_SUPER_MASK:
                         // Clear the measurement Win F9
-                        g_free( pMeasurement->measurementData );
-                        bzero( pMeasurement, sizeof( tCircularBuffer ) );
+                        if( pGlobal->flags.bGPIBcommsActive ) {
+                            postError( "Stop the measurement (ESC) before clearing the plot" );
+                            break;
+                        }
+                        freeCircularBuffer( pMeasurement );
+                        pMeasurement->flags.bValidNoiseData = FALSE;
+                        pMeasurement->flags.bValidGainData = FALSE;
+                        pGlobal->plot.sweepCheckpoint.flags.bValid = FALSE;
                         gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
                         break;
                     case 0:
@@ -188,18 +578,60 @@ CB_KeyPressed (GtkEventControllerKey *self, guint keyval, guint keycode,
                         break;
                     }
                 break;
+            case GDK_KEY_F10:
+                switch (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK | GDK_SUPER_MASK))
+                    {
+                    case 0:
+                        // Add a saved plot to the memory traces F10
+                        chooseTraceFile( pGlobal );
+                        break;
+                    case GDK_SHIFT_MASK:
+                        // Add the calibration sweep to the memory traces Shift F10
+                        storeCalibrationTrace( pGlobal );
+                        break;
+                    case GDK_CONTROL_MASK:
+                        // Select the next memory trace Ctrl F10
+                        changeSelectedTrace( pGlobal, eTraceNext );
+                        break;
+                    case GDK_ALT_MASK:
+                        // Show or hide the selected trace Alt F10
+                        changeSelectedTrace( pGlobal, eTraceVisible );
+                        break;
+                    case GDK_SUPER_MASK:
+                        // Line style of the selected trace Super F10
+                        changeSelectedTrace( pGlobal, eTraceStyle );
+                        break;
+                    case GDK_CONTROL_MASK | GDK_SHIFT_MASK:
+                        // Color of the selected trace Ctrl Shift F10
+                        changeSelectedTrace( pGlobal, eTraceColor );
+                        break;
+                    default:
+                        break;
+                    }
+                break;
         case GDK_KEY_F11:
             switch (state & (GDK_SHIFT_MASK | GDK_CONTROL_MASK | GDK_ALT_MASK | GDK_SUPER_MASK))
                 {
                 case GDK_SHIFT_MASK:
+                    // Reset the accumulators Shift F11
+                    resetAccumulatedTraces( pGlobal );
                     break;
                 case GDK_CONTROL_MASK:
+                    // Change the averaging length Ctrl F11 (the drop down on the Plot page resets the accumulators)
+                    newLength = pGlobal->plot.accumulators.length * 2;
+                    if( newLength > MAX_ACCUMULATOR_LENGTH )
+                        newLength = MIN_ACCUMULATOR_LENGTH;
+                    gtk_drop_down_set_selected( GTK_DROP_DOWN( pGlobal->widgets[ eW_drop_AccumulatorLength ] ),
+                                                g_bit_storage( newLength ) - 2 );
                     break;
                 case GDK_ALT_MASK:
                     break;
                 case GDK_SUPER_MASK:
                     break;
                 case 0:
+                    // Cycle the accumulated trace display F11 (through the drop down on the Plot page)
+                    gtk_drop_down_set_selected( GTK_DROP_DOWN( pGlobal->widgets[ eW_drop_Accumulated ] ),
+                                                (pGlobal->accumulatorDisplay + 1) % eMAX_ACCUM_DISPLAY );
                     break;
                 }
             break;
@@ -419,7 +851,8 @@ void CB_tgl_Spot (GtkToggleButton *wSpot, gpointer user_data) {
 
 /*!     \brief  Callback for Calibration button
  *
- * Calibration
+ * Calibration. If the HP8970 is already calibrated for the current settings
+ * we say so; a second press calibrates anyway.
  *
  * \param  wBtnCalibrate        pointer to GtkButton for Calibrate
  * \param  uData                user data (unused)
@@ -428,6 +861,20 @@ static void
 CB_btn_Calibrate( GtkButton* wBtnCalibrate, gpointer uData ) {
     tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnCalibrate), "data");
 
+    if( isCalibrationValid( pGlobal ) && !pGlobal->flags.bForceCalibration ) {
+        if( pGlobal->calibration.sDateTime ) {
+            gchar *sMessage = g_strdup_printf( "HP8970 calibration of %s is still valid .. Calibrate again to repeat",
+                                               pGlobal->calibration.sDateTime );
+            postInfo( sMessage );
+            g_free( sMessage );
+        } else {
+            postInfo( "HP8970 calibration is still valid .. Calibrate again to repeat" );
+        }
+        pGlobal->flags.bForceCalibration = TRUE;
+        return;
+    }
+    pGlobal->flags.bForceCalibration = FALSE;
+
     postDataToGPIBThread ( TG_CALIBRATE, NULL);
     quarantineControlsOnSweep( pGlobal, FALSE, FALSE );
 }
@@ -727,8 +1174,9 @@ void on_PlotMouseMotion ( GtkEventControllerMotion* eventGesture, gdouble x,  gd
         pGlobal->liveMarkerPosnRatio.x = x / gtk_widget_get_width( GTK_WIDGET( wDrawingArea ) );
         pGlobal->liveMarkerPosnRatio.y = y / gtk_widget_get_height( GTK_WIDGET( wDrawingArea ) );
 
+        // (drawn at the next frame however many events there are before it)
         if( pGlobal->plot.measurementBuffer.flags.bValidNoiseData || pGlobal->plot.measurementBuffer.flags.bValidGainData )
-            gtk_widget_queue_draw ( GTK_WIDGET( wDrawingArea ) );
+            requestPlotRefresh( pGlobal, PLOT_DIRTY_MARKER );
     }
 }
 
@@ -748,6 +1196,8 @@ on_PlotLeftMouse_1_press ( GtkGestureClick* eventGesture, gint n_press, gdouble
     GtkDrawingArea *wDrawingArea= GTK_DRAWING_AREA( gtk_event_controller_get_widget( GTK_EVENT_CONTROLLER( eventGesture ) ));
     tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(gtk_widget_get_root(GTK_WIDGET(wDrawingArea))), "data");
 
+    gboolean bWasPreview = pGlobal->flags.bPreviewModeDiagram;
+
     if ( pGlobal->flags.bPreviewModeDiagram )
         gtk_widget_grab_focus ( pGlobal->widgets[ eW_note_Controls ] );
     pGlobal->flags.bPreviewModeDiagram = FALSE;
@@ -755,8 +1205,9 @@ on_PlotLeftMouse_1_press ( GtkGestureClick* eventGesture, gint n_press, gdouble
     pGlobal->flags.bHoldLiveMarker = FALSE;
     pGlobal->liveMarkerPosnRatio.x = x / gtk_widget_get_width( GTK_WIDGET( wDrawingArea ) );
     pGlobal->liveMarkerPosnRatio.y = y / gtk_widget_get_height( GTK_WIDGET( wDrawingArea ) );
+    // (the plot itself only if it was showing the mode diagram)
     if( pGlobal->plot.measurementBuffer.flags.bValidNoiseData || pGlobal->plot.measurementBuffer.flags.bValidGainData )
-        gtk_widget_queue_draw ( GTK_WIDGET( wDrawingArea ) );
+        requestPlotRefresh( pGlobal, PLOT_DIRTY_MARKER | (bWasPreview ? PLOT_DIRTY_DATA : 0) );
 }
 
 /*!     \brief  Callback for mouse clicks in the plot area
@@ -803,17 +1254,8 @@ CB_PlotMouse_3_press_1_release ( GtkGestureClick* eventGesture, gint n_press, gd
 void
 CB_btn_Memory ( GtkButton *wBtnMemory, gpointer udata ) {
     tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnMemory), "data");
-    tCircularBuffer *pMemory = &pGlobal->plot.memoryBuffer;
-    tCircularBuffer *pMeasurement = &pGlobal->plot.measurementBuffer;
 
-    if( !pGlobal->plot.flags.bSpotFrequencyPlot &&
-            (pMeasurement->flags.bValidNoiseData || pMeasurement->flags.bValidGainData) ) {
-        g_free( pMemory->measurementData );
-        pMemory->measurementData = 0;
-        *pMemory = *pMeasurement;
-        pMemory->measurementData = g_memdup2( pMeasurement->measurementData, pMeasurement->size * sizeof(tNoiseAndGain) );
-        gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
-    }
+    storeMeasurementTrace( pGlobal );
 }
 
 
@@ -822,9 +1264,7 @@ void
 CB_rightClickGesture_ClearMemory (GtkGesture *gesture, int n_press, double x, double y, gpointer udata) {
     tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(gesture), "data");
     // Clear the memory Alt F9
-    g_free( pGlobal->plot.memoryBuffer.measurementData );
-    bzero( &pGlobal->plot.memoryBuffer, sizeof( tCircularBuffer ) );
-    gtk_widget_queue_draw ( GTK_WIDGET( pGlobal->widgets[ eW_drawing_Plot ] ) );
+    clearMemoryTraces( pGlobal );
 }
 
 /*!     \brief  Refresh the controls on the main page
@@ -908,6 +1348,8 @@ refreshMainDialog( tGlobal *pGlobal )
     gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
     gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_SaveJSON ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
 
+    setAccumulatorWidgets( pGlobal );
+
     enablePageExtLOwidgets( pGlobal, pGlobal->HP8970settings.mode );
     warnFrequencyRangeOutOfBounds( pGlobal );
 }
@@ -1098,6 +1540,8 @@ initializeMainDialog( tGlobal *pGlobal )
 
     // Define the drawing function for the GtkDrawingArea widget
     gtk_drawing_area_set_draw_func ( pGlobal->widgets[ eW_drawing_Plot ], CB_DrawingArea_Draw, pGlobal, NULL);
+    // .. and the live marker over it (so moving the marker does not draw the plot again)
+    gtk_drawing_area_set_draw_func ( pGlobal->widgets[ eW_drawing_LiveMarker ], CB_DrawingArea_LiveMarker_Draw, pGlobal, NULL);
 
 #if 0
     void appEnter (GtkEventControllerFocus *self, gpointer gpGlobal);
@@ -292,6 +292,180 @@ setFixedRangePlotWidgets( tGlobal *pGlobal ) {
     g_signal_handlers_unblock_by_func( G_OBJECT(  pGlobal->widgets[ eW_spin_GainMax ] ), CB_spin_NoiseMin, NULL );
 }
 
+/*!     \brief  Show or hide the heat map of a two dimensional sweep
+ *
+ * (F8 or the 'Heat Map' button)
+ *
+ * \param  pGlobal      pointer to global data
+ */
+void
+toggleHeatMap( tGlobal *pGlobal ) {
+    if( !pGlobal->plot.sweep2D.flags.bValid ) {
+        postInfo( "There is no two dimensional sweep" );
+        return;
+    }
+    pGlobal->flags.bShowHeatMap = !pGlobal->flags.bShowHeatMap;
+    gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+}
+
+/*!     \brief  Callback for the 'Heat Map' button
+ *
+ * \param  wBtnHeatMap   pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_HeatMap ( GtkButton* wBtnHeatMap, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnHeatMap), "data");
+
+    toggleHeatMap( pGlobal );
+}
+
+/*!     \brief  Callback for the memory trace 'Add Plot…' button
+ *
+ * \param  wBtnTraceAdd  pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_TraceAdd ( GtkButton* wBtnTraceAdd, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnTraceAdd), "data");
+
+    chooseTraceFile( pGlobal );
+}
+
+/*!     \brief  Callback for the memory trace 'Calibration' button
+ *
+ * \param  wBtnTraceCal  pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_TraceCalibration ( GtkButton* wBtnTraceCal, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnTraceCal), "data");
+
+    storeCalibrationTrace( pGlobal );
+}
+
+/*!     \brief  Callback for the memory trace 'Clear' button
+ *
+ * \param  wBtnTraceClear    pointer to GtkButton
+ * \param  udata             unused
+ */
+static void
+CB_btn_TraceClear ( GtkButton* wBtnTraceClear, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnTraceClear), "data");
+
+    clearMemoryTraces( pGlobal );
+}
+
+/*!     \brief  Callback for the buttons that change the selected memory trace
+ *
+ * \param  wBtnTrace     pointer to GtkButton
+ * \param  gpChange      the change (next, show / hide, style or color)
+ */
+static void
+CB_btn_TraceChange ( GtkButton* wBtnTrace, gpointer gpChange ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnTrace), "data");
+
+    changeSelectedTrace( pGlobal, GPOINTER_TO_INT( gpChange ) );
+}
+
+/*!     \brief  Reset the accumulated traces
+ *
+ * Clear the statistics gathered over the repeated sweeps (keeping the averaging length)
+ *
+ * \param  pGlobal      pointer to global data
+ */
+void
+resetAccumulatedTraces( tGlobal *pGlobal ) {
+    initTraceAccumulators( &pGlobal->plot.accumulators, pGlobal->plot.accumulators.nBins,
+                           pGlobal->plot.accumulators.length );
+    postInfo( "Accumulated traces reset" );
+    gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+}
+
+/*!     \brief  Callback for the accumulated trace drop down
+ *
+ * Show the average, running average, max/min hold or standard deviation of repeated sweeps
+ *
+ * \param  wDropAccumulated   pointer to GtkDropDown
+ * \param  udata              unused
+ */
+static void
+CB_drop_Accumulated ( GtkDropDown* wDropAccumulated, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wDropAccumulated), "data");
+    guint ID = gtk_drop_down_get_selected ( wDropAccumulated );
+    gchar *sMessage;
+
+    if( ID == GTK_INVALID_LIST_POSITION || ID >= eMAX_ACCUM_DISPLAY )
+        return;
+
+    pGlobal->accumulatorDisplay = ID;
+    sMessage = g_strdup_printf( "Accumulated trace: %s (N = %d, %d sweeps)",
+                                sAccumulatorDisplay[ pGlobal->accumulatorDisplay ],
+                                pGlobal->plot.accumulators.length, pGlobal->plot.accumulators.nSweeps );
+    postInfo( sMessage );
+    g_free( sMessage );
+    gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+}
+
+/*!     \brief  Callback for the averaging length drop down
+ *
+ * Change the averaging length N (2, 4 .. 64 sweeps) and reset the accumulators
+ *
+ * \param  wDropLength    pointer to GtkDropDown
+ * \param  udata          unused
+ */
+static void
+CB_drop_AccumulatorLength ( GtkDropDown* wDropLength, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wDropLength), "data");
+    guint ID = gtk_drop_down_get_selected ( wDropLength );
+    guint length;
+    gchar *sMessage;
+
+    if( ID == GTK_INVALID_LIST_POSITION )
+        return;
+
+    length = MIN( MIN_ACCUMULATOR_LENGTH << ID, MAX_ACCUMULATOR_LENGTH );
+    initTraceAccumulators( &pGlobal->plot.accumulators, pGlobal->plot.accumulators.nBins, length );
+    sMessage = g_strdup_printf( "Accumulated traces reset: averaging over %d sweeps", length );
+    postInfo( sMessage );
+    g_free( sMessage );
+    gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+}
+
+/*!     \brief  Callback for the accumulated traces reset button
+ *
+ * \param  wBtnReset     pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_AccumulatorReset ( GtkButton* wBtnReset, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnReset), "data");
+
+    resetAccumulatedTraces( pGlobal );
+}
+
+/*!     \brief  Show the accumulated trace display and averaging length on the Plot page
+ *
+ * The length restored from a plot may not be a power of two; the nearest one below is shown
+ *
+ * \param  pGlobal      pointer to global data
+ */
+void
+setAccumulatorWidgets( tGlobal *pGlobal ) {
+    GtkDropDown *wDropAccumulated = GTK_DROP_DOWN( pGlobal->widgets[ eW_drop_Accumulated ] );
+    GtkDropDown *wDropLength = GTK_DROP_DOWN( pGlobal->widgets[ eW_drop_AccumulatorLength ] );
+
+    g_signal_handlers_block_by_func( G_OBJECT( wDropAccumulated ), CB_drop_Accumulated, NULL );
+    g_signal_handlers_block_by_func( G_OBJECT( wDropLength ), CB_drop_AccumulatorLength, NULL );
+
+    gtk_drop_down_set_selected( wDropAccumulated, pGlobal->accumulatorDisplay );
+    // N = 2 is the first entry
+    gtk_drop_down_set_selected( wDropLength, g_bit_storage( pGlobal->plot.accumulators.length ) - 2 );
+
+    g_signal_handlers_unblock_by_func( G_OBJECT( wDropAccumulated ), CB_drop_Accumulated, NULL );
+    g_signal_handlers_unblock_by_func( G_OBJECT( wDropLength ), CB_drop_AccumulatorLength, NULL );
+}
+
 /*!     \brief  Initialize the widgets on the Plot page
  *
  * Initialize the widgets on the External Plot page
@@ -338,5 +512,22 @@ initializePagePlot( tGlobal *pGlobal ) {
     g_signal_connect ( pGlobal->widgets[ eW_btn_ColorReset ], "clicked", G_CALLBACK (CB_ColorReset), NULL );
 
     g_signal_connect ( wChkAuto, "toggled", G_CALLBACK (CB_chk_AutoScale), NULL );
+    g_signal_connect ( pGlobal->widgets[ eW_btn_HeatMap ], "clicked", G_CALLBACK (CB_btn_HeatMap), NULL );
+
+    // Accumulated traces (the selection is set before the callbacks are connected)
+    setAccumulatorWidgets( pGlobal );
+    g_signal_connect( pGlobal->widgets[ eW_drop_Accumulated ], "notify::selected", G_CALLBACK( CB_drop_Accumulated ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_drop_AccumulatorLength ], "notify::selected",
+                      G_CALLBACK( CB_drop_AccumulatorLength ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_btn_AccumulatorReset ], "clicked", G_CALLBACK( CB_btn_AccumulatorReset ), NULL);
+
+    // Memory traces
+    g_signal_connect( pGlobal->widgets[ eW_btn_TraceAdd ], "clicked", G_CALLBACK( CB_btn_TraceAdd ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_btn_TraceCalibration ], "clicked", G_CALLBACK( CB_btn_TraceCalibration ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_btn_TraceClear ], "clicked", G_CALLBACK( CB_btn_TraceClear ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_btn_TraceNext ], "clicked", G_CALLBACK( CB_btn_TraceChange ), GINT_TO_POINTER( eTraceNext ));
+    g_signal_connect( pGlobal->widgets[ eW_btn_TraceVisible ], "clicked", G_CALLBACK( CB_btn_TraceChange ), GINT_TO_POINTER( eTraceVisible ));
+    g_signal_connect( pGlobal->widgets[ eW_btn_TraceStyle ], "clicked", G_CALLBACK( CB_btn_TraceChange ), GINT_TO_POINTER( eTraceStyle ));
+    g_signal_connect( pGlobal->widgets[ eW_btn_TraceColor ], "clicked", G_CALLBACK( CB_btn_TraceChange ), GINT_TO_POINTER( eTraceColor ));
 
 }
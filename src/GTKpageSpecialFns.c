@@ -44,6 +44,14 @@ CB_drop_NoiseUnits( GtkDropDown * wNoiseUnits, gpointer udata ) {
 
     pGlobal->HP8970settings.noiseUnits = gtk_drop_down_get_selected( wNoiseUnits );
     UPDATE_8970_SETTING( pGlobal, pGlobal->HP8970settings.updateFlags.each.bNoiseUnits);
+
+    // the noise is held linear, so the plot can be shown in the new units straight away
+    // (but a Y factor cannot be shown as a noise figure or the reverse)
+    if( NOISE_UNITS_COMPATIBLE( pGlobal->HP8970settings.noiseUnits, pGlobal->plot.noiseUnits ) ) {
+        pGlobal->plot.noiseUnits = pGlobal->HP8970settings.noiseUnits;
+        setFixedRangePlotWidgets( pGlobal );
+        gtk_widget_queue_draw( pGlobal->widgets[ eW_drawing_Plot ] );
+    }
 }
 
 
@@ -191,6 +199,118 @@ void CB_chk_LossCompensationEnable ( GtkCheckButton *wChkEnableLossCompensation,
     UPDATE_8970_SETTING( pGlobal, pGlobal->HP8970settings.updateFlags.each.bLossCompenstaion );
 }
 
+/*!     \brief  Callback for the 'Resume Sweep' button
+ *
+ * Resume an interrupted sweep from the next frequency (as F5)
+ *
+ * \param  wBtnResume    pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_ResumeSweep ( GtkButton* wBtnResume, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnResume), "data");
+
+    resumeInterruptedSweep( pGlobal );
+}
+
+/*!     \brief  Callback for the 'Sequence…' button
+ *
+ * Choose and run a measurement sequence file (as F6)
+ *
+ * \param  wBtnSequence  pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_Sequence ( GtkButton* wBtnSequence, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnSequence), "data");
+
+    chooseSequenceFile( pGlobal );
+}
+
+/*!     \brief  Show the multi-spot list on the Special Fns. page
+ *
+ * \param  pGlobal      pointer to global data
+ */
+void
+refreshMultiSpotLabel( tGlobal *pGlobal ) {
+    GString *pstLabel = g_string_new( "Multi-spot:" );
+    gint nMultiSpot;
+
+    g_mutex_lock( &pGlobal->mUpdate );
+    nMultiSpot = pGlobal->HP8970settings.nMultiSpot;
+    for( gint i = 0; i < nMultiSpot; i++ )
+        g_string_append_printf( pstLabel, " %.0lf", pGlobal->HP8970settings.multiSpotMHz[ i ] );
+    g_mutex_unlock( &pGlobal->mUpdate );
+    g_string_append( pstLabel, nMultiSpot > 0 ? " MHz" : " none" );
+
+    gtk_label_set_text( GTK_LABEL( pGlobal->widgets[ eW_lbl_MultiSpot ] ), pstLabel->str );
+    g_string_free( pstLabel, TRUE );
+}
+
+/*!     \brief  Add the spot frequency to the multi-spot list
+ *
+ * (F7 or the 'Add Spot' button). Two or more frequencies are measured in turn.
+ *
+ * \param  pGlobal      pointer to global data
+ */
+void
+addSpotToMultiSpot( tGlobal *pGlobal ) {
+    gboolean bAdded;
+
+    // the GPIB thread reads the list when a spot measurement starts
+    g_mutex_lock( &pGlobal->mUpdate );
+    tMode mode = pGlobal->HP8970settings.mode;
+    gboolean bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
+    bAdded = addMultiSpotFrequency( &pGlobal->HP8970settings, pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz );
+    g_mutex_unlock( &pGlobal->mUpdate );
+
+    if( !bAdded ) {
+        postError( "The multi-spot list is full" );
+        return;
+    }
+    refreshMultiSpotLabel( pGlobal );
+    postInfo( (gchar *)gtk_label_get_text( GTK_LABEL( pGlobal->widgets[ eW_lbl_MultiSpot ] ) ) );
+}
+
+/*!     \brief  Clear the multi-spot list
+ *
+ * (Shift F7 or the 'Clear' button)
+ *
+ * \param  pGlobal      pointer to global data
+ */
+void
+clearMultiSpot( tGlobal *pGlobal ) {
+    g_mutex_lock( &pGlobal->mUpdate );
+    pGlobal->HP8970settings.nMultiSpot = 0;
+    g_mutex_unlock( &pGlobal->mUpdate );
+
+    refreshMultiSpotLabel( pGlobal );
+    postInfo( "Multi-spot frequencies cleared" );
+}
+
+/*!     \brief  Callback for the multi-spot 'Add Spot' button
+ *
+ * \param  wBtnAdd       pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_MultiSpotAdd ( GtkButton* wBtnAdd, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnAdd), "data");
+
+    addSpotToMultiSpot( pGlobal );
+}
+
+/*!     \brief  Callback for the multi-spot 'Clear' button
+ *
+ * \param  wBtnClear     pointer to GtkButton
+ * \param  udata         unused
+ */
+static void
+CB_btn_MultiSpotClear ( GtkButton* wBtnClear, gpointer udata ) {
+    tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnClear), "data");
+
+    clearMultiSpot( pGlobal );
+}
 
 /*!     \brief  Refresh widgets on the HP8970 page
  *
@@ -226,6 +346,7 @@ refreshPageHP8970( tGlobal *pGlobal ) {
     gtk_widget_set_visible( pGlobal->widgets[ eW_frm_IF_Attenuation ], pGlobal->flags.bShowAdditionalSP );
     gtk_widget_set_visible( pGlobal->widgets[ eW_frm_RF_Attenuation ], pGlobal->flags.bShowAdditionalSP );
 
+    refreshMultiSpotLabel( pGlobal );
 }
 
 /*!     \brief  Initialize the widgets on the HP8970 page
@@ -249,4 +370,9 @@ initializePageHP8970( tGlobal *pGlobal ) {
 
     g_signal_connect_after( pGlobal->widgets[ eW_drop_RF_Attenuation ], "notify::selected", G_CALLBACK( CB_drop_RFattenuation ), NULL);
     g_signal_connect_after( pGlobal->widgets[ eW_drop_IF_Attenuation ], "notify::selected", G_CALLBACK( CB_drop_IFattenuation ), NULL);
+
+    g_signal_connect( pGlobal->widgets[ eW_btn_ResumeSweep ], "clicked", G_CALLBACK( CB_btn_ResumeSweep ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_btn_Sequence ], "clicked", G_CALLBACK( CB_btn_Sequence ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_btn_MultiSpotAdd ], "clicked", G_CALLBACK( CB_btn_MultiSpotAdd ), NULL);
+    g_signal_connect( pGlobal->widgets[ eW_btn_MultiSpotClear ], "clicked", G_CALLBACK( CB_btn_MultiSpotClear ), NULL);
 }
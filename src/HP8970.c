@@ -42,26 +42,51 @@
 tGlobal globalData = { 0 };
 
 static gint optDebug = 0;
-static gboolean bOptQuiet = 0;
+static gboolean bOptQuiet = 0;          // no GUI sounds .. or, headless, only errors are reported
 static gint bOptDoNotEnableSystemController = 0;
 static gint optDeviceID = INVALID;
 static gint optControllerIndex = INVALID;
 static gboolean bOptNoGPIBtimeout = 0;
 static gchar **argsRemainder = NULL;
 
+static gboolean bOptHeadless = 0;
+static gchar *sOptConfiguration = NULL;
+static gchar *sOptSettingsFile = NULL;
+static gchar *sOptSequenceFile = NULL;
+static gboolean bOptCalibrate = 0;
+static gint optSweeps = 1;
+static gint optSpotSeconds = 0;
+static gchar *sOptFrequencies = NULL;
+static gchar **sOptOutputs = NULL;
+
 static const GOptionEntry optionEntries[] =
     {
         { "debug", 'b', 0, G_OPTION_ARG_INT, &optDebug, "Print diagnostic messages in journal (0-7)", NULL },
-        { "quiet", 'q', 0, G_OPTION_ARG_NONE, &bOptQuiet, "No GUI sounds", NULL },
+        { "quiet", 'q', 0, G_OPTION_ARG_NONE, &bOptQuiet, "No GUI sounds (with --headless, only report errors)", NULL },
         { "GPIBnoSystemController", 'n', 0, G_OPTION_ARG_NONE, &bOptDoNotEnableSystemController,
                 "Do not enable GPIB interface as a system controller", NULL },
         { "GPIBdeviceID", 'd', 0, G_OPTION_ARG_INT, &optDeviceID, "GPIB device ID for HPGL plotter", NULL },
         { "GPIBcontrollerIndex", 'c', 0, G_OPTION_ARG_INT, &optControllerIndex, "GPIB controller board index", NULL },
         { "noGPIBtimeout", 't', 0, G_OPTION_ARG_NONE, &bOptNoGPIBtimeout, "no GPIB timeout (for debug with HP59401A)", NULL },
+        { "headless", 'H', 0, G_OPTION_ARG_NONE, &bOptHeadless, "Measure without the GUI (--headless --help for options)", NULL },
 
         { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_STRING_ARRAY, &argsRemainder, "", NULL },
         { NULL } };
 
+static const GOptionEntry headlessOptionEntries[] =
+    {
+        { "configuration", 'C', 0, G_OPTION_ARG_STRING, &sOptConfiguration, "Use saved configuration", "NAME" },
+        { "settings", 'S', 0, G_OPTION_ARG_FILENAME, &sOptSettingsFile, "Use the settings from a saved JSON plot", "FILE" },
+        { "sequence", 's', 0, G_OPTION_ARG_FILENAME, &sOptSequenceFile, "Run a sequence file (other measurement options are ignored)", "FILE" },
+        { "calibrate", 0, 0, G_OPTION_ARG_NONE, &bOptCalibrate, "Calibrate before measuring", NULL },
+        { "sweep", 'w', 0, G_OPTION_ARG_INT, &optSweeps, "Number of sweeps (default 1)", "N" },
+        { "spot", 'p', 0, G_OPTION_ARG_INT, &optSpotSeconds, "Spot frequency measurement for T seconds", "T" },
+        { "frequencies", 'f', 0, G_OPTION_ARG_STRING, &sOptFrequencies,
+                "Spot frequencies (MHz) measured in turn (e.g. 100,435,1296)", "LIST" },
+        { "output", 'o', 0, G_OPTION_ARG_FILENAME_ARRAY, &sOptOutputs,
+                "Save to file (type from .json .csv .pdf .svg .png) or '-' for CSV to stdout (may be repeated)", "FILE" },
+        { NULL } };
+
 
 gboolean
 shrinkWrap (gpointer gpGlobal) {
@@ -179,8 +204,15 @@ initializeData (tGlobal *pGlobal) {
     pGlobal->plot.measurementBuffer.minGain  =  0.0;
     pGlobal->plot.measurementBuffer.maxGain  = 10.0;
 
-    pGlobal->plot.measurementBuffer.measurementData = NULL;
-    pGlobal->plot.memoryBuffer.measurementData = NULL;
+    pGlobal->plot.measurementBuffer.abscissa = NULL;
+    pGlobal->plot.measurementBuffer.noise = NULL;
+    pGlobal->plot.measurementBuffer.gain = NULL;
+    pGlobal->plot.measurementBuffer.itemFlags = NULL;
+    pGlobal->plot.traceLibrary.nTraces = 0;
+    pGlobal->plot.accumulators.bins = NULL;
+    pGlobal->plot.accumulators.historyStore = NULL;
+    pGlobal->plot.accumulators.length = DEFAULT_ACCUMULATOR_LENGTH;
+    pGlobal->accumulatorDisplay = eAccumNone;
 
     pGlobal->HP8970settings.switches.bAutoScaling = TRUE;
     pGlobal->plot.noiseUnits = eFdB;
@@ -330,25 +362,14 @@ on_activate (GApplication *app, gpointer udata) {
 }
 
 
-/*!     \brief  on_startup (startup signal callback)
- *
- * Setup application (get configuration and create main window (but do not show it))
- * nb: this occurs before 'activate'
+/*!     \brief  Initialization common to the GUI and headless operation
  *
- * \ingroup initialize
+ * Recover settings & configurations, create the message queues and initialize mutexes
  *
- * \param  app      : pointer to this GApplication
- * \param  udata    : unused
+ * \param  pGlobal      : pointer to data structure
  */
 static void
-on_startup (GApplication *app, gpointer udata) {
-    tGlobal *pGlobal = (tGlobal*) udata;
-    gboolean bAbort = FALSE;
-
-    LOG(G_LOG_LEVEL_INFO, "Starting");
-    setenv ("IB_NO_ERROR", "1", 0);	// no noise
-    logVersion ();
-
+initializeCommon (tGlobal *pGlobal) {
     initializeData ( pGlobal );
     recoverSettings( pGlobal );
     recoverConfigurations( pGlobal );
@@ -356,14 +377,7 @@ on_startup (GApplication *app, gpointer udata) {
     pGlobal->flags.bNoGPIBtimeout = bOptNoGPIBtimeout;
     pGlobal->flags.bbDebug = optDebug;
 
-    /*! We use a loop source to send data back from the
-     *  GPIB threads to indicate status
-     */
-
-    pGlobal->messageQueueToMain = g_async_queue_new();
-    pGlobal->messageEventSource = g_source_new( &messageEventFunctions, sizeof(GSource) );
     pGlobal->messageQueueToGPIB = g_async_queue_new();
-    g_source_attach( globalData.messageEventSource, NULL );
 
     if (optControllerIndex != INVALID) {
         pGlobal->GPIBcontrollerIndex = optControllerIndex;
@@ -376,8 +390,72 @@ on_startup (GApplication *app, gpointer udata) {
     // Initialize the settings update mutex
     g_mutex_init( &pGlobal->mUpdate );
 
+    g_mutex_init( &pGlobal->plot.mPlotUpdate );
     g_mutex_init( &pGlobal->plot.measurementBuffer.mBuffer );
-    g_mutex_init( &pGlobal->plot.memoryBuffer.mBuffer );
+    g_mutex_init( &pGlobal->plot.spotLog.mLog );
+    g_mutex_init( &pGlobal->plot.traceLibrary.mTraces );
+    g_mutex_init( &pGlobal->plot.accumulators.mAccumulators );
+    g_mutex_init( &pGlobal->plot.sweep2D.mSweep2D );
+}
+
+/*!     \brief  Cleanup common to the GUI and headless operation
+ *
+ * Release the message queues, mutexes and buffers (the GPIB thread must have ended)
+ *
+ * \param  pGlobal      : pointer to data structure
+ */
+static void
+cleanupCommon (tGlobal *pGlobal) {
+    g_async_queue_unref (pGlobal->messageQueueToGPIB);
+
+    g_mutex_clear( &pGlobal->mUpdate );
+    g_mutex_clear( &pGlobal->plot.measurementBuffer.mBuffer );
+    g_mutex_clear( &pGlobal->plot.spotLog.mLog );
+    g_mutex_clear( &pGlobal->plot.traceLibrary.mTraces );
+    g_mutex_clear( &pGlobal->plot.accumulators.mAccumulators );
+    g_mutex_clear( &pGlobal->plot.sweep2D.mSweep2D );
+
+    g_list_free_full ( pGlobal->configurationList, freeConfigurationItemContent );
+
+    freeCircularBuffer( &pGlobal->plot.measurementBuffer );
+    freeMeasurementLog( &pGlobal->plot.spotLog );
+    freeTraceLibrary( &pGlobal->plot.traceLibrary );
+    g_free( pGlobal->plot.accumulators.bins );
+    g_free( pGlobal->plot.accumulators.historyStore );
+    g_free( pGlobal->calibration.data );
+    g_free( pGlobal->calibration.sDateTime );
+    freeSweep2D( &pGlobal->plot.sweep2D );
+    freeMarkerIndex( &pGlobal->plot.markerIndex );
+
+    freeSVGhandles();
+}
+
+/*!     \brief  on_startup (startup signal callback)
+ *
+ * Setup application (get configuration and create main window (but do not show it))
+ * nb: this occurs before 'activate'
+ *
+ * \ingroup initialize
+ *
+ * \param  app      : pointer to this GApplication
+ * \param  udata    : unused
+ */
+static void
+on_startup (GApplication *app, gpointer udata) {
+    tGlobal *pGlobal = (tGlobal*) udata;
+    gboolean bAbort = FALSE;
+
+    LOG(G_LOG_LEVEL_INFO, "Starting");
+    setenv ("IB_NO_ERROR", "1", 0);	// no noise
+    logVersion ();
+
+    initializeCommon( pGlobal );
+
+    /*! We use a loop source to send data back from the
+     *  GPIB threads to indicate status
+     */
+    pGlobal->messageEventSource = g_source_new( &messageEventFunctions, sizeof(GSource) );
+    g_source_attach( globalData.messageEventSource, NULL );
 
 //    pGlobal->flags.bValidGainData = FALSE;
 //    pGlobal->flags.bValidNoiseData = TRUE;
@@ -410,25 +488,96 @@ on_shutdown (GApplication *app, gpointer userData) {
         g_thread_join (pGlobal->pGThread);
         g_thread_unref (pGlobal->pGThread);
     }
+    // finish writing any files still being saved
+    waitForSnapshotWriter();
 
-    // Destroy queue and source
-    g_async_queue_unref (pGlobal->messageQueueToMain);
-    g_async_queue_unref (pGlobal->messageQueueToGPIB);
+    // Destroy source, queues etc.
     g_source_destroy (pGlobal->messageEventSource);
     g_source_unref (pGlobal->messageEventSource);
 
-    g_mutex_clear( &pGlobal->mUpdate );
-    g_mutex_clear( &pGlobal->plot.measurementBuffer.mBuffer );
-    g_mutex_clear( &pGlobal->plot.memoryBuffer.mBuffer );
+    cleanupCommon( pGlobal );
 
-    g_list_free_full ( pGlobal->configurationList, freeConfigurationItemContent );
+    LOG(G_LOG_LEVEL_INFO, "Ending");
+}
+
+/*!     \brief  Measure without the GUI
+ *
+ * Parse the command line (including the headless options), establish the settings
+ * and run the measurement sequence. Settings & configurations are not saved on exit.
+ *
+ * \param argc	number of arguments
+ * \param argv	pointer to array of arguments
+ * \return		EXIT_SUCCESS or EXIT_FAILURE
+ */
+static gint
+mainHeadless (int argc, char *argv[]) {
+    tGlobal *pGlobal = &globalData;
+    GOptionContext *context;
+    GError *err = NULL;
+    GList *sequence = NULL;
+    gboolean bStream = FALSE;
+    gint status = EXIT_FAILURE;
+
+    context = g_option_context_new ("- HP8970 noise figure measurement without the GUI");
+    g_option_context_add_main_entries (context, optionEntries, NULL);
+    g_option_context_add_main_entries (context, headlessOptionEntries, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &err)) {
+        g_printerr ("%s\n", err->message);
+        g_clear_error (&err);
+        g_option_context_free (context);
+        return EXIT_FAILURE;
+    }
+    g_option_context_free (context);
 
-    g_free( pGlobal->plot.measurementBuffer.measurementData );
-    g_free( pGlobal->plot.memoryBuffer.measurementData );
+    LOG(G_LOG_LEVEL_INFO, "Starting (headless)");
+    logVersion ();
 
-    freeSVGhandles();
+    initializeCommon( pGlobal );
+    pGlobal->flags.bHeadless = TRUE;
+    // relative output file names are relative to the working directory
+    g_free( pGlobal->sLastDirectory );
+    pGlobal->sLastDirectory = g_get_current_dir();
+
+    do {
+        if( sOptSettingsFile ) {
+            if( retrievePlot( sOptSettingsFile, pGlobal ) != OK ) {
+                g_printerr ("Cannot read settings from %s\n", sOptSettingsFile);
+                break;
+            }
+            restoreSettingsFromPlot( pGlobal );
+        }
 
-    LOG(G_LOG_LEVEL_INFO, "Ending");
+        if( sOptSequenceFile ) {
+            if( (sequence = readSequenceFile( sOptSequenceFile )) == NULL ) {
+                messageEventData *message;
+                // show the errors the parser posted for the status bar
+                while( (message = getMessageForMainLoop( 0 )) != NULL ) {
+                    if( message->command == TM_ERROR )
+                        g_printerr ("%s\n", message->sMessage);
+                    g_free( message->data );
+                    releaseMessage( message );
+                }
+                break;
+            }
+        } else {
+            if( sOptConfiguration
+                    && g_list_find_custom( pGlobal->configurationList, sOptConfiguration, compareFindConfiguration ) == NULL ) {
+                g_printerr ("No saved configuration named \"%s\"\n", sOptConfiguration);
+                break;
+            }
+            if( (sequence = headlessSequence( sOptConfiguration, bOptCalibrate, optSweeps, optSpotSeconds,
+                                              sOptFrequencies, sOptOutputs, &bStream )) == NULL )
+                break;
+        }
+        pGlobal->flags.bStreamMeasurements = bStream;
+
+        status = runHeadless( pGlobal, sequence, bOptQuiet );
+    } while FALSE;
+
+    cleanupCommon( pGlobal );
+
+    LOG(G_LOG_LEVEL_INFO, "Ending (headless)");
+    return status;
 }
 
 /*!     \brief  Start of program
@@ -452,6 +601,11 @@ main (int argc, char *argv[]) {
     // When debugging always cause warnings to crash program
     g_log_set_always_fatal(G_LOG_LEVEL_CRITICAL|G_LOG_LEVEL_WARNING);
 #endif
+    // Headless operation does not start GTK (so no display is needed)
+    for( gint i = 1; i < argc; i++ )
+        if( g_strcmp0( argv[ i ], "--headless" ) == 0 || g_strcmp0( argv[ i ], "-H" ) == 0 )
+            return mainHeadless( argc, argv );
+
     // ensure only one instance of program runs ..
     app = gtk_application_new ("us.heterodyne.hp8970", G_APPLICATION_HANDLES_OPEN);
     g_application_add_main_option_entries (G_APPLICATION(app), optionEntries);
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+gchar *sAccumulatorDisplay[ eMAX_ACCUM_DISPLAY ] = { "off", "average", "running average", "max/min hold", "standard deviation" };
+
+/*!     \brief  Initialize (or reset) the per-frequency accumulators
+ *
+ * Allocate one bin per sweep point and clear all statistics.
+ * The accumulators are updated as each point of a sweep arrives
+ * so that the averaged traces are available throughout an auto-sweep.
+ *
+ * \param  pAccum       pointer to the accumulators
+ * \param  nBins        number of points in the sweep
+ * \param  length       averaging length (N) for the exponential & running averages
+ */
+void
+initTraceAccumulators( tTraceAccumulators *pAccum, guint nBins, guint length ) {
+    g_mutex_lock( &pAccum->mAccumulators );
+
+    if( length < MIN_ACCUMULATOR_LENGTH || length > MAX_ACCUMULATOR_LENGTH )
+        length = DEFAULT_ACCUMULATOR_LENGTH;
+
+    pAccum->bins = g_realloc( pAccum->bins, nBins * sizeof( tAccumulatorBin ) );
+    // each bin has a history of N noise values and N gain values
+    pAccum->historyStore = g_realloc( pAccum->historyStore, nBins * length * 2 * sizeof( gdouble ) );
+    pAccum->nBins = nBins;
+    pAccum->length = length;
+    pAccum->nSweeps = 0;
+
+    for( gint i = 0; i < nBins; i++ ) {
+        tAccumulatorBin *pBin = &pAccum->bins[ i ];
+        memset( pBin, 0, sizeof( tAccumulatorBin ) );
+        pBin->noise.history = &pAccum->historyStore[ (i * 2) * length ];
+        pBin->gain.history  = &pAccum->historyStore[ (i * 2 + 1) * length ];
+    }
+    pAccum->flags.bValid = FALSE;
+
+    g_mutex_unlock( &pAccum->mAccumulators );
+}
+
+/*!     \brief  Add one value to the statistics of a quantity
+ *
+ * The exponential average uses a weight of 1/n until N values have been seen
+ * (so it starts as the cumulative mean) and 1/N thereafter.
+ * The running average keeps the last N values in a small ring.
+ * The standard deviation uses Welford's algorithm over all values.
+ *
+ * \param  pStats       pointer to the statistics for noise or gain at one frequency
+ * \param  value        the new value
+ * \param  length       averaging length (N)
+ */
+static void
+accumulateValue( tAccumulator *pStats, gdouble value, guint length ) {
+    guint slot = pStats->n % length;
+    gdouble delta;
+
+    if( pStats->n == 0 ) {
+        pStats->exponential = value;
+        pStats->max = value;
+        pStats->min = value;
+    } else {
+        pStats->exponential += (value - pStats->exponential) / (gdouble)MIN( pStats->n + 1, length );
+        pStats->max = MAX( pStats->max, value );
+        pStats->min = MIN( pStats->min, value );
+    }
+
+    // drop the oldest value from the running sum once the window is full
+    if( pStats->n >= length )
+        pStats->windowSum -= pStats->history[ slot ];
+    pStats->history[ slot ] = value;
+    pStats->windowSum += value;
+
+    pStats->n++;
+    delta = value - pStats->mean;
+    pStats->mean += delta / (gdouble)pStats->n;
+    pStats->sumSqDiff += delta * (value - pStats->mean);
+}
+
+/*!     \brief  Accumulate a measurement into the bin for its frequency
+ *
+ * Called as each point of a sweep arrives. Invalid noise or gain values
+ * are not accumulated (the other quantity may still be valid).
+ *
+ * \param  pAccum       pointer to the accumulators
+ * \param  bin          index of the point in the sweep
+ * \param  pMeasurement pointer to the measured noise & gain
+ */
+void
+accumulateMeasurement( tTraceAccumulators *pAccum, guint bin, tNoiseAndGain *pMeasurement ) {
+    g_mutex_lock( &pAccum->mAccumulators );
+
+    if( bin < pAccum->nBins ) {
+        tAccumulatorBin *pBin = &pAccum->bins[ bin ];
+
+        // the start of a new sweep
+        if( bin == 0 )
+            pAccum->nSweeps++;
+
+        pBin->freq = pMeasurement->abscissa.freq;
+        if( !pMeasurement->flags.each.bNoiseInvalid )
+            accumulateValue( &pBin->noise, pMeasurement->noise, pAccum->length );
+        if( !pMeasurement->flags.each.bGainInvalid )
+            accumulateValue( &pBin->gain, pMeasurement->gain, pAccum->length );
+
+        pAccum->flags.bValid = TRUE;
+    }
+
+    g_mutex_unlock( &pAccum->mAccumulators );
+}
+
+/*!     \brief  Standard deviation of the accumulated values
+ *
+ * \param  pStats       pointer to the statistics for noise or gain at one frequency
+ * \return sample standard deviation (0.0 if fewer than two values)
+ */
+gdouble
+accumulatorStdDeviation( tAccumulator *pStats ) {
+    if( pStats->n < 2 )
+        return 0.0;
+    else
+        return sqrt( pStats->sumSqDiff / (gdouble)(pStats->n - 1) );
+}
+
+/*!     \brief  Get the value(s) to display for a bin
+ *
+ * Averages return a single value (upper == lower).
+ * Max/min hold returns the envelope and standard deviation returns mean ± σ.
+ * The caller should hold the mAccumulators mutex.
+ *
+ * \param  pAccum       pointer to the accumulators
+ * \param  bin          index of the point in the sweep
+ * \param  display      which accumulated statistic is wanted
+ * \param  axis         eNoise or eGain
+ * \param  pUpper       pointer to the upper (or only) value
+ * \param  pLower       pointer to the lower value
+ * \return TRUE if the bin has data
+ */
+gboolean
+accumulatedValue( tTraceAccumulators *pAccum, guint bin, tAccumulatorDisplay display,
+                  tGridAxes axis, gdouble *pUpper, gdouble *pLower ) {
+    tAccumulator *pStats;
+    gdouble sigma;
+
+    if( bin >= pAccum->nBins )
+        return FALSE;
+
+    pStats = (axis == eGain) ? &pAccum->bins[ bin ].gain : &pAccum->bins[ bin ].noise;
+    if( pStats->n == 0 )
+        return FALSE;
+
+    switch( display ) {
+    case eAccumExponential:
+        *pUpper = *pLower = pStats->exponential;
+        break;
+    case eAccumRunning:
+        *pUpper = *pLower = pStats->windowSum / (gdouble)MIN( pStats->n, pAccum->length );
+        break;
+    case eAccumMaxMinHold:
+        *pUpper = pStats->max;
+        *pLower = pStats->min;
+        break;
+    case eAccumStdDeviation:
+        sigma = accumulatorStdDeviation( pStats );
+        *pUpper = pStats->mean + sigma;
+        *pLower = pStats->mean - sigma;
+        break;
+    case eAccumNone:
+    default:
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*!     \brief  Find the extremes of the displayed accumulated trace
+ *
+ * Used when autoscaling so that the accumulated trace fits on the grid.
+ *
+ * \param  pAccum       pointer to the accumulators
+ * \param  display      which accumulated statistic is shown
+ * \param  axis         eNoise or eGain
+ * \param  pMin         pointer to the minimum (updated)
+ * \param  pMax         pointer to the maximum (updated)
+ * \return TRUE if there is any data
+ */
+gboolean
+accumulatorExtremes( tTraceAccumulators *pAccum, tAccumulatorDisplay display,
+                     tGridAxes axis, gdouble *pMin, gdouble *pMax ) {
+    gboolean bData = FALSE;
+    gdouble upper, lower;
+
+    if( display == eAccumNone || !pAccum->flags.bValid )
+        return FALSE;
+
+    g_mutex_lock( &pAccum->mAccumulators );
+    for( gint i = 0; i < pAccum->nBins; i++ ) {
+        if( accumulatedValue( pAccum, i, display, axis, &upper, &lower ) ) {
+            updateBoundaries( upper, pMin, pMax );
+            updateBoundaries( lower, pMin, pMax );
+            bData = TRUE;
+        }
+    }
+    g_mutex_unlock( &pAccum->mAccumulators );
+
+    return bData;
+}
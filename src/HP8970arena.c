@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Acquisition arena
+ *
+ * The strings made for each point of a sweep, spot or calibration measurement (the commands to the
+ * HP8970 and LO) are taken from an arena that lives for the measurement and is emptied at each point,
+ * so once the measurement has started the acquisition path does not use the heap. Messages to the main loop come from a
+ * fixed pool and the progress of each point is posted as an event (see messageEvent.c).
+ *
+ * The counters record what was taken from the arena and the pool and how often either had to
+ * fall back to the heap (a string too long for the arena or the pool exhausted).
+ */
+
+#include <stdarg.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+tAllocationCounters allocationCounters;
+
+/*!     \brief  Make the arena for a measurement
+ *
+ * \param  pArena       pointer to the arena
+ * \param  size         bytes in the arena
+ */
+void
+initArena( tArena *pArena, gsize size ) {
+    pArena->pBase = g_malloc( size );
+    pArena->size = size;
+    pArena->used = 0;
+    pArena->pOverflow = NULL;
+}
+
+/*!     \brief  Empty the arena (at each point)
+ *
+ * The strings taken from the arena since it was last emptied are no longer valid.
+ *
+ * \param  pArena       pointer to the arena
+ */
+void
+resetArena( tArena *pArena ) {
+    pArena->used = 0;
+    g_slist_free_full( pArena->pOverflow, g_free );
+    pArena->pOverflow = NULL;
+}
+
+/*!     \brief  Free the arena (at the end of the measurement)
+ *
+ * \param  pArena       pointer to the arena
+ */
+void
+freeArena( tArena *pArena ) {
+    resetArena( pArena );
+    g_free( pArena->pBase );
+    pArena->pBase = NULL;
+    pArena->size = 0;
+}
+
+/*!     \brief  Format a string in the arena
+ *
+ * If the arena has no room the string is allocated from the heap (and freed when the arena is emptied).
+ *
+ * \param  pArena       pointer to the arena
+ * \param  sFormat      printf format
+ * \param  ...          arguments of the format
+ * \return the string (valid until the arena is emptied)
+ */
+gchar *
+arenaPrintf( tArena *pArena, const gchar *sFormat, ... ) {
+    gchar *sString = &pArena->pBase[ pArena->used ];
+    gsize room = pArena->size - pArena->used;
+    gint length;
+    va_list args;
+
+    va_start( args, sFormat );
+    length = g_vsnprintf( sString, room, sFormat, args );
+    va_end( args );
+
+    if( length >= 0 && (gsize)length < room ) {
+        pArena->used += length + 1;
+        g_atomic_int_inc( &allocationCounters.arenaStrings );
+    } else {
+        va_start( args, sFormat );
+        sString = g_strdup_vprintf( sFormat, args );
+        va_end( args );
+        pArena->pOverflow = g_slist_prepend( pArena->pOverflow, sString );
+        g_atomic_int_inc( &allocationCounters.heapStrings );
+    }
+
+    return sString;
+}
+
+/*!     \brief  Log the use of the arena and the message pool (and start counting afresh)
+ *
+ * \param  sMeasurement name of the measurement that has ended
+ */
+void
+logAllocationCounters( gchar *sMeasurement ) {
+    DBG( eDEBUG_INFO, "%s: %d strings from the arena (%d from the heap), %d messages from the pool (%d from the heap)",
+         sMeasurement,
+         g_atomic_int_get( &allocationCounters.arenaStrings ), g_atomic_int_get( &allocationCounters.heapStrings ),
+         g_atomic_int_get( &allocationCounters.poolMessages ), g_atomic_int_get( &allocationCounters.heapMessages ) );
+
+    g_atomic_int_set( &allocationCounters.arenaStrings, 0 );
+    g_atomic_int_set( &allocationCounters.heapStrings, 0 );
+    g_atomic_int_set( &allocationCounters.poolMessages, 0 );
+    g_atomic_int_set( &allocationCounters.heapMessages, 0 );
+}
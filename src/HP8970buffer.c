@@ -0,0 +1,619 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Circular buffer of measurements
+ *
+ * The acquisition thread is the only one to add or rewrite items (single producer); the plot,
+ * the live marker and the exports read them at the same time without waiting on it.
+ *
+ *   head & tail    published together as one 64 bit word, so a reader never pairs the head
+ *                  of one item with the tail of another (a full buffer would look empty)
+ *   extremes       published under a sequence count, so a reader takes a minimum and maximum
+ *                  of noise and gain that were found together
+ *   items          written under a sequence count, so getItemFromCircularBuffer never returns
+ *                  the columns of an item that was being (re)written as they were gathered
+ *
+ * Loops over the columns (circularBufferSpans) do not wait either. An item rewritten as the loop
+ * passes may be the old or the new (the plot is drawn again for the rewritten range).
+ *
+ * It uses only GLib (no GPIB or GTK functions) so it is linked on its own into the stress test
+ * of tests/ (make check).
+ */
+
+#include <stdlib.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+/*!     \brief  Update the min / max values in the circular buffer
+ *
+ * Update the min / max values based on the current data point
+ *
+ * \param current data value
+ * \param pMin    pointer to the minimum value of the data set
+ * \param pMax    pointer to the maximum value of the data set
+ */
+void
+updateBoundaries( gdouble current, gdouble *pMin, gdouble *pMax ) {
+    if( current >= ERROR_INDICATOR_HP8970 )
+        return;
+    if( *pMin == UNINITIALIZED_DOUBLE || current < *pMin )
+        *pMin = current;
+    if( *pMax == UNINITIALIZED_DOUBLE || current > *pMax )
+        *pMax = current;
+}
+
+/*!     \brief  publish the extremes (min / max) of a circular buffer
+ *
+ * Only one thread changes the extremes (the acquisition thread, or any thread when not measuring).
+ * The count is odd while they are being changed (see circularBufferExtremes).
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  minNoise         minimum noise (linear)
+ * \param  maxNoise         maximum noise (linear)
+ * \param  minGain          minimum gain
+ * \param  maxGain          maximum gain
+ */
+static void
+publishExtremes( tCircularBuffer *pCircBuffer, gdouble minNoise, gdouble maxNoise, gdouble minGain, gdouble maxGain ) {
+    guint sequence = pCircBuffer->extremesSequence;
+
+    __atomic_store_n( &pCircBuffer->extremesSequence, sequence + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    __atomic_store( &pCircBuffer->minNoise, &minNoise, __ATOMIC_RELAXED );
+    __atomic_store( &pCircBuffer->maxNoise, &maxNoise, __ATOMIC_RELAXED );
+    __atomic_store( &pCircBuffer->minGain,  &minGain,  __ATOMIC_RELAXED );
+    __atomic_store( &pCircBuffer->maxGain,  &maxGain,  __ATOMIC_RELAXED );
+    __atomic_store_n( &pCircBuffer->extremesSequence, sequence + 2, __ATOMIC_RELEASE );
+}
+
+/*!     \brief  get the extremes (min / max) of a circular buffer
+ *
+ * The four values are those published together (taken again if they were being changed).
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  pMinNoise        pointer to the minimum noise (linear)
+ * \param  pMaxNoise        pointer to the maximum noise (linear)
+ * \param  pMinGain         pointer to the minimum gain
+ * \param  pMaxGain         pointer to the maximum gain
+ */
+void
+circularBufferExtremes( tCircularBuffer *pCircBuffer, gdouble *pMinNoise, gdouble *pMaxNoise,
+                        gdouble *pMinGain, gdouble *pMaxGain ) {
+    guint sequence;
+
+    do {
+        sequence = __atomic_load_n( &pCircBuffer->extremesSequence, __ATOMIC_ACQUIRE );
+        __atomic_load( &pCircBuffer->minNoise, pMinNoise, __ATOMIC_RELAXED );
+        __atomic_load( &pCircBuffer->maxNoise, pMaxNoise, __ATOMIC_RELAXED );
+        __atomic_load( &pCircBuffer->minGain,  pMinGain,  __ATOMIC_RELAXED );
+        __atomic_load( &pCircBuffer->maxGain,  pMaxGain,  __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    } while( (sequence & 1) || sequence != __atomic_load_n( &pCircBuffer->extremesSequence, __ATOMIC_RELAXED ) );
+}
+
+/*!     \brief  stop sharing the columns of a circular buffer
+ *
+ * The buffer no longer refers to the shared columns (but the pointers are left)
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \return TRUE if the columns are still used by another buffer (so must not be freed or changed)
+ */
+static gboolean
+unshareColumns( tCircularBuffer *pCircBuffer ) {
+    gboolean bStillShared = FALSE;
+
+    if( pCircBuffer->pColumnRefs ) {
+        if( g_atomic_ref_count_dec( pCircBuffer->pColumnRefs ) )
+            g_free( pCircBuffer->pColumnRefs );
+        else
+            bStillShared = TRUE;
+        pCircBuffer->pColumnRefs = NULL;
+    }
+    return bStillShared;
+}
+
+/*!     \brief  initialize a circular buffer
+ *
+ * Allocate buffer and set counters
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  size             size of the new buffer
+ */
+void
+initCircularBuffer( tCircularBuffer *pCircBuffer, guint size, tAbscissa abscissa ) {
+    g_mutex_lock ( &pCircBuffer->mBuffer );
+	size = size+1;	// add one so that tail != head when size items in buffer
+    // leave shared columns to the other buffers and start afresh
+    if( unshareColumns( pCircBuffer ) ) {
+        pCircBuffer->abscissa = NULL;
+        pCircBuffer->noise = NULL;
+        pCircBuffer->gain = NULL;
+        pCircBuffer->itemFlags = NULL;
+    }
+    pCircBuffer->abscissa  = g_realloc( pCircBuffer->abscissa, size * sizeof( tAbscissaValue ) );
+    pCircBuffer->noise     = g_realloc( pCircBuffer->noise, size * sizeof( gdouble ) );
+    pCircBuffer->gain      = g_realloc( pCircBuffer->gain, size * sizeof( gdouble ) );
+    pCircBuffer->itemFlags = g_realloc( pCircBuffer->itemFlags, size * sizeof( guint32 ) );
+    PUBLISH_BUFFER_INDICES( pCircBuffer, ((tBufferIndices){ .head = 0, .tail = 0 }) );
+    pCircBuffer->rewriteTail = 0;
+    pCircBuffer->size = size;
+    pCircBuffer->generation++;
+    pCircBuffer->rewritten = NO_REWRITTEN_RANGE;
+
+    publishExtremes( pCircBuffer, UNINITIALIZED_DOUBLE, UNINITIALIZED_DOUBLE, UNINITIALIZED_DOUBLE, UNINITIALIZED_DOUBLE );
+
+    if( abscissa == eFreqAbscissa ) {
+        pCircBuffer->minAbscissa.freq  = UNINITIALIZED_DOUBLE;
+        pCircBuffer->maxAbscissa.freq  = UNINITIALIZED_DOUBLE;
+    } else {
+        pCircBuffer->minAbscissa.time  = 0;
+        pCircBuffer->maxAbscissa.time  = 0;
+    }
+    g_mutex_unlock ( &pCircBuffer->mBuffer );
+}
+
+/*!     \brief  free the data of a circular buffer
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ */
+void
+freeCircularBuffer( tCircularBuffer *pCircBuffer ) {
+    if( !unshareColumns( pCircBuffer ) ) {
+        g_free( pCircBuffer->abscissa );
+        g_free( pCircBuffer->noise );
+        g_free( pCircBuffer->gain );
+        g_free( pCircBuffer->itemFlags );
+    }
+
+    pCircBuffer->abscissa = NULL;
+    pCircBuffer->noise = NULL;
+    pCircBuffer->gain = NULL;
+    pCircBuffer->itemFlags = NULL;
+    pCircBuffer->head = pCircBuffer->tail = pCircBuffer->rewriteTail = pCircBuffer->size = 0;
+    pCircBuffer->generation++;
+}
+
+/*!     \brief  Copy a circular buffer (and its data)
+ *
+ * The copy has its own (newly initialized) mutex.
+ *
+ * \param  pCopy      pointer to the destination buffer
+ * \param  pSource    pointer to the buffer to copy
+ */
+void
+copyCircularBuffer( tCircularBuffer *pCopy, tCircularBuffer *pSource ) {
+    g_mutex_lock( &pSource->mBuffer );
+    *pCopy = *pSource;
+    pCopy->abscissa  = g_memdup2( pSource->abscissa, pSource->size * sizeof( tAbscissaValue ) );
+    pCopy->noise     = g_memdup2( pSource->noise, pSource->size * sizeof( gdouble ) );
+    pCopy->gain      = g_memdup2( pSource->gain, pSource->size * sizeof( gdouble ) );
+    pCopy->itemFlags = g_memdup2( pSource->itemFlags, pSource->size * sizeof( guint32 ) );
+    pCopy->pColumnRefs = NULL;
+    g_mutex_unlock( &pSource->mBuffer );
+    g_mutex_init( &pCopy->mBuffer );
+}
+
+/*!     \brief  Share the data of a circular buffer (copy on write)
+ *
+ * The copy uses the same columns. The columns are copied only when one of the buffers
+ * is next changed (or freed when the last is freed).
+ * The source must not be being changed by another thread (i.e. not while measuring).
+ *
+ * \param  pShare     pointer to the destination buffer
+ * \param  pSource    pointer to the buffer to share
+ */
+void
+shareCircularBuffer( tCircularBuffer *pShare, tCircularBuffer *pSource ) {
+    g_mutex_lock( &pSource->mBuffer );
+    if( pSource->pColumnRefs == NULL ) {
+        pSource->pColumnRefs = g_new( gatomicrefcount, 1 );
+        g_atomic_ref_count_init( pSource->pColumnRefs );
+    }
+    g_atomic_ref_count_inc( pSource->pColumnRefs );
+    *pShare = *pSource;
+    g_mutex_unlock( &pSource->mBuffer );
+    g_mutex_init( &pShare->mBuffer );
+}
+
+/*!     \brief  Take a private copy of shared columns before they are changed
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ */
+static void
+detachCircularBuffer( tCircularBuffer *pCircBuffer ) {
+    tAbscissaValue *abscissa = pCircBuffer->abscissa;
+    gdouble *noise = pCircBuffer->noise, *gain = pCircBuffer->gain;
+    guint32 *itemFlags = pCircBuffer->itemFlags;
+
+    // the lock keeps a plot from seeing the columns change under it
+    g_mutex_lock( &pCircBuffer->mBuffer );
+    if( !g_atomic_ref_count_compare( pCircBuffer->pColumnRefs, 1 ) ) {
+        pCircBuffer->abscissa  = g_memdup2( abscissa, pCircBuffer->size * sizeof( tAbscissaValue ) );
+        pCircBuffer->noise     = g_memdup2( noise, pCircBuffer->size * sizeof( gdouble ) );
+        pCircBuffer->gain      = g_memdup2( gain, pCircBuffer->size * sizeof( gdouble ) );
+        pCircBuffer->itemFlags = g_memdup2( itemFlags, pCircBuffer->size * sizeof( guint32 ) );
+        // (the others may have let go since we looked)
+        if( !unshareColumns( pCircBuffer ) ) {
+            g_free( abscissa );
+            g_free( noise );
+            g_free( gain );
+            g_free( itemFlags );
+        }
+    } else {
+        unshareColumns( pCircBuffer );
+    }
+    g_mutex_unlock( &pCircBuffer->mBuffer );
+}
+
+/*!     \brief  get the number of items stored in a circular buffer
+ *
+ * get the number of items stored in a circular buffer
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \return number if items
+ */
+gint
+nItemsInCircularBuffer( tCircularBuffer *pCircBuffer ) {
+    tBufferIndices indices = ACQUIRE_BUFFER_INDICES( pCircBuffer );
+    gint nItems = (gint)indices.tail - (gint)indices.head;
+
+    if( nItems < 0 )
+        nItems += pCircBuffer->size;
+
+    return( nItems );
+}
+
+/*!     \brief  get the contiguous runs of the items in a circular buffer
+ *
+ * The items (oldest first) are in the columns from spans[ 0 ].start for spans[ 0 ].count
+ * and then (if the buffer has wrapped) from spans[ 1 ].start for spans[ 1 ].count.
+ * Loops over the spans need no modulo for each item.
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  spans            array of two spans (filled)
+ * \return number of spans (0, 1 or 2)
+ */
+gint
+circularBufferSpans( tCircularBuffer *pCircBuffer, tBufferSpan *spans ) {
+    // the items published when we look .. more may be added while we use them
+    tBufferIndices indices = ACQUIRE_BUFFER_INDICES( pCircBuffer );
+    guint head = indices.head, tail = indices.tail;
+
+    if( tail == head )
+        return 0;
+
+    spans[ 0 ].start = head;
+    if( tail > head ) {
+        spans[ 0 ].count = tail - head;
+        return 1;
+    }
+    spans[ 0 ].count = pCircBuffer->size - head;
+    spans[ 1 ].start = 0;
+    spans[ 1 ].count = tail;
+    return tail ? 2 : 1;
+}
+
+/*!     \brief  extremes of a column
+ *
+ * The errors (flagged with a very large value) are skipped. The loop has no
+ * branches so that the compiler can vectorize it.
+ *
+ * \param  pColumn          pointer to the first value
+ * \param  n                number of values
+ * \param  pMin             pointer to the minimum (updated)
+ * \param  pMax             pointer to the maximum (updated)
+ */
+static void
+columnExtremes( const gdouble *pColumn, guint n, gdouble *pMin, gdouble *pMax ) {
+    gdouble min = G_MAXDOUBLE, max = -G_MAXDOUBLE;
+
+    for( guint i = 0; i < n; i++ ) {
+        gdouble value = pColumn[ i ];
+        gboolean bValid = value < ERROR_INDICATOR_HP8970;
+        min = (bValid && value < min) ? value : min;
+        max = (bValid && value > max) ? value : max;
+    }
+    if( min <= max ) {
+        updateBoundaries( min, pMin, pMax );
+        updateBoundaries( max, pMin, pMax );
+    }
+}
+
+/*!     \brief  recalculate extremes (min / max)
+ *
+ * Only called by the thread that changes the items (see publishExtremes); no lock is needed.
+ * Readers are not blocked: they take the items by the published head and tail and the new
+ * extremes under the sequence count (circularBufferExtremes).
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ */
+static void
+findExtremes( tCircularBuffer *pCircBuffer ) {
+    tBufferSpan spans[ 2 ];
+    gint nSpans = circularBufferSpans( pCircBuffer, spans );
+    gdouble minNoise = UNINITIALIZED_DOUBLE, maxNoise = UNINITIALIZED_DOUBLE;
+    gdouble minGain = UNINITIALIZED_DOUBLE, maxGain = UNINITIALIZED_DOUBLE;
+
+    for( gint span = 0; span < nSpans; span++ ) {
+        columnExtremes( &pCircBuffer->noise[ spans[ span ].start ], spans[ span ].count, &minNoise, &maxNoise );
+        columnExtremes( &pCircBuffer->gain[ spans[ span ].start ], spans[ span ].count, &minGain, &maxGain );
+    }
+    publishExtremes( pCircBuffer, minNoise, maxNoise, minGain, maxGain );
+}
+
+/*!     \brief  recalculate extremes (min / max)
+ *
+ * recalculate extremes (min / max)
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ */
+void
+recalculateBoundaries( tCircularBuffer *pCircBuffer ) {
+    g_mutex_lock ( &pCircBuffer->mBuffer );
+    findExtremes( pCircBuffer );
+    g_mutex_unlock ( &pCircBuffer->mBuffer );
+}
+
+/*!     \brief  store an item in the columns of a circular buffer
+ *
+ * Only the thread that adds items writes them. The count is odd while they are
+ * being written (see getItemFromCircularBuffer).
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  posn             position in the columns
+ * \param  pItem            pointer to the data
+ */
+static inline void
+putItemInCircularBuffer( tCircularBuffer *pCircBuffer, guint posn, tNoiseAndGain *pItem ) {
+    guint sequence = pCircBuffer->itemSequence;
+
+    if( pCircBuffer->pColumnRefs != NULL )
+        detachCircularBuffer( pCircBuffer );
+
+    __atomic_store_n( &pCircBuffer->itemSequence, sequence + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    __atomic_store( &pCircBuffer->abscissa[ posn ], &pItem->abscissa, __ATOMIC_RELAXED );
+    __atomic_store( &pCircBuffer->noise[ posn ], &pItem->noise, __ATOMIC_RELAXED );
+    __atomic_store( &pCircBuffer->gain[ posn ], &pItem->gain, __ATOMIC_RELAXED );
+    __atomic_store_n( &pCircBuffer->itemFlags[ posn ], pItem->flags.all, __ATOMIC_RELAXED );
+    __atomic_store_n( &pCircBuffer->itemSequence, sequence + 2, __ATOMIC_RELEASE );
+}
+
+/*!     \brief  add item to a circular buffer
+ *
+ * add item to a circular buffer, possibly overwriting older data
+ *
+ * This does not lock the buffer. Only one thread (the acquisition thread) may add
+ * items; readers see the item once the new tail is published.
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  pItem            pointer to the data
+ * \param  bCircular        TRUE if we use the circular buffer property, overwiting old data
+ * \return TRUE if no overflow (or FALSE if full)
+ */
+gboolean
+addItemToCircularBuffer( tCircularBuffer *pCircBuffer, tNoiseAndGain *pItem, gboolean bCircular ) {
+    // if we full, either return (if we are told not to overwrite)
+    // or move the head, discarding the first item
+
+    gboolean bNeedRecalc = FALSE;
+    // (only this thread changes the indices)
+    tBufferIndices indices = pCircBuffer->indices;
+
+    if( (indices.tail + 1) % pCircBuffer->size  == indices.head ) {
+        if( !bCircular )
+            return FALSE;
+        // discard the oldest .. its slot is only reused by the next item
+        // (the slot at the tail is always free) so a reader still using it has that long
+        indices.head = (indices.head + 1) % pCircBuffer->size;
+        bNeedRecalc = TRUE;
+    }
+    putItemInCircularBuffer( pCircBuffer, indices.tail, pItem );
+    indices.tail = (indices.tail + 1) % pCircBuffer->size;
+    // the new head and tail together (a reader of a full buffer always sees it full)
+    PUBLISH_BUFFER_INDICES( pCircBuffer, indices );
+
+    // Update the minimum and maximum values
+    if( bNeedRecalc ) {
+        findExtremes( pCircBuffer );
+    } else {
+        gdouble minNoise = pCircBuffer->minNoise, maxNoise = pCircBuffer->maxNoise;
+        gdouble minGain = pCircBuffer->minGain, maxGain = pCircBuffer->maxGain;
+
+        updateBoundaries( pItem->noise, &minNoise, &maxNoise );
+        updateBoundaries( pItem->gain,  &minGain,  &maxGain );
+        publishExtremes( pCircBuffer, minNoise, maxNoise, minGain, maxGain );
+    }
+    return TRUE;
+}
+
+/*!     \brief  widen the range of rewritten positions (for the plot)
+ *
+ * Only the acquisition thread rewrites items; the plot may take the range at any time.
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  posn             position in the columns of the rewritten item
+ */
+static inline void
+markRewritten( tCircularBuffer *pCircBuffer, guint posn ) {
+    guint64 range = __atomic_load_n( &pCircBuffer->rewritten, __ATOMIC_RELAXED ), widened;
+
+    do {
+        widened = ((guint64)MIN( REWRITTEN_FIRST( range ), posn ) << 32) | MAX( REWRITTEN_LAST( range ), posn );
+    } while( !__atomic_compare_exchange_n( &pCircBuffer->rewritten, &range, widened,
+                                           TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+}
+
+/*!     \brief  rewrite over populated circular buffer
+ *
+ * rewrite over populated circular buffer
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  pItem            pointer to the data
+ * \return TRUE if no overflow (or FALSE if full)
+ */
+gboolean
+rewriteCircularBuffer( tCircularBuffer *pCircBuffer, tNoiseAndGain *pItem ) {
+
+    // (a reader may see the old or the new point .. either is a valid plot)
+    putItemInCircularBuffer( pCircBuffer, pCircBuffer->rewriteTail, pItem );
+    markRewritten( pCircBuffer, pCircBuffer->rewriteTail );
+    pCircBuffer->rewriteTail = (pCircBuffer->rewriteTail + 1) % pCircBuffer->size;
+
+    findExtremes( pCircBuffer );
+    return TRUE;
+}
+
+/*!     \brief  rewrite a particular item of a populated circular buffer
+ *
+ * Used when a sweep pass is made in descending frequency, so the
+ * buffer stays in frequency order.
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  item             position in the buffer of the data to replace
+ * \param  pItem            pointer to the data
+ */
+void
+rewritePointInCircularBuffer( tCircularBuffer *pCircBuffer, guint item, tNoiseAndGain *pItem ) {
+
+    putItemInCircularBuffer( pCircBuffer, CIRCULAR_BUFFER_POSN( pCircBuffer, item ), pItem );
+    markRewritten( pCircBuffer, CIRCULAR_BUFFER_POSN( pCircBuffer, item ) );
+
+    findExtremes( pCircBuffer );
+}
+
+/*!     \brief  get a particular item from a circular buffer
+ *
+ * Gather the columns of an item into a measurement. Loops over all
+ * items should rather use the columns (see circularBufferSpans).
+ *
+ * The item is taken again if an item was written while the columns were gathered
+ * (while measuring, the slot may have been reused by a newer item).
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \param  item             position in the buffer of the data we want (or LAST_ITEM)
+ * \param  pItem            pointer to the measurement to fill
+ * \return pItem (or NULL if there is no such item)
+ */
+tNoiseAndGain *
+getItemFromCircularBuffer( tCircularBuffer *pCircBuffer, guint item, tNoiseAndGain *pItem ) {
+    tBufferIndices indices;
+    guint sequence, posn;
+
+    if( item != LAST_ITEM && item >= pCircBuffer->size )
+        return NULL;
+
+    do {
+        sequence = __atomic_load_n( &pCircBuffer->itemSequence, __ATOMIC_ACQUIRE );
+        indices = ACQUIRE_BUFFER_INDICES( pCircBuffer );
+        if( item != LAST_ITEM )
+            posn = (indices.head + item) % pCircBuffer->size;
+        else if( indices.tail == indices.head )
+            return NULL;
+        else
+            posn = indices.tail > 0 ? indices.tail - 1 : pCircBuffer->size - 1;
+
+        __atomic_load( &pCircBuffer->abscissa[ posn ], &pItem->abscissa, __ATOMIC_RELAXED );
+        __atomic_load( &pCircBuffer->noise[ posn ], &pItem->noise, __ATOMIC_RELAXED );
+        __atomic_load( &pCircBuffer->gain[ posn ], &pItem->gain, __ATOMIC_RELAXED );
+        pItem->flags.all = __atomic_load_n( &pCircBuffer->itemFlags[ posn ], __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    } while( (sequence & 1) || sequence != __atomic_load_n( &pCircBuffer->itemSequence, __ATOMIC_RELAXED ) );
+
+    return pItem;
+}
+
+/*!     \brief  determine minimum and maximum values for time/frequency based on the data
+ *
+ * determine minimum and maximum values for time/frequency based on the data
+ *
+ * \param  pCircBuffer      pointer to the circular buffer structure
+ * \return 0 if OK or -1 if error
+ */
+
+gboolean
+determineTimeExtremesInCircularBuffer( tCircularBuffer *pCircBuffer ) {
+    tBufferIndices indices = ACQUIRE_BUFFER_INDICES( pCircBuffer );
+    guint head = indices.head, tail = indices.tail;
+
+    // empty
+    if( tail == head )
+                return ERROR;
+
+    pCircBuffer->minAbscissa.time = pCircBuffer->abscissa[ head ].time;
+    pCircBuffer->maxAbscissa.time = pCircBuffer->abscissa[ tail > 0 ? tail - 1 : pCircBuffer->size - 1 ].time;
+
+    return 0;
+}
+
+#define TIME_FROM_POSN( x, y ) (x)->abscissa[ CIRCULAR_BUFFER_POSN( (x), (y) ) ].time
+
+// Function to find the closest element in the circular buffer
+gint
+findTimeDeltaInCircularBuffer(tCircularBuffer *pCircBuffer, gdouble delta) {
+    gint nItems = ((pCircBuffer->tail - pCircBuffer->head) + pCircBuffer->size) % pCircBuffer->size;
+    gint low = 0;              // index to first item
+    gint high = nItems - 1;    // index to last item / since they are ascending this is also the highest
+
+    // nonsense if no items
+    if( nItems == 0 )
+        return INVALID;
+
+    gint64 lowTime, highTime;
+
+    lowTime  = TIME_FROM_POSN( pCircBuffer, low );
+    highTime = TIME_FROM_POSN( pCircBuffer, high );
+
+    // if delta is 10.0 seconds, then look for the last time-10 seconds
+    gint64 target = highTime - (gint64)(delta * 1.0e3);
+
+    // Corner cases
+    if (target <= lowTime)  return low;
+    if (target >= highTime) return high;
+
+    // Binary search
+    while (low <= high) {
+        gint mid = low + (high - low) / 2;
+        gdouble midTime = TIME_FROM_POSN( pCircBuffer, mid );
+
+        lowTime  = TIME_FROM_POSN( pCircBuffer, low );
+        highTime = TIME_FROM_POSN( pCircBuffer, high );
+
+        if ( midTime == target) return mid; // Exact match
+
+        // Update the closest element if necessary
+        if (abs(midTime - target) < abs(lowTime - target)) {
+            low = mid;
+        }
+
+        if (midTime < target) {
+            low  = mid + 1; // Search in upper half
+        } else {
+            high = mid - 1; // Search in lower half
+        }
+    }
+
+    // At this point, low is either equal to high or one position ahead
+    // We need to compare the elements at low and low-1 to find the closest
+    gint64 lowMinusOneTime = TIME_FROM_POSN( pCircBuffer, low -1 );
+    if (low > 0 && abs( lowMinusOneTime - target) < abs(lowTime - target)) {
+        return low - 1;
+    } else {
+        return low;
+    }
+}
@@ -272,15 +272,14 @@ GPIBtriggerMeasurement (gint descGPIB_HP8970, tNoiseAndGain *pResult, gint *pGPI
 
         waitTime += THIRTY_MS;
         if (waitTime > FIVE_SECONDS && fmod (waitTime, 1.0) < THIRTY_MS) {
-            gchar *sMessage;
+            gchar sMessage[ MSG_STRING_SIZE ];
             if (estimatedTimeOfMeasurement > 15) {    // this means we have a "WAIT;" message .. so show the estimated time
-                sMessage = g_strdup_printf ("✳️ Waiting for HP8970 : %ds / %.0lfs", (gint) (waitTime),
+                g_snprintf (sMessage, MSG_STRING_SIZE, "✳️ Waiting for HP8970 : %ds / %.0lfs", (gint) (waitTime),
                                             (double) estimatedTimeOfMeasurement);
             } else {
-                sMessage = g_strdup_printf ("✳️ Waiting for HP8970 : %ds", (gint) (waitTime));
+                g_snprintf (sMessage, MSG_STRING_SIZE, "✳️ Waiting for HP8970 : %ds", (gint) (waitTime));
             }
             postInfo(sMessage);
-            g_free (sMessage);
         }
     }
     while (rtn == eRDWT_CONTINUE && (globalData.flags.bNoGPIBtimeout || waitTime < ( 5.0 + estimatedTimeOfMeasurement * 1.2) )); // add safety of 20% + 1 second
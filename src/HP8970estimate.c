@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+// weight of a new timing in the learned (exponentially averaged) value
+#define ESTIMATE_WEIGHT     0.25
+
+/*!     \brief  Blend a new timing into a learned value
+ *
+ * \param  pLearned     pointer to the learned value (0 if nothing learned yet)
+ * \param  seconds      the new timing
+ */
+static void
+learnTiming( gdouble *pLearned, gdouble seconds ) {
+    if( *pLearned == 0.0 )
+        *pLearned = seconds;
+    else
+        *pLearned += ESTIMATE_WEIGHT * (seconds - *pLearned);
+}
+
+/*!     \brief  Start (or restart) the progress estimate of a sweep
+ *
+ * The timings learned are kept for each mode and smoothing factor,
+ * so they survive from sweep to sweep.
+ *
+ * \param  pEstimate        pointer to the estimator
+ * \param  pSettings        pointer to the HP8970 settings of the sweep
+ * \param  nPoints          number of points in the sweep
+ * \param  nDone            number of points already measured (a resumed sweep)
+ */
+void
+startSweepEstimate( tSweepEstimate *pEstimate, tHP8970settings *pSettings, guint nPoints, guint nDone ) {
+    pEstimate->mode = pSettings->mode;
+    pEstimate->smoothing = CLAMP( (gint)round( log2( pSettings->smoothingFactor ) ), 0, N_SMOOTHING_FACTORS - 1 );
+
+    // until we learn better .. the nominal measurement time plus settling if the LO is stepped
+    pEstimate->defaultPointTime = pSettings->smoothingFactor * APPROX_MEASUREMENT_TIME;
+    if( pSettings->mode == eMode1_1 || pSettings->mode == eMode1_3 )
+        pEstimate->defaultPointTime += pSettings->settlingTime_ms / 1000.0;
+
+    pEstimate->nPoints = nPoints;
+    pEstimate->nDone = nDone;
+    pEstimate->nMeasured = 0;
+    pEstimate->startTime = g_get_monotonic_time();
+    pEstimate->lastPointTime = 0;
+    pEstimate->triggerTime = 0;
+}
+
+/*!     \brief  Note the trigger of a measurement
+ *
+ * \param  pEstimate        pointer to the estimator
+ * \param  smoothingFactor  the smoothing factor of the measurement
+ * \return the time we expect the HP8970 to take for the measurement (s)
+ */
+gdouble
+triggerPointEstimate( tSweepEstimate *pEstimate, gint smoothingFactor ) {
+    gdouble learned = pEstimate->measurementTime[ pEstimate->mode ][ pEstimate->smoothing ];
+
+    pEstimate->triggerTime = g_get_monotonic_time();
+    return learned != 0.0 ? learned : smoothingFactor * APPROX_MEASUREMENT_TIME;
+}
+
+/*!     \brief  Learn the time taken by a (successful) measurement
+ *
+ * The time is that from the trigger to having read the data (including the SRQ).
+ *
+ * \param  pEstimate        pointer to the estimator
+ */
+void
+measuredPointEstimate( tSweepEstimate *pEstimate ) {
+    if( pEstimate->triggerTime == 0 )
+        return;
+    learnTiming( &pEstimate->measurementTime[ pEstimate->mode ][ pEstimate->smoothing ],
+                 (g_get_monotonic_time() - pEstimate->triggerTime) / 1.0e6 );
+    pEstimate->triggerTime = 0;
+}
+
+/*!     \brief  Learn the time taken by a complete point of the sweep
+ *
+ * The point time is the interval between successive points so it includes
+ * the LO retune and settling. The first point (which includes the setup of
+ * the sweep) is not used.
+ *
+ * \param  pEstimate        pointer to the estimator
+ * \param  nDone            number of points of the sweep now complete
+ */
+void
+completePointEstimate( tSweepEstimate *pEstimate, guint nDone ) {
+    gint64 now = g_get_monotonic_time();
+
+    if( pEstimate->lastPointTime != 0 )
+        learnTiming( &pEstimate->pointTime[ pEstimate->mode ][ pEstimate->smoothing ],
+                     (now - pEstimate->lastPointTime) / 1.0e6 );
+    pEstimate->lastPointTime = now;
+    pEstimate->nDone = nDone;
+    pEstimate->nMeasured++;
+}
+
+/*!     \brief  Progress of the sweep
+ *
+ * (shown as e.g. "42% · 3.1 pts/s · ETA 1:05")
+ *
+ * \param  pEstimate        pointer to the estimator
+ * \param  pPercent         pointer to the percentage of the sweep completed
+ * \param  pPointsPerSec    pointer to the rate of measurement
+ * \param  pETA             pointer to the seconds to the end of the sweep
+ */
+void
+sweepProgress( tSweepEstimate *pEstimate, gint *pPercent, gdouble *pPointsPerSec, gint *pETA ) {
+    gdouble pointTime = pEstimate->pointTime[ pEstimate->mode ][ pEstimate->smoothing ];
+    gdouble elapsed = (g_get_monotonic_time() - pEstimate->startTime) / 1.0e6;
+    gdouble remaining;
+
+    if( pointTime == 0.0 )
+        pointTime = pEstimate->defaultPointTime;
+
+    // the rate actually achieved in this sweep (once we have a couple of points)
+    if( pEstimate->nMeasured > 1 && elapsed > 0.0 )
+        *pPointsPerSec = pEstimate->nMeasured / elapsed;
+    else
+        *pPointsPerSec = 1.0 / pointTime;
+
+    *pPercent = pEstimate->nPoints ? (100 * pEstimate->nDone) / pEstimate->nPoints : 0;
+    remaining = pEstimate->nPoints > pEstimate->nDone ? pEstimate->nPoints - pEstimate->nDone : 0;
+    *pETA = (gint)ceil( remaining * pointTime );
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Glyph cache
+ *
+ * The labels of the plot are mostly the same from one frame to the next. Each string is shaped
+ * once (converted to glyphs and measured) for the font it is shown in and the glyphs and extents
+ * are kept, so showing or measuring it again is a lookup and cairo_show_glyphs.
+ *
+ * A run of glyphs is found by the scaled font (the face, size and transformation of the text)
+ * and the string. A reference to the scaled font is held by the run so its address cannot be
+ * reused by another font while the run is kept. When the cache is full it is emptied.
+ *
+ * Surfaces that keep the text (PDF) are given the string with cairo_show_text, as before.
+ */
+
+#include <string.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+#define GLYPH_CACHE_SIZE    512     // runs kept before the cache is emptied
+#define GLYPH_RUN_STACK     64      // glyphs placed on the stack (longer runs use the heap)
+
+// A string shaped in a font
+typedef struct {
+    cairo_scaled_font_t *pFont;
+    gchar *sText;
+    cairo_glyph_t *glyphs;          // (relative to the origin of the text)
+    gint nGlyphs;
+    cairo_text_extents_t extents;
+} tGlyphRun;
+
+static GHashTable *glyphRuns = NULL;
+static GMutex mGlyphRuns;
+
+/*!     \brief  Hash of a glyph run (font and string)
+ *
+ * \param  key        pointer to the glyph run
+ * \return hash
+ */
+static guint
+hashGlyphRun( gconstpointer key ) {
+    const tGlyphRun *pRun = key;
+
+    return g_str_hash( pRun->sText ) ^ g_direct_hash( pRun->pFont );
+}
+
+/*!     \brief  Are the glyph runs of the same string in the same font
+ *
+ * \param  a          pointer to a glyph run
+ * \param  b          pointer to a glyph run
+ * \return TRUE if the same
+ */
+static gboolean
+equalGlyphRun( gconstpointer a, gconstpointer b ) {
+    const tGlyphRun *pRunA = a, *pRunB = b;
+
+    return pRunA->pFont == pRunB->pFont && strcmp( pRunA->sText, pRunB->sText ) == 0;
+}
+
+/*!     \brief  Free a glyph run (when it is removed from the cache)
+ *
+ * \param  data       pointer to the glyph run
+ */
+static void
+freeGlyphRun( gpointer data ) {
+    tGlyphRun *pRun = (tGlyphRun *)data;
+
+    cairo_glyph_free( pRun->glyphs );
+    cairo_scaled_font_destroy( pRun->pFont );
+    g_free( pRun->sText );
+    g_free( pRun );
+}
+
+/*!     \brief  Find (or shape) the glyph run of a string in the current font
+ *
+ * Must be called with the cache locked. The run is valid until the cache is unlocked.
+ *
+ * \param  cr         pointer to cairo context
+ * \param  sText      NULL terminated string
+ * \return pointer to the glyph run or NULL if the string cannot be shaped in the font
+ */
+static tGlyphRun *
+lookupGlyphRun( cairo_t *cr, const gchar *sText ) {
+    tGlyphRun key = { .pFont = cairo_get_scaled_font( cr ), .sText = (gchar *)sText }, *pRun;
+
+    if( cairo_scaled_font_status( key.pFont ) != CAIRO_STATUS_SUCCESS )
+        return NULL;
+
+    if( glyphRuns == NULL )
+        glyphRuns = g_hash_table_new_full( hashGlyphRun, equalGlyphRun, freeGlyphRun, NULL );
+    else if( (pRun = g_hash_table_lookup( glyphRuns, &key )) != NULL )
+        return pRun;
+
+    pRun = g_new0( tGlyphRun, 1 );
+    if( cairo_scaled_font_text_to_glyphs( key.pFont, 0.0, 0.0, sText, -1, &pRun->glyphs, &pRun->nGlyphs,
+                                          NULL, NULL, NULL ) != CAIRO_STATUS_SUCCESS ) {
+        g_free( pRun );
+        return NULL;
+    }
+    cairo_scaled_font_glyph_extents( key.pFont, pRun->glyphs, pRun->nGlyphs, &pRun->extents );
+    pRun->pFont = cairo_scaled_font_reference( key.pFont );
+    pRun->sText = g_strdup( sText );
+
+    if( g_hash_table_size( glyphRuns ) >= GLYPH_CACHE_SIZE )
+        g_hash_table_remove_all( glyphRuns );
+    g_hash_table_add( glyphRuns, pRun );
+
+    return pRun;
+}
+
+/*!     \brief  Extents of a string in the current font (as cairo_text_extents)
+ *
+ * \param  cr         pointer to cairo context
+ * \param  sText      NULL terminated string
+ * \param  pExtents   pointer to the extents to fill
+ */
+void
+cachedCairoTextExtents( cairo_t *cr, const gchar *sText, cairo_text_extents_t *pExtents ) {
+    tGlyphRun *pRun;
+
+    g_mutex_lock( &mGlyphRuns );
+    if( (pRun = lookupGlyphRun( cr, sText )) != NULL )
+        *pExtents = pRun->extents;
+    g_mutex_unlock( &mGlyphRuns );
+
+    if( pRun == NULL )
+        cairo_text_extents( cr, sText, pExtents );
+}
+
+/*!     \brief  Show a string at the current point in the current font (as cairo_show_text)
+ *
+ * The current point is advanced past the string.
+ *
+ * \param  cr         pointer to cairo context
+ * \param  sText      NULL terminated string
+ */
+void
+showCachedCairoText( cairo_t *cr, const gchar *sText ) {
+    cairo_glyph_t stackGlyphs[ GLYPH_RUN_STACK ], *glyphs = stackGlyphs;
+    gdouble x = 0.0, y = 0.0, xAdvance = 0.0, yAdvance = 0.0;
+    tGlyphRun *pRun;
+    gint nGlyphs = 0;
+
+    if( cairo_surface_has_show_text_glyphs( cairo_get_target( cr ) ) ) {
+        cairo_show_text( cr, sText );
+        return;
+    }
+
+    if( cairo_has_current_point( cr ) )
+        cairo_get_current_point( cr, &x, &y );
+
+    // place the glyphs at the current point (so the run can be used after the cache is unlocked)
+    g_mutex_lock( &mGlyphRuns );
+    if( (pRun = lookupGlyphRun( cr, sText )) != NULL ) {
+        nGlyphs = pRun->nGlyphs;
+        if( nGlyphs > GLYPH_RUN_STACK )
+            glyphs = g_new( cairo_glyph_t, nGlyphs );
+        for( gint i = 0; i < nGlyphs; i++ ) {
+            glyphs[ i ].index = pRun->glyphs[ i ].index;
+            glyphs[ i ].x = pRun->glyphs[ i ].x + x;
+            glyphs[ i ].y = pRun->glyphs[ i ].y + y;
+        }
+        xAdvance = pRun->extents.x_advance;
+        yAdvance = pRun->extents.y_advance;
+    }
+    g_mutex_unlock( &mGlyphRuns );
+
+    if( pRun == NULL ) {
+        cairo_show_text( cr, sText );
+        return;
+    }
+
+    cairo_show_glyphs( cr, glyphs, nGlyphs );
+    // (cairo_show_glyphs does not move the current point)
+    cairo_move_to( cr, x + xAdvance, y + yAdvance );
+
+    if( glyphs != stackGlyphs )
+        g_free( glyphs );
+}
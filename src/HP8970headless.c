@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Headless (command line) acquisition
+ *
+ * e.g.  hp8970 --headless --configuration "LNA 1GHz" --calibrate --sweep 4 --output - --output lna.json
+ *
+ * No GTK widgets are created. The measurement is run as a sequence (see HP8970sequence.c)
+ * on the GPIB thread and the messages that would be shown in the status bar are written to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+#include "messageEvent.h"
+
+static volatile sig_atomic_t bInterrupted = FALSE;
+
+/*!     \brief  Signal handler for ^C (and kill)
+ *
+ * \param  signal   signal number (unused)
+ */
+static void
+interruptHandler( int signal ) {
+    bInterrupted = TRUE;
+}
+
+/*!     \brief  Write a measurement to stdout
+ *
+ * Called from the GPIB thread as each measurement arrives. The format is the same as
+ * the CSV file. A header line is written before the first measurement (or if we change
+ * between swept and spot measurements). A multi-spot measurement has an extra column with
+ * the frequency.
+ *
+ * \param  pGlobal       pointer to global data
+ * \param  pMeasurement  pointer to the measurement
+ * \param  bTime         TRUE if the abscissa is time (spot frequency)
+ */
+void
+streamMeasurement( tGlobal *pGlobal, tNoiseAndGain *pMeasurement, gboolean bTime ) {
+    static gint lastAbscissa = INVALID;
+    gboolean bMultiSpot = bTime && pGlobal->plot.nMultiSpot >= 2;
+    gint abscissa = bTime + bMultiSpot;
+    gdouble noise = noiseInUnits( pMeasurement->noise, pGlobal->plot.noiseUnits );
+
+    if( lastAbscissa != abscissa ) {
+        gchar sNoiseU[ SHORT_STRING ];
+
+        if( sNoiseUnits[ pGlobal->plot.noiseUnits ] != 0 ) {
+            g_snprintf( sNoiseU, SHORT_STRING, " (%s)", sNoiseUnits[ pGlobal->plot.noiseUnits ] );
+        } else {
+            sNoiseU[ 0 ] = 0;
+        }
+        printf( "%s,%s%s,Gain (dB)%s\n", bTime ? "Time (s) since 1/1/1970" : "Frequency (MHz)",
+                sNoiseLabel[ pGlobal->plot.noiseUnits ], sNoiseU, bMultiSpot ? ",Frequency (MHz)" : "" );
+        lastAbscissa = abscissa;
+    }
+
+    if( bMultiSpot )
+        printf( "%.3lf,%g,%g,%g\n", ((gdouble)pMeasurement->abscissa.time) / 1000.0, noise, pMeasurement->gain,
+                pGlobal->plot.multiSpotMHz[ pMeasurement->flags.each.bbSeries ] );
+    else if( bTime )
+        printf( "%.3lf,%g,%g\n", ((gdouble)pMeasurement->abscissa.time) / 1000.0, noise, pMeasurement->gain );
+    else
+        printf( "%g,%g,%g\n", pMeasurement->abscissa.freq / MHz(1.0), noise, pMeasurement->gain );
+    fflush( stdout );
+}
+
+/*!     \brief  Make a sequence from the command line options
+ *
+ * [configuration] [calibrate] sweep or spot, then save each output file.
+ * An output of '-' streams the measurements to stdout rather than saving a file.
+ *
+ * \param  sConfiguration  name of saved configuration to use (or NULL)
+ * \param  bCalibrate      calibrate before measuring
+ * \param  nSweeps         number of sweeps
+ * \param  spotSeconds     duration of spot frequency measurement (0 to sweep)
+ * \param  sFrequencies    spot frequencies (MHz) to measure in turn (or NULL)
+ * \param  sOutputs        NULL terminated array of output files (or NULL)
+ * \param  pbStream        pointer to flag set if measurements are to be streamed
+ * \return list of tSequenceStep or NULL on error
+ */
+GList *
+headlessSequence( gchar *sConfiguration, gboolean bCalibrate, gint nSweeps, gint spotSeconds,
+                  gchar *sFrequencies, gchar **sOutputs, gboolean *pbStream ) {
+    GList *sequence = NULL;
+    tSequenceStep *pStep;
+    static gchar *sFileTypes[] = { ".pdf", ".svg", ".png", ".csv", ".json" };
+
+    *pbStream = FALSE;
+
+    if( sConfiguration ) {
+        pStep = g_malloc0( sizeof( tSequenceStep ) );
+        pStep->action = eSeqConfiguration;
+        pStep->sArgument = g_strdup( sConfiguration );
+        sequence = g_list_append( sequence, pStep );
+    }
+
+    if( bCalibrate ) {
+        pStep = g_malloc0( sizeof( tSequenceStep ) );
+        pStep->action = eSeqCalibrate;
+        sequence = g_list_append( sequence, pStep );
+    }
+
+    pStep = g_malloc0( sizeof( tSequenceStep ) );
+    if( spotSeconds > 0 ) {
+        pStep->action = eSeqSpot;
+        pStep->count = spotSeconds;
+        if( sFrequencies ) {
+            tHP8970settings check = { 0 };
+            if( setMultiSpotFrequencies( &check, sFrequencies ) < 2 ) {
+                g_printerr( "Two or more spot frequencies are needed: %s\n", sFrequencies );
+                g_free( pStep );
+                freeSequence( sequence );
+                return NULL;
+            }
+            pStep->sArgument = g_strdup( sFrequencies );
+        }
+    } else {
+        pStep->action = eSeqSweep;
+        pStep->count = MAX( nSweeps, 1 );
+    }
+    sequence = g_list_append( sequence, pStep );
+
+    for( gint i = 0; sOutputs && sOutputs[ i ]; i++ ) {
+        gint fileType;
+
+        if( g_strcmp0( sOutputs[ i ], "-" ) == 0 ) {
+            *pbStream = TRUE;
+            continue;
+        }
+        for( fileType = 0; fileType < G_N_ELEMENTS( sFileTypes ); fileType++ )
+            if( g_str_has_suffix( sOutputs[ i ], sFileTypes[ fileType ] ) )
+                break;
+        if( fileType == G_N_ELEMENTS( sFileTypes ) ) {
+            g_printerr( "Cannot determine the type of output file %s (use .json, .csv, .pdf, .svg or .png)\n", sOutputs[ i ] );
+            freeSequence( sequence );
+            return NULL;
+        }
+
+        pStep = g_malloc0( sizeof( tSequenceStep ) );
+        pStep->action = eSeqSave;
+        pStep->fileType = fileType;
+        pStep->sArgument = g_strdup( sOutputs[ i ] );
+        sequence = g_list_append( sequence, pStep );
+    }
+
+    return sequence;
+}
+
+/*!     \brief  Report the latest progress of the measurement
+ *
+ * The progress posted since the last report is dropped.
+ */
+static void
+reportProgress( void ) {
+    tProgressEvent status, LO;
+    guint nRefreshPlot;
+    gchar sText[ MSG_STRING_SIZE ];
+    gint found = takeLatestProgress( &status, &LO, &nRefreshPlot );
+
+    if( found & PROGRESS_LO )
+        g_printerr( "%s\n", progressText( &LO, sText, MSG_STRING_SIZE ) );
+    if( found & PROGRESS_STATUS )
+        g_printerr( "%s\n", progressText( &status, sText, MSG_STRING_SIZE ) );
+}
+
+/*!     \brief  Run a measurement sequence without the GUI
+ *
+ * Start the GPIB thread, pass it the sequence and report the messages
+ * it sends until the sequence is complete. ^C aborts the measurement.
+ *
+ * \param  pGlobal   pointer to global data (queues & mutexes initialized)
+ * \param  sequence  list of tSequenceStep (this is freed by the GPIB thread)
+ * \param  bQuiet    only report errors
+ * \return EXIT_SUCCESS or EXIT_FAILURE if any error was reported
+ */
+gint
+runHeadless( tGlobal *pGlobal, GList *sequence, gboolean bQuiet ) {
+    struct sigaction action = { 0 };
+    messageEventData *message;
+    gboolean bError = FALSE, bAbortSent = FALSE;
+    gint nComplete = 0, nExpected = 1;
+
+    action.sa_handler = interruptHandler;
+    sigaction( SIGINT, &action, NULL );
+    sigaction( SIGTERM, &action, NULL );
+
+    // all settings are sent before the sequence begins
+    pGlobal->HP8970settings.updateFlags.all = ALL_FUNCTIONS;
+    pGlobal->pGThread = g_thread_new ("GPIBthread", threadGPIB, (gpointer) pGlobal);
+    postDataToGPIBThread (TG_RUN_SEQUENCE, sequence);
+
+    while( nComplete < nExpected ) {
+        if( bInterrupted && !bAbortSent ) {
+            postDataToGPIBThread (TG_ABORT, NULL);
+            // the abort is a command too
+            nExpected++;
+            bAbortSent = TRUE;
+        }
+
+        // (at most ten times a second while measuring)
+        if( !bQuiet )
+            reportProgress();
+
+        if( (message = getMessageForMainLoop( ms( 100 ) )) == NULL )
+            continue;
+
+        switch( message->command ) {
+        case TM_INFO:
+        case TM_INFO_LO:
+        case TM_INFO_HIGHLIGHT:
+            if( !bQuiet && message->sMessage && *message->sMessage )
+                g_printerr( "%s\n", message->sMessage );
+            break;
+        case TM_ERROR:
+        case TM_ERROR_LO:
+            g_printerr( "Error: %s\n", message->sMessage );
+            bError = TRUE;
+            break;
+        case TM_CALIBRATED:
+            recordCalibrationInConfigurations( pGlobal, *(guint32 *)message->data );
+            break;
+        case TM_COMPLETE_GPIB:
+            nComplete++;
+            break;
+        default:
+            break;
+        }
+
+        g_free( message->data );
+        releaseMessage( message );
+    }
+
+    message = g_malloc0( sizeof(messageEventData) );
+    message->command = TG_END;
+    g_async_queue_push( pGlobal->messageQueueToGPIB, message );
+    g_thread_join (pGlobal->pGThread);
+    pGlobal->pGThread = NULL;
+
+    return (bError || bInterrupted) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
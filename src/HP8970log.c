@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measurement log
+ *
+ * A spot frequency measurement may run for days. The measurement buffer only holds the latest
+ * MAX_SPOT_POINTS (for the plot); every measurement is also kept in the log as a 16 byte record
+ * (rather than the 32 byte tNoiseAndGain):
+ *
+ *   time       ms after the first record of its block of MEASUREMENT_LOG_BLOCK records (gint32)
+ *   noise      single precision (linear) .. far finer than the 0.01 dB resolution of the HP8970
+ *   gain       single precision (dB)
+ *   packed     the measurement flags and the HP8970 error codes of the noise and gain
+ *
+ * Each block has the full time of its first record, so any record can be found directly.
+ * When a record is promoted to a tNoiseAndGain the time, flags and error values (9.00e10 + code * 1e6)
+ * are rebuilt exactly as they were measured. The noise and gain are only as measured to single
+ * precision: they were rounded when logged (at most 6e-8 relative, about 3e-7 dB of noise and
+ * 2e-6 dB of a 50 dB gain .. well under the 0.01 dB the HP8970 reports).
+ */
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+#include <math.h>
+
+G_STATIC_ASSERT( sizeof( tCompactMeasurement ) == 16 );
+
+// packed word of a record
+#define LOG_FLAGS_MASK          0x000000ff      // tNoiseAndGain flags.all (only the low 8 bits are used)
+#define LOG_NOISE_CODE_SHIFT    8               // HP8970 error code of the noise
+#define LOG_GAIN_CODE_SHIFT     16              // HP8970 error code of the gain
+#define LOG_CODE_MASK           0xff
+#define LOG_NOISE_ERROR         (1 << 24)       // the noise is an HP8970 error
+#define LOG_GAIN_ERROR          (1 << 25)       // the gain is an HP8970 error
+
+/*!     \brief  Pack a value (noise or gain) of a measurement
+ *
+ * \param  value        the value (may be an HP8970 error)
+ * \param  pCompact     pointer to the single precision value
+ * \param  shift        position of the error code in the packed word
+ * \param  errorBit     bit of the packed word set if the value is an error
+ * \return the bits of the packed word for the value
+ */
+static guint32
+packValue( gdouble value, gfloat *pCompact, gint shift, guint32 errorBit ) {
+    if( IS_HP8970_ERROR( value ) ) {
+        *pCompact = 0.0;
+        return errorBit | (((guint32)round( (value - ERROR_INDICATOR_HP8970) / 1.0e6 ) & LOG_CODE_MASK) << shift);
+    } else {
+        *pCompact = (gfloat)value;
+        return 0;
+    }
+}
+
+/*!     \brief  Unpack a value (noise or gain) of a measurement
+ *
+ * \param  compact      the single precision value
+ * \param  packed       the packed word of the record
+ * \param  shift        position of the error code in the packed word
+ * \param  errorBit     bit of the packed word set if the value is an error
+ * \return the value (or HP8970 error)
+ */
+static gdouble
+unpackValue( gfloat compact, guint32 packed, gint shift, guint32 errorBit ) {
+    if( packed & errorBit )
+        return ERROR_INDICATOR_HP8970 + ((packed >> shift) & LOG_CODE_MASK) * 1.0e6;
+    else
+        return (gdouble)compact;
+}
+
+/*!     \brief  Add a measurement to the log
+ *
+ * Called by the GPIB thread for each spot frequency measurement. The log grows as needed.
+ *
+ * \param  pLog         pointer to the measurement log
+ * \param  pItem        pointer to the measurement (time abscissa)
+ * \return OK or ERROR if the time is too far from the start of its block to be kept
+ */
+gint
+appendToMeasurementLog( tMeasurementLog *pLog, tNoiseAndGain *pItem ) {
+    tCompactMeasurement *pRecord;
+    guint block;
+    gint64 offset;
+
+    g_mutex_lock( &pLog->mLog );
+    block = pLog->nRecords / MEASUREMENT_LOG_BLOCK;
+    if( pLog->nRecords == pLog->size ) {
+        pLog->size = pLog->size ? pLog->size * 2 : MEASUREMENT_LOG_BLOCK;
+        pLog->records = g_realloc( pLog->records, pLog->size * sizeof( tCompactMeasurement ) );
+        pLog->blockTime = g_realloc( pLog->blockTime, (pLog->size / MEASUREMENT_LOG_BLOCK) * sizeof( gint64 ) );
+    }
+
+    if( pLog->nRecords % MEASUREMENT_LOG_BLOCK == 0 )
+        pLog->blockTime[ block ] = pItem->abscissa.time;
+    offset = pItem->abscissa.time - pLog->blockTime[ block ];
+    // (about 24 days either side .. the clock may be stepped back)
+    if( offset > G_MAXINT32 || offset < G_MININT32 ) {
+        g_mutex_unlock( &pLog->mLog );
+        return ERROR;
+    }
+
+    pRecord = &pLog->records[ pLog->nRecords ];
+    pRecord->msOffset = (gint32)offset;
+    pRecord->packed = pItem->flags.all & LOG_FLAGS_MASK;
+    pRecord->packed |= packValue( pItem->noise, &pRecord->noise, LOG_NOISE_CODE_SHIFT, LOG_NOISE_ERROR );
+    pRecord->packed |= packValue( pItem->gain,  &pRecord->gain,  LOG_GAIN_CODE_SHIFT,  LOG_GAIN_ERROR );
+    pLog->nRecords++;
+    g_mutex_unlock( &pLog->mLog );
+
+    return OK;
+}
+
+/*!     \brief  Get a measurement from the log
+ *
+ * The caller must not be adding to the log (e.g. it is a copy in a snapshot).
+ *
+ * \param  pLog         pointer to the measurement log
+ * \param  item         index of the measurement (0 is the first)
+ * \param  pItem        pointer to the measurement to fill
+ * \return pointer to the measurement (pItem)
+ */
+tNoiseAndGain *
+measurementFromLog( tMeasurementLog *pLog, guint item, tNoiseAndGain *pItem ) {
+    tCompactMeasurement *pRecord = &pLog->records[ item ];
+
+    pItem->abscissa.time = pLog->blockTime[ item / MEASUREMENT_LOG_BLOCK ] + pRecord->msOffset;
+    pItem->noise = unpackValue( pRecord->noise, pRecord->packed, LOG_NOISE_CODE_SHIFT, LOG_NOISE_ERROR );
+    pItem->gain  = unpackValue( pRecord->gain,  pRecord->packed, LOG_GAIN_CODE_SHIFT,  LOG_GAIN_ERROR );
+    pItem->flags.all = pRecord->packed & LOG_FLAGS_MASK;
+
+    return pItem;
+}
+
+/*!     \brief  Free the records of the log
+ *
+ * Used when the log itself is discarded (no lock is taken).
+ *
+ * \param  pLog         pointer to the measurement log
+ */
+void
+freeMeasurementLog( tMeasurementLog *pLog ) {
+    g_free( pLog->records );
+    g_free( pLog->blockTime );
+    pLog->records = NULL;
+    pLog->blockTime = NULL;
+    pLog->nRecords = pLog->size = 0;
+}
+
+/*!     \brief  Empty the log
+ *
+ * \param  pLog         pointer to the measurement log
+ */
+void
+clearMeasurementLog( tMeasurementLog *pLog ) {
+    g_mutex_lock( &pLog->mLog );
+    freeMeasurementLog( pLog );
+    g_mutex_unlock( &pLog->mLog );
+}
+
+/*!     \brief  Copy the log (for a snapshot)
+ *
+ * The copy has its own records (only those used) and mutex.
+ *
+ * \param  pCopy        pointer to the copy
+ * \param  pSource      pointer to the measurement log
+ */
+void
+copyMeasurementLog( tMeasurementLog *pCopy, tMeasurementLog *pSource ) {
+    g_mutex_lock( &pSource->mLog );
+    pCopy->nRecords = pCopy->size = pSource->nRecords;
+    pCopy->records = g_memdup2( pSource->records, pSource->nRecords * sizeof( tCompactMeasurement ) );
+    pCopy->blockTime = g_memdup2( pSource->blockTime,
+                                  ((pSource->nRecords + MEASUREMENT_LOG_BLOCK - 1) / MEASUREMENT_LOG_BLOCK) * sizeof( gint64 ) );
+    g_mutex_unlock( &pSource->mLog );
+    g_mutex_init( &pCopy->mLog );
+}
@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Unattended measurement sequences
+ *
+ * A sequence file is plain text with one step per line ('#' starts a comment):
+ *
+ *      configuration <name>         restore a saved configuration (only the changed settings are sent)
+ *      calibrate                    calibrate the HP8970
+ *      sweep [N]                    sweep N times (the accumulators collect over the N passes)
+ *      spot <T> [f1 f2 ...]         spot frequency measurement for T seconds (at two or more
+ *                                   frequencies (MHz) in turn if given)
+ *      parameter <device> <start> <stop> <step> <command>
+ *                                   two dimensional sweep .. the command (e.g. VSET %.3lf) is sent to
+ *                                   the GPIB device (name, address or LO) to set each parameter value
+ *                                   and a frequency sweep is made at each
+ *      save json|csv|pdf|svg|png <filename pattern>
+ *
+ * In the filename pattern %c is replaced by the configuration name, %n by the step number,
+ * %d by the date and time and %% by a '%'. A relative filename is in the last used directory.
+ *
+ * The steps are run back-to-back on the GPIB thread. Files are written from a background thread
+ * using a snapshot of the plot so that the next measurement can begin immediately. Files saved
+ * one after the other (with no measurement between) share the one snapshot.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib-2.0/glib.h>
+#include <gpib/ib.h>
+#include <HP8970.h>
+
+#include "GPIBcomms.h"
+#include "messageEvent.h"
+
+static gchar *sFileTypes[] = { "pdf", "svg", "png", "csv", "json" };
+
+/*!     \brief  Free a sequence step
+ *
+ * \param  data       pointer to the tSequenceStep
+ */
+static void
+freeSequenceStep( gpointer data ) {
+    tSequenceStep *pStep = (tSequenceStep *)data;
+    g_free( pStep->sArgument );
+    g_free( pStep );
+}
+
+/*!     \brief  Free a sequence
+ *
+ * \param  sequence   list of tSequenceStep
+ */
+void
+freeSequence( GList *sequence ) {
+    g_list_free_full( sequence, freeSequenceStep );
+}
+
+/*!     \brief  Read a sequence file
+ *
+ * Parse the sequence file into a list of steps.
+ *
+ * \param  sFilename  path of the sequence file
+ * \return list of tSequenceStep or NULL on error
+ */
+GList *
+readSequenceFile( gchar *sFilename ) {
+    gchar *sContents = NULL, **lines, *sMessage;
+    GError *err = NULL;
+    GList *sequence = NULL;
+    gboolean bOK = TRUE;
+
+    if( !g_file_get_contents( sFilename, &sContents, NULL, &err ) ) {
+        sMessage = g_strdup_printf( "Cannot read sequence: %s", err->message );
+        postError( sMessage );
+        g_free( sMessage );
+        g_clear_error( &err );
+        return NULL;
+    }
+
+    lines = g_strsplit( sContents, "\n", -1 );
+    for( gint i = 0; bOK && lines[ i ] != NULL; i++ ) {
+        gchar *sLine = g_strstrip( lines[ i ] ), *sArgument;
+        gchar *sComment = strchr( sLine, '#' );
+        tSequenceStep step = { 0 };
+
+        if( sComment )
+            *sComment = 0;
+        g_strchomp( sLine );
+        if( *sLine == 0 )
+            continue;
+
+        // split the keyword from the rest of the line
+        sArgument = sLine + strcspn( sLine, " \t" );
+        if( *sArgument != 0 )
+            *sArgument++ = 0;
+        sArgument = g_strchug( sArgument );
+
+        if( g_ascii_strcasecmp( sLine, "configuration" ) == 0 && *sArgument != 0 ) {
+            step.action = eSeqConfiguration;
+            step.sArgument = g_strdup( sArgument );
+        } else if( g_ascii_strcasecmp( sLine, "calibrate" ) == 0 ) {
+            step.action = eSeqCalibrate;
+        } else if( g_ascii_strcasecmp( sLine, "sweep" ) == 0 ) {
+            step.action = eSeqSweep;
+            step.count = (*sArgument == 0) ? 1 : atoi( sArgument );
+            bOK = (step.count > 0);
+        } else if( g_ascii_strcasecmp( sLine, "spot" ) == 0 ) {
+            gchar *sFrequencies = sArgument + strcspn( sArgument, " \t" );
+            tHP8970settings check = { 0 };
+
+            step.action = eSeqSpot;
+            step.count = atoi( sArgument );
+            bOK = (step.count > 0);
+            // multi-spot frequencies
+            sFrequencies = g_strchug( sFrequencies );
+            if( bOK && *sFrequencies != 0 ) {
+                bOK = (setMultiSpotFrequencies( &check, sFrequencies ) >= 2);
+                step.sArgument = g_strdup( sFrequencies );
+            }
+        } else if( g_ascii_strcasecmp( sLine, "parameter" ) == 0 ) {
+            tParameterSweep parameter;
+
+            step.action = eSeqParameter;
+            step.sArgument = g_strdup( sArgument );
+            // (the mode is not known until the step is run .. the LO is checked then)
+            bOK = (parseParameterSweep( sArgument, &parameter, FALSE ) == OK);
+            g_free( parameter.sDevice );
+            g_free( parameter.sSetCommand );
+        } else if( g_ascii_strcasecmp( sLine, "save" ) == 0 ) {
+            gchar *sPattern = sArgument + strcspn( sArgument, " \t" );
+            if( *sPattern != 0 )
+                *sPattern++ = 0;
+            sPattern = g_strchug( sPattern );
+            step.action = eSeqSave;
+            step.fileType = G_N_ELEMENTS( sFileTypes );
+            for( gint type = 0; type < G_N_ELEMENTS( sFileTypes ); type++ )
+                if( g_ascii_strcasecmp( sArgument, sFileTypes[ type ] ) == 0 )
+                    step.fileType = type;
+            bOK = (step.fileType < G_N_ELEMENTS( sFileTypes ) && *sPattern != 0);
+            step.sArgument = g_strdup( sPattern );
+        } else {
+            bOK = FALSE;
+        }
+
+        if( bOK ) {
+            sequence = g_list_append( sequence, g_memdup2( &step, sizeof( tSequenceStep ) ) );
+        } else {
+            g_free( step.sArgument );
+            sMessage = g_strdup_printf( "Sequence error at line %d: \"%s\"", i + 1, sLine );
+            postError( sMessage );
+            g_free( sMessage );
+        }
+    }
+    g_strfreev( lines );
+    g_free( sContents );
+
+    if( !bOK ) {
+        freeSequence( sequence );
+        sequence = NULL;
+    } else if( sequence == NULL ) {
+        postError( "The sequence has no steps" );
+    }
+
+    return sequence;
+}
+
+/*!     \brief  Make the filename for a save step
+ *
+ * Substitute the tokens in the filename pattern and add the file type
+ * suffix if there is none.
+ *
+ * \param  pGlobal         pointer to global data
+ * \param  sPattern        filename pattern
+ * \param  sConfiguration  name of the last restored configuration (or NULL)
+ * \param  nStep           step number
+ * \param  fileType        type of file to be saved
+ * \return newly allocated filename
+ */
+static gchar *
+expandFilenamePattern( tGlobal *pGlobal, gchar *sPattern, gchar *sConfiguration,
+                       gint nStep, enum eFileType fileType ) {
+    GString *pstFilename = g_string_new( NULL );
+    gchar *sBasename, *sFilename, *sSubstitution;
+    GDateTime *now = g_date_time_new_now_local ();
+
+    for( gchar *pChar = sPattern; *pChar != 0; pChar++ ) {
+        if( *pChar != '%' || pChar[1] == 0 ) {
+            g_string_append_c( pstFilename, *pChar );
+            continue;
+        }
+        switch( *++pChar ) {
+        case 'c':
+            // a configuration name may contain characters that are not sensible in a filename
+            sSubstitution = g_strdup( sConfiguration ? sConfiguration : "none" );
+            g_strdelimit( sSubstitution, "/\\:*?\"<>| ", '_' );
+            g_string_append( pstFilename, sSubstitution );
+            g_free( sSubstitution );
+            break;
+        case 'n':
+            g_string_append_printf( pstFilename, "%02d", nStep );
+            break;
+        case 'd':
+            sSubstitution = g_date_time_format( now, "%Y%m%d-%H%M%S" );
+            g_string_append( pstFilename, sSubstitution );
+            g_free( sSubstitution );
+            break;
+        default:
+            g_string_append_c( pstFilename, *pChar );
+            break;
+        }
+    }
+    g_date_time_unref( now );
+
+    sBasename = g_path_get_basename( pstFilename->str );
+    if( strchr( sBasename, '.' ) == NULL )
+        g_string_append_printf( pstFilename, ".%s", sFileTypes[ fileType ] );
+    g_free( sBasename );
+
+    if( g_path_is_absolute( pstFilename->str ) || pGlobal->sLastDirectory == NULL )
+        sFilename = g_strdup( pstFilename->str );
+    else
+        sFilename = g_build_filename( pGlobal->sLastDirectory, pstFilename->str, NULL );
+
+    g_string_free( pstFilename, TRUE );
+    return sFilename;
+}
+
+/*!     \brief  Determine which settings differ between two configurations
+ *
+ * Only these need to be sent to the HP8970 when changing between configurations.
+ *
+ * \param  pCurrent   pointer to the current settings
+ * \param  pNew       pointer to the new settings
+ * \return update flags for the settings that have changed
+ */
+static tUpdateFlags
+settingsDelta( tHP8970settings *pCurrent, tHP8970settings *pNew ) {
+    tUpdateFlags delta = { .all = 0 };
+    gboolean bExtLO = !(pNew->mode == eMode1_0 || pNew->mode == eMode1_4);
+
+    // The frequency ranges for modes 1.1 - 1.3 are separate from those for 1.0 and 1.4
+    // and we must retune the LO if the way we set it has changed
+    if( pCurrent->mode != pNew->mode
+            || g_strcmp0( pCurrent->sExtLOsetup, pNew->sExtLOsetup ) != 0
+            || g_strcmp0( pCurrent->sExtLOsetFreq, pNew->sExtLOsetFreq ) != 0 ) {
+        delta.each.bMode = TRUE;
+        delta.each.bSpotFrequency = TRUE;
+        delta.each.bStartFrequency = TRUE;
+        delta.each.bStopFrequency = TRUE;
+        delta.each.bStepFrequency = TRUE;
+    } else {
+        delta.each.bSpotFrequency  = pCurrent->range[ bExtLO ].freqSpotMHz    != pNew->range[ bExtLO ].freqSpotMHz;
+        delta.each.bStartFrequency = pCurrent->range[ bExtLO ].freqStartMHz   != pNew->range[ bExtLO ].freqStartMHz;
+        delta.each.bStopFrequency  = pCurrent->range[ bExtLO ].freqStopMHz    != pNew->range[ bExtLO ].freqStopMHz;
+        delta.each.bStepFrequency  = pCurrent->range[ bExtLO ].freqStepCalMHz != pNew->range[ bExtLO ].freqStepCalMHz;
+    }
+
+    delta.each.bSmoothing = pCurrent->smoothingFactor != pNew->smoothingFactor;
+    delta.each.bNoiseUnits = pCurrent->noiseUnits != pNew->noiseUnits;
+    delta.each.bColdTemperature = pCurrent->coldTemp != pNew->coldTemp;
+    delta.each.bLossCompenstaion = pCurrent->switches.bLossCompensation != pNew->switches.bLossCompensation
+                                    || pCurrent->lossBeforeDUT != pNew->lossBeforeDUT
+                                    || pCurrent->lossAfterDUT != pNew->lossAfterDUT
+                                    || pCurrent->lossTemp != pNew->lossTemp;
+    delta.each.bCorrection = pCurrent->switches.bCorrectedNFAndGain != pNew->switches.bCorrectedNFAndGain;
+    delta.each.bExternalLO = pCurrent->extLOfreqIF != pNew->extLOfreqIF
+                                    || pCurrent->extLOfreqLO != pNew->extLOfreqLO
+                                    || pCurrent->extLOsideband != pNew->extLOsideband;
+    delta.each.bRFattenuation = pCurrent->RFattenuation != pNew->RFattenuation;
+    delta.each.bIFattenuation = pCurrent->IFattenuation != pNew->IFattenuation;
+
+    return delta;
+}
+
+/*!     \brief  Restore a saved configuration and send the changes to the HP8970
+ *
+ * \param  pGlobal          pointer to global data
+ * \param  sName            name of the configuration
+ * \param  descGPIB_HP8970  GPIB descriptor for HP8970 device
+ * \param  descGPIB_extLO   GPIB descriptor for the external LO
+ * \param  pGPIBstatus      pointer to GPIB status
+ * \return OK or ERROR
+ */
+static gint
+applyConfiguration( tGlobal *pGlobal, gchar *sName,
+                    gint descGPIB_HP8970, gint descGPIB_extLO, gint *pGPIBstatus ) {
+    GList *configurationItem;
+    tHP8970settings *pConfiguration;
+    tUpdateFlags delta;
+    gboolean bSpotFrequency, bAutoSweep, bAutoScaling;
+    gchar *sMessage;
+
+    configurationItem = g_list_find_custom ( pGlobal->configurationList, (gconstpointer)sName, compareFindConfiguration );
+    if( configurationItem == NULL ) {
+        sMessage = g_strdup_printf( "Sequence: there is no configuration named \"%s\"", sName );
+        postError( sMessage );
+        g_free( sMessage );
+        return ERROR;
+    }
+    pConfiguration = (tHP8970settings *)configurationItem->data;
+
+    g_mutex_lock ( &pGlobal->mUpdate );
+    delta = settingsDelta( &pGlobal->HP8970settings, pConfiguration );
+    delta.all |= pGlobal->HP8970settings.updateFlags.all;
+    // these are not part of the configuration
+    bSpotFrequency = pGlobal->HP8970settings.switches.bSpotFrequency;
+    bAutoSweep = pGlobal->HP8970settings.switches.bAutoSweep;
+    bAutoScaling = pGlobal->HP8970settings.switches.bAutoScaling;
+
+    freeConfigurationItemContent( (gpointer)&pGlobal->HP8970settings );
+    // This just copies the references to the strings, so we need to create new string copies
+    pGlobal->HP8970settings = *pConfiguration;
+    pGlobal->HP8970settings.sConfigurationName = NULL;
+    pGlobal->HP8970settings.sExtLOsetFreq = g_strdup( pConfiguration->sExtLOsetFreq );
+    pGlobal->HP8970settings.sExtLOsetup = g_strdup( pConfiguration->sExtLOsetup );
+
+    pGlobal->HP8970settings.switches.bSpotFrequency = bSpotFrequency;
+    pGlobal->HP8970settings.switches.bAutoSweep = bAutoSweep;
+    pGlobal->HP8970settings.switches.bAutoScaling = bAutoScaling;
+    pGlobal->HP8970settings.updateFlags = delta;
+    g_mutex_unlock ( &pGlobal->mUpdate );
+
+    postMessageToMainLoop( TM_REFRESH_SETTINGS, NULL );
+
+    if( delta.all != 0 )
+        sendSettingsHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus );
+
+    return GPIBsucceeded( *pGPIBstatus ) ? OK : ERROR;
+}
+
+/*!     \brief  Run a measurement sequence
+ *
+ * Run the steps of the sequence one after the other. The sequence stops
+ * on an error or if aborted (ESC).
+ * Files are written by a background thread; we wait for these to complete
+ * before returning.
+ *
+ * \param  pGlobal          pointer to global data
+ * \param  sequence         list of tSequenceStep
+ * \param  descGPIB_HP8970  GPIB descriptor for HP8970 device
+ * \param  descGPIB_extLO   GPIB descriptor for the external LO
+ * \param  pGPIBstatus      pointer to GPIB status
+ * \return TRUE if all steps completed
+ */
+gboolean
+runSequenceHP8970( tGlobal *pGlobal, GList *sequence, gint descGPIB_HP8970, gint descGPIB_extLO, gint *pGPIBstatus ) {
+    tPlotSnapshot *pSnapshot = NULL;
+    gchar *sConfiguration = NULL, *sMessage;
+    gboolean bOK = TRUE;
+    gint nStep = 1, nSteps = g_list_length( sequence );
+    gdouble multiSpotMHz[ MAX_MULTI_SPOT ];
+    gint nMultiSpot;
+
+    // settings that are still to be sent (say, the HP8970 has just been contacted)
+    if( pGlobal->HP8970settings.updateFlags.all != 0 )
+        sendSettingsHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus );
+
+    for( GList *item = sequence; item != NULL; item = item->next, nStep++ ) {
+        tSequenceStep *pStep = (tSequenceStep *)item->data;
+        gchar *sFilename;
+
+        if( checkMessageQueue( NULL ) == SEVER_DIPLOMATIC_RELATIONS ) {
+            bOK = FALSE;
+            break;
+        }
+
+        // the plot is about to change .. a later save needs a new snapshot
+        if( pStep->action != eSeqSave ) {
+            releasePlotSnapshot( pSnapshot );
+            pSnapshot = NULL;
+        }
+
+        switch( pStep->action ) {
+        case eSeqConfiguration:
+            sMessage = g_strdup_printf( "Sequence step %d/%d: configuration \"%s\"", nStep, nSteps, pStep->sArgument );
+            postInfo( sMessage );
+            g_free( sMessage );
+            bOK = (applyConfiguration( pGlobal, pStep->sArgument, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus ) == OK);
+            sConfiguration = pStep->sArgument;
+            break;
+
+        case eSeqCalibrate:
+            // no need to calibrate again if the HP8970 is already calibrated for these settings
+            if( isCalibrationValid( pGlobal ) ) {
+                postInfo( "HP8970 calibration is still valid 📏" );
+                bOK = TRUE;
+            } else {
+                bOK = calibrateHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus );
+            }
+            break;
+
+        case eSeqSweep:
+            // (the GUI reads and changes the settings while the sequence runs)
+            g_mutex_lock ( &pGlobal->mUpdate );
+            pGlobal->sweepPassLimit = pStep->count;
+            pGlobal->HP8970settings.switches.bAutoSweep = (pStep->count > 1);
+            g_mutex_unlock ( &pGlobal->mUpdate );
+
+            snapshotSettings( pGlobal );
+            bOK = sweepHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus, FALSE );
+
+            g_mutex_lock ( &pGlobal->mUpdate );
+            pGlobal->HP8970settings.switches.bAutoSweep = FALSE;
+            pGlobal->sweepPassLimit = 0;
+            g_mutex_unlock ( &pGlobal->mUpdate );
+            break;
+
+        case eSeqSpot:
+            // the frequencies of the step replace the multi-spot list (only for the step)
+            g_mutex_lock ( &pGlobal->mUpdate );
+            memcpy( multiSpotMHz, pGlobal->HP8970settings.multiSpotMHz, sizeof( multiSpotMHz ) );
+            nMultiSpot = pGlobal->HP8970settings.nMultiSpot;
+            if( pStep->sArgument )
+                setMultiSpotFrequencies( &pGlobal->HP8970settings, pStep->sArgument );
+            pGlobal->spotEndTime = g_get_monotonic_time() + pStep->count * G_USEC_PER_SEC;
+            pGlobal->HP8970settings.switches.bSpotFrequency = TRUE;
+            g_mutex_unlock ( &pGlobal->mUpdate );
+
+            snapshotSettings( pGlobal );
+            bOK = spotFrequencyHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus );
+
+            g_mutex_lock ( &pGlobal->mUpdate );
+            pGlobal->HP8970settings.switches.bSpotFrequency = FALSE;
+            pGlobal->spotEndTime = 0;
+            memcpy( pGlobal->HP8970settings.multiSpotMHz, multiSpotMHz, sizeof( multiSpotMHz ) );
+            pGlobal->HP8970settings.nMultiSpot = nMultiSpot;
+            g_mutex_unlock ( &pGlobal->mUpdate );
+            break;
+
+        case eSeqParameter:
+            {
+                tParameterSweep parameter;
+                gchar *sSpecification = g_strdup( pStep->sArgument );
+
+                sMessage = g_strdup_printf( "Sequence step %d/%d: two dimensional sweep", nStep, nSteps );
+                postInfo( sMessage );
+                g_free( sMessage );
+                // the external LO cannot be the parameter if the frequency sweep tunes it
+                if( parseParameterSweep( sSpecification, &parameter,
+                        pGlobal->flags.bNoLOcontrol == FALSE && pGlobal->HP8970settings.mode != eMode1_0 ) != OK ) {
+                    postError( "Sequence: the external LO is set by the sweep in this mode (it cannot be the parameter)" );
+                    g_free( sSpecification );
+                    bOK = FALSE;
+                    break;
+                }
+                g_free( sSpecification );
+
+                snapshotSettings( pGlobal );
+                bOK = parameterSweepHP8970( pGlobal, &parameter, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus );
+            }
+            break;
+
+        case eSeqSave:
+            if( pSnapshot == NULL )
+                pSnapshot = snapshotPlot( pGlobal );
+            sFilename = expandFilenamePattern( pGlobal, pStep->sArgument, sConfiguration, nStep, pStep->fileType );
+            writePlotSnapshot( refPlotSnapshot( pSnapshot ), pStep->fileType, sFilename );
+            g_free( sFilename );
+            break;
+        }
+
+        // (nStep is left at the step that failed)
+        if( !(bOK = bOK && GPIBsucceeded( *pGPIBstatus )) )
+            break;
+    }
+
+    // wait for the files to be written
+    releasePlotSnapshot( pSnapshot );
+    waitForSnapshotWriter();
+
+    if( bOK ) {
+        sMessage = g_strdup_printf( "Sequence of %d steps complete", nSteps );
+        postInfo( sMessage );
+    } else {
+        sMessage = g_strdup_printf( "Sequence ended at step %d of %d", nStep, nSteps );
+        postError( sMessage );
+    }
+    g_free( sMessage );
+
+    return bOK;
+}
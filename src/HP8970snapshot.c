@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Snapshots of the plot
+ *
+ * A snapshot (tPlotSnapshot) is a reference counted copy of the plot (the measurement, trace library,
+ * accumulator and two dimensional data together with the settings and strings needed to draw or save it).
+ * Only those are copied into its view; the widgets, queues etc. of the application are not.
+ * It is never changed once made, so any number of readers may use it, on any thread, without
+ * locks and while the GPIB thread carries on measuring. The last reader to release it frees it.
+ *
+ * The GPIB thread changes the plot between BEGIN_PLOT_UPDATE and END_PLOT_UPDATE (a point at a time,
+ * holding mPlotUpdate) and the copy is made holding the same mutex, so a snapshot is always of the plot
+ * as it was between two points. Neither waits longer than a point or a copy takes.
+ * The strings and calibration (which are reallocated) and the settings of the plot are changed and
+ * copied under mUpdate.
+ *
+ * Printing and the PDF, SVG, PNG, CSV & JSON files are made from a snapshot. Files are written
+ * by a background thread (in the order requested).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+#include "messageEvent.h"
+
+// A file to be written by the background writer
+typedef struct {
+    tPlotSnapshot *pSnapshot;
+    enum eFileType fileType;
+    gchar *sFilename;
+} tWriteJob;
+
+static GThreadPool *writerPool = NULL;
+static GMutex mWriterPool;
+
+/*!     \brief  Copy the data of the plot into the view of a snapshot
+ *
+ * Called holding mPlotUpdate (see snapshotPlot). The metadata and strings are copied under mUpdate.
+ *
+ * \param  pView      pointer to the view of the snapshot
+ * \param  pGlobal    pointer to global data
+ */
+static void
+copyPlotData( tGlobal *pView, tGlobal *pGlobal ) {
+    tTraceAccumulators *pAccum = &pGlobal->plot.accumulators, *pAccumCopy = &pView->plot.accumulators;
+
+    g_mutex_lock( &pGlobal->mUpdate );
+    // axes, flags and metadata (the data is copied below)
+    pView->plot = pGlobal->plot;
+    g_mutex_init( &pView->plot.mPlotUpdate );
+    pView->plot.sTitle = g_strdup( pGlobal->plot.sTitle );
+    pView->plot.sNotes = g_strdup( pGlobal->plot.sNotes );
+    pView->plot.sDateTime = g_strdup( pGlobal->plot.sDateTime );
+    pView->plot.sExtLOsetup = g_strdup( pGlobal->plot.sExtLOsetup );
+    pView->plot.sExtLOsetFreq = g_strdup( pGlobal->plot.sExtLOsetFreq );
+    pView->calibration = pGlobal->calibration;
+    pView->calibration.data = g_memdup2( pGlobal->calibration.data, pGlobal->calibration.nPoints * sizeof( tNoiseAndGain ) );
+    pView->calibration.sDateTime = g_strdup( pGlobal->calibration.sDateTime );
+    g_mutex_unlock( &pGlobal->mUpdate );
+
+    copyCircularBuffer( &pView->plot.measurementBuffer, &pGlobal->plot.measurementBuffer );
+    copyMeasurementLog( &pView->plot.spotLog, &pGlobal->plot.spotLog );
+    // the traces are never changed .. so are shared
+    copyTraceLibrary( &pView->plot.traceLibrary, &pGlobal->plot.traceLibrary );
+
+    g_mutex_lock( &pAccum->mAccumulators );
+    *pAccumCopy = *pAccum;
+    pAccumCopy->bins = g_memdup2( pAccum->bins, pAccum->nBins * sizeof( tAccumulatorBin ) );
+    pAccumCopy->historyStore = g_memdup2( pAccum->historyStore, pAccum->nBins * pAccum->length * 2 * sizeof( gdouble ) );
+    for( gint i = 0; i < pAccumCopy->nBins; i++ ) {
+        pAccumCopy->bins[ i ].noise.history = &pAccumCopy->historyStore[ (i * 2) * pAccumCopy->length ];
+        pAccumCopy->bins[ i ].gain.history  = &pAccumCopy->historyStore[ (i * 2 + 1) * pAccumCopy->length ];
+    }
+    g_mutex_unlock( &pAccum->mAccumulators );
+    g_mutex_init( &pAccumCopy->mAccumulators );
+    copySweep2D( &pView->plot.sweep2D, &pGlobal->plot.sweep2D );
+    // the snapshot makes its own marker index (if it needs one)
+    bzero( &pView->plot.markerIndex, sizeof( tMarkerIndex ) );
+}
+
+/*!     \brief  Free the data of the plot in the view of a snapshot
+ *
+ * \param  pView      pointer to the view of the snapshot
+ */
+static void
+freePlotData( tGlobal *pView ) {
+    freeCircularBuffer( &pView->plot.measurementBuffer );
+    freeMeasurementLog( &pView->plot.spotLog );
+    freeTraceLibrary( &pView->plot.traceLibrary );
+    g_free( pView->plot.accumulators.bins );
+    g_free( pView->plot.accumulators.historyStore );
+    g_mutex_clear( &pView->plot.measurementBuffer.mBuffer );
+    g_mutex_clear( &pView->plot.spotLog.mLog );
+    g_mutex_clear( &pView->plot.traceLibrary.mTraces );
+    g_mutex_clear( &pView->plot.accumulators.mAccumulators );
+    freeSweep2D( &pView->plot.sweep2D );
+    g_mutex_clear( &pView->plot.sweep2D.mSweep2D );
+    freeMarkerIndex( &pView->plot.markerIndex );
+    g_mutex_clear( &pView->plot.mPlotUpdate );
+
+    g_free( pView->plot.sTitle );
+    g_free( pView->plot.sNotes );
+    g_free( pView->plot.sDateTime );
+    g_free( pView->plot.sExtLOsetup );
+    g_free( pView->plot.sExtLOsetFreq );
+    g_free( pView->calibration.data );
+    g_free( pView->calibration.sDateTime );
+}
+
+/*!     \brief  Make a snapshot of the plot
+ *
+ * The plot is copied when the GPIB thread is between points (it waits for the copy
+ * to be made before it adds the next).
+ *
+ * \param  pGlobal    pointer to global data
+ * \return pointer to the snapshot (one reference .. release with releasePlotSnapshot)
+ */
+tPlotSnapshot *
+snapshotPlot( tGlobal *pGlobal ) {
+    tPlotSnapshot *pSnapshot = g_atomic_rc_box_new0( tPlotSnapshot );
+    tGlobal *pView = &pSnapshot->view;
+
+    // the display options that change what is drawn (but not the live marker or mode diagram)
+    pView->flags = pGlobal->flags;
+    pView->flags.bPreviewModeDiagram = FALSE;
+    pView->flags.bLiveMarkerActive = FALSE;
+    pView->accumulatorDisplay = pGlobal->accumulatorDisplay;
+    pView->PDFpaperSize = pGlobal->PDFpaperSize;
+
+    g_mutex_lock( &pGlobal->mUpdate );
+    pView->HP8970settings = pGlobal->HP8970settings;
+    pView->HP8970settings.sExtLOsetup = g_strdup( pGlobal->HP8970settings.sExtLOsetup );
+    pView->HP8970settings.sExtLOsetFreq = g_strdup( pGlobal->HP8970settings.sExtLOsetFreq );
+    pView->HP8970settings.sConfigurationName = NULL;
+    g_mutex_unlock( &pGlobal->mUpdate );
+    g_mutex_init( &pView->mUpdate );
+
+    g_mutex_lock( &pGlobal->plot.mPlotUpdate );
+    copyPlotData( pView, pGlobal );
+    g_mutex_unlock( &pGlobal->plot.mPlotUpdate );
+
+    return pSnapshot;
+}
+
+/*!     \brief  Free the content of a snapshot (when the last reference is released)
+ *
+ * \param  data       pointer to the snapshot
+ */
+static void
+clearPlotSnapshot( gpointer data ) {
+    tGlobal *pView = &((tPlotSnapshot *)data)->view;
+
+    freePlotData( pView );
+    g_mutex_clear( &pView->mUpdate );
+
+    g_free( pView->HP8970settings.sExtLOsetup );
+    g_free( pView->HP8970settings.sExtLOsetFreq );
+}
+
+/*!     \brief  Take another reference to a snapshot
+ *
+ * \param  pSnapshot  pointer to the snapshot
+ * \return pointer to the snapshot
+ */
+tPlotSnapshot *
+refPlotSnapshot( tPlotSnapshot *pSnapshot ) {
+    return g_atomic_rc_box_acquire( pSnapshot );
+}
+
+/*!     \brief  Release a reference to a snapshot
+ *
+ * The snapshot is freed when the last reference is released.
+ *
+ * \param  pSnapshot  pointer to the snapshot (may be NULL)
+ */
+void
+releasePlotSnapshot( tPlotSnapshot *pSnapshot ) {
+    if( pSnapshot )
+        g_atomic_rc_box_release_full( pSnapshot, clearPlotSnapshot );
+}
+
+/*!     \brief  Write a file (background writer thread)
+ *
+ * \param  data       pointer to the tWriteJob
+ * \param  udata      unused
+ */
+static void
+writeSnapshot( gpointer data, gpointer udata ) {
+    tWriteJob *pJob = (tWriteJob *)data;
+    tGlobal *pView = &pJob->pSnapshot->view;
+    gint rtn;
+    gchar *sMessage;
+
+    switch( pJob->fileType ) {
+    case eJSON:
+        rtn = savePlot( pJob->sFilename, pView );
+        break;
+    case eCSV:
+        rtn = saveCSV( pJob->sFilename, pView );
+        break;
+    default:
+        rtn = savePlotImage( pJob->sFilename, pView, pJob->fileType );
+        break;
+    }
+
+    if( rtn == OK ) {
+        sMessage = g_strdup_printf( "Saved %s", pJob->sFilename );
+        postInfo( sMessage );
+    } else {
+        sMessage = g_strdup_printf( "Failed to save %s", pJob->sFilename );
+        postError( sMessage );
+    }
+    g_free( sMessage );
+
+    releasePlotSnapshot( pJob->pSnapshot );
+    g_free( pJob->sFilename );
+    g_free( pJob );
+}
+
+/*!     \brief  Write a snapshot of the plot to a file in the background
+ *
+ * The files are written one at a time in the order they are requested.
+ *
+ * \param  pSnapshot  pointer to the snapshot (the reference is taken by the writer)
+ * \param  fileType   type of file
+ * \param  sFilename  path of the file to write
+ */
+void
+writePlotSnapshot( tPlotSnapshot *pSnapshot, enum eFileType fileType, gchar *sFilename ) {
+    tWriteJob *pJob = g_malloc0( sizeof( tWriteJob ) );
+
+    pJob->pSnapshot = pSnapshot;
+    pJob->fileType = fileType;
+    pJob->sFilename = g_strdup( sFilename );
+
+    g_mutex_lock( &mWriterPool );
+    // one thread so that the files are written in order
+    if( writerPool == NULL )
+        writerPool = g_thread_pool_new( writeSnapshot, NULL, 1, FALSE, NULL );
+    g_thread_pool_push( writerPool, pJob, NULL );
+    g_mutex_unlock( &mWriterPool );
+}
+
+/*!     \brief  Wait for the files requested to be written
+ */
+void
+waitForSnapshotWriter( void ) {
+    GThreadPool *pool;
+
+    g_mutex_lock( &mWriterPool );
+    pool = writerPool;
+    writerPool = NULL;
+    g_mutex_unlock( &mWriterPool );
+
+    if( pool )
+        g_thread_pool_free( pool, FALSE, TRUE );
+}
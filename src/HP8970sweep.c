@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <math.h>
 
@@ -69,249 +70,87 @@ LOfrequency( tGlobal *pGlobal, gdouble freqRF ) {
 }
 
 
-/*!     \brief  initialize a circular buffer
+/*!     \brief  Frequency of a point in the sweep
  *
- * Allocate buffer and set counters
+ * Step from the start frequency in the same way as the sweep does
+ * (the last step may be short to land on the stop frequency).
  *
- * \param  pCircBuffer      pointer to the circular buffer structure
- * \param  size             size of the new buffer
+ * \param  freqStartMHz     start frequency of the sweep
+ * \param  freqStopMHz      stop frequency of the sweep
+ * \param  freqStepMHz      step frequency of the sweep
+ * \param  point            index of the point in the sweep
+ * \return frequency of the point (or the stop frequency if beyond the end)
  */
-void
-initCircularBuffer( tCircularBuffer *pCircBuffer, guint size, tAbscissa abscissa ) {
-    g_mutex_lock ( &pCircBuffer->mBuffer );
-	size = size+1;	// add one so that tail != head when size items in buffer
-    pCircBuffer->measurementData = g_realloc( pCircBuffer->measurementData, size * sizeof( tNoiseAndGain ) );
-    pCircBuffer->head = 0;
-    pCircBuffer->tail = 0;
-    pCircBuffer->rewriteTail = 0;
-    pCircBuffer->size = size;
-
-    pCircBuffer->minNoise = UNINITIALIZED_DOUBLE;
-    pCircBuffer->maxNoise = UNINITIALIZED_DOUBLE;
-    pCircBuffer->minGain  = UNINITIALIZED_DOUBLE;
-    pCircBuffer->maxGain  = UNINITIALIZED_DOUBLE;
-
-    if( abscissa == eFreqAbscissa ) {
-        pCircBuffer->minAbscissa.freq  = UNINITIALIZED_DOUBLE;
-        pCircBuffer->maxAbscissa.freq  = UNINITIALIZED_DOUBLE;
-    } else {
-        pCircBuffer->minAbscissa.time  = 0;
-        pCircBuffer->maxAbscissa.time  = 0;
-    }
-    g_mutex_unlock ( &pCircBuffer->mBuffer );
-}
-
-/*!     \brief  get the number of items stored in a circular buffer
- *
- * get the number of items stored in a circular buffer
- *
- * \param  pCircBuffer      pointer to the circular buffer structure
- * \return number if items
- */
-gint
-nItemsInCircularBuffer( tCircularBuffer *pCircBuffer ) {
-    gint nItems = pCircBuffer->tail - pCircBuffer->head;
-
-    if( nItems < 0 )
-        nItems += pCircBuffer->size;
-
-    return( nItems );
-}
-
-/*!     \brief  recalculate extremes (min / max)
- *
- * recalculate extremes (min / max)
- *
- * \param  pCircBuffer      pointer to the circular buffer structure
- */
-void
-recalculateBoundaries( tCircularBuffer *pCircBuffer ) {
-
-    gint i, n, ptr;
-
-    g_mutex_lock ( &pCircBuffer->mBuffer );
-    pCircBuffer->minNoise = UNINITIALIZED_DOUBLE;
-    pCircBuffer->maxNoise = UNINITIALIZED_DOUBLE;
-    pCircBuffer->minGain  = UNINITIALIZED_DOUBLE;
-    pCircBuffer->maxGain  = UNINITIALIZED_DOUBLE;
-
-    for( i=0, ptr = pCircBuffer->head, n = nItemsInCircularBuffer( pCircBuffer ); i < n; i++, ptr++ ) {
-        updateBoundaries( pCircBuffer->measurementData[ ptr ].noise, &pCircBuffer->minNoise, &pCircBuffer->maxNoise );
-        updateBoundaries( pCircBuffer->measurementData[ ptr ].gain,  &pCircBuffer->minGain,  &pCircBuffer->maxGain );
-    }
-    g_mutex_unlock ( &pCircBuffer->mBuffer );
-}
-
-/*!     \brief  add item to a circular buffer
- *
- * add item to a circular buffer, possibly overwriting older data
- *
- * \param  pCircBuffer      pointer to the circular buffer structure
- * \param  pItem            pointer to the data
- * \param  bCircular        TRUE if we use the circular buffer property, overwiting old data
- * \return TRUE if no overflow (or FALSE if full)
- */
-gboolean
-addItemToCircularBuffer( tCircularBuffer *pCircBuffer, tNoiseAndGain *pItem, gboolean bCircular ) {
-    // if we full, either return (if we are told not to overwrite)
-    // or move the head, discarding the first item
-
-    gboolean bNeedRecalc = FALSE;
-    g_mutex_lock ( &pCircBuffer->mBuffer );
+gdouble
+sweepPointFrequency( gdouble freqStartMHz, gdouble freqStopMHz, gdouble freqStepMHz, guint point ) {
+    gdouble freqMHz = freqStartMHz;
 
-    if( (pCircBuffer->tail + 1) % pCircBuffer->size  == pCircBuffer->head ) {
-        if( !bCircular )
-            goto error;
+    for( guint i = 0; i < point && freqMHz != freqStopMHz; i++ ) {
+        if( freqMHz + freqStepMHz > freqStopMHz )
+            freqMHz = freqStopMHz;
         else
-            pCircBuffer->head = (pCircBuffer->head + 1)  % pCircBuffer->size;
-        bNeedRecalc = TRUE;
-    }
-    pCircBuffer->measurementData[ pCircBuffer->tail ] = *pItem;
-    pCircBuffer->tail = (pCircBuffer->tail + 1) % pCircBuffer->size;
-
-    // Update the minimum and maximum values
-    if( bNeedRecalc ) {
-        recalculateBoundaries( pCircBuffer );
-    } else {
-        updateBoundaries( pItem->noise, &pCircBuffer->minNoise, &pCircBuffer->maxNoise );
-        updateBoundaries( pItem->gain,  &pCircBuffer->minGain,  &pCircBuffer->maxGain );
+            freqMHz += freqStepMHz;
     }
-    g_mutex_unlock ( &pCircBuffer->mBuffer );
-    return TRUE;
-
-error:
-    g_mutex_unlock ( &pCircBuffer->mBuffer );
-    return FALSE;
+    return freqMHz;
 }
 
-/*!     \brief  rewrite over populated circular buffer
- *
- * rewrite over populated circular buffer
- *
- * \param  pCircBuffer      pointer to the circular buffer structure
- * \param  pItem            pointer to the data
- * \return TRUE if no overflow (or FALSE if full)
- */
-gboolean
-rewriteCircularBuffer( tCircularBuffer *pCircBuffer, tNoiseAndGain *pItem ) {
-
-    pCircBuffer->measurementData[ pCircBuffer->rewriteTail ] = *pItem;
-    pCircBuffer->rewriteTail = (pCircBuffer->rewriteTail + 1) % pCircBuffer->size;
-
-    recalculateBoundaries( pCircBuffer );
-    return TRUE;
-}
-
-/*!     \brief  get a particular item from a circular buffer
- *
- * get a particular item from a circular buffer
+/*!     \brief  Number of points in the sweep
  *
- * \param  pCircBuffer      pointer to the circular buffer structure
- * \param  item             position in the buffer of the data we want
+ * \param  freqStartMHz     start frequency of the sweep
+ * \param  freqStopMHz      stop frequency of the sweep
+ * \param  freqStepMHz      step frequency of the sweep
+ * \return number of points (including the start and stop frequencies)
  */
+guint
+sweepPointCount( gdouble freqStartMHz, gdouble freqStopMHz, gdouble freqStepMHz ) {
+    guint nPoints = 1;
 
-tNoiseAndGain *
-getItemFromCircularBuffer( tCircularBuffer *pCircBuffer, guint item ) {
-    if( item == LAST_ITEM ) {
-        if( pCircBuffer->tail == pCircBuffer->head ) {
-            return NULL;
-        } else {
-            if( pCircBuffer->tail >= 0 )
-                return( &pCircBuffer->measurementData[ pCircBuffer->tail-1 ] );
-            else
-                return( &pCircBuffer->measurementData[ pCircBuffer->size-1 ] );
-        }
-    }
-    if( item > pCircBuffer->size )
-        return NULL;
+    while( sweepPointFrequency( freqStartMHz, freqStopMHz, freqStepMHz, nPoints - 1 ) != freqStopMHz )
+        nPoints++;
 
-    item = ( item + pCircBuffer->head ) % pCircBuffer->size;
-
-    return( &pCircBuffer->measurementData[ item ] );
+    return nPoints;
 }
 
-/*!     \brief  determine minimum and maximum values for time/frequency based on the data
+/*!     \brief  Determine if there is an interrupted sweep that can be resumed
  *
- * determine minimum and maximum values for time/frequency based on the data
+ * The sweep can only be resumed if the points still to be measured would be comparable with
+ * those already measured: the frequency range and mode, the settings the calibration depends on
+ * (IF, LO, sideband, attenuation ..), the class of noise units (Y factor or noise factor),
+ * the smoothing and the corrections must be unchanged.
  *
- * \param  pCircBuffer      pointer to the circular buffer structure
- * \return 0 if OK or -1 if error
+ * \param  pGlobal          pointer to global data
+ * \param  psReason         pointer to the reason it cannot be resumed (set if FALSE is returned)
+ * \return TRUE if the sweep can be resumed
  */
-
 gboolean
-determineTimeExtremesInCircularBuffer( tCircularBuffer *pCircBuffer ) {
-    tNoiseAndGain *pFirst = getItemFromCircularBuffer( pCircBuffer, 0 );
-    tNoiseAndGain *pLast = getItemFromCircularBuffer( pCircBuffer, LAST_ITEM );
-
-    // empty
-    if( pCircBuffer->tail == pCircBuffer->head )
-                return ERROR;
-
-    pCircBuffer->minAbscissa.time = pFirst->abscissa.time;
-    pCircBuffer->maxAbscissa.time = pLast->abscissa.time;
-
-    return 0;
-}
-
-#define TIME_FROM_POSN( x, y ) pCircBuffer->measurementData[ ((x)->head + (y)) % (x)->size].abscissa.time
-
-// Function to find the closest element in the circular buffer
-gint
-findTimeDeltaInCircularBuffer(tCircularBuffer *pCircBuffer, gdouble delta) {
-    gint nItems = ((pCircBuffer->tail - pCircBuffer->head) + pCircBuffer->size) % pCircBuffer->size;
-    gint low = 0;              // index to first item
-    gint high = nItems - 1;    // index to last item / since they are ascending this is also the highest
-
-    // nonsense if no items
-    if( nItems == 0 )
-        return INVALID;
+canResumeSweepHP8970( tGlobal *pGlobal, const gchar **psReason ) {
+    tSweepCheckpoint *pCheckpoint = &pGlobal->plot.sweepCheckpoint;
+    tHP8970settings *pSettings = &pGlobal->HP8970settings;
+    tMode mode =  pSettings->mode;
+    gboolean bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
+
+    if( !pCheckpoint->flags.bValid || pGlobal->plot.flags.bSpotFrequencyPlot )
+        *psReason = "there is no interrupted sweep";
+    else if( pCheckpoint->mode != mode
+            || pCheckpoint->freqStartMHz != pSettings->range[ bExtLO ].freqStartMHz
+            || pCheckpoint->freqStopMHz  != pSettings->range[ bExtLO ].freqStopMHz
+            || pCheckpoint->freqStepMHz  != pSettings->range[ bExtLO ].freqStepSweepMHz )
+        *psReason = "the mode or frequency range has changed";
+    else if( pCheckpoint->calibrationKey != calibrationKey( pGlobal, pSettings ) )
+        *psReason = "the IF, LO, sideband, attenuation or ENR has changed";
+    else if( pCheckpoint->flags.bYfactor != IS_Y_FACTOR( pSettings->noiseUnits ) )
+        *psReason = "the noise units have changed between Y factor and noise factor";
+    else if( pCheckpoint->smoothingFactor != pSettings->smoothingFactor )
+        *psReason = "the smoothing has changed";
+    else if( pCheckpoint->flags.bCorrectedNFAndGain != pSettings->switches.bCorrectedNFAndGain
+            || pCheckpoint->flags.bLossCompensation != pSettings->switches.bLossCompensation )
+        *psReason = "the correction or loss compensation has changed";
+    else
+        return TRUE;
 
-    gint64 lowTime, highTime;
-
-    lowTime  = TIME_FROM_POSN( pCircBuffer, low );
-    highTime = TIME_FROM_POSN( pCircBuffer, high );
-
-    // if delta is 10.0 seconds, then look for the last time-10 seconds
-    gint64 target = highTime - (gint64)(delta * 1.0e3);
-
-    // Corner cases
-    if (target <= lowTime)  return low;
-    if (target >= highTime) return high;
-
-    // Binary search
-    while (low <= high) {
-        gint mid = low + (high - low) / 2;
-        gdouble midTime = TIME_FROM_POSN( pCircBuffer, mid );
-
-        lowTime  = TIME_FROM_POSN( pCircBuffer, low );
-        highTime = TIME_FROM_POSN( pCircBuffer, high );
-
-        if ( midTime == target) return mid; // Exact match
-
-        // Update the closest element if necessary
-        if (abs(midTime - target) < abs(lowTime - target)) {
-            low = mid;
-        }
-
-        if (midTime < target) {
-            low  = mid + 1; // Search in upper half
-        } else {
-            high = mid - 1; // Search in lower half
-        }
-    }
-
-    // At this point, low is either equal to high or one position ahead
-    // We need to compare the elements at low and low-1 to find the closest
-    gint64 lowMinusOneTime = TIME_FROM_POSN( pCircBuffer, low -1 );
-    if (low > 0 && abs( lowMinusOneTime - target) < abs(lowTime - target)) {
-        return low - 1;
-    } else {
-        return low;
-    }
+    return FALSE;
 }
 
-
-
 /*!     \brief  Sweep the HP8970 to obtain noise figure (and gain)
  *
  * Sweep the HP8970 to obtain noise figure (and gain)
@@ -320,27 +159,44 @@ findTimeDeltaInCircularBuffer(tCircularBuffer *pCircBuffer, gdouble delta) {
  * \param  descGPIB_HP8970  descriptor of the HP8970 GPIB connection
  * \param  descGPIB_extLO   descriptor of the external LO GPIB connection
  * \param  pGPIBstatus      pointer to the GPIB status
+ * \param  bResume          continue an interrupted sweep from the checkpoint (rather than start afresh)
  * \return TRUE if successful
  */
 gboolean
-sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *pGPIBstatus ) {
+sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *pGPIBstatus, gboolean bResume ) {
     gint HP8970error;
     GString *pstCommands;
     gchar HP8970status, LOstatus;;
-    gboolean completionStatus = FALSE, bInitialSweep;
-    gdouble LOfreq = 0.0, expectedMeasurementTime = pGlobal->HP8970settings.smoothingFactor * APPROX_MEASUREMENT_TIME;
+    gboolean completionStatus = FALSE, bInitialSweep = TRUE, bSweepStarted = FALSE;
+    gdouble LOfreq = 0.0, expectedMeasurementTime;
     gboolean bLOerror = FALSE;
     tMode mode =  pGlobal->HP8970settings.mode;
+    tSweepCheckpoint *pCheckpoint = &pGlobal->plot.sweepCheckpoint;
+    guint nSweepPoint = 0, nPointsInSweep = 0, nPass = 1;
+    gdouble freqMHz = 0.0, storedMHz = -1.0;
+    gchar *sMessage, *sResume;
+    tSweepEstimate *pEstimate = &pGlobal->sweepEstimate;
+    gdouble LOtunedFreq = 0.0;
+    gboolean bSerpentine, bDescending = FALSE, bSpotStepped = FALSE;
+    gint64 settlingSaved_ms = 0;
+    // units the HP8970 is set to (the noise is kept linear)
+    tNoiseType noiseUnits = pGlobal->HP8970settings.noiseUnits;
+    tProgressEvent progress = { 0 };
+    tArena arena;
+
+    // In modes 1.1 & 1.3 every point retunes the LO. Repeated (auto) sweeps go alternately up and down
+    // in frequency (serpentine) so the LO is never sent back across the whole range.
+    bSerpentine = pGlobal->flags.bNoLOcontrol == FALSE && ( mode == eMode1_1 || mode == eMode1_3 );
 
     while TRUE {
         pstCommands = g_string_new ( NULL );
         gboolean bExtLO;
-        gdouble freqMHz, freqStartMHz, freqStopMHz, freqStepMHz;
+        gdouble freqStartMHz, freqStopMHz, freqStepMHz;
         gboolean bContinue;
-        gchar *sMessage;
 
-        postInfo( "HP8970 data sweep 🧹");
-        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], FALSE );
+        postInfo( bResume ? "HP8970 data sweep resumed 🧹" : "HP8970 data sweep 🧹");
+        if( !pGlobal->flags.bHeadless )
+            gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], FALSE );
 
         // snapshot of the settings we need to send
         bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
@@ -349,19 +205,40 @@ sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *
         freqStopMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz;
         freqStepMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStepSweepMHz;
 
+        nPointsInSweep = sweepPointCount( freqStartMHz, freqStopMHz, freqStepMHz );
+
+        // A resumed sweep continues from the point after the last one we stored
+        if( bResume ) {
+            nSweepPoint = pCheckpoint->nextPoint;
+            nPass = pCheckpoint->nPass;
+            bInitialSweep = pCheckpoint->flags.bInitialSweep;
+            bSpotStepped = bDescending = pCheckpoint->flags.bDescending;
+        } else {
+            nSweepPoint = 0;
+            nPass = 1;
+            bInitialSweep = TRUE;
+            bDescending = FALSE;
+        }
+        freqMHz = sweepPointFrequency( freqStartMHz, freqStopMHz, freqStepMHz,
+                                       bDescending ? nPointsInSweep - 1 - nSweepPoint : nSweepPoint );
+        pCheckpoint->flags.bValid = FALSE;
+        // a resumed sweep already has its data buffer
+        bSweepStarted = bResume;
+
         // Set the external signal generator (LO) for higher modes
         if( pGlobal->flags.bNoLOcontrol == FALSE && mode != eMode1_0 ) {
             if( pGlobal->HP8970settings.sExtLOsetup )
                 if( GPIBasyncWrite (descGPIB_extLO, pGlobal->HP8970settings.sExtLOsetup, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK )
                     break;
             // We only have to set the LO frequency once for modes 1.2 and 1.4
-            if( ( LOfreq = LOfrequency( pGlobal, freqStartMHz ) ) != 0.0 ) {
+            if( ( LOfreq = LOfrequency( pGlobal, freqMHz ) ) != 0.0 ) {
                 g_string_printf( pstCommands, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq );
                 if( GPIBasyncWrite (descGPIB_extLO, pstCommands->str, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
                     bLOerror = TRUE;
                     break;
                 }
                 *pGPIBstatus = ibrsp (descGPIB_extLO, &LOstatus); // get the status byte from the LO
+                LOtunedFreq = LOfreq;
                 sMessage = g_strdup_printf( "Signal Generator (LO): %.0lf MHz", LOfreq );
                 postInfoLO( sMessage );
                 g_free( sMessage );
@@ -382,12 +259,12 @@ sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *
                       (gint) pGlobal->HP8970settings.extLOfreqLO,
 
                       pGlobal->HP8970settings.extLOsideband,
-                      (gint)freqStartMHz,
+                      (gint)(bDescending ? freqStartMHz : freqMHz),
                       (gint)freqStopMHz,
                       (gint)freqStepMHz,
                       (gint)round( log2( pGlobal->HP8970settings.smoothingFactor ) ),
 
-                      pGlobal->HP8970settings.noiseUnits,
+                      noiseUnits,
                       pGlobal->HP8970settings.mode,
                       // D0 - input temperature units K
                       pGlobal->HP8970settings.coldTemp,
@@ -404,62 +281,76 @@ sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *
 
         *pGPIBstatus = ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
 
-        initCircularBuffer( &pGlobal->plot.measurementBuffer, (freqStopMHz - freqStartMHz) / freqStepMHz + 2, eFreqAbscissa );
-
-        pGlobal->plot.measurementBuffer.minAbscissa.freq  = freqStartMHz * MHz(1.0);
-        pGlobal->plot.measurementBuffer.maxAbscissa.freq  = freqStopMHz * MHz(1.0);
-        pGlobal->plot.flags.bSpotFrequencyPlot = FALSE;
+        // A resumed sweep merges into the data we already have
+        if( !bResume ) {
+            BEGIN_PLOT_UPDATE( &pGlobal->plot );
+            initCircularBuffer( &pGlobal->plot.measurementBuffer, (freqStopMHz - freqStartMHz) / freqStepMHz + 2, eFreqAbscissa );
+            pGlobal->plot.measurementBuffer.flags.bYfactor = IS_Y_FACTOR( noiseUnits );
+            // per-frequency statistics over repeated (auto) sweeps
+            initTraceAccumulators( &pGlobal->plot.accumulators, (freqStopMHz - freqStartMHz) / freqStepMHz + 2,
+                                   pGlobal->plot.accumulators.length );
+
+            pGlobal->plot.measurementBuffer.minAbscissa.freq  = freqStartMHz * MHz(1.0);
+            pGlobal->plot.measurementBuffer.maxAbscissa.freq  = freqStopMHz * MHz(1.0);
+            pGlobal->plot.flags.bSpotFrequencyPlot = FALSE;
+            END_PLOT_UPDATE( &pGlobal->plot );
+            bSweepStarted = TRUE;
+        }
 
         // Initially do a frequency sweep which uses the step increment in the 8970
         // initiate a single sweep
         enableSRQonDataReady (descGPIB_HP8970, pGPIBstatus);
-        GPIBasyncWrite (descGPIB_HP8970, "W2", pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
+        if( bDescending ) {
+            // (resuming a descending pass) each point is set as a spot frequency
+            g_string_printf( pstCommands, "W0FR%dMZ", (gint)freqMHz );
+            GPIBasyncWrite (descGPIB_HP8970, pstCommands->str, pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
+        } else {
+            GPIBasyncWrite (descGPIB_HP8970, "W2", pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
+        }
 
-        pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
-        pGlobal->plot.measurementBuffer.flags.bValidGainData = FALSE;
+        if( !bResume ) {
+            BEGIN_PLOT_UPDATE( &pGlobal->plot );
+            pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
+            pGlobal->plot.measurementBuffer.flags.bValidGainData = FALSE;
 
-        getTimeStamp(&pGlobal->plot.sDateTime);
+            g_mutex_lock( &pGlobal->mUpdate );
+            getTimeStamp(&pGlobal->plot.sDateTime);
+            g_mutex_unlock( &pGlobal->mUpdate );
+            END_PLOT_UPDATE( &pGlobal->plot );
+        }
+
+        startSweepEstimate( pEstimate, &pGlobal->HP8970settings, nPointsInSweep, nSweepPoint );
+        initArena( &arena, ACQUISITION_ARENA_SIZE );
 
         // Sweep with the sweep step (may not be the same as the calibration step)
-        for( freqMHz = freqStartMHz, bContinue = TRUE, bInitialSweep = TRUE;
+        for( bContinue = TRUE;
                 GPIBsucceeded( *pGPIBstatus ) && bContinue && checkMessageQueue(NULL) != SEVER_DIPLOMATIC_RELATIONS; ) {
 
             tNoiseAndGain measurement;
+            // position of this point in the sweep (the plot is always in frequency order)
+            guint nPoint = bDescending ? nPointsInSweep - 1 - nSweepPoint : nSweepPoint;
             measurement.flags.all = 0;
+            resetArena( &arena );
 
-            // This is the last measurement
-            if( freqMHz == freqStopMHz )
+            // This is the last measurement of the pass
+            if( freqMHz == (bDescending ? freqStartMHz : freqStopMHz) )
                 bContinue = FALSE;
 
+            // the timeout is based on what we have learned of the measurement time
+            expectedMeasurementTime = triggerPointEstimate( pEstimate, pGlobal->HP8970settings.smoothingFactor );
             if( GPIBtriggerMeasurement (descGPIB_HP8970, &measurement,
                                         pGPIBstatus, &HP8970error, expectedMeasurementTime) != eRDWT_OK )
                 break;  // this will exit the for loop if error
+            measuredPointEstimate( pEstimate );
 
-            if( freqMHz + freqStepMHz > freqStopMHz ) {
+            if( bDescending ) {
+                freqMHz = sweepPointFrequency( freqStartMHz, freqStopMHz, freqStepMHz, nPoint > 0 ? nPoint - 1 : 0 );
+            } else if( freqMHz + freqStepMHz > freqStopMHz ) {
                 freqMHz = freqStopMHz;
             } else {
                 freqMHz += freqStepMHz;
             }
 
-            // Changing the LO only in mode 1.1 & 1.3 (1.2 & 1.4 have a fixed LO that we already set)
-            if( pGlobal->flags.bNoLOcontrol == FALSE && ( mode == eMode1_1 || mode == eMode1_3 ) ) {
-
-                if( ( LOfreq = LOfrequency( pGlobal, freqMHz ) ) != 0.0 ) {
-                    g_string_printf( pstCommands, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq );
-
-                    if( GPIBasyncWrite (descGPIB_extLO, pstCommands->str, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
-                        bLOerror = TRUE;
-                        break;
-                    }
-                    *pGPIBstatus = ibrsp (descGPIB_extLO, &LOstatus); // get the status byte from the LO
-                }
-                sMessage = g_strdup_printf( "Signal Generator (LO): %.0lf MHz", LOfreq );
-                postInfoLO( sMessage );
-                g_free( sMessage );
-
-                usleep( pGlobal->HP8970settings.settlingTime_ms * 1000 );
-            }
-
             measurement.flags.each.bNoiseInvalid =
                     IS_HP8970_ERROR( measurement.noise );
             measurement.flags.each.bNoiseOverflow =
@@ -469,7 +360,9 @@ sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *
                     IS_HP8970_ERROR( measurement.gain );
             measurement.flags.each.bGainOverflow =
                     IS_HP8970_OVERFLOW( measurement.gain );
+            measurement.noise = linearNoise( measurement.noise, noiseUnits );
 
+            BEGIN_PLOT_UPDATE( &pGlobal->plot );
             if( measurement.flags.each.bNoiseInvalid == FALSE )
                 pGlobal->plot.measurementBuffer.flags.bValidNoiseData = TRUE;
             if( measurement.flags.each.bGainInvalid == FALSE )
@@ -477,30 +370,85 @@ sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *
 
             if( bInitialSweep )
             	addItemToCircularBuffer( &pGlobal->plot.measurementBuffer, &measurement, FALSE );
+            else if( bDescending )
+                rewritePointInCircularBuffer( &pGlobal->plot.measurementBuffer, nPoint, &measurement );
             else
             	rewriteCircularBuffer( &pGlobal->plot.measurementBuffer, &measurement );
+            accumulateMeasurement( &pGlobal->plot.accumulators, nPoint, &measurement );
+            END_PLOT_UPDATE( &pGlobal->plot );
+            completePointEstimate( pEstimate, ++nSweepPoint );
+            storedMHz = measurement.abscissa.freq / MHz( 1.0 );
+            progress.type = eProgressSweep;
+            progress.nPoint = nPoint;
+            progress.freqMHz = measurement.abscissa.freq / MHz( 1.0 );
+            progress.HP8970error = HP8970error;
+            progress.bRefreshPlot = TRUE;
+            sweepProgress( pEstimate, &progress.percent, &progress.pointsPerSec, &progress.ETA );
+            if( pGlobal->flags.bStreamMeasurements )
+                streamMeasurement( pGlobal, &measurement, FALSE );
 
             // We have reached the terminal frequency but do we need to loop (auto trigger)?
-            if( bContinue == FALSE && pGlobal->HP8970settings.switches.bAutoSweep ) {
+            // (the sequencer may limit the number of passes)
+            if( bContinue == FALSE && pGlobal->HP8970settings.switches.bAutoSweep
+                    && ( pGlobal->sweepPassLimit == 0 || ++nPass <= pGlobal->sweepPassLimit ) ) {
                 bContinue = TRUE;
                 bInitialSweep = FALSE;
-                freqMHz = freqStartMHz;
-                pGlobal->plot.measurementBuffer.rewriteTail = pGlobal->plot.measurementBuffer.head;
-                GPIBasyncWrite (descGPIB_HP8970, "W2", pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
+                nSweepPoint = 0;
+                if( bSerpentine ) {
+                    // Sweep back the way we came .. the LO is already where the next pass begins
+                    // (in ascending order it would be retuned to the start frequency and settled again)
+                    settlingSaved_ms += pGlobal->HP8970settings.settlingTime_ms;
+                    bDescending = !bDescending;
+                    bSpotStepped = TRUE;
+                }
+                if( bDescending ) {
+                    freqMHz = freqStopMHz;
+                    // the HP8970 only sweeps upward, so each point is set as a spot frequency
+                    GPIBasyncWrite (descGPIB_HP8970, "W0", pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
+                } else {
+                    freqMHz = freqStartMHz;
+                    pGlobal->plot.measurementBuffer.rewriteTail = pGlobal->plot.measurementBuffer.head;
+                    // (a resumed sweep will have started the HP8970 part way through the range)
+                    GPIBasyncWrite (descGPIB_HP8970, arenaPrintf( &arena, "FA%dMZW2", (gint)freqStartMHz ),
+                                    pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
+                }
             }
 
-            if( HP8970error ) {
-                sMessage = g_strdup_printf( "Sweep: %.0lf MHz ☠️  %s",
-                                            measurement.abscissa.freq / MHz( 1.0 ),
-                                            HP8970errorString( HP8970error ) );
-            } else {
-                sMessage = g_strdup_printf( "Sweep: %.0lf MHz",
-                                            measurement.abscissa.freq / MHz( 1.0 ) );
+            // errors 20 .. 25 indicate the HP8970 is not calibrated for these settings
+            if( HP8970error >= 20 && HP8970error <= 25 )
+                invalidateCalibration( pGlobal );
+
+            postProgress( &progress );
+
+            if( !bContinue )
+                continue;
+
+            // Changing the LO only in mode 1.1 & 1.3 (1.2 & 1.4 have a fixed LO that we already set)
+            // .. and only if it moves (it does not at the turn of a serpentine sweep)
+            if( pGlobal->flags.bNoLOcontrol == FALSE && ( mode == eMode1_1 || mode == eMode1_3 )
+                    && ( LOfreq = LOfrequency( pGlobal, freqMHz ) ) != 0.0 && LOfreq != LOtunedFreq ) {
+                if( GPIBasyncWrite (descGPIB_extLO, arenaPrintf( &arena, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq ),
+                                    pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
+                    bLOerror = TRUE;
+                    break;
+                }
+                *pGPIBstatus = ibrsp (descGPIB_extLO, &LOstatus); // get the status byte from the LO
+                LOtunedFreq = LOfreq;
+
+                progress.type = eProgressLO;
+                progress.freqMHz = LOfreq;
+                progress.bRefreshPlot = FALSE;
+                postProgress( &progress );
+
+                usleep( pGlobal->HP8970settings.settlingTime_ms * 1000 );
             }
-            postInfo( sMessage );
-            g_free( sMessage );
-            postMessageToMainLoop(TM_REFRESH_PLOT, NULL);
+
+            // a descending pass sets the HP8970 to each frequency
+            if( bDescending )
+                GPIBasyncWrite (descGPIB_HP8970, arenaPrintf( &arena, "FR%dMZ", (gint)freqMHz ),
+                                pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
         }
+        freeArena( &arena );
 
         GPIBasyncWrite (descGPIB_HP8970, "T0Q0", pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
         completionStatus = TRUE;
@@ -509,37 +457,191 @@ sweepHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gint *
         break;
     }
     g_string_free ( pstCommands, TRUE );
+    logAllocationCounters( "Sweep" );
+
+    // Checkpoint an incomplete sweep so that it may be resumed (in the direction it was going)
+    if( bSweepStarted && nSweepPoint < nPointsInSweep ) {
+        gboolean bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
+        pCheckpoint->freqStartMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz;
+        pCheckpoint->freqStopMHz  = pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz;
+        pCheckpoint->freqStepMHz  = pGlobal->HP8970settings.range[ bExtLO ].freqStepSweepMHz;
+        pCheckpoint->mode         = mode;
+        pCheckpoint->nextPoint    = nSweepPoint;
+        pCheckpoint->nPass        = nPass;
+        pCheckpoint->calibrationKey  = calibrationKey( pGlobal, &pGlobal->HP8970settings );
+        pCheckpoint->smoothingFactor = pGlobal->HP8970settings.smoothingFactor;
+        pCheckpoint->flags.bInitialSweep = bInitialSweep;
+        pCheckpoint->flags.bDescending   = bDescending;
+        pCheckpoint->flags.bAutoSweep    = pGlobal->HP8970settings.switches.bAutoSweep;
+        pCheckpoint->flags.bYfactor      = IS_Y_FACTOR( pGlobal->HP8970settings.noiseUnits );
+        pCheckpoint->flags.bCorrectedNFAndGain = pGlobal->HP8970settings.switches.bCorrectedNFAndGain;
+        pCheckpoint->flags.bLossCompensation   = pGlobal->HP8970settings.switches.bLossCompensation;
+        pCheckpoint->flags.bValid = TRUE;
+    }
+
+    // The points measured so far are kept .. the sweep can be resumed with F5
+    if( !pCheckpoint->flags.bValid )
+        sResume = g_strdup( "" );
+    else if( storedMHz < 0.0 )
+        sResume = g_strdup( " .. interrupted (F5 to resume)" );
+    else
+        sResume = g_strdup_printf( " .. interrupted after %.0lf MHz (F5 to resume)", storedMHz );
 
     if( GPIBfailed( *pGPIBstatus ) ) {
         if( bLOerror ) {
-            postErrorLO( "Communications failure with signal generator (LO)" );
+            sMessage = g_strdup_printf( "Communications failure with signal generator (LO)%s", sResume );
+            postErrorLO( sMessage );
         } else {
-            postError( "Communications failure with HP8790" );
+            sMessage = g_strdup_printf( "Communications failure with HP8790%s", sResume );
+            postError( sMessage );
         }
-        pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
-        pGlobal->plot.measurementBuffer.flags.bValidGainData  = FALSE;
+        g_free( sMessage );
     } else if( HP8970error > 0 ) {
-        gchar *sError = g_strdup_printf( "HP8970 error: %s", HP8970errorString( HP8970error ) );
+        gchar *sError = g_strdup_printf( "HP8970 error: %s%s", HP8970errorString( HP8970error ), sResume );
         postError( sError );
         g_free( sError );
     } else {
-        postInfo( "HP8970 data sweep OK");
+        if( pCheckpoint->flags.bValid ) {
+            // interrupted (ESC)
+            sMessage = g_strdup_printf( "HP8970 data sweep%s", sResume );
+            postInfo( sMessage );
+            g_free( sMessage );
+        } else if( settlingSaved_ms > 0 ) {
+            sMessage = g_strdup_printf( "HP8970 data sweep OK (serpentine order saved %.1lf s of LO settling)",
+                                        settlingSaved_ms / 1000.0 );
+            postInfo( sMessage );
+            g_free( sMessage );
+        } else {
+            postInfo( "HP8970 data sweep OK");
+        }
         postInfoLO( "");
         postMessageToMainLoop(TM_REFRESH_PLOT, NULL);
     }
+    g_free( sResume );
+
+    // The HP8970 start frequency was moved for the resumed sweep .. restore it
+    if( bResume )
+        UPDATE_8970_SETTING( pGlobal, pGlobal->HP8970settings.updateFlags.each.bStartFrequency );
+    // .. and the spot frequency was used to step down in frequency
+    if( bSpotStepped )
+        UPDATE_8970_SETTING( pGlobal, pGlobal->HP8970settings.updateFlags.each.bSpotFrequency );
 
     if( pGlobal->flags.bNoLOcontrol == FALSE && mode != eMode1_0 )
         ibloc(descGPIB_HP8970);
 
     ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
-    gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
-    gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_SaveJSON ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+    if( !pGlobal->flags.bHeadless ) {
+        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_SaveJSON ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+    }
 
     return completionStatus;
 }
 
 
 
+/*!     \brief  Add a frequency to the multi-spot list
+ *
+ * The list is kept in ascending order (without duplicates). Measured in this order
+ * the LO moves the least in each round of the frequencies and every frequency is
+ * measured at the same interval.
+ *
+ * \param  pSettings        pointer to the HP8970 settings
+ * \param  freqMHz          frequency to add (MHz)
+ * \return FALSE if the list is full
+ */
+gboolean
+addMultiSpotFrequency( tHP8970settings *pSettings, gdouble freqMHz ) {
+    gint i;
+
+    for( i = 0; i < pSettings->nMultiSpot && pSettings->multiSpotMHz[ i ] < freqMHz; i++ );
+    if( i < pSettings->nMultiSpot && pSettings->multiSpotMHz[ i ] == freqMHz )
+        return TRUE;
+    if( pSettings->nMultiSpot >= MAX_MULTI_SPOT )
+        return FALSE;
+
+    memmove( &pSettings->multiSpotMHz[ i + 1 ], &pSettings->multiSpotMHz[ i ],
+             (pSettings->nMultiSpot - i) * sizeof( gdouble ) );
+    pSettings->multiSpotMHz[ i ] = freqMHz;
+    pSettings->nMultiSpot++;
+    return TRUE;
+}
+
+/*!     \brief  Set the multi-spot list from a string
+ *
+ * e.g. "100 435 1296" (MHz, separated by spaces or commas). An empty string clears the list.
+ *
+ * \param  pSettings        pointer to the HP8970 settings
+ * \param  sFrequencies     list of frequencies (MHz)
+ * \return number of frequencies in the list or ERROR if the list is invalid
+ */
+gint
+setMultiSpotFrequencies( tHP8970settings *pSettings, gchar *sFrequencies ) {
+    gchar **sFreqs = g_strsplit_set( sFrequencies, " \t,", -1 );
+    gint rtn;
+
+    pSettings->nMultiSpot = 0;
+    for( gint i = 0; sFreqs[ i ] != NULL; i++ ) {
+        gchar *sEnd;
+        gdouble freqMHz;
+
+        if( *sFreqs[ i ] == 0 )
+            continue;
+        freqMHz = g_ascii_strtod( sFreqs[ i ], &sEnd );
+        if( *sEnd != 0 || freqMHz <= 0.0 || !addMultiSpotFrequency( pSettings, freqMHz ) ) {
+            pSettings->nMultiSpot = 0;
+            g_strfreev( sFreqs );
+            return ERROR;
+        }
+    }
+    rtn = pSettings->nMultiSpot;
+    g_strfreev( sFreqs );
+
+    return rtn;
+}
+
+/*!     \brief  Retune the HP8970 (and the LO if needed) to the next multi-spot frequency
+ *
+ * The LO is only sent a new frequency (and only then waited on to settle) if its
+ * frequency changes. This is so for modes 1.1 and 1.3; in modes 1.2 & 1.4 the LO is fixed.
+ *
+ * \param  pGlobal          pointer to global data
+ * \param  descGPIB_HP8970  descriptor of the HP8970 GPIB connection
+ * \param  descGPIB_extLO   descriptor of the external LO GPIB connection
+ * \param  freqMHz          spot frequency (MHz)
+ * \param  pLOfreq          pointer to the frequency the LO is set to (updated)
+ * \param  pGPIBstatus      pointer to the GPIB status
+ * \param  pbLOerror        pointer to flag set if the LO could not be set
+ * \param  pArena           pointer to the arena of the measurement
+ * \return TRUE if successful
+ */
+static gboolean
+tuneSpotFrequency( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gdouble freqMHz,
+                   gdouble *pLOfreq, gint *pGPIBstatus, gboolean *pbLOerror, tArena *pArena ) {
+    gchar sCommand[ SHORT_STRING ], LOstatus;
+    gdouble LOfreq;
+    tProgressEvent progress = { 0 };
+
+    if( pGlobal->flags.bNoLOcontrol == FALSE && pGlobal->HP8970settings.mode != eMode1_0
+            && ( LOfreq = LOfrequency( pGlobal, freqMHz ) ) != 0.0 && LOfreq != *pLOfreq ) {
+        if( GPIBasyncWrite (descGPIB_extLO, arenaPrintf( pArena, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq ),
+                            pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
+            *pbLOerror = TRUE;
+            return FALSE;
+        }
+        *pGPIBstatus = ibrsp (descGPIB_extLO, &LOstatus); // get the status byte from the LO
+        *pLOfreq = LOfreq;
+
+        progress.type = eProgressLO;
+        progress.freqMHz = LOfreq;
+        postProgress( &progress );
+        usleep( pGlobal->HP8970settings.settlingTime_ms * 1000 );
+    }
+
+    g_snprintf( sCommand, SHORT_STRING, "FR%dMZ", (gint)freqMHz );
+    return GPIBasyncWrite (descGPIB_HP8970, sCommand, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) == eRDWT_OK;
+}
+
 /*!     \brief  Repeatedly take read NF (& gain) at the spot frequency
  *
  * Repeatedly take read NF (& gain) at the spot frequency
@@ -557,19 +659,39 @@ spotFrequencyHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO
     gchar HP8970status, LOstatus;
     gboolean completionStatus = FALSE;
     tGPIBReadWriteStatus rtn;
-    gdouble freqSpotMHz, LOfreq;
-    gdouble expectedMeasurementTime = pGlobal->HP8970settings.smoothingFactor * APPROX_MEASUREMENT_TIME;
+    gdouble freqSpotMHz, LOfreq = 0.0;
+    gdouble expectedMeasurementTime;
     gboolean bExtLO, bLOerror = FALSE;
+    tSweepEstimate *pEstimate = &pGlobal->sweepEstimate;
     tMode mode;
+    gdouble spotMHz[ MAX_MULTI_SPOT ], tunedMHz;
+    gint nSpot, series = 0;
+    // units the HP8970 is set to (the noise is kept linear)
+    tNoiseType noiseUnits = pGlobal->HP8970settings.noiseUnits;
+    // strings made at each point (the LO commands)
+    tArena arena;
+    tProgressEvent progress = { 0 };
 
     mode = pGlobal->HP8970settings.mode;
     bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
 
     freqSpotMHz = pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz;
 
+    // With two or more multi-spot frequencies, each is measured in turn (round robin)
+    // and the measurements are tagged with the series (index of the frequency)
+    if( pGlobal->HP8970settings.nMultiSpot >= 2 ) {
+        nSpot = pGlobal->HP8970settings.nMultiSpot;
+        memcpy( spotMHz, pGlobal->HP8970settings.multiSpotMHz, nSpot * sizeof( gdouble ) );
+    } else {
+        nSpot = 1;
+        spotMHz[ 0 ] = freqSpotMHz;
+    }
+    tunedMHz = spotMHz[ 0 ];
+
     while TRUE {
         pstCommands = g_string_new ( NULL );
-        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], FALSE );
+        if( !pGlobal->flags.bHeadless )
+            gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], FALSE );
 
         gchar *sMessage;
 
@@ -584,7 +706,7 @@ spotFrequencyHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO
                 if( GPIBasyncWrite (descGPIB_extLO, pGlobal->HP8970settings.sExtLOsetup, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK )
                     break;
             // We only have to set the LO frequency once for modes 1.2 and 1.4
-            if( ( LOfreq = LOfrequency( pGlobal, freqSpotMHz ) ) != 0.0 ) {
+            if( ( LOfreq = LOfrequency( pGlobal, tunedMHz ) ) != 0.0 ) {
                 g_string_printf( pstCommands, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq );
                 if( GPIBasyncWrite (descGPIB_extLO, pstCommands->str, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
                     bLOerror = TRUE;
@@ -611,9 +733,9 @@ spotFrequencyHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO
                          (gint) pGlobal->HP8970settings.extLOfreqLO,
 
                          pGlobal->HP8970settings.extLOsideband,
-                         (gint)pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz,
+                         (gint)tunedMHz,
                          (gint)round( log2( pGlobal->HP8970settings.smoothingFactor ) ),
-                         pGlobal->HP8970settings.noiseUnits,
+                         noiseUnits,
                          // D0 - input temperature units in K
 
                          pGlobal->HP8970settings.coldTemp,
@@ -628,32 +750,57 @@ spotFrequencyHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO
 
         *pGPIBstatus = ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
 
+        BEGIN_PLOT_UPDATE( &pGlobal->plot );
         initCircularBuffer( &pGlobal->plot.measurementBuffer, MAX_SPOT_POINTS, eTimeAbscissa );
+        clearMeasurementLog( &pGlobal->plot.spotLog );
 
-        pGlobal->plot.noiseUnits = pGlobal->HP8970settings.noiseUnits;
+        pGlobal->plot.noiseUnits = noiseUnits;
+        pGlobal->plot.measurementBuffer.flags.bYfactor = IS_Y_FACTOR( noiseUnits );
 
         pGlobal->plot.flags.bDataCorrectedNFAndGain = pGlobal->HP8970settings.switches.bCorrectedNFAndGain;
         pGlobal->plot.smoothingFactor = pGlobal->HP8970settings.smoothingFactor;
+        pGlobal->plot.nMultiSpot = (nSpot > 1) ? nSpot : 0;
+        memcpy( pGlobal->plot.multiSpotMHz, spotMHz, nSpot * sizeof( gdouble ) );
 
         pGlobal->plot.flags.bSpotFrequencyPlot = TRUE;
+        END_PLOT_UPDATE( &pGlobal->plot );
 
         // Get data via SQR after trigger
         enableSRQonDataReady (descGPIB_HP8970, pGPIBstatus);
 
+        BEGIN_PLOT_UPDATE( &pGlobal->plot );
         pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
         pGlobal->plot.measurementBuffer.flags.bValidGainData = FALSE;
 
+        g_mutex_lock( &pGlobal->mUpdate );
         getTimeStamp(&pGlobal->plot.sDateTime);
+        g_mutex_unlock( &pGlobal->mUpdate );
+        END_PLOT_UPDATE( &pGlobal->plot );
+        // (there is no end to a spot measurement .. we only use the measurement time)
+        startSweepEstimate( pEstimate, &pGlobal->HP8970settings, 0, 0 );
+        initArena( &arena, ACQUISITION_ARENA_SIZE );
 
         // Standard resolution just sweep. This is faster than setting the frequency each time but less noticeable once we do smoothing.
         for(; GPIBsucceeded( *pGPIBstatus )
                     && checkMessageQueue(NULL) != SEVER_DIPLOMATIC_RELATIONS
                     && bLOerror == FALSE
-                    && pGlobal->HP8970settings.switches.bSpotFrequency; ) {
+                    && pGlobal->HP8970settings.switches.bSpotFrequency
+                    && ( pGlobal->spotEndTime == 0 || g_get_monotonic_time() < pGlobal->spotEndTime ); ) {
             tNoiseAndGain measurement;
 
             measurement.flags.all = 0;
+            resetArena( &arena );
 
+            // next of the multi-spot frequencies
+            if( spotMHz[ series ] != tunedMHz ) {
+                if( !tuneSpotFrequency( pGlobal, descGPIB_HP8970, descGPIB_extLO, spotMHz[ series ],
+                                        &LOfreq, pGPIBstatus, &bLOerror, &arena ) )
+                    break;
+                tunedMHz = spotMHz[ series ];
+            }
+            measurement.flags.each.bbSeries = series;
+
+            expectedMeasurementTime = triggerPointEstimate( pEstimate, pGlobal->HP8970settings.smoothingFactor );
             rtn = GPIBtriggerMeasurement (descGPIB_HP8970, &measurement,
                                           pGPIBstatus, &HP8970error, expectedMeasurementTime);
             if( rtn == eRDWT_ABORT )
@@ -661,6 +808,7 @@ spotFrequencyHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO
             else if( rtn != eRDWT_OK ) {
                 break;  // this will exit the for loop when interrupted or error
             }
+            measuredPointEstimate( pEstimate );
 
             measurement.abscissa.time = g_get_real_time() / 1000;    // convert microseconds to milliseconds
             measurement.flags.each.bNoiseInvalid =
@@ -672,30 +820,36 @@ spotFrequencyHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO
                     IS_HP8970_ERROR( measurement.gain );
             measurement.flags.each.bGainOverflow =
                     IS_HP8970_OVERFLOW( measurement.gain );
+            measurement.noise = linearNoise( measurement.noise, noiseUnits );
 
+            BEGIN_PLOT_UPDATE( &pGlobal->plot );
             if( measurement.flags.each.bNoiseInvalid == FALSE )
                 pGlobal->plot.measurementBuffer.flags.bValidNoiseData = TRUE;
             if( measurement.flags.each.bGainInvalid == FALSE )
                 pGlobal->plot.measurementBuffer.flags.bValidGainData = TRUE;
 
             addItemToCircularBuffer( &pGlobal->plot.measurementBuffer, &measurement, TRUE );
-
-            // we will display 60 seconds * the smoothing factor
+            // the buffer only keeps the latest .. the log has them all
+            if( appendToMeasurementLog( &pGlobal->plot.spotLog, &measurement ) != OK )
+                LOG(G_LOG_LEVEL_WARNING, "Spot measurement not logged (clock changed)");
+            if( pGlobal->flags.bStreamMeasurements )
+                streamMeasurement( pGlobal, &measurement, TRUE );
+            series = (series + 1) % nSpot;
+
+            // we will display 60 seconds * the smoothing factor (* the number of frequencies measured in turn)
             pGlobal->plot.measurementBuffer.idxTimeBeforeTail = findTimeDeltaInCircularBuffer(&pGlobal->plot.measurementBuffer,
-                                                                                              TIME_PLOT_LENGTH * pGlobal->HP8970settings.smoothingFactor  );
-
-            if( HP8970error ) {
-                sMessage = g_strdup_printf( "Spot measurement: %.1lf s  ☠️  %s",
-                                            measurement.abscissa.freq,
-                                            HP8970errorString( HP8970error ) );
-            } else {
-                sMessage = g_strdup_printf( "Spot measurement: %.1lf s",
-                        measurement.abscissa.freq );
-            }
-            postInfo( sMessage );
-            g_free( sMessage );
-            postMessageToMainLoop(TM_REFRESH_PLOT, NULL);
+                                                                                              TIME_PLOT_SPAN( &pGlobal->plot ) );
+            END_PLOT_UPDATE( &pGlobal->plot );
+
+            progress.type = eProgressSpot;
+            progress.freqMHz = tunedMHz;
+            progress.elapsed = (g_get_monotonic_time() - pEstimate->startTime) / 1.0e6;
+            progress.HP8970error = HP8970error;
+            progress.bRefreshPlot = TRUE;
+            postProgress( &progress );
         }
+        freeArena( &arena );
+        logAllocationCounters( "Spot measurement" );
 
 
         // resume auto trigger & disable SRQ
@@ -731,13 +885,129 @@ spotFrequencyHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO
     g_string_free ( pstCommands, TRUE );
     ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
 
-    gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
-    gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_SaveJSON ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+    if( !pGlobal->flags.bHeadless ) {
+        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_SaveJSON ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+    }
 
     return completionStatus;
 }
 
 
+/*!     \brief  Key identifying the settings on which the calibration depends
+ *
+ * The HP8970 calibration depends on the mode, the calibration frequencies,
+ * the IF, LO & sideband, the RF & IF attenuation, the input gain calibration
+ * and the ENR table. If any change, the calibration is no longer valid.
+ *
+ * \param  pGlobal          pointer to global data
+ * \param  pSettings        pointer to the settings (current or configuration)
+ * \return key (never 0)
+ */
+guint32
+calibrationKey( tGlobal *pGlobal, tHP8970settings *pSettings ) {
+    tMode mode = pSettings->mode;
+    gboolean bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
+    tNoiseSource *pNoiseSource = &pGlobal->noiseSources[ pGlobal->activeNoiseSource ];
+    GString *pstKey = g_string_new( NULL );
+    guint32 key;
+
+    g_string_printf( pstKey, "E%d FA%.0lf FB%.0lf SS%.0lf R%d I%d C%d", mode,
+                     pSettings->range[ bExtLO ].freqStartMHz,
+                     pSettings->range[ bExtLO ].freqStopMHz,
+                     pSettings->range[ bExtLO ].freqStepCalMHz,
+                     pSettings->RFattenuation, pSettings->IFattenuation, pSettings->inputGainCal );
+    // the IF, LO and sideband only matter with a frequency converter
+    if( mode != eMode1_0 )
+        g_string_append_printf( pstKey, " IF%d LF%d B%d",
+                                pSettings->extLOfreqIF, pSettings->extLOfreqLO, pSettings->extLOsideband );
+    for( gint i = 0; i < MAX_NOISE_SOURCE_ENR_DATA_LENGTH; i++ ) {
+        if( pNoiseSource->calibrationPoints[ i ][ 0 ] == 0.0 )
+            continue;
+        g_string_append_printf( pstKey, " %.0lf:%.3lf",
+                                pNoiseSource->calibrationPoints[ i ][ 0 ], pNoiseSource->calibrationPoints[ i ][ 1 ] );
+    }
+
+    key = g_str_hash( pstKey->str );
+    g_string_free( pstKey, TRUE );
+
+    return key != 0 ? key : 1;
+}
+
+/*!     \brief  Is the calibration in the HP8970 valid for the current settings
+ *
+ * \param  pGlobal          pointer to global data
+ * \return TRUE if calibrating again would be redundant
+ */
+gboolean
+isCalibrationValid( tGlobal *pGlobal ) {
+    return pGlobal->calibration.key != 0
+            && pGlobal->calibration.key == calibrationKey( pGlobal, &pGlobal->HP8970settings );
+}
+
+/*!     \brief  Forget the calibration of the HP8970
+ *
+ * The ENR table has been changed or the HP8970 reports that it is not calibrated.
+ *
+ * \param  pGlobal          pointer to global data
+ */
+void
+invalidateCalibration( tGlobal *pGlobal ) {
+    pGlobal->calibration.key = 0;
+}
+
+/*!     \brief  Note a calibration in the saved configurations that share its settings
+ *
+ * Only called from the main loop (the configurations are edited there).
+ *
+ * \param  pGlobal          pointer to global data
+ * \param  key              calibrationKey() of the calibrated settings
+ */
+void
+recordCalibrationInConfigurations( tGlobal *pGlobal, guint32 key ) {
+    for( GList *item = pGlobal->configurationList; item != NULL; item = item->next ) {
+        tHP8970settings *pConfiguration = (tHP8970settings *)item->data;
+        if( calibrationKey( pGlobal, pConfiguration ) == key )
+            pConfiguration->calibrationKey = key;
+    }
+}
+
+/*!     \brief  Remember a successful calibration
+ *
+ * Note the settings the HP8970 is calibrated for (in the current settings and, by
+ * the main loop, in any saved configuration that shares them) and keep the data of
+ * the final pass of the calibration sweep for diagnostics.
+ *
+ * \param  pGlobal          pointer to global data
+ */
+static void
+recordCalibration( tGlobal *pGlobal ) {
+    tCalibration *pCalibration = &pGlobal->calibration;
+    tCircularBuffer *pCircularBuffer = &pGlobal->plot.measurementBuffer;
+    guint32 *pKey = g_new( guint32, 1 );
+
+    // (a snapshot of the plot may be copying the calibration)
+    g_mutex_lock( &pGlobal->mUpdate );
+    pCalibration->key = calibrationKey( pGlobal, &pGlobal->HP8970settings );
+    pGlobal->HP8970settings.calibrationKey = pCalibration->key;
+    g_mutex_lock ( &pCircularBuffer->mBuffer );
+    pCalibration->nPoints = nItemsInCircularBuffer( pCircularBuffer );
+    pCalibration->data = g_realloc( pCalibration->data, pCalibration->nPoints * sizeof( tNoiseAndGain ) );
+    for( gint i = 0; i < pCalibration->nPoints; i++ )
+        getItemFromCircularBuffer( pCircularBuffer, i, &pCalibration->data[ i ] );
+    g_mutex_unlock ( &pCircularBuffer->mBuffer );
+
+    pCalibration->noiseUnits = pGlobal->HP8970settings.noiseUnits;
+
+    g_free( pCalibration->sDateTime );
+    pCalibration->sDateTime = g_strdup( pGlobal->plot.sDateTime );
+    *pKey = pCalibration->key;
+    g_mutex_unlock( &pGlobal->mUpdate );
+
+    // the configurations are changed by the main loop (g_free()'d there)
+    postDataToMainLoop( TM_CALIBRATED, pKey );
+}
+
 /*!     \brief  Calibrate the HP8970 to account for the 2nd stage noise and gain
  *
  * Calibrate the HP8970 to account for the 2nd stage noise and gain
@@ -764,8 +1034,13 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
 
     pstCommands = g_string_new ( NULL );
     gboolean bExtLO, bContinue, bRestartSweep, completionStatus = FALSE, bLOerror = FALSE;
+    gboolean bCalComplete = FALSE;  // the HP8970 reported the end of the calibration (not aborted)
     gchar *sMessage;
     gint nCalPoint, nCalPass;
+    // units the HP8970 is set to (the noise is kept linear)
+    tNoiseType noiseUnits = pGlobal->HP8970settings.noiseUnits;
+    tProgressEvent progress = { 0 };
+    tArena arena;
 
     mode = pGlobal->HP8970settings.mode;
     bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
@@ -834,7 +1109,7 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
                       (gint)freqStopMHz,
                       (gint)freqStepMHz,
                       (gint)round( log2( pGlobal->HP8970settings.smoothingFactor ) ),
-                      pGlobal->HP8970settings.noiseUnits,
+                      noiseUnits,
 
                       pGlobal->HP8970settings.coldTemp,
                       pGlobal->HP8970settings.switches.bLossCompensation,
@@ -849,15 +1124,20 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
 
         *pGPIBstatus = ibrsp (descGPIB_HP8970, &HP8970status);    // Clear out status
 
+        BEGIN_PLOT_UPDATE( &pGlobal->plot );
         pGlobal->plot.measurementBuffer.flags.bValidNoiseData  = FALSE;
         pGlobal->plot.measurementBuffer.flags.bValidGainData   = FALSE;
         pGlobal->plot.flags.bCalibrationPlot = TRUE;
+        pGlobal->plot.flags.bSpotFrequencyPlot = FALSE;
+        END_PLOT_UPDATE( &pGlobal->plot );
         postMessageToMainLoop(TM_REFRESH_PLOT, NULL);
 
-        pGlobal->plot.flags.bSpotFrequencyPlot = FALSE;
         // Initially do a frequency sweep which uses the step increment in the 8970
         // initiate a single sweep
         enableSRQonDataReady (descGPIB_HP8970, pGPIBstatus);
+        // from here the calibration held by the HP8970 is disturbed .. it is only valid again
+        // if this calibration completes (recordCalibration)
+        invalidateCalibration( pGlobal );
         GPIBasyncWrite (descGPIB_HP8970, "CA", pGPIBstatus, 10 * TIMEOUT_RW_1SEC);
 
         // See if there is an error when we try to calibrate
@@ -878,7 +1158,10 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
         	break;
         }
 
+        g_mutex_lock( &pGlobal->mUpdate );
         getTimeStamp(&pGlobal->plot.sDateTime);
+        g_mutex_unlock( &pGlobal->mUpdate );
+        initArena( &arena, ACQUISITION_ARENA_SIZE );
 
         for( nCalPoint = 1, nCalPass = 0, bContinue = TRUE, bRestartSweep = TRUE, freqRF_MHz = pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz;
                 GPIBsucceeded( *pGPIBstatus ) && bContinue
@@ -889,15 +1172,19 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
 
             tNoiseAndGain calDataPoint;
 
+            resetArena( &arena );
             rtn = GPIBtriggerMeasurement (descGPIB_HP8970, &calDataPoint,
                                                     pGPIBstatus, &HP8970error, expectedMeasurementTime);
 
             if( bRestartSweep ) {
+                BEGIN_PLOT_UPDATE( &pGlobal->plot );
                 initCircularBuffer( pCircularBuffer, (freqStopMHz - freqStartMHz) / freqStepMHz + 2, eFreqAbscissa );
+                pCircularBuffer->flags.bYfactor = IS_Y_FACTOR( noiseUnits );
                 pCircularBuffer->minAbscissa.freq  = freqStartMHz * MHz(1.0);
                 pCircularBuffer->maxAbscissa.freq  = freqStopMHz * MHz(1.0);
                 pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
                 pGlobal->plot.measurementBuffer.flags.bValidGainData  = FALSE;
+                END_PLOT_UPDATE( &pGlobal->plot );
                 bRestartSweep = FALSE;
             }
             calDataPoint.flags.all = 0;
@@ -920,17 +1207,17 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
                 }
 
                 if( ( LOfreq = LOfrequency( pGlobal, freqRF_MHz ) ) != 0.0 ) {
-                    g_string_printf( pstCommands, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq );
-
-                    if( GPIBasyncWrite (descGPIB_extLO, pstCommands->str, pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
+                    if( GPIBasyncWrite (descGPIB_extLO, arenaPrintf( &arena, pGlobal->HP8970settings.sExtLOsetFreq, LOfreq ),
+                                        pGPIBstatus, 10 * TIMEOUT_RW_1SEC) != eRDWT_OK ) {
                         bLOerror = TRUE;
                         break;
                     }
                     *pGPIBstatus = ibrsp (descGPIB_extLO, &LOstatus); // get the status byte from the LO
                 }
-                sMessage = g_strdup_printf( "Signal Generator (LO): %.0lf MHz", LOfreq );
-                postInfoLO( sMessage );
-                g_free( sMessage );
+                progress.type = eProgressLO;
+                progress.freqMHz = LOfreq;
+                progress.bRefreshPlot = FALSE;
+                postProgress( &progress );
 
                 usleep( pGlobal->HP8970settings.settlingTime_ms * 1000 );
             }
@@ -944,24 +1231,23 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
                     IS_HP8970_ERROR( calDataPoint.gain );
             calDataPoint.flags.each.bGainOverflow =
                     IS_HP8970_OVERFLOW( calDataPoint.gain );
+            calDataPoint.noise = linearNoise( calDataPoint.noise, noiseUnits );
 
+            BEGIN_PLOT_UPDATE( &pGlobal->plot );
             if( calDataPoint.flags.each.bNoiseInvalid == FALSE )
                 pGlobal->plot.measurementBuffer.flags.bValidNoiseData = TRUE;
             if( calDataPoint.flags.each.bGainInvalid == FALSE )
                 pGlobal->plot.measurementBuffer.flags.bValidGainData = TRUE;
 
             gboolean bOverflow = (addItemToCircularBuffer( pCircularBuffer, &calDataPoint, FALSE ) == FALSE);
+            END_PLOT_UPDATE( &pGlobal->plot );
 
-            if( HP8970error ) {
-                sMessage = g_strdup_printf( "Calibration point %d: %.0lf MHz ☠️  %s", nCalPoint,
-                                            calDataPoint.abscissa.freq / MHz( 1.0 ),
-                                            HP8970errorString( HP8970error ) );
-            } else {
-                sMessage = g_strdup_printf( "Calibration point %d: %.0lf MHz", nCalPoint,
-                                            calDataPoint.abscissa.freq / MHz( 1.0 ) );
-            }
-            postInfo( sMessage );
-            g_free( sMessage );
+            progress.type = eProgressCalibration;
+            progress.nPoint = nCalPoint;
+            progress.freqMHz = calDataPoint.abscissa.freq / MHz( 1.0 );
+            progress.HP8970error = HP8970error;
+            progress.bRefreshPlot = bContinue;
+            postProgress( &progress );
 
             if( bContinue ) {
                 // Calibration runs three times
@@ -970,12 +1256,16 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
                     nCalPoint = 0;
                     nCalPass++;
                 }
-                postMessageToMainLoop(TM_REFRESH_PLOT, NULL);
+            } else {
+                bCalComplete = TRUE;
             }
         }
+        freeArena( &arena );
 
+        BEGIN_PLOT_UPDATE( &pGlobal->plot );
         pGlobal->plot.measurementBuffer.flags.bValidNoiseData = FALSE;
         pGlobal->plot.measurementBuffer.flags.bValidGainData  = FALSE;
+        END_PLOT_UPDATE( &pGlobal->plot );
         postMessageToMainLoop(TM_REFRESH_PLOT, NULL);
 
         // sweep off (in case we've interrupted the calibration .. according to the manual, this is the only way to stop the calibration)
@@ -984,10 +1274,11 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
                                 // the write will not be attempted
         GPIBasyncWrite (descGPIB_HP8970, "W0T0Q0", &altGPIBstatus, 10 * TIMEOUT_RW_1SEC);
 
-        completionStatus = TRUE;
+        completionStatus = bCalComplete && HP8970error == 0;
         break;
     }
     g_string_free ( pstCommands, TRUE );
+    logAllocationCounters( "Calibration" );
 
     if( GPIBfailed( *pGPIBstatus ) ) {
         if( bLOerror ) {
@@ -1003,8 +1294,12 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
                                         HP8970errorString( HP8970error ) );
             postError( sMessage );
             g_free( sMessage );
+        } else if( !bCalComplete ) {
+            // aborted between points .. the HP8970 is left with a partial calibration
+            postError( "HP8970 calibration aborted" );
         }  else {
         	postInfo( "HP8970 calibration OK");
+        	recordCalibration( pGlobal );
         }
         postInfoLO( "");
         postMessageToMainLoop(TM_REFRESH_PLOT, NULL);
@@ -1013,7 +1308,9 @@ calibrateHP8970( tGlobal *pGlobal, gint descGPIB_HP8970, gint descGPIB_extLO, gi
     if( pGlobal->flags.bNoLOcontrol == FALSE && (mode == eMode1_1 || mode == eMode1_2) )
         ibloc(descGPIB_HP8970);
 
+    BEGIN_PLOT_UPDATE( &pGlobal->plot );
     pGlobal->plot.flags.bCalibrationPlot = FALSE;
+    END_PLOT_UPDATE( &pGlobal->plot );
 
     return completionStatus;
 }
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Two dimensional sweeps
+ *
+ * An external parameter (bias, LO power, attenuation ...) is stepped by sending a command
+ * to a GPIB device (e.g. "VSET %.3lf" .. like the external LO frequency command) and at each
+ * value the HP8970 frequency sweep is made. The sweeps are kept in one dense array
+ * (parameter x frequency) which is shown as a heat map and saved in the one JSON or CSV file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib-2.0/glib.h>
+#include <gpib/ib.h>
+#include <HP8970.h>
+
+#include "GPIBcomms.h"
+#include "messageEvent.h"
+
+/*!     \brief  Check the command template has just one floating point conversion
+ *
+ * The template is used as a printf format, so anything else could be dangerous.
+ *
+ * \param  sTemplate        the command template
+ * \return TRUE if the template is usable
+ */
+static gboolean
+validCommandTemplate( gchar *sTemplate ) {
+    gint nConversions = 0;
+
+    for( gchar *p = sTemplate; *p; p++ ) {
+        if( *p != '%' )
+            continue;
+        if( *++p == '%' )
+            continue;
+        // flags, width & precision
+        p += strspn( p, "-+ #0123456789." );
+        if( *p == 'l' )
+            p++;
+        if( *p == 0 || strchr( "eEfgG", *p ) == NULL )
+            return FALSE;
+        nConversions++;
+    }
+    return nConversions == 1;
+}
+
+/*!     \brief  Parse the specification of a parameter sweep
+ *
+ * <device> <start> <stop> <step> <command template>
+ *
+ * The device is a GPIB name or address, or LO to use the external LO (only if the
+ * frequency sweep does not use it).
+ *
+ * \param  sSpecification   the specification
+ * \param  pParameter       pointer to the parameter sweep (the strings are allocated)
+ * \param  bLOinUse         the frequency sweep sets the external LO
+ * \return OK or ERROR if the specification is invalid
+ */
+gint
+parseParameterSweep( gchar *sSpecification, tParameterSweep *pParameter, gboolean bLOinUse ) {
+    gchar **sFields = g_strsplit_set( g_strstrip( sSpecification ), " \t", 5 );
+    gint rtn = ERROR;
+
+    bzero( pParameter, sizeof( tParameterSweep ) );
+    do {
+        gchar *sEnd;
+
+        if( g_strv_length( sFields ) != 5 )
+            break;
+        pParameter->start = g_ascii_strtod( sFields[ 1 ], &sEnd );
+        if( *sEnd != 0 )
+            break;
+        pParameter->stop = g_ascii_strtod( sFields[ 2 ], &sEnd );
+        if( *sEnd != 0 )
+            break;
+        pParameter->step = g_ascii_strtod( sFields[ 3 ], &sEnd );
+        if( *sEnd != 0 )
+            break;
+        // the step must go from start towards stop
+        if( pParameter->step == 0.0 || (pParameter->stop - pParameter->start) / pParameter->step < 0.0
+                || (pParameter->stop - pParameter->start) / pParameter->step >= MAX_2D_ROWS )
+            break;
+        if( !validCommandTemplate( g_strchug( sFields[ 4 ] ) ) )
+            break;
+
+        if( g_ascii_strcasecmp( sFields[ 0 ], "LO" ) != 0 )
+            pParameter->sDevice = g_strdup( sFields[ 0 ] );
+        else if( bLOinUse )
+            break;
+        pParameter->sSetCommand = g_strdup( sFields[ 4 ] );
+        rtn = OK;
+    } while FALSE;
+
+    g_strfreev( sFields );
+    return rtn;
+}
+
+/*!     \brief  Value of the parameter for a row of the two dimensional sweep
+ *
+ * \param  pSweep2D         pointer to the two dimensional sweep
+ * \param  row              row
+ * \return the parameter value
+ */
+gdouble
+parameterValue( tSweep2D *pSweep2D, guint row ) {
+    return pSweep2D->parameter.start + row * pSweep2D->parameter.step;
+}
+
+/*!     \brief  Free the data of a two dimensional sweep
+ *
+ * \param  pSweep2D         pointer to the two dimensional sweep
+ */
+void
+freeSweep2D( tSweep2D *pSweep2D ) {
+    g_free( pSweep2D->parameter.sDevice );
+    g_free( pSweep2D->parameter.sSetCommand );
+    g_free( pSweep2D->frequencies );
+    g_free( pSweep2D->data );
+    if( pSweep2D->heatMap )
+        cairo_surface_destroy( pSweep2D->heatMap );
+
+    pSweep2D->parameter.sDevice = NULL;
+    pSweep2D->parameter.sSetCommand = NULL;
+    pSweep2D->frequencies = NULL;
+    pSweep2D->data = NULL;
+    pSweep2D->heatMap = NULL;
+    pSweep2D->nRows = pSweep2D->nColumns = pSweep2D->nRowsDone = 0;
+    pSweep2D->flags.bValid = FALSE;
+}
+
+/*!     \brief  Copy a two dimensional sweep
+ *
+ * The copy has its own data (but not the heat map, which it will draw if needed)
+ *
+ * \param  pCopy            pointer to the copy
+ * \param  pSource          pointer to the two dimensional sweep to copy
+ */
+void
+copySweep2D( tSweep2D *pCopy, tSweep2D *pSource ) {
+    g_mutex_lock( &pSource->mSweep2D );
+    *pCopy = *pSource;
+    pCopy->parameter.sDevice = g_strdup( pSource->parameter.sDevice );
+    pCopy->parameter.sSetCommand = g_strdup( pSource->parameter.sSetCommand );
+    pCopy->frequencies = g_memdup2( pSource->frequencies, pSource->nColumns * sizeof( gdouble ) );
+    pCopy->data = g_memdup2( pSource->data, pSource->nRows * pSource->nColumns * sizeof( tNoiseAndGain ) );
+    pCopy->heatMap = NULL;
+    g_mutex_unlock( &pSource->mSweep2D );
+    g_mutex_init( &pCopy->mSweep2D );
+}
+
+/*!     \brief  Keep a sweep as a row of the two dimensional sweep
+ *
+ * A sweep that is short (interrupted) has its missing points marked invalid.
+ *
+ * \param  pSweep2D         pointer to the two dimensional sweep
+ * \param  row              row
+ * \param  pSweep           pointer to the circular buffer holding the sweep
+ */
+static void
+storeSweep2DRow( tSweep2D *pSweep2D, guint row, tCircularBuffer *pSweep ) {
+    guint nPoints = nItemsInCircularBuffer( pSweep );
+
+    g_mutex_lock( &pSweep2D->mSweep2D );
+    for( guint i = 0; i < pSweep2D->nColumns; i++ ) {
+        tNoiseAndGain *pPoint = &pSweep2D->data[ row * pSweep2D->nColumns + i ];
+        if( i < nPoints ) {
+            getItemFromCircularBuffer( pSweep, i, pPoint );
+        } else {
+            pPoint->abscissa.freq = pSweep2D->frequencies[ i ];
+            pPoint->flags.each.bNoiseInvalid = TRUE;
+            pPoint->flags.each.bGainInvalid = TRUE;
+        }
+    }
+    pSweep2D->nRowsDone = row + 1;
+    pSweep2D->flags.bValid = TRUE;
+
+    // the heat map must be redrawn
+    if( pSweep2D->heatMap )
+        cairo_surface_destroy( pSweep2D->heatMap );
+    pSweep2D->heatMap = NULL;
+    g_mutex_unlock( &pSweep2D->mSweep2D );
+}
+
+/*!     \brief  Make a two dimensional sweep
+ *
+ * Step the parameter from start to stop and sweep the HP8970 at each value.
+ *
+ * \param  pGlobal          pointer to global data
+ * \param  pParameter       pointer to the parameter sweep (the strings are taken)
+ * \param  descGPIB_HP8970  descriptor of the HP8970 GPIB connection
+ * \param  descGPIB_extLO   descriptor of the external LO GPIB connection
+ * \param  pGPIBstatus      pointer to the GPIB status
+ * \return TRUE if successful
+ */
+gboolean
+parameterSweepHP8970( tGlobal *pGlobal, tParameterSweep *pParameter,
+                      gint descGPIB_HP8970, gint descGPIB_extLO, gint *pGPIBstatus ) {
+    tSweep2D *pSweep2D = &pGlobal->plot.sweep2D;
+    gint descGPIB_Parameter = INVALID;
+    gboolean bOK = TRUE, bAutoSweep;
+    tMode mode = pGlobal->HP8970settings.mode;
+    gboolean bExtLO = !(mode == eMode1_0 || mode == eMode1_4);
+    gdouble freqStartMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz;
+    gdouble freqStopMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz;
+    gdouble freqStepMHz = pGlobal->HP8970settings.range[ bExtLO ].freqStepSweepMHz;
+    GString *pstCommand;
+    gchar *sMessage;
+    guint row;
+
+    // the columns are the points of a full sweep (so an interrupted sweep is never the pattern)
+    g_mutex_lock( &pSweep2D->mSweep2D );
+    freeSweep2D( pSweep2D );
+    pSweep2D->parameter = *pParameter;
+    pSweep2D->nRows = (guint)((pParameter->stop - pParameter->start) / pParameter->step + SMIG) + 1;
+    pSweep2D->nColumns = sweepPointCount( freqStartMHz, freqStopMHz, freqStepMHz );
+    pSweep2D->frequencies = g_malloc( pSweep2D->nColumns * sizeof( gdouble ) );
+    pSweep2D->data = g_malloc0( pSweep2D->nRows * pSweep2D->nColumns * sizeof( tNoiseAndGain ) );
+    for( guint i = 0; i < pSweep2D->nColumns; i++ )
+        pSweep2D->frequencies[ i ] = MHz( sweepPointFrequency( freqStartMHz, freqStopMHz, freqStepMHz, i ) );
+    g_mutex_unlock( &pSweep2D->mSweep2D );
+
+    if( pParameter->sDevice ) {
+        if( open_Parameter_GPIBdevice( pGlobal, pParameter->sDevice, &descGPIB_Parameter ) != OK )
+            return FALSE;
+    } else if( descGPIB_extLO == INVALID ) {
+        postError( "There is no external LO to set the parameter" );
+        return FALSE;
+    } else {
+        descGPIB_Parameter = descGPIB_extLO;
+    }
+
+    // show the heat map as it is built
+    pGlobal->flags.bShowHeatMap = TRUE;
+
+    // one pass for each value of the parameter
+    bAutoSweep = pGlobal->HP8970settings.switches.bAutoSweep;
+    pGlobal->HP8970settings.switches.bAutoSweep = FALSE;
+    pstCommand = g_string_new( NULL );
+
+    for( row = 0; bOK && row < pSweep2D->nRows; row++ ) {
+        gdouble value = parameterValue( pSweep2D, row );
+
+        if( checkMessageQueue( NULL ) == SEVER_DIPLOMATIC_RELATIONS ) {
+            bOK = FALSE;
+            break;
+        }
+
+        g_string_printf( pstCommand, pParameter->sSetCommand, value );
+        if( GPIBasyncWrite( descGPIB_Parameter, pstCommand->str, pGPIBstatus, 10 * TIMEOUT_RW_1SEC ) != eRDWT_OK ) {
+            postError( "Communications failure with the parameter device" );
+            bOK = FALSE;
+            break;
+        }
+        sMessage = g_strdup_printf( "Parameter: %g  (%d of %d)", value, row + 1, pSweep2D->nRows );
+        postInfoLO( sMessage );
+        g_free( sMessage );
+        usleep( pGlobal->HP8970settings.settlingTime_ms * 1000 );
+
+        bOK = sweepHP8970( pGlobal, descGPIB_HP8970, descGPIB_extLO, pGPIBstatus, FALSE )
+                && GPIBsucceeded( *pGPIBstatus );
+        // an interrupted sweep is kept (the missing points are invalid)
+        if( nItemsInCircularBuffer( &pGlobal->plot.measurementBuffer ) > 0 )
+            storeSweep2DRow( pSweep2D, row, &pGlobal->plot.measurementBuffer );
+        postMessageToMainLoop( TM_REFRESH_PLOT, NULL );
+    }
+
+    g_string_free( pstCommand, TRUE );
+    pGlobal->HP8970settings.switches.bAutoSweep = bAutoSweep;
+    if( pParameter->sDevice ) {
+        ibloc( descGPIB_Parameter );
+        GPIBclose( &descGPIB_Parameter );
+    }
+
+    if( bOK ) {
+        sMessage = g_strdup_printf( "Two dimensional sweep of %d x %d points complete", pSweep2D->nRows, pSweep2D->nColumns );
+        postInfo( sMessage );
+        g_free( sMessage );
+    }
+    postInfoLO( "" );
+
+    return bOK;
+}
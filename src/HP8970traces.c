@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Trace library (memory)
+ *
+ * Up to MAX_TRACES traces are kept to be shown with the measurement: measurements stored
+ * to memory, plots loaded from JSON files and calibration sweeps. Each has its own name,
+ * color, line style and visibility. When the library is full the oldest trace is dropped.
+ *
+ * A trace (the data and name) is reference counted and is never changed once stored, so a
+ * snapshot of the plot just takes another reference. How it is shown is kept in the library.
+ * Storing the measurement shares its columns (copy on write); they are only copied when
+ * the next sweep changes them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+/*!     \brief  Free the content of a trace (when the last reference is released)
+ *
+ * \param  data       pointer to the trace
+ */
+static void
+clearTrace( gpointer data ) {
+    tTrace *pTrace = (tTrace *)data;
+
+    freeCircularBuffer( &pTrace->data );
+    g_mutex_clear( &pTrace->data.mBuffer );
+    g_free( pTrace->sName );
+}
+
+/*!     \brief  Forget the paths drawn for a trace
+ *
+ * \param  pSlot      pointer to the slot of the trace library
+ */
+static void
+forgetTracePaths( tTraceSlot *pSlot ) {
+    for( gint axis = 0; axis < eMAX_AXES; axis++ ) {
+        if( pSlot->paths[ axis ].path )
+            cairo_path_destroy( pSlot->paths[ axis ].path );
+        pSlot->paths[ axis ].path = NULL;
+    }
+}
+
+/*!     \brief  Release a trace and empty its slot
+ *
+ * \param  pSlot      pointer to the slot of the trace library
+ */
+static void
+emptyTraceSlot( tTraceSlot *pSlot ) {
+    g_atomic_rc_box_release_full( pSlot->pTrace, clearTrace );
+    pSlot->pTrace = NULL;
+    forgetTracePaths( pSlot );
+}
+
+/*!     \brief  Add a new trace to the library
+ *
+ * If the library is full the oldest trace is dropped. The trace becomes the selected one.
+ *
+ * \param  pLibrary   pointer to the trace library
+ * \param  pTrace     pointer to the trace (the reference is taken)
+ * \return number of traces in the library
+ */
+static gint
+addTrace( tTraceLibrary *pLibrary, tTrace *pTrace ) {
+    tTraceSlot *pSlot;
+    gint nTraces;
+
+    g_mutex_lock( &pLibrary->mTraces );
+    if( pLibrary->nTraces == MAX_TRACES ) {
+        emptyTraceSlot( &pLibrary->slots[ 0 ] );
+        memmove( &pLibrary->slots[ 0 ], &pLibrary->slots[ 1 ], (MAX_TRACES - 1) * sizeof( tTraceSlot ) );
+        pLibrary->nTraces--;
+    }
+    pSlot = &pLibrary->slots[ pLibrary->nTraces ];
+    bzero( pSlot, sizeof( tTraceSlot ) );
+    pSlot->pTrace = pTrace;
+    // colors in turn (the first has the memory colors of the plot page)
+    pSlot->color = pLibrary->nTraces % N_TRACE_COLORS;
+    pSlot->style = eTraceDashed;
+    pSlot->flags.bVisible = TRUE;
+
+    pLibrary->selected = pLibrary->nTraces++;
+    nTraces = pLibrary->nTraces;
+    g_mutex_unlock( &pLibrary->mTraces );
+
+    return nTraces;
+}
+
+/*!     \brief  Store a measurement in the trace library
+ *
+ * \param  pLibrary   pointer to the trace library
+ * \param  pSource    pointer to the measurement
+ * \param  bShare     share the data (copy on write) .. only if the measurement is not being changed
+ * \param  sName      name of the trace
+ * \return number of traces in the library
+ */
+gint
+storeTrace( tTraceLibrary *pLibrary, tCircularBuffer *pSource, gboolean bShare, gchar *sName ) {
+    tTrace *pTrace = g_atomic_rc_box_new0( tTrace );
+
+    if( bShare )
+        shareCircularBuffer( &pTrace->data, pSource );
+    else
+        copyCircularBuffer( &pTrace->data, pSource );
+    pTrace->sName = g_strdup( sName );
+
+    return addTrace( pLibrary, pTrace );
+}
+
+/*!     \brief  Store a sweep (calibration or loaded from a file) in the trace library
+ *
+ * \param  pLibrary   pointer to the trace library
+ * \param  data       the measurements (in frequency order, linear noise)
+ * \param  nPoints    number of measurements
+ * \param  bYfactor   the noise is the Y factor (not the noise factor)
+ * \param  sName      name of the trace
+ * \return number of traces in the library (or ERROR if there is nothing valid to store)
+ */
+gint
+storeTraceData( tTraceLibrary *pLibrary, tNoiseAndGain *data, guint nPoints, gboolean bYfactor, gchar *sName ) {
+    tTrace *pTrace;
+    tCircularBuffer *pBuffer;
+
+    if( nPoints == 0 )
+        return ERROR;
+
+    pTrace = g_atomic_rc_box_new0( tTrace );
+    pBuffer = &pTrace->data;
+    g_mutex_init( &pBuffer->mBuffer );
+    initCircularBuffer( pBuffer, nPoints, eFreqAbscissa );
+    pBuffer->flags.bYfactor = bYfactor;
+    for( guint i = 0; i < nPoints; i++ ) {
+        addItemToCircularBuffer( pBuffer, &data[ i ], FALSE );
+        if( !data[ i ].flags.each.bNoiseInvalid )
+            pBuffer->flags.bValidNoiseData = TRUE;
+        if( !data[ i ].flags.each.bGainInvalid )
+            pBuffer->flags.bValidGainData = TRUE;
+        updateBoundaries( data[ i ].abscissa.freq, &pBuffer->minAbscissa.freq, &pBuffer->maxAbscissa.freq );
+    }
+
+    if( !pBuffer->flags.bValidNoiseData && !pBuffer->flags.bValidGainData ) {
+        g_atomic_rc_box_release_full( pTrace, clearTrace );
+        return ERROR;
+    }
+    pTrace->sName = g_strdup( sName );
+
+    return addTrace( pLibrary, pTrace );
+}
+
+/*!     \brief  Release all the traces
+ *
+ * Used when the library itself is discarded (no lock is taken).
+ *
+ * \param  pLibrary   pointer to the trace library
+ */
+void
+freeTraceLibrary( tTraceLibrary *pLibrary ) {
+    for( gint i = 0; i < pLibrary->nTraces; i++ )
+        emptyTraceSlot( &pLibrary->slots[ i ] );
+    pLibrary->nTraces = 0;
+    pLibrary->selected = 0;
+}
+
+/*!     \brief  Remove all the traces from the library
+ *
+ * \param  pLibrary   pointer to the trace library
+ */
+void
+clearTraceLibrary( tTraceLibrary *pLibrary ) {
+    g_mutex_lock( &pLibrary->mTraces );
+    freeTraceLibrary( pLibrary );
+    g_mutex_unlock( &pLibrary->mTraces );
+}
+
+/*!     \brief  Copy the trace library (for a snapshot)
+ *
+ * The traces are shared (another reference is taken). The copy has its own paths and mutex.
+ *
+ * \param  pCopy      pointer to the copy
+ * \param  pSource    pointer to the trace library
+ */
+void
+copyTraceLibrary( tTraceLibrary *pCopy, tTraceLibrary *pSource ) {
+    g_mutex_lock( &pSource->mTraces );
+    *pCopy = *pSource;
+    for( gint i = 0; i < pCopy->nTraces; i++ ) {
+        g_atomic_rc_box_acquire( pCopy->slots[ i ].pTrace );
+        for( gint axis = 0; axis < eMAX_AXES; axis++ )
+            pCopy->slots[ i ].paths[ axis ].path = NULL;
+    }
+    g_mutex_unlock( &pSource->mTraces );
+    g_mutex_init( &pCopy->mTraces );
+}
+
+/*!     \brief  Extremes of the visible traces
+ *
+ * Traces whose noise cannot be shown in the units of the plot (Y factor or noise factor) are not shown.
+ *
+ * \param  pLibrary   pointer to the trace library
+ * \param  axis       eFreq (Hz), eNoise (in the units) or eGain
+ * \param  units      noise units of the plot
+ * \param  pMin       pointer to the minimum (only changed if there is a visible trace)
+ * \param  pMax       pointer to the maximum (only changed if there is a visible trace)
+ * \return TRUE if there is a visible trace with data for the axis
+ */
+gboolean
+traceLibraryExtremes( tTraceLibrary *pLibrary, tGridAxes axis, tNoiseType units, gdouble *pMin, gdouble *pMax ) {
+    gboolean bFound = FALSE;
+
+    for( gint i = 0; i < pLibrary->nTraces; i++ ) {
+        tCircularBuffer *pData = &pLibrary->slots[ i ].pTrace->data;
+
+        if( !pLibrary->slots[ i ].flags.bVisible || pData->flags.bYfactor != IS_Y_FACTOR( units ) )
+            continue;
+
+        switch( axis ) {
+        case eFreq:
+        default:
+            if( !pData->flags.bValidNoiseData && !pData->flags.bValidGainData )
+                continue;
+            *pMin = MIN( *pMin, pData->minAbscissa.freq );
+            *pMax = MAX( *pMax, pData->maxAbscissa.freq );
+            break;
+        case eNoise:
+            if( !pData->flags.bValidNoiseData )
+                continue;
+            // (the conversion keeps the order)
+            *pMin = MIN( *pMin, noiseInUnits( pData->minNoise, units ) );
+            *pMax = MAX( *pMax, noiseInUnits( pData->maxNoise, units ) );
+            break;
+        case eGain:
+            if( !pData->flags.bValidGainData )
+                continue;
+            *pMin = MIN( *pMin, pData->minGain );
+            *pMax = MAX( *pMax, pData->maxGain );
+            break;
+        }
+        bFound = TRUE;
+    }
+
+    return bFound;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Noise units
+ *
+ * The noise is kept in linear form whatever units the HP8970 was set to: the noise factor F
+ * for FdB, F & TeK and the Y factor for YdB & Y. It is converted to the units of the plot
+ * when it is shown or saved, so changing the units does not need a new measurement and
+ * traces measured in different units can be overlaid.
+ *
+ * The Y factor also depends on the ENR of the noise source (and the cold temperature),
+ * so it is not converted to or from the noise factor.
+ *
+ * The kernels that convert a column of noise and transform a run of measurements to positions
+ * on the plot grid are here (rather than in CairoPlot.c) so they can be timed on their own
+ * (tests/benchTraceTransform.c).
+ */
+
+#include <string.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+#include <math.h>
+
+/*!     \brief  Convert a noise value (as read from the HP8970) to linear form
+ *
+ * \param  value        noise in the units
+ * \param  units        units of the value
+ * \return noise factor or Y factor (linear) .. errors are unchanged
+ */
+gdouble
+linearNoise( gdouble value, tNoiseType units ) {
+    if( IS_HP8970_ERROR( value ) )
+        return value;
+
+    switch( units ) {
+    case eFdB:
+    case eYdB:
+        return pow( 10.0, value / 10.0 );
+    case eTeK:
+        return 1.0 + value / T0_KELVIN;
+    case eF:
+    case eY:
+    default:
+        return value;
+    }
+}
+
+/*!     \brief  Convert a linear noise value to the units
+ *
+ * \param  linear       noise factor or Y factor (linear)
+ * \param  units        units wanted
+ * \return noise in the units .. errors are unchanged
+ */
+gdouble
+noiseInUnits( gdouble linear, tNoiseType units ) {
+    if( IS_HP8970_ERROR( linear ) )
+        return linear;
+
+    switch( units ) {
+    case eFdB:
+    case eYdB:
+        return 10.0 * log10( MAX( linear, MIN_LINEAR_NOISE ) );
+    case eTeK:
+        return (linear - 1.0) * T0_KELVIN;
+    case eF:
+    case eY:
+    default:
+        return linear;
+    }
+}
+
+/*!     \brief  Convert a column of linear noise values to the units
+ *
+ * The choice of conversion is made once for the column, so each loop is a simple
+ * pass over contiguous memory that the compiler can vectorize.
+ *
+ * \param  pLinear      pointer to the noise factors or Y factors (linear)
+ * \param  pNoise       pointer to the noise in the units (may be the same as pLinear)
+ * \param  n            number of values
+ * \param  units        units wanted
+ */
+void
+convertNoiseColumn( const gdouble *pLinear, gdouble *pNoise, guint n, tNoiseType units ) {
+    switch( units ) {
+    case eFdB:
+    case eYdB:
+        for( guint i = 0; i < n; i++ )
+            pNoise[ i ] = IS_HP8970_ERROR( pLinear[ i ] ) ? pLinear[ i ]
+                                : 10.0 * log10( MAX( pLinear[ i ], MIN_LINEAR_NOISE ) );
+        break;
+    case eTeK:
+        for( guint i = 0; i < n; i++ )
+            pNoise[ i ] = IS_HP8970_ERROR( pLinear[ i ] ) ? pLinear[ i ] : (pLinear[ i ] - 1.0) * T0_KELVIN;
+        break;
+    case eF:
+    case eY:
+    default:
+        if( pNoise != pLinear )
+            memcpy( pNoise, pLinear, n * sizeof( gdouble ) );
+        break;
+    }
+}
+
+/*!     \brief  Transform a run of measurements to positions on the grid
+ *
+ * There is a loop for each kind of abscissa (frequency in Hz or time in ms) and one for the
+ * coordinate (gain, or noise already in the units of the plot); none has a branch (the clipping,
+ * as clipData, is a select) so the compiler can vectorize them. A measurement is valid if its
+ * noise is not an HP8970 error (a gap in the trace).
+ *
+ * \param pDataBuffer   pointer to data circular buffer
+ * \param pCoordinates  the coordinates of the run (gain or noise in the units of the plot)
+ * \param posn          position of the first measurement of the run in the columns
+ * \param n             number of measurements (up to TRACE_CHUNK)
+ * \param bTime         the abscissa is time (spot frequency plot)
+ * \param xScale        pixels per Hz or ms
+ * \param xOffset       x position of zero Hz or ms
+ * \param pAxis         axis of the coordinate
+ * \param yScale        pixels per unit of the coordinate
+ * \param pX            x positions (filled)
+ * \param pY            y positions (filled)
+ * \param pbValid       valid measurements (filled)
+ */
+void
+transformToGrid( tCircularBuffer *pDataBuffer, const gdouble *pCoordinates, guint posn, guint n, gboolean bTime,
+                 gdouble xScale, gdouble xOffset, tAxis *pAxis, gdouble yScale,
+                 gdouble *pX, gdouble *pY, guint8 *pbValid ) {
+    const tAbscissaValue *pAbscissa = &pDataBuffer->abscissa[ posn ];
+    const gdouble *pNoise = &pDataBuffer->noise[ posn ];
+    gdouble min = pAxis->min, max = pAxis->max, margin = (max - min) / 150.0;
+
+    if( bTime ) {
+        for( guint i = 0; i < n; i++ )
+            pX[ i ] = (gdouble)pAbscissa[ i ].time * xScale + xOffset;
+    } else {
+        for( guint i = 0; i < n; i++ )
+            pX[ i ] = pAbscissa[ i ].freq * xScale + xOffset;
+    }
+
+    for( guint i = 0; i < n; i++ ) {
+        gdouble coordinate = pCoordinates[ i ];
+        coordinate = coordinate > max ? max + margin : coordinate;
+        coordinate = coordinate < min ? min - margin : coordinate;
+        pY[ i ] = (coordinate - min) * yScale;
+        pbValid[ i ] = pNoise[ i ] < ERROR_INDICATOR_HP8970;
+    }
+}
@@ -447,7 +447,7 @@ void cairo_renderHewlettPackardLogo(cairo_t *cr,
 
 /*!     \brief  find the width of the string in the current font
  *
- * Determine the width of the string in the current font and scaling
+ * Determine the width of the string in the current font and scaling (see HP8970glyphs.c)
  *
  * \ingroup drawing
  *
@@ -459,7 +459,7 @@ gdouble
 stringWidthCairoText(cairo_t *cr, gchar *sLabel)
 {
         cairo_text_extents_t extents;
-        cairo_text_extents (cr, sLabel, &extents);
+        cachedCairoTextExtents (cr, sLabel, &extents);
         return( extents.x_advance );
 }
 
@@ -481,7 +481,7 @@ leftJustifiedCairoText(cairo_t *cr, gchar *sLabel, gdouble x, gdouble y, gboolea
     cairo_text_extents_t extents;
     GdkRGBA white = { 1.0, 1.0, 1.0, 0.7 };
     cairo_move_to(cr, x, y );
-    cairo_text_extents (cr, sLabel, &extents);
+    cachedCairoTextExtents (cr, sLabel, &extents);
     gdouble margin = extents.height * 0.1;
     if( bMask ) {
         cairo_save( cr );
@@ -496,7 +496,7 @@ leftJustifiedCairoText(cairo_t *cr, gchar *sLabel, gdouble x, gdouble y, gboolea
 
         cairo_move_to(cr, x, y );
     }
-    cairo_show_text (cr, sLabel);
+    showCachedCairoText (cr, sLabel);
 }
 
 /*!     \brief  Render a text string right justified from the specified point
@@ -517,8 +517,8 @@ rightJustifiedCairoText(cairo_t *cr, gchar *sLabel, gdouble x, gdouble y, gboole
     cairo_text_extents_t extents;
     gdouble justifiedX, justifiedY;
     GdkRGBA white = { 1.0, 1.0, 1.0, 0.7 };
-    cairo_move_to(cr, x - stringWidthCairoText(cr, sLabel), y );
-    cairo_text_extents (cr, sLabel, &extents);
+    cachedCairoTextExtents (cr, sLabel, &extents);
+    cairo_move_to(cr, x - extents.x_advance, y );
     gdouble margin = extents.height * 0.1;
     if( bMask ) {
         cairo_get_current_point( cr, &justifiedX, &justifiedY );
@@ -534,7 +534,7 @@ rightJustifiedCairoText(cairo_t *cr, gchar *sLabel, gdouble x, gdouble y, gboole
 
         cairo_move_to ( cr, justifiedX, justifiedY );
     }
-    cairo_show_text (cr, sLabel);
+    showCachedCairoText (cr, sLabel);
 }
 
 /*!     \brief  Render a text string center justified around the specified point
@@ -555,8 +555,8 @@ centreJustifiedCairoText(cairo_t *cr, gchar *sLabel, gdouble x, gdouble y, gdoub
     cairo_text_extents_t extents;
     gdouble justifiedX, justifiedY;
     GdkRGBA white = { 1.0, 1.0, 1.0, backgroundOpacity };
-    cairo_move_to(cr, x - stringWidthCairoText(cr, sLabel)/2.0, y);
-    cairo_text_extents (cr, sLabel, &extents);
+    cachedCairoTextExtents (cr, sLabel, &extents);
+    cairo_move_to(cr, x - extents.x_advance/2.0, y);
     gdouble margin = extents.height * 0.1;
     if( backgroundOpacity != 0.0  ) {
         cairo_get_current_point( cr, &justifiedX, &justifiedY );
@@ -572,7 +572,7 @@ centreJustifiedCairoText(cairo_t *cr, gchar *sLabel, gdouble x, gdouble y, gdoub
 
         cairo_move_to ( cr, justifiedX, justifiedY );
     }
-    cairo_show_text (cr, sLabel);
+    showCachedCairoText (cr, sLabel);
 }
 
 cairo_user_data_key_t hardcopyKey;
@@ -626,9 +626,9 @@ static struct _RsvgHandle *SVGhandles[ eMode_Max ];
 
 void
 freeSVGhandles( void ) {
-    g_object_unref( SVGhandles[ eMode1_0 ] );
-    g_object_unref( SVGhandles[ eMode1_1 ] );
-    g_object_unref( SVGhandles[ eMode1_3 ] );
+    g_clear_object( &SVGhandles[ eMode1_0 ] );
+    g_clear_object( &SVGhandles[ eMode1_1 ] );
+    g_clear_object( &SVGhandles[ eMode1_3 ] );
 }
 
 void
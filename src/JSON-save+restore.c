@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <glib-2.0/glib.h>
@@ -83,6 +84,223 @@ suggestFilename( tGlobal *pGlobal, gchar *chosenFileName, gchar *suffix ) {
     return filename;
 }
 
+#define N_ACCUMULATOR_JSON_ITEMS 7
+/*!     \brief  Add the statistics for one quantity to the JSON array
+ *
+ * [ n, average, running average, max, min, mean, standard deviation ]
+ *
+ * \param  builder      pointer to the JSON builder
+ * \param  pStats       pointer to the statistics for noise or gain at one frequency
+ * \param  length       averaging length (N)
+ */
+static void
+addAccumulatorToJSON( JsonBuilder *builder, tAccumulator *pStats, guint length ) {
+    json_builder_add_int_value ( builder, pStats->n );
+    json_builder_add_double_value ( builder, pStats->exponential );
+    json_builder_add_double_value ( builder,
+            pStats->n ? pStats->windowSum / (gdouble)MIN( pStats->n, length ) : 0.0 );
+    json_builder_add_double_value ( builder, pStats->max );
+    json_builder_add_double_value ( builder, pStats->min );
+    json_builder_add_double_value ( builder, pStats->mean );
+    json_builder_add_double_value ( builder, accumulatorStdDeviation( pStats ) );
+}
+
+/*!     \brief  Add the values in the running average of one quantity to the JSON array
+ *
+ * [ oldest .. newest ] (the last N values, or fewer if fewer have been accumulated)
+ *
+ * \param  builder      pointer to the JSON builder
+ * \param  pStats       pointer to the statistics for noise or gain at one frequency
+ * \param  length       averaging length (N)
+ */
+static void
+addAccumulatorHistoryToJSON( JsonBuilder *builder, tAccumulator *pStats, guint length ) {
+    guint nWindow = MIN( pStats->n, length );
+
+    json_builder_begin_array( builder );
+    for( guint i = pStats->n - nWindow; i < pStats->n; i++ )
+        json_builder_add_double_value ( builder, pStats->history[ i % length ] );
+    json_builder_end_array( builder );
+}
+
+/*!     \brief  Read the statistics for one quantity from the JSON array
+ *
+ * The running sum and sum of squared differences are reconstructed from
+ * the running average and standard deviation (the values in the running
+ * average are read by readAccumulatorHistoryFromJSON).
+ *
+ * \param  reader       pointer to the JSON reader (positioned at the bin array)
+ * \param  offset       index of the first item for this quantity
+ * \param  pStats       pointer to the statistics for noise or gain at one frequency
+ * \param  length       averaging length (N)
+ */
+static void
+readAccumulatorFromJSON( JsonReader *reader, gint offset, tAccumulator *pStats, guint length ) {
+    gdouble values[ N_ACCUMULATOR_JSON_ITEMS ] = {0};
+
+    for( gint i=0; i < N_ACCUMULATOR_JSON_ITEMS; i++ ) {
+        json_reader_read_element (reader, offset + i);
+        values[ i ] = json_reader_get_double_value( reader );
+        json_reader_end_element (reader);
+    }
+    // the count is an integer
+    json_reader_read_element (reader, offset);
+    pStats->n = json_reader_get_int_value( reader );
+    json_reader_end_element (reader);
+
+    pStats->exponential = values[ 1 ];
+    pStats->windowSum   = values[ 2 ] * MIN( pStats->n, length );
+    pStats->max         = values[ 3 ];
+    pStats->min         = values[ 4 ];
+    pStats->mean        = values[ 5 ];
+    pStats->sumSqDiff   = pStats->n > 1 ? values[ 6 ] * values[ 6 ] * (pStats->n - 1) : 0.0;
+}
+
+/*!     \brief  Read the values in the running average of one quantity from the JSON array
+ *
+ * The values are put back in the ring where accumulateValue expects them and the running sum
+ * is made from them, so the running average carries on correctly if more sweeps are accumulated.
+ * Older plots do not have the values; the ring is filled with the running average so that the
+ * running sum stays consistent as it is refilled with new values.
+ *
+ * \param  reader       pointer to the JSON reader (positioned at the bin array)
+ * \param  index        index of the array of values for this quantity
+ * \param  pStats       pointer to the statistics for noise or gain at one frequency
+ * \param  length       averaging length (N)
+ */
+static void
+readAccumulatorHistoryFromJSON( JsonReader *reader, gint index, tAccumulator *pStats, guint length ) {
+    guint nWindow = MIN( pStats->n, length );
+    gdouble average = nWindow ? pStats->windowSum / nWindow : 0.0;
+
+    if( json_reader_read_element (reader, index) && json_reader_is_array( reader )
+            && json_reader_count_elements( reader ) == nWindow ) {
+        pStats->windowSum = 0.0;
+        for( guint i = 0; i < nWindow; i++ ) {
+            json_reader_read_element (reader, i);
+            pStats->history[ (pStats->n - nWindow + i) % length ] = json_reader_get_double_value( reader );
+            json_reader_end_element (reader);
+            pStats->windowSum += pStats->history[ (pStats->n - nWindow + i) % length ];
+        }
+    } else {
+        for( guint i = 0; i < length; i++ )
+            pStats->history[ i ] = average;
+    }
+    json_reader_end_element (reader);
+}
+
+/*!     \brief  Convert the noise statistics of an older plot to linear form
+ *
+ * Plots saved before the noise was kept linear have the statistics in the units of the plot.
+ * The standard deviation is converted about the mean.
+ *
+ * \param  pStats       pointer to the noise statistics at one frequency
+ * \param  length       averaging length (N)
+ * \param  units        noise units of the plot
+ */
+static void
+linearAccumulator( tAccumulator *pStats, guint length, tNoiseType units ) {
+    gdouble mean = pStats->mean;
+    gdouble sd = accumulatorStdDeviation( pStats );
+    guint nWindow = MIN( pStats->n, length );
+
+    pStats->exponential = linearNoise( pStats->exponential, units );
+    if( nWindow )
+        pStats->windowSum = linearNoise( pStats->windowSum / nWindow, units ) * nWindow;
+    pStats->max  = linearNoise( pStats->max, units );
+    pStats->min  = linearNoise( pStats->min, units );
+    pStats->mean = linearNoise( mean, units );
+    sd = linearNoise( mean + sd, units ) - pStats->mean;
+    pStats->sumSqDiff = pStats->n > 1 ? sd * sd * (pStats->n - 1) : 0.0;
+}
+
+/*!     \brief  Read a point of a plot from the JSON array
+ *
+ * [ frequency (or time), gain, noise, flags ]
+ *
+ * \param  reader       pointer to the JSON reader (positioned at the points array)
+ * \param  i            index of the point
+ * \param  bTime        the abscissa is time (spot frequency plot)
+ * \param  units        noise units of the file (the noise is made linear)
+ * \param  pMeasurement pointer to the measurement
+ */
+static void
+readPointFromJSON( JsonReader *reader, gint i, gboolean bTime, tNoiseType units, tNoiseAndGain *pMeasurement ) {
+    // move to element i (array with four elements)
+    json_reader_read_element (reader, i);
+
+    // frequency
+    json_reader_read_element (reader, 0);
+    if( bTime )
+        pMeasurement->abscissa.time = json_reader_get_int_value( reader );
+    else
+        pMeasurement->abscissa.freq = json_reader_get_double_value( reader );
+    json_reader_end_element (reader);
+
+    // gain
+    json_reader_read_element (reader, 1);
+    pMeasurement->gain = json_reader_get_double_value( reader );
+    json_reader_end_element (reader);
+
+    // noise
+    json_reader_read_element (reader, 2);
+    pMeasurement->noise = linearNoise( json_reader_get_double_value( reader ), units );
+    json_reader_end_element (reader);
+
+    // flags
+    json_reader_read_element (reader, 3);
+    pMeasurement->flags.all = (guint32)json_reader_get_int_value( reader );
+    json_reader_end_element (reader);
+
+    // end of point
+    json_reader_end_element (reader);
+}
+
+/*!     \brief  Read the points of a swept plot (or trace) from the JSON array
+ *
+ * \param  reader       pointer to the JSON reader (positioned at the points array)
+ * \param  units        noise units of the file (the noise is made linear)
+ * \param  pnPoints     pointer to the number of points read
+ * \return the points (caller must free)
+ */
+static tNoiseAndGain *
+readSweepFromJSON( JsonReader *reader, tNoiseType units, guint *pnPoints ) {
+    gint nPoints = json_reader_count_elements( reader );
+    tNoiseAndGain *data;
+
+    if( nPoints < 0 )
+        nPoints = 0;
+    data = g_malloc0( (nPoints + 1) * sizeof( tNoiseAndGain ) );
+    for( int i=0; i < nPoints; i++ )
+        readPointFromJSON( reader, i, FALSE, units, &data[ i ] );
+
+    *pnPoints = nPoints;
+    return data;
+}
+
+/*!     \brief  Add the points of a trace to the JSON builder
+ *
+ * \param  builder      pointer to the JSON builder
+ * \param  pTrace       pointer to the circular buffer of the trace
+ * \param  units        noise units to save
+ */
+static void
+addTraceToJSON( JsonBuilder *builder, tCircularBuffer *pTrace, tNoiseType units ) {
+    gint  nPoints = nItemsInCircularBuffer( pTrace );
+
+    json_builder_begin_array(builder);      // begin points array
+    for( int i=0; i < nPoints; i++ ) {
+        tNoiseAndGain measurement, *pMeasurement = getItemFromCircularBuffer( pTrace, i, &measurement );
+        json_builder_begin_array(builder);
+        json_builder_add_double_value ( builder, pMeasurement->abscissa.freq );
+        json_builder_add_double_value ( builder, pMeasurement->gain );
+        json_builder_add_double_value ( builder, noiseInUnits( pMeasurement->noise, units ) );
+        json_builder_add_int_value ( builder, pMeasurement->flags.all );
+        json_builder_end_array(builder);
+    }
+    json_builder_end_array(builder);        // end points array
+}
+
 /*!     \brief  Retrieve plot in JSON form from a file
  *
  * Retrieve plot in JSON form from a file
@@ -184,6 +402,18 @@ retrievePlot( gchar *filePath, tGlobal *pGlobal ) {
             pGlobal->plot.freqSpotMHz = 0.0;
         json_reader_end_member (reader);
 
+        pGlobal->plot.nMultiSpot = 0;
+        if( json_reader_read_member (reader, "multiSpotMHz") == TRUE ) {
+            gint nSpot = MIN( json_reader_count_elements( reader ), MAX_MULTI_SPOT );
+            for( gint i = 0; i < nSpot; i++ ) {
+                json_reader_read_element (reader, i);
+                pGlobal->plot.multiSpotMHz[ i ] = json_reader_get_double_value( reader );
+                json_reader_end_element (reader);
+            }
+            pGlobal->plot.nMultiSpot = nSpot;
+        }
+        json_reader_end_member (reader);
+
         if( json_reader_read_member (reader, "freqStartMHz") == TRUE )
             pGlobal->plot.freqStartMHz = json_reader_get_double_value ( reader );
         else
@@ -283,88 +513,214 @@ retrievePlot( gchar *filePath, tGlobal *pGlobal ) {
 // end settings
         json_reader_end_member (reader);    // settings
 
+        // a restored plot cannot be continued (and only has the points saved)
+        pGlobal->plot.sweepCheckpoint.flags.bValid = FALSE;
+        clearMeasurementLog( &pGlobal->plot.spotLog );
+
         if( json_reader_read_member (reader, "points")  ) {
 
             gint nPoints = json_reader_count_elements( reader );
             initCircularBuffer( &pGlobal->plot.measurementBuffer, nPoints+1, pGlobal->plot.spotFrequency ? eTimeAbscissa : eFreqAbscissa );
+            pGlobal->plot.measurementBuffer.flags.bYfactor = IS_Y_FACTOR( pGlobal->plot.noiseUnits );
 
             for( int i=0; i < nPoints; i++ ) {
-                // point array 1 of N
-                // move to element i (array with four elements)
                 tNoiseAndGain measurement;
-                json_reader_read_element (reader, i);
-
-                // frequency
-                json_reader_read_element (reader, 0);
-
-                if( pGlobal->plot.flags.bSpotFrequencyPlot )
-                    measurement.abscissa.time = json_reader_get_int_value( reader );
-                else
-                    measurement.abscissa.freq = json_reader_get_double_value( reader );
-
-                json_reader_end_element (reader);
-
-                // gain
-                json_reader_read_element (reader, 1);
-                measurement.gain = json_reader_get_double_value( reader );
-                json_reader_end_element (reader);
-
-                // noise
-                json_reader_read_element (reader, 2);
-                measurement.noise = json_reader_get_double_value( reader );
-                json_reader_end_element (reader);
-
-                // flags
-                json_reader_read_element (reader, 3);
-                measurement.flags.all = (guint32)json_reader_get_int_value( reader );
-                json_reader_end_element (reader);
+                readPointFromJSON( reader, i, pGlobal->plot.flags.bSpotFrequencyPlot, pGlobal->plot.noiseUnits, &measurement );
                 addItemToCircularBuffer( &pGlobal->plot.measurementBuffer, &measurement, TRUE );
-                // end of point
-                json_reader_end_element (reader);
             }
             json_reader_end_member (reader);    // points
         }
 
-        if( json_reader_read_member (reader, "memory_points")  ) {
-            // memory on;y works with frequency
-            gint nPoints = json_reader_count_elements( reader );
-            initCircularBuffer( &pGlobal->plot.memoryBuffer, nPoints+1, eFreqAbscissa );
-
-            for( int i=0; i < nPoints; i++ ) {
-                // point array 1 of N
-                // move to element i (array with four elements)
-                tNoiseAndGain measurement;
-                json_reader_read_element (reader, i);
-
-                // frequency
-                json_reader_read_element (reader, 0);
+        // Trace library (memory) .. only replaced if the plot has one
+        if( json_reader_read_member (reader, "traces")  ) {
+            tTraceLibrary *pLibrary = &pGlobal->plot.traceLibrary;
+            gint nTraces = json_reader_count_elements( reader );
 
-                measurement.abscissa.freq = json_reader_get_double_value( reader );
+            clearTraceLibrary( pLibrary );
+            for( int i=0; i < nTraces; i++ ) {
+                gint color = INVALID, style = eTraceDashed;
+                tNoiseType units = pGlobal->plot.noiseUnits;
+                gboolean bVisible = TRUE;
+                gchar *sName = NULL;
+                tNoiseAndGain *data = NULL;
+                guint nPoints = 0;
 
+                json_reader_read_element (reader, i);
+                if( json_reader_read_member (reader, "name") == TRUE )
+                    sName = g_strdup( json_reader_get_string_value ( reader ) );
+                json_reader_end_member (reader);
+                if( json_reader_read_member (reader, "color") == TRUE )
+                    color = json_reader_get_int_value ( reader );
+                json_reader_end_member (reader);
+                if( json_reader_read_member (reader, "style") == TRUE )
+                    style = json_reader_get_int_value ( reader );
+                json_reader_end_member (reader);
+                if( json_reader_read_member (reader, "visible") == TRUE )
+                    bVisible = json_reader_get_boolean_value ( reader );
+                json_reader_end_member (reader);
+                // (the points must be read after the units)
+                if( json_reader_read_member (reader, "noiseUnits") == TRUE )
+                    units = json_reader_get_int_value ( reader );
+                json_reader_end_member (reader);
+                if( json_reader_read_member (reader, "points") == TRUE )
+                    data = readSweepFromJSON( reader, units, &nPoints );
+                json_reader_end_member (reader);
                 json_reader_end_element (reader);
 
-                // gain
-                json_reader_read_element (reader, 1);
-                measurement.gain = json_reader_get_double_value( reader );
-                json_reader_end_element (reader);
-
-                // noise
-                json_reader_read_element (reader, 2);
-                measurement.noise = json_reader_get_double_value( reader );
-                json_reader_end_element (reader);
+                if( storeTraceData( pLibrary, data, nPoints, IS_Y_FACTOR( units ), sName ) != ERROR ) {
+                    tTraceSlot *pSlot = &pLibrary->slots[ pLibrary->selected ];
+                    if( color >= 0 && color < N_TRACE_COLORS )
+                        pSlot->color = color;
+                    if( style >= 0 && style < eMAX_TRACE_STYLES )
+                        pSlot->style = style;
+                    pSlot->flags.bVisible = bVisible;
+                }
+                g_free( data );
+                g_free( sName );
+            }
+            if( !pGlobal->flags.bHeadless && pLibrary->nTraces > 0 )
+                gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
+        }
+        json_reader_end_member (reader);    // traces
 
-                // flags
-                json_reader_read_element (reader, 3);
-                measurement.flags.all = (guint32)json_reader_get_int_value( reader );
-                json_reader_end_element (reader);
-                addItemToCircularBuffer( &pGlobal->plot.memoryBuffer, &measurement, TRUE );
-                // end of point
-                json_reader_end_element (reader);
+        // the single memory trace of older plots
+        if( json_reader_read_member (reader, "memory_points")  ) {
+            // memory only works with frequency
+            guint nPoints;
+            tNoiseAndGain *data = readSweepFromJSON( reader, pGlobal->plot.noiseUnits, &nPoints );
+
+            clearTraceLibrary( &pGlobal->plot.traceLibrary );
+            if( storeTraceData( &pGlobal->plot.traceLibrary, data, nPoints,
+                                IS_Y_FACTOR( pGlobal->plot.noiseUnits ), "Memory" ) != ERROR
+                    && !pGlobal->flags.bHeadless )
+                gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
+            g_free( data );
+        }
+        json_reader_end_member (reader);    // memory_points
+
+
+        // Statistics accumulated over repeated sweeps
+        if( json_reader_read_member (reader, "accumulated")  ) {
+            gint nBins = 0, length = DEFAULT_ACCUMULATOR_LENGTH, nSweeps = 0;
+            gboolean bLinear = FALSE;
+
+            // older plots have the noise statistics in the units of the plot
+            if( json_reader_read_member (reader, "linearNoise") == TRUE )
+                bLinear = json_reader_get_boolean_value ( reader );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "length") == TRUE )
+                length = json_reader_get_int_value ( reader );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "sweeps") == TRUE )
+                nSweeps = json_reader_get_int_value ( reader );
+            json_reader_end_member (reader);
+
+            if( json_reader_read_member (reader, "bins") == TRUE ) {
+                nBins = json_reader_count_elements( reader );
+                initTraceAccumulators( &pGlobal->plot.accumulators, nBins, length );
+                g_mutex_lock( &pGlobal->plot.accumulators.mAccumulators );
+                for( int i=0; i < nBins; i++ ) {
+                    tAccumulatorBin *pBin = &pGlobal->plot.accumulators.bins[ i ];
+                    // [ freq, noise statistics ..., gain statistics ..., [ noise values ], [ gain values ] ]
+                    json_reader_read_element (reader, i);
+                    json_reader_read_element (reader, 0);
+                    pBin->freq = json_reader_get_double_value( reader );
+                    json_reader_end_element (reader);
+                    readAccumulatorFromJSON( reader, 1, &pBin->noise, pGlobal->plot.accumulators.length );
+                    readAccumulatorFromJSON( reader, 1 + N_ACCUMULATOR_JSON_ITEMS, &pBin->gain, pGlobal->plot.accumulators.length );
+                    if( !bLinear )
+                        linearAccumulator( &pBin->noise, pGlobal->plot.accumulators.length, pGlobal->plot.noiseUnits );
+                    readAccumulatorHistoryFromJSON( reader, 1 + 2 * N_ACCUMULATOR_JSON_ITEMS,
+                                                    &pBin->noise, pGlobal->plot.accumulators.length );
+                    readAccumulatorHistoryFromJSON( reader, 2 + 2 * N_ACCUMULATOR_JSON_ITEMS,
+                                                    &pBin->gain, pGlobal->plot.accumulators.length );
+                    json_reader_end_element (reader);
+                }
+                pGlobal->plot.accumulators.nSweeps = nSweeps;
+                pGlobal->plot.accumulators.flags.bValid = (nBins > 0);
+                g_mutex_unlock( &pGlobal->plot.accumulators.mAccumulators );
             }
-            json_reader_end_member (reader);    // points
-            gtk_check_button_set_active ( pGlobal->widgets[ eW_chk_ShowMemory ], TRUE );
+            json_reader_end_member (reader);    // bins
+        } else {
+            pGlobal->plot.accumulators.flags.bValid = FALSE;
         }
+        json_reader_end_member (reader);    // accumulated
+
+        // Two dimensional (parameter) sweep
+        g_mutex_lock( &pGlobal->plot.sweep2D.mSweep2D );
+        freeSweep2D( &pGlobal->plot.sweep2D );
+        if( json_reader_read_member (reader, "sweep2D")  ) {
+            tSweep2D *pSweep2D = &pGlobal->plot.sweep2D;
+            guint nRows = 0, nColumns = 0, nRowsDone = 0;
+
+            if( json_reader_read_member (reader, "device") == TRUE )
+                pSweep2D->parameter.sDevice = g_strdup( json_reader_get_string_value ( reader ) );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "command") == TRUE )
+                pSweep2D->parameter.sSetCommand = g_strdup( json_reader_get_string_value ( reader ) );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "start") == TRUE )
+                pSweep2D->parameter.start = json_reader_get_double_value ( reader );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "stop") == TRUE )
+                pSweep2D->parameter.stop = json_reader_get_double_value ( reader );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "step") == TRUE )
+                pSweep2D->parameter.step = json_reader_get_double_value ( reader );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "rows") == TRUE )
+                nRows = json_reader_get_int_value ( reader );
+            json_reader_end_member (reader);
+
+            if( json_reader_read_member (reader, "frequencies") == TRUE ) {
+                nColumns = json_reader_count_elements( reader );
+                pSweep2D->frequencies = g_malloc( nColumns * sizeof( gdouble ) );
+                for( int i=0; i < nColumns; i++ ) {
+                    json_reader_read_element (reader, i);
+                    pSweep2D->frequencies[ i ] = json_reader_get_double_value( reader );
+                    json_reader_end_element (reader);
+                }
+            }
+            json_reader_end_member (reader);
+
+            if( json_reader_read_member (reader, "points") == TRUE ) {
+                nRowsDone = json_reader_count_elements( reader );
+                nRows = MAX( nRows, nRowsDone );
+                pSweep2D->data = g_malloc0( nRows * nColumns * sizeof( tNoiseAndGain ) );
+                for( int row=0; row < nRowsDone; row++ ) {
+                    json_reader_read_element (reader, row);
+                    for( int i=0; i < nColumns && i < json_reader_count_elements( reader ); i++ ) {
+                        tNoiseAndGain *pMeasurement = &pSweep2D->data[ row * nColumns + i ];
+                        pMeasurement->abscissa.freq = pSweep2D->frequencies[ i ];
+                        // [ gain, noise, flags ]
+                        json_reader_read_element (reader, i);
+                        json_reader_read_element (reader, 0);
+                        pMeasurement->gain = json_reader_get_double_value( reader );
+                        json_reader_end_element (reader);
+                        json_reader_read_element (reader, 1);
+                        pMeasurement->noise = linearNoise( json_reader_get_double_value( reader ), pGlobal->plot.noiseUnits );
+                        json_reader_end_element (reader);
+                        json_reader_read_element (reader, 2);
+                        pMeasurement->flags.all = (guint32)json_reader_get_int_value( reader );
+                        json_reader_end_element (reader);
+                        json_reader_end_element (reader);
+                    }
+                    json_reader_end_element (reader);
+                }
+            }
+            json_reader_end_member (reader);    // points
 
+            pSweep2D->nRows = nRows;
+            pSweep2D->nColumns = nColumns;
+            pSweep2D->nRowsDone = nRowsDone;
+            if( nColumns > 0 && nRowsDone > 0 && pSweep2D->parameter.sSetCommand != NULL )
+                pSweep2D->flags.bValid = TRUE;
+            else
+                freeSweep2D( pSweep2D );
+        }
+        json_reader_end_member (reader);    // sweep2D
+        g_mutex_unlock( &pGlobal->plot.sweep2D.mSweep2D );
+        pGlobal->flags.bShowHeatMap = pGlobal->plot.sweep2D.flags.bValid;
 
         json_reader_end_member (reader);    // HP8970
         bOK = TRUE;
@@ -377,16 +733,90 @@ retrievePlot( gchar *filePath, tGlobal *pGlobal ) {
     // we will display 60 seconds * the smoothing factor
     if( pGlobal->plot.flags.bSpotFrequencyPlot )
         pGlobal->plot.measurementBuffer.idxTimeBeforeTail = findTimeDeltaInCircularBuffer(&pGlobal->plot.measurementBuffer,
-                                                                       TIME_PLOT_LENGTH * pGlobal->plot.smoothingFactor  );
+                                                                       TIME_PLOT_SPAN( &pGlobal->plot ) );
     else
         pGlobal->plot.measurementBuffer.idxTimeBeforeTail = 0;
 
-    gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
-    gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_SaveJSON ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+    if( !pGlobal->flags.bHeadless ) {
+        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_CSV ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+        gtk_widget_set_sensitive( pGlobal->widgets[ eW_btn_SaveJSON ], pGlobal->plot.measurementBuffer.flags.bValidNoiseData );
+    }
 
     return bOK ? 0 : ERROR;
 }
 
+/*!     \brief  Retrieve the swept plot in a JSON file as a trace of the trace library
+ *
+ * Only the points are used; the settings of the plot on screen are not changed.
+ *
+ * \param  filePath         pointer to the filename and path
+ * \param  pGlobal          pointer to global data
+ * \return number of traces in the library or ERROR
+ */
+gint
+retrieveTrace( gchar *filePath, tGlobal *pGlobal ) {
+    gint rtn = ERROR;
+    GError *error = NULL;
+
+    GFile *file = g_file_new_for_path( filePath );
+    GFileInputStream *fileStream = g_file_read ( file, NULL, &error );
+    g_object_unref( file );
+
+    if( fileStream == NULL ) {
+        g_clear_error( &error );
+        return ERROR;
+    }
+
+    JsonParser *parser = json_parser_new ();
+    json_parser_load_from_stream (parser, G_INPUT_STREAM( fileStream ), NULL, &error);
+    JsonReader *reader = json_reader_new (json_parser_get_root (parser));
+
+    do {
+        gboolean bSpotFrequencyPlot = FALSE;
+        tNoiseType units = eFdB;
+        gchar *sName = NULL;
+        tNoiseAndGain *data;
+        guint nPoints;
+
+        if( json_reader_read_member (reader, "HP8970") == FALSE )
+            break;
+
+        if( json_reader_read_member (reader, "settings") == TRUE ) {
+            if( json_reader_read_member (reader, "spotFrequencyPlot") == TRUE )
+                bSpotFrequencyPlot = json_reader_get_boolean_value ( reader );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "noiseUnits") == TRUE )
+                units = json_reader_get_int_value ( reader );
+            json_reader_end_member (reader);
+            if( json_reader_read_member (reader, "title") == TRUE && *json_reader_get_string_value ( reader ) )
+                sName = g_strdup( json_reader_get_string_value ( reader ) );
+            json_reader_end_member (reader);
+        }
+        json_reader_end_member (reader);    // settings
+
+        // a spot frequency plot cannot be shown with a swept plot
+        if( bSpotFrequencyPlot || json_reader_read_member (reader, "points") == FALSE ) {
+            g_free( sName );
+            break;
+        }
+        data = readSweepFromJSON( reader, units, &nPoints );
+        json_reader_end_member (reader);    // points
+
+        if( sName == NULL )
+            sName = g_path_get_basename( filePath );
+        rtn = storeTraceData( &pGlobal->plot.traceLibrary, data, nPoints, IS_Y_FACTOR( units ), sName );
+        g_free( data );
+        g_free( sName );
+    } while FALSE;
+
+    g_clear_error( &error );
+    g_object_unref( parser );
+    g_object_unref( reader );
+    g_object_unref( fileStream );
+
+    return rtn;
+}
+
 /*!     \brief  Save plot in JSON form to a file
  *
  * Save plot in JSON form to a file
@@ -451,6 +881,13 @@ savePlot( gchar *filePath, tGlobal *pGlobal ) {
             // Save current settings (not needed for plot)
             json_builder_set_member_name (builder, "freqSpotMHz");
             json_builder_add_double_value ( builder, pGlobal->plot.freqSpotMHz );
+            if( pGlobal->plot.nMultiSpot > 0 ) {
+                json_builder_set_member_name (builder, "multiSpotMHz");
+                json_builder_begin_array(builder);
+                for( gint i = 0; i < pGlobal->plot.nMultiSpot; i++ )
+                    json_builder_add_double_value ( builder, pGlobal->plot.multiSpotMHz[ i ] );
+                json_builder_end_array(builder);
+            }
             json_builder_set_member_name (builder, "freqStartMHz");
             json_builder_add_double_value ( builder, pGlobal->plot.freqStartMHz );
             json_builder_set_member_name (builder, "freqStopMHz");
@@ -501,35 +938,156 @@ savePlot( gchar *filePath, tGlobal *pGlobal ) {
             json_builder_begin_array(builder);      // begin points array
             gint  nPoints = nItemsInCircularBuffer( &pGlobal->plot.measurementBuffer );
             for( int i=0; i < nPoints; i++ ) {
-                tNoiseAndGain *pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.measurementBuffer, i );
+                tNoiseAndGain measurement, *pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.measurementBuffer, i, &measurement );
                 json_builder_begin_array(builder);
                 if( pGlobal->plot.flags.bSpotFrequencyPlot )
                     json_builder_add_int_value ( builder, pMeasurement->abscissa.time );
                 else
                     json_builder_add_double_value ( builder, pMeasurement->abscissa.freq );
                 json_builder_add_double_value ( builder, pMeasurement->gain );
-                json_builder_add_double_value ( builder, pMeasurement->noise );
+                json_builder_add_double_value ( builder, noiseInUnits( pMeasurement->noise, pGlobal->plot.noiseUnits ) );
                 json_builder_add_int_value ( builder, pMeasurement->flags.all );
                 json_builder_end_array(builder);
             }
             json_builder_end_array(builder);        // end points array
         }
 
-        // Memory buffer
-        if( pGlobal->plot.memoryBuffer.flags.bValidNoiseData || pGlobal->plot.memoryBuffer.flags.bValidGainData ) {
-            json_builder_set_member_name (builder, "memory_points");
+        // Trace library (memory)
+        if( pGlobal->plot.traceLibrary.nTraces > 0 ) {
+            tTraceLibrary *pLibrary = &pGlobal->plot.traceLibrary;
+
+            g_mutex_lock( &pLibrary->mTraces );
+            json_builder_set_member_name (builder, "traces");
+            json_builder_begin_array(builder);      // begin traces array
+            for( int i=0; i < pLibrary->nTraces; i++ ) {
+                tTraceSlot *pSlot = &pLibrary->slots[ i ];
+                // in the units of the plot (if the trace can be shown in them)
+                tNoiseType units = pSlot->pTrace->data.flags.bYfactor ? eYdB : eFdB;
+                if( pSlot->pTrace->data.flags.bYfactor == IS_Y_FACTOR( pGlobal->plot.noiseUnits ) )
+                    units = pGlobal->plot.noiseUnits;
+                json_builder_begin_object( builder );
+                json_builder_set_member_name (builder, "name");
+                json_builder_add_string_value ( builder, pSlot->pTrace->sName ? pSlot->pTrace->sName : "" );
+                json_builder_set_member_name (builder, "color");
+                json_builder_add_int_value ( builder, pSlot->color );
+                json_builder_set_member_name (builder, "style");
+                json_builder_add_int_value ( builder, pSlot->style );
+                json_builder_set_member_name (builder, "visible");
+                json_builder_add_boolean_value ( builder, pSlot->flags.bVisible );
+                json_builder_set_member_name (builder, "noiseUnits");
+                json_builder_add_int_value ( builder, units );
+                json_builder_set_member_name (builder, "points");
+                addTraceToJSON( builder, &pSlot->pTrace->data, units );
+                json_builder_end_object( builder );
+            }
+            json_builder_end_array(builder);        // end traces array
+            g_mutex_unlock( &pLibrary->mTraces );
+        }
+
+        // Statistics accumulated over repeated sweeps
+        if( !pGlobal->plot.flags.bSpotFrequencyPlot && pGlobal->plot.accumulators.flags.bValid ) {
+            tTraceAccumulators *pAccum = &pGlobal->plot.accumulators;
+
+            g_mutex_lock( &pAccum->mAccumulators );
+            json_builder_set_member_name (builder, "accumulated");
+            json_builder_begin_object( builder );   // begin accumulated
+            json_builder_set_member_name (builder, "linearNoise");
+            json_builder_add_boolean_value ( builder, TRUE );
+            json_builder_set_member_name (builder, "sweeps");
+            json_builder_add_int_value ( builder, pAccum->nSweeps );
+            json_builder_set_member_name (builder, "length");
+            json_builder_add_int_value ( builder, pAccum->length );
+            json_builder_set_member_name (builder, "bins");
+            json_builder_begin_array(builder);      // begin bins array
+            for( int i=0; i < pAccum->nBins; i++ ) {
+                if( pAccum->bins[ i ].noise.n == 0 && pAccum->bins[ i ].gain.n == 0 )
+                    continue;
+                json_builder_begin_array(builder);
+                json_builder_add_double_value ( builder, pAccum->bins[ i ].freq );
+                addAccumulatorToJSON( builder, &pAccum->bins[ i ].noise, pAccum->length );
+                addAccumulatorToJSON( builder, &pAccum->bins[ i ].gain, pAccum->length );
+                addAccumulatorHistoryToJSON( builder, &pAccum->bins[ i ].noise, pAccum->length );
+                addAccumulatorHistoryToJSON( builder, &pAccum->bins[ i ].gain, pAccum->length );
+                json_builder_end_array(builder);
+            }
+            json_builder_end_array(builder);        // end bins array
+            json_builder_end_object( builder );     // end accumulated
+            g_mutex_unlock( &pAccum->mAccumulators );
+        }
+
+        // Two dimensional (parameter) sweep
+        if( pGlobal->plot.sweep2D.flags.bValid ) {
+            tSweep2D *pSweep2D = &pGlobal->plot.sweep2D;
+
+            g_mutex_lock( &pSweep2D->mSweep2D );
+            json_builder_set_member_name (builder, "sweep2D");
+            json_builder_begin_object( builder );   // begin sweep2D
+            if( pSweep2D->parameter.sDevice ) {
+                json_builder_set_member_name (builder, "device");
+                json_builder_add_string_value ( builder, pSweep2D->parameter.sDevice );
+            }
+            json_builder_set_member_name (builder, "command");
+            json_builder_add_string_value ( builder, pSweep2D->parameter.sSetCommand );
+            json_builder_set_member_name (builder, "start");
+            json_builder_add_double_value ( builder, pSweep2D->parameter.start );
+            json_builder_set_member_name (builder, "stop");
+            json_builder_add_double_value ( builder, pSweep2D->parameter.stop );
+            json_builder_set_member_name (builder, "step");
+            json_builder_add_double_value ( builder, pSweep2D->parameter.step );
+            json_builder_set_member_name (builder, "rows");
+            json_builder_add_int_value ( builder, pSweep2D->nRows );
+            json_builder_set_member_name (builder, "frequencies");
+            json_builder_begin_array(builder);      // begin frequencies array
+            for( int i=0; i < pSweep2D->nColumns; i++ )
+                json_builder_add_double_value ( builder, pSweep2D->frequencies[ i ] );
+            json_builder_end_array(builder);        // end frequencies array
+            // a row for each parameter value swept, each point [ gain, noise, flags ]
+            json_builder_set_member_name (builder, "points");
+            json_builder_begin_array(builder);      // begin points array
+            for( int row=0; row < pSweep2D->nRowsDone; row++ ) {
+                json_builder_begin_array(builder);  // begin row
+                for( int i=0; i < pSweep2D->nColumns; i++ ) {
+                    tNoiseAndGain *pMeasurement = &pSweep2D->data[ row * pSweep2D->nColumns + i ];
+                    json_builder_begin_array(builder);
+                    json_builder_add_double_value ( builder, pMeasurement->gain );
+                    json_builder_add_double_value ( builder, noiseInUnits( pMeasurement->noise, pGlobal->plot.noiseUnits ) );
+                    json_builder_add_int_value ( builder, pMeasurement->flags.all );
+                    json_builder_end_array(builder);
+                }
+                json_builder_end_array(builder);    // end row
+            }
+            json_builder_end_array(builder);        // end points array
+            json_builder_end_object( builder );     // end sweep2D
+            g_mutex_unlock( &pSweep2D->mSweep2D );
+        }
+
+        // The calibration sweep (for diagnostics)
+        if( pGlobal->calibration.nPoints != 0 ) {
+            tCalibration *pCalibration = &pGlobal->calibration;
+
+            json_builder_set_member_name (builder, "calibration");
+            json_builder_begin_object( builder );   // begin calibration
+            json_builder_set_member_name (builder, "key");
+            json_builder_add_int_value ( builder, pCalibration->key );
+            if( pCalibration->sDateTime ) {
+                json_builder_set_member_name (builder, "dateTime");
+                json_builder_add_string_value ( builder, pCalibration->sDateTime );
+            }
+            json_builder_set_member_name (builder, "noiseUnits");
+            json_builder_add_int_value ( builder, pCalibration->noiseUnits );
+            json_builder_set_member_name (builder, "points");
             json_builder_begin_array(builder);      // begin points array
-            gint  nPoints = nItemsInCircularBuffer( &pGlobal->plot.memoryBuffer );
-            for( int i=0; i < nPoints; i++ ) {
-                tNoiseAndGain *pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.memoryBuffer, i );
+            for( int i=0; i < pCalibration->nPoints; i++ ) {
+                tNoiseAndGain *pMeasurement = &pCalibration->data[ i ];
                 json_builder_begin_array(builder);
                 json_builder_add_double_value ( builder, pMeasurement->abscissa.freq );
                 json_builder_add_double_value ( builder, pMeasurement->gain );
-                json_builder_add_double_value ( builder, pMeasurement->noise );
+                json_builder_add_double_value ( builder, noiseInUnits( pMeasurement->noise, pCalibration->noiseUnits ) );
                 json_builder_add_int_value ( builder, pMeasurement->flags.all );
                 json_builder_end_array(builder);
             }
             json_builder_end_array(builder);        // end points array
+            json_builder_end_object( builder );     // end calibration
         }
 
     json_builder_end_object (builder);   //end HP8970
@@ -594,11 +1152,8 @@ CB_JSONsave( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
         // so that the settings will be saved.
         if( pGlobal->plot.measurementBuffer.flags.bValidNoiseData == FALSE && pGlobal->plot.measurementBuffer.flags.bValidGainData == FALSE )
             snapshotSettings( pGlobal );
-        if( savePlot( sChosenFilename, pGlobal  ) != 0 )  {
-            alert_dialog = gtk_alert_dialog_new ("Cannot open file for writing:\n%s", sChosenFilename);
-            gtk_alert_dialog_show (alert_dialog, NULL);
-            g_object_unref (alert_dialog);
-        }
+        // written in the background (a failure is posted to the status line)
+        writePlotSnapshot( snapshotPlot( pGlobal ), eJSON, sChosenFilename );
 
         suggestFilename( pGlobal, selectedFileBasename, "json" );
         g_free( sSuggestedHPGLfilename );
@@ -681,6 +1236,59 @@ CB_rightClickGesture_SaveJSON (GtkGesture *gesture, int n_press, double x, doubl
 }
 
 
+/*!     \brief  Copy the settings saved with a plot to the current settings
+ *
+ * The settings snapshot taken when the plot was measured is read with the plot.
+ * These become the current settings (so that the measurement can be repeated).
+ *
+ * \param  pGlobal          pointer to global data
+ */
+void
+restoreSettingsFromPlot( tGlobal *pGlobal ) {
+    gboolean bExtLO = !(pGlobal->plot.mode == eMode1_0 || pGlobal->plot.mode == eMode1_4);
+    if( pGlobal->plot.freqSpotMHz != 0.0 )
+        pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz = pGlobal->plot.freqSpotMHz;
+    if( pGlobal->plot.nMultiSpot > 0 ) {
+        memcpy( pGlobal->HP8970settings.multiSpotMHz, pGlobal->plot.multiSpotMHz, sizeof( pGlobal->plot.multiSpotMHz ) );
+        pGlobal->HP8970settings.nMultiSpot = pGlobal->plot.nMultiSpot;
+    }
+    if( pGlobal->plot.freqStartMHz != 0.0 )
+        pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz = pGlobal->plot.freqStartMHz;
+    if( pGlobal->plot.freqStopMHz != 0.0 )
+        pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz = pGlobal->plot.freqStopMHz;
+    if( pGlobal->plot.freqStepCalMHz != 0.0 )
+        pGlobal->HP8970settings.range[ bExtLO ].freqStepCalMHz = pGlobal->plot.freqStepCalMHz;
+    if( pGlobal->plot.freqStepSweepMHz != 0.0 )
+        pGlobal->HP8970settings.range[ bExtLO ].freqStepSweepMHz = pGlobal->plot.freqStepSweepMHz;
+
+    pGlobal->HP8970settings.mode = pGlobal->plot.mode;
+
+    if( pGlobal->plot.extLOfreqIF != 0 )
+        pGlobal->HP8970settings.extLOfreqIF = pGlobal->plot.extLOfreqIF;
+    if( pGlobal->plot.extLOfreqLO != 0 )
+        pGlobal->HP8970settings.extLOfreqLO = pGlobal->plot.extLOfreqLO;
+
+    pGlobal->HP8970settings.settlingTime_ms = pGlobal->plot.settlingTime_ms;
+
+    if( pGlobal->plot.sExtLOsetup != NULL ) {
+        g_free( pGlobal->HP8970settings.sExtLOsetup );
+        pGlobal->HP8970settings.sExtLOsetup = g_strdup( pGlobal->plot.sExtLOsetup );
+    }
+    if( pGlobal->plot.sExtLOsetFreq != NULL ) {
+        g_free( pGlobal->HP8970settings.sExtLOsetFreq );
+        pGlobal->HP8970settings.sExtLOsetFreq = g_strdup( pGlobal->plot.sExtLOsetFreq );
+    }
+
+    pGlobal->HP8970settings.extLOsideband = pGlobal->plot.extLOsideband;
+
+    pGlobal->HP8970settings.lossBeforeDUT = pGlobal->plot.lossBeforeDUT;
+    pGlobal->HP8970settings.lossAfterDUT  = pGlobal->plot.lossAfterDUT;
+    pGlobal->HP8970settings.lossTemp  = pGlobal->plot.lossTemp;
+    pGlobal->HP8970settings.coldTemp  = pGlobal->plot.coldTemp;
+
+    pGlobal->HP8970settings.switches.bLossCompensation = pGlobal->plot.flags.bLossCompensation;
+}
+
 /*!     \brief  Callback when opening file from system file selection dialog
  *
  * Callback when opening file from system file selection dialog
@@ -710,7 +1318,7 @@ CB_JSONopen( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
         if( retrievePlot( sChosenFilename, pGlobal ) == 0 ) {
             gint  nPoints = nItemsInCircularBuffer( &pGlobal->plot.measurementBuffer );
             for( int i=0; i < nPoints; i++ ) {
-                tNoiseAndGain *pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.measurementBuffer, i );
+                tNoiseAndGain measurement, *pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.measurementBuffer, i, &measurement );
                 if( !pMeasurement->flags.each.bGainInvalid )
                     pGlobal->plot.measurementBuffer.flags.bValidGainData = TRUE;
                 if( !pMeasurement->flags.each.bNoiseInvalid )
@@ -720,18 +1328,6 @@ CB_JSONopen( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
                                   &pGlobal->plot.measurementBuffer.maxAbscissa.freq );
             }
 
-            nPoints = nItemsInCircularBuffer( &pGlobal->plot.memoryBuffer );
-            for( int i=0; i < nPoints; i++ ) {
-                tNoiseAndGain *pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.memoryBuffer, i );
-                if( !pMeasurement->flags.each.bGainInvalid )
-                    pGlobal->plot.memoryBuffer.flags.bValidGainData = TRUE;
-                if( !pMeasurement->flags.each.bNoiseInvalid )
-                    pGlobal->plot.memoryBuffer.flags.bValidNoiseData = TRUE;
-                // Update the minimum and maximum values
-                updateBoundaries( pMeasurement->abscissa.freq,  &pGlobal->plot.memoryBuffer.minAbscissa.freq,
-                                  &pGlobal->plot.memoryBuffer.maxAbscissa.freq );
-            }
-
             gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
             // This has the side effect of redrawing
             GtkEditable *wTitle = gtk_editable_get_delegate(GTK_EDITABLE( pGlobal->widgets[ eW_entry_Title ] ));
@@ -749,45 +1345,7 @@ CB_JSONopen( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
             setFixedRangePlotWidgets( pGlobal );
 
             // Recover settings .. read to snapshot, now copy to controls
-            // Save current settings (not needed for plot)
-            gboolean bExtLO = !(pGlobal->plot.mode == eMode1_0 || pGlobal->plot.mode == eMode1_4);
-            if( pGlobal->plot.freqSpotMHz != 0.0 )
-                pGlobal->HP8970settings.range[ bExtLO ].freqSpotMHz = pGlobal->plot.freqSpotMHz;
-            if( pGlobal->plot.freqStartMHz != 0.0 )
-                pGlobal->HP8970settings.range[ bExtLO ].freqStartMHz = pGlobal->plot.freqStartMHz;
-            if( pGlobal->plot.freqStopMHz != 0.0 )
-                pGlobal->HP8970settings.range[ bExtLO ].freqStopMHz = pGlobal->plot.freqStopMHz;
-            if( pGlobal->plot.freqStepCalMHz != 0.0 )
-                pGlobal->HP8970settings.range[ bExtLO ].freqStepCalMHz = pGlobal->plot.freqStepCalMHz;
-            if( pGlobal->plot.freqStepSweepMHz != 0.0 )
-                pGlobal->HP8970settings.range[ bExtLO ].freqStepSweepMHz = pGlobal->plot.freqStepSweepMHz;
-
-            pGlobal->HP8970settings.mode = pGlobal->plot.mode;
-
-            if( pGlobal->plot.extLOfreqIF != 0 )
-                pGlobal->HP8970settings.extLOfreqIF = pGlobal->plot.extLOfreqIF;
-            if( pGlobal->plot.extLOfreqLO != 0 )
-                pGlobal->HP8970settings.extLOfreqLO = pGlobal->plot.extLOfreqLO;
-
-            pGlobal->HP8970settings.settlingTime_ms = pGlobal->plot.settlingTime_ms;
-
-            if( pGlobal->plot.sExtLOsetup != NULL ) {
-                g_free( pGlobal->HP8970settings.sExtLOsetup );
-                pGlobal->HP8970settings.sExtLOsetup = g_strdup( pGlobal->plot.sExtLOsetup );
-            }
-            if( pGlobal->plot.sExtLOsetFreq != NULL ) {
-                g_free( pGlobal->HP8970settings.sExtLOsetFreq );
-                pGlobal->HP8970settings.sExtLOsetFreq = g_strdup( pGlobal->plot.sExtLOsetFreq );
-            }
-
-            pGlobal->HP8970settings.extLOsideband = pGlobal->plot.extLOsideband;
-
-            pGlobal->HP8970settings.lossBeforeDUT = pGlobal->plot.lossBeforeDUT;
-            pGlobal->HP8970settings.lossAfterDUT  = pGlobal->plot.lossAfterDUT;
-            pGlobal->HP8970settings.lossTemp  = pGlobal->plot.lossTemp;
-            pGlobal->HP8970settings.coldTemp  = pGlobal->plot.coldTemp;
-
-            pGlobal->HP8970settings.switches.bLossCompensation = pGlobal->plot.flags.bLossCompensation;
+            restoreSettingsFromPlot( pGlobal );
 
             setPageExtLOwidgets( pGlobal );
             refreshPageHP8970( pGlobal );
@@ -41,16 +41,174 @@ tPaperDimensions paperDimensions[ eNumPaperSizes ] = {
 };
 
 
-/*!     \brief  Write the PDF image to a file
+/*!     \brief  Render the plot to a PDF, SVG or PNG file
  *
- * Determine the filename to use for the PNG file and
- * write image(s) of plot using the already retrieved data to the file.
+ * Write an image of the plot using the already retrieved data to the file.
+ * This does not use any GTK widgets so may be called from any thread
+ * (the sequencer writes files from a background thread).
  *
- * \param  wButton  file pointer to the open, writable file
- * \param  pGlobal  pointer to data
+ * \param  sFilename  path of the file to write
+ * \param  pGlobal    pointer to data
+ * \param  fileType   ePDF, eSVG or ePNG
+ * \return OK or ERROR
  */
+gint
+savePlotImage( gchar *sFilename, tGlobal *pGlobal, enum eFileType fileType ) {
+    gdouble width, height;
+    cairo_t *cr;
+    cairo_surface_t *cs;
+    gint rtn = OK;
+
+    switch( fileType ) {
+    case ePDF:
+    default:
+        width  = paperDimensions[pGlobal->PDFpaperSize].width;
+        height = paperDimensions[pGlobal->PDFpaperSize].height;
+        cs = cairo_pdf_surface_create ( sFilename, width, height );
+        cairo_pdf_surface_set_metadata (cs, CAIRO_PDF_METADATA_CREATOR, "Linux HP8970 Noise Figure Meter");
+        break;
+    case eSVG:
+        width  = paperDimensions[pGlobal->PDFpaperSize].width;
+        height = paperDimensions[pGlobal->PDFpaperSize].height;
+        cs = cairo_svg_surface_create ( sFilename, width, height );
+        break;
+    case ePNG:
+        width  = PNG_WIDTH;
+        height = PNG_WIDTH / sqrt( 2.0 );
+        cs = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+        break;
+    }
+    cr = cairo_create (cs);
+
+    // Letter and Tabloid size are not in the ratio of our data ( height = width / sqrt( 2 ) )
+    // we need to adjust
+    if( fileType != ePNG )  {   // we know PNG is the right aspect ratio
+        // aspect ratio is sqrt( 2 )
+        if( (height / width) / sqrt( 2.0 ) > 1.01 ) {// this should leave A4 and A3 untouched
+            cairo_translate( cr, width - (height * sqrt(2.0)) / 2.0, 0.0  );
+            width = height * sqrt( 2.0 );
+        } else if( (height / width) / sqrt( 2.0 ) < 0.99 ) {   // wider
+            cairo_translate( cr, 0.0, (height - width / sqrt( 2.0 )) / 2.0  );
+            height = width / sqrt( 2.0 );
+        }
+    }
+
+    cairo_save( cr ); {
+        plotNoiseFigureAndGain( cr, width, height, pGlobal, TRUE);
+    } cairo_restore( cr );
+
+    cairo_show_page( cr );
+
+    if( fileType  == ePNG
+            && cairo_surface_write_to_png (cs, sFilename ) != CAIRO_STATUS_SUCCESS )
+        rtn = ERROR;
+    if( cairo_surface_status( cs ) != CAIRO_STATUS_SUCCESS )
+        rtn = ERROR;
+
+    cairo_surface_destroy ( cs );
+    cairo_destroy( cr );
+
+    return rtn;
+}
+
+/*!     \brief  Write the measurement data to a CSV file
+ *
+ * Write the frequency (or time), noise and gain of each measurement.
+ * All the measurements of a spot frequency plot are written (from the log), not just those plotted.
+ * This does not use any GTK widgets so may be called from any thread.
+ *
+ * \param  sFilename  path of the file to write
+ * \param  pGlobal    pointer to data
+ * \return OK or ERROR
+ */
+gint
+saveCSV( gchar *sFilename, tGlobal *pGlobal ) {
+    GError *err = NULL;
+    gint nMeasurements = nItemsInCircularBuffer( &pGlobal->plot.measurementBuffer );
+    gboolean bSpotFreqency = pGlobal->plot.flags.bSpotFrequencyPlot;
+    gboolean bMultiSpot = bSpotFreqency && pGlobal->plot.nMultiSpot >= 2;
+    gboolean bFromLog = bSpotFreqency && pGlobal->plot.spotLog.nRecords > 0;
+    tNoiseAndGain measurement, *pMeasurement;
+
+    gchar *sFreqOrTime, *sNoise;
+    gchar sNoiseU[ SHORT_STRING ];
+
+    GFile *file = g_file_new_for_path( sFilename );
+    GFileOutputStream *oStream = g_file_replace(
+                file,NULL,FALSE, G_FILE_CREATE_NONE, NULL, &err);
+
+    if( oStream == NULL ) {
+        LOG( G_LOG_LEVEL_CRITICAL, "Cannot write %s: %s", sFilename, err->message );
+        g_clear_error (&err);
+        g_object_unref( file );
+        return ERROR;
+    }
+
+    if( bSpotFreqency )
+        sFreqOrTime = "Time (s) since 1/1/1970";
+    else
+        sFreqOrTime = "Frequency (MHz)";
+
+    sNoise = sNoiseLabel[ pGlobal->plot.noiseUnits ];
+    if( sNoiseUnits[ pGlobal->plot.noiseUnits ] != 0 ) {
+        g_snprintf( sNoiseU, SHORT_STRING, " (%s)", sNoiseUnits[ pGlobal->plot.noiseUnits ] );
+    } else {
+        sNoiseU[ 0 ] = 0;
+    }
+
+    // a two dimensional sweep (shown as a heat map) is written a point to a line with its parameter value
+    if( pGlobal->flags.bShowHeatMap && pGlobal->plot.sweep2D.flags.bValid ) {
+        tSweep2D *pSweep2D = &pGlobal->plot.sweep2D;
+
+        g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "Parameter,Frequency (MHz),%s%s,Gain (dB)\n",
+                                sNoise, sNoiseU );
+        g_mutex_lock( &pSweep2D->mSweep2D );
+        for( int row=0; row < pSweep2D->nRowsDone; row++ ) {
+            for( int i=0; i < pSweep2D->nColumns; i++ ) {
+                pMeasurement = &pSweep2D->data[ row * pSweep2D->nColumns + i ];
+                g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%g,%g,%g,%g\n",
+                                        parameterValue( pSweep2D, row ), pSweep2D->frequencies[ i ] / MHz(1.0),
+                                        noiseInUnits( pMeasurement->noise, pGlobal->plot.noiseUnits ),  pMeasurement->gain );
+            }
+        }
+        g_mutex_unlock( &pSweep2D->mSweep2D );
+        nMeasurements = 0;
+    } else {
+        // the measurements of a multi-spot plot are interleaved .. each is labeled with its frequency
+        g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%s,%s%s,Gain (dB)%s\n",
+                                sFreqOrTime, sNoise, sNoiseU, bMultiSpot ? ",Frequency (MHz)" : "" );
+    }
+
+    if( bFromLog && nMeasurements > 0 )
+        nMeasurements = pGlobal->plot.spotLog.nRecords;
+    for( int i=0; i < nMeasurements; i++ ) {
+        if( bFromLog )
+            pMeasurement = measurementFromLog( &pGlobal->plot.spotLog, i, &measurement );
+        else
+            pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.measurementBuffer, i, &measurement );
+        if( bMultiSpot ) {
+            g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%.3lf,%g,%g,%g\n",
+                                    ((gdouble)pMeasurement->abscissa.time) / 1000.0, noiseInUnits( pMeasurement->noise, pGlobal->plot.noiseUnits ),  pMeasurement->gain,
+                                    pGlobal->plot.multiSpotMHz[ pMeasurement->flags.each.bbSeries ] );
+        } else if( bSpotFreqency ) {
+            g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%.3lf,%g,%g\n",
+                                    ((gdouble)pMeasurement->abscissa.time) / 1000.0, noiseInUnits( pMeasurement->noise, pGlobal->plot.noiseUnits ),  pMeasurement->gain );
+        } else {
+            g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%g,%g,%g\n",
+                                    pMeasurement->abscissa.freq / MHz(1.0), noiseInUnits( pMeasurement->noise, pGlobal->plot.noiseUnits ),  pMeasurement->gain );
+        }
+    }
 
-enum eFileType { ePDF, eSVG, ePNG, eCSV };
+    g_output_stream_close(G_OUTPUT_STREAM(oStream),NULL,NULL);
+    g_object_unref(oStream);
+    g_object_unref( file );
+
+    if( err ) {
+        g_clear_error (&err);
+        return ERROR;
+    }
+    return OK;
+}
 
 static gchar *sSuggestedFilename = NULL;
 // Call back when file is selected
@@ -62,10 +220,6 @@ plotAndSaveFile( GObject *source_object, GAsyncResult *res, gpointer gpGlobal, e
     GFile *file;
     GError *err = NULL;
     GtkAlertDialog *alert_dialog;
-    gdouble width, height;
-
-    cairo_t *cr;
-    cairo_surface_t *cs;
 
     if (((file = gtk_file_dialog_save_finish (dialog, res, &err)) != NULL) ) {
         gchar *sChosenFilename = g_file_get_path( file );
@@ -73,53 +227,19 @@ plotAndSaveFile( GObject *source_object, GAsyncResult *res, gpointer gpGlobal, e
         switch( fileType ) {
         case ePDF:
         default:
-            width  = paperDimensions[pGlobal->PDFpaperSize].width;
-            height = paperDimensions[pGlobal->PDFpaperSize].height;
-            cs = cairo_pdf_surface_create ( sChosenFilename, width, height );
-            cairo_pdf_surface_set_metadata (cs, CAIRO_PDF_METADATA_CREATOR, "Linux HP8970 Noise Figure Meter");
             suggestFilename( pGlobal, selectedFileBasename, "pdf" );
             break;
         case eSVG:
-            width  = paperDimensions[pGlobal->PDFpaperSize].width;
-            height = paperDimensions[pGlobal->PDFpaperSize].height;
-            cs = cairo_svg_surface_create ( sChosenFilename, width, height );
             suggestFilename( pGlobal, selectedFileBasename, "svg" );
             break;
         case ePNG:
-            width  = PNG_WIDTH;
-            height = PNG_WIDTH / sqrt( 2.0 );
-            cs = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
             suggestFilename( pGlobal, selectedFileBasename, "png" );
             break;
         }
-        cr = cairo_create (cs);
-
         g_free( selectedFileBasename );
 
-        // Letter and Tabloid size are not in the ratio of our data ( height = width / sqrt( 2 ) )
-        // we need to adjust
-        if( fileType != ePNG )  {   // we know PNG is the right aspect ratio
-            // aspect ratio is sqrt( 2 )
-            if( (height / width) / sqrt( 2.0 ) > 1.01 ) {// this should leave A4 and A3 untouched
-                cairo_translate( cr, width - (height * sqrt(2.0)) / 2.0, 0.0  );
-                width = height * sqrt( 2.0 );
-            } else if( (height / width) / sqrt( 2.0 ) < 0.99 ) {   // wider
-                cairo_translate( cr, 0.0, (height - width / sqrt( 2.0 )) / 2.0  );
-                height = width / sqrt( 2.0 );
-            }
-        }
-
-        cairo_save( cr ); {
-            plotNoiseFigureAndGain( cr, width, height, pGlobal, TRUE);
-        } cairo_restore( cr );
-
-        cairo_show_page( cr );
-
-        if( fileType  == ePNG )
-            cairo_surface_write_to_png (cs, sChosenFilename );
-
-        cairo_surface_destroy ( cs );
-        cairo_destroy( cr );
+        // the image is drawn from a snapshot in the background
+        writePlotSnapshot( snapshotPlot( pGlobal ), fileType, sChosenFilename );
 
         GFile *dir = g_file_get_parent( file );
         gchar *sChosenDirectory = g_file_get_path( dir );
@@ -167,12 +287,6 @@ CB_CSVsave( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
     GFile *file;
     GError *err = NULL;
     GtkAlertDialog *alert_dialog;
-    gint nMeasurements = nItemsInCircularBuffer( &pGlobal->plot.measurementBuffer );
-    gboolean bSpotFreqency = pGlobal->plot.flags.bSpotFrequencyPlot;
-    tNoiseAndGain *pMeasurement;
-
-    gchar *sFreqOrTime, *sNoise;
-    gchar sNoiseU[ SHORT_STRING ];
 
     if (((file = gtk_file_dialog_save_finish (dialog, res, &err)) != NULL) ) {
         gchar *sChosenFilename = g_file_get_path( file );
@@ -181,46 +295,7 @@ CB_CSVsave( GObject *source_object, GAsyncResult *res, gpointer gpGlobal ) {
         suggestFilename( pGlobal, selectedFileBasename, "pdf" );
         g_free( selectedFileBasename );
 
-
-// Open file and save....
-
-        GFileOutputStream *oStream = g_file_replace(
-                    file,NULL,FALSE, G_FILE_CREATE_NONE, NULL,NULL);
-
-        if( bSpotFreqency )
-            sFreqOrTime = "Time (s) since 1/1/1970";
-        else
-            sFreqOrTime = "Frequency (MHz)";
-
-        sNoise = sNoiseLabel[ pGlobal->plot.noiseUnits ];
-        if( sNoiseUnits[ pGlobal->plot.noiseUnits ] != 0 ) {
-            g_snprintf( sNoiseU, SHORT_STRING, " (%s)", sNoiseUnits[ pGlobal->plot.noiseUnits ] );
-        } else {
-            sNoiseU[ 0 ] = 0;
-        }
-
-        g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%s,%s%s,Gain (dB)\n",
-                                sFreqOrTime, sNoise, sNoiseU );
-
-        for( int i=0; i < nMeasurements; i++ ) {
-            pMeasurement = getItemFromCircularBuffer( &pGlobal->plot.measurementBuffer, i );
-            if( bSpotFreqency ) {
-                g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%.3lf,%g,%g\n",
-                                        ((gdouble)pMeasurement->abscissa.time) / 1000.0, pMeasurement->noise,  pMeasurement->gain );
-            } else {
-                g_output_stream_printf( G_OUTPUT_STREAM( oStream ), NULL, NULL, &err, "%g,%g,%g\n",
-                                        pMeasurement->abscissa.freq / MHz(1.0), pMeasurement->noise,  pMeasurement->gain );
-            }
-        }
-
-        g_output_stream_close(G_OUTPUT_STREAM(oStream),NULL,NULL);
-        g_object_unref(oStream);
-
-
-
-            postInfo( "CSV saved" );
-
-
+        writePlotSnapshot( snapshotPlot( pGlobal ), eCSV, sChosenFilename );
 
         GFile *dir = g_file_get_parent( file );
         gchar *sChosenDirectory = g_file_get_path( dir );
@@ -63,19 +63,32 @@ buildWidgetList( tGlobal *pGlobal,  GtkBuilder *builder ) {
     const static gchar *sWidgetNames[ eW_N_WIDGETS ] = {
             [ eW_aspect_Plot ]                  = "WID_aspect_Plot",
             [ eW_box_Spot ]                     = "WID_box_Spot",
+            [ eW_btn_AccumulatorReset ]         = "WID_btn_AccumulatorReset",
             [ eW_btn_Calibrate ]                = "WID_btn_Calibrate",
             [ eW_btn_ColorReset ]               = "WID_btn_ColorReset",
             [ eW_btn_CSV ]                      = "WID_btn_CSV",
+            [ eW_btn_HeatMap ]                  = "WID_btn_HeatMap",
             [ eW_btn_Memory ]                   = "WID_btn_Memory",
+            [ eW_btn_MultiSpotAdd ]             = "WID_btn_MultiSpotAdd",
+            [ eW_btn_MultiSpotClear ]           = "WID_btn_MultiSpotClear",
             [ eW_btn_PDF ]                      = "WID_btn_PDF",
             [ eW_btn_PNG ]                      = "WID_btn_PNG",
             [ eW_btn_Print ]                    = "WID_btn_Print",
             [ eW_btn_RestoreJSON ]              = "WID_btn_RestoreJSON",
+            [ eW_btn_ResumeSweep ]              = "WID_btn_ResumeSweep",
             [ eW_btn_SaveJSON ]                 = "WID_btn_SaveJSON",
+            [ eW_btn_Sequence ]                 = "WID_btn_Sequence",
             [ eW_btn_SettingsDelete ]           = "WID_btn_SettingsDelete",
             [ eW_btn_SettingsRestore ]          = "WID_btn_SettingsRestore",
             [ eW_btn_SettingsSave ]             = "WID_btn_SettingsSave",
             [ eW_btn_SVG ]                      = "WID_btn_SVG",
+            [ eW_btn_TraceAdd ]                 = "WID_btn_TraceAdd",
+            [ eW_btn_TraceCalibration ]         = "WID_btn_TraceCalibration",
+            [ eW_btn_TraceClear ]               = "WID_btn_TraceClear",
+            [ eW_btn_TraceColor ]               = "WID_btn_TraceColor",
+            [ eW_btn_TraceNext ]                = "WID_btn_TraceNext",
+            [ eW_btn_TraceStyle ]               = "WID_btn_TraceStyle",
+            [ eW_btn_TraceVisible ]             = "WID_btn_TraceVisible",
             [ eW_chk_AutoScale ]                = "WID_chk_AutoScale",
             [ eW_chk_Correction ]               = "WID_chk_Correction",
             [ eW_chk_LossOn ]                   = "WID_chk_LossOn",
@@ -97,7 +110,10 @@ buildWidgetList( tGlobal *pGlobal,  GtkBuilder *builder ) {
             [ eW_combo_SettingsConfigurations ] = "WID_combo_SettingsConfigurations",
             [ eW_Controls ]                     = "WID_Controls",
             [ eW_CV_NoiseSource ]               = "WID_CV_NoiseSource",
+            [ eW_drawing_LiveMarker ]           = "WID_drawing_LiveMarker",
             [ eW_drawing_Plot ]                 = "WID_drawing_Plot",
+            [ eW_drop_Accumulated ]             = "WID_drop_Accumulated",
+            [ eW_drop_AccumulatorLength ]       = "WID_drop_AccumulatorLength",
             [ eW_drop_IF_Attenuation ]          = "WID_drop_IF_Attenuation",
             [ eW_drop_InputGainCalibration ]    = "WID_drop_InputGainCalibration",
             [ eW_drop_NoiseUnits ]              = "WID_drop_NoiseUnits",
@@ -114,6 +130,7 @@ buildWidgetList( tGlobal *pGlobal,  GtkBuilder *builder ) {
             [ eW_frm_Sweep ]                    = "WID_frm_Sweep",
             [ eW_HP8970_application ]           = "WID_HP8970_application",
             [ eW_lbl_LOnotice ]                 = "WID_lbl_LOnotice",
+            [ eW_lbl_MultiSpot ]                = "WID_lbl_MultiSpot",
             [ eW_lbl_version ]                  = "WID_lbl_version",
             [ eW_lbl_Status ]                   = "WID_lbl_Status",
             [ eW_lbl_Status_LO ]                = "WID_lbl_Status_LO",
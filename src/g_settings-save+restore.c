@@ -234,6 +234,7 @@ recoverSettings( tGlobal *pGlobal ) {
  *              2:bLossCompensation
  *              3:bSpotFrequency
  * qyyy     -   4:smoothingFactor
+ *               :calibrationKey (high & low 16 bits in two of the spare q's)
  *              5:noiseUnits
  *              6:inputGainCal
  *              7:mode
@@ -290,8 +291,8 @@ configurationBuilder( tHP8970settings *configuration ){
     // qyyy
 
     g_variant_builder_add(configBuilder, "q", configuration->smoothingFactor );
-    g_variant_builder_add(configBuilder, "q", 0 );
-    g_variant_builder_add(configBuilder, "q", 0 );
+    g_variant_builder_add(configBuilder, "q", (guint16)(configuration->calibrationKey >> 16) );
+    g_variant_builder_add(configBuilder, "q", (guint16)(configuration->calibrationKey & 0xFFFF) );
     g_variant_builder_add(configBuilder, "q", 0 );
     g_variant_builder_add(configBuilder, "q", 0 );
     g_variant_builder_add(configBuilder, "y", configuration->noiseUnits );
@@ -355,6 +356,8 @@ saveConfigurations( tGlobal *pGlobal ) {
 
     dictBuilder = g_variant_builder_new (G_VARIANT_TYPE ("a{sv}"));
 
+    // The current settings carry the key of the calibration held by the HP8970
+    pGlobal->HP8970settings.calibrationKey = pGlobal->calibration.key;
     // Add some more if you want
     tupple = configurationBuilder( &pGlobal->HP8970settings );
     g_variant_builder_add(dictBuilder, "{sv}", "", tupple);
@@ -419,7 +422,7 @@ recoverConfigurations( tGlobal *pGlobal ) {
 
         gboolean bCorrectedNFAndGain, bLossCompensation, bAutoScaling;
         gboolean bPlaceholder;
-        guint16  iPlaceholder;
+        guint16  iPlaceholder, calibrationKeyHigh, calibrationKeyLow;
         guchar   cPlaceholder;
         g_variant_get( tuple, CONFIG_TUPPLE,
                 // a(ddddd)(bbbbb)qyyy(qqqssy)(dddd)ba(dd)(dd)
@@ -434,7 +437,7 @@ recoverConfigurations( tGlobal *pGlobal ) {
 
                 // qqqqqyyyyy
                 &pHP8970settings->smoothingFactor,
-                &iPlaceholder, &iPlaceholder, &iPlaceholder, &iPlaceholder,
+                &calibrationKeyHigh, &calibrationKeyLow, &iPlaceholder, &iPlaceholder,
                 &pHP8970settings->noiseUnits,
                 &pHP8970settings->inputGainCal,
                 &pHP8970settings->mode,
@@ -487,8 +490,12 @@ recoverConfigurations( tGlobal *pGlobal ) {
         pHP8970settings->switches.bCorrectedNFAndGain = bCorrectedNFAndGain;
         pHP8970settings->switches.bLossCompensation = bLossCompensation;
         pHP8970settings->switches.bAutoScaling = bAutoScaling;
+        pHP8970settings->calibrationKey = ((guint32)calibrationKeyHigh << 16) | calibrationKeyLow;
 
-        if( g_strcmp0( sConfigurationName, "" ) != 0 ) {
+        if( g_strcmp0( sConfigurationName, "" ) == 0 ) {
+            // (assume the HP8970 has kept the calibration we last made)
+            pGlobal->calibration.key = pHP8970settings->calibrationKey;
+        } else {
             pHP8970settings->sConfigurationName = g_strdup( sConfigurationName );
             pGlobal->configurationList = g_list_insert_sorted( pGlobal->configurationList, pHP8970settings, compareSortConfiguration );
         }
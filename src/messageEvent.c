@@ -14,8 +14,12 @@
  * limitations under the License.
 */
 
+#include <string.h>
+
 #include <HP8970.h>
 #include <messageEvent.h>
+#include "GPIBcomms.h"
+#include "HP8970comms.h"
 
 typedef struct {
     gint timerID;
@@ -37,6 +41,441 @@ clearNotification( gpointer gpStatusTimer ) {
 GSourceFuncs messageEventFunctions = { messageEventPrepare, messageEventCheck,
 		messageEventDispatch, NULL, };
 
+// Messages to the main loop are taken from a fixed pool (from the heap only if it is exhausted)
+// and queued by their own link, so posting a message from the GPIB thread does not use the heap.
+static messageEventData messagePool[ MESSAGE_POOL_SIZE ];
+static messageEventData *pFreeMessages = NULL;
+static gboolean bMessagePoolReady = FALSE;
+
+static struct {
+    messageEventData *pHead, *pTail;
+    gint length;
+} queueToMain = { NULL, NULL, 0 };
+
+static GMutex mMessages;
+static GCond cMessages;
+
+// Progress events are kept in a ring. The main loop only shows the latest (at most once every
+// PROGRESS_INTERVAL) so the cost to the UI is the same however fast the points are measured.
+// They are taken by the message source, so they are shown even when the plot is not drawn.
+#define PROGRESS_INTERVAL           ms( 40 )
+
+static struct {
+    tProgressEvent events[ PROGRESS_RING_SIZE ];
+    guint nWritten, nRead;          // events posted and taken (the index in the ring is modulo PROGRESS_RING_SIZE)
+    guint nStaleStatus, nStaleLO;   // events posted before the last message taken for the status & LO labels
+    guint nRefreshPlot;             // points added to the plot since the events were last taken
+    GMutex mRing;
+    gint64 lastShown;               // time the main loop last took the events (us)
+} progressRing;
+
+// The plot is redrawn by the frame clock: new data and marker moves only mark it dirty, so it is
+// drawn at most once a frame (and less often when the window is not active or saving power).
+#define FRAME_INTERVAL_INACTIVE     ms( 100 )
+#define FRAME_INTERVAL_POWER_SAVER  ms( 50 )
+
+static struct {
+    guint tickID;               // frame clock tick callback (0 when there is nothing to do)
+    guint dirty;                // PLOT_DIRTY_DATA / PLOT_DIRTY_MARKER
+    gint64 lastFrameTime;       // frame clock time the plot was last drawn (us)
+    gint spinNoiseUnits;        // units the noise range spin buttons were set for (-1 not yet set)
+    guint nRequested, nRendered;
+} plotRefresh = { 0, 0, 0, -1, 0, 0 };
+
+/*!     \brief  Take a message for the main loop from the pool
+ *
+ * \param Command       : enumerated state to indicate action
+ * \return pointer to the (cleared) message
+ */
+static messageEventData *
+newMessage( enum _threadmessage Command ) {
+    messageEventData *message;
+
+    g_mutex_lock( &mMessages );
+    if( !bMessagePoolReady ) {
+        for( gint i = 0; i < MESSAGE_POOL_SIZE; i++ ) {
+            messagePool[ i ].pNext = pFreeMessages;
+            pFreeMessages = &messagePool[ i ];
+        }
+        bMessagePoolReady = TRUE;
+    }
+    if( (message = pFreeMessages) != NULL )
+        pFreeMessages = message->pNext;
+    g_mutex_unlock( &mMessages );
+
+    if( message ) {
+        message->sMessage = NULL;
+        message->data = NULL;
+        message->dataLength = 0;
+        message->bPooled = TRUE;
+        g_atomic_int_inc( &allocationCounters.poolMessages );
+    } else {
+        // the main loop has fallen behind
+        message = g_malloc0( sizeof( messageEventData ) );
+        g_atomic_int_inc( &allocationCounters.heapMessages );
+    }
+    message->command = Command;
+    message->pNext = NULL;
+
+    // progress events posted before the message are older than it
+    g_mutex_lock( &progressRing.mRing );
+    message->nProgress = progressRing.nWritten;
+    g_mutex_unlock( &progressRing.mRing );
+
+    return message;
+}
+
+/*!     \brief  Queue a message for the main loop
+ *
+ * \param message       : pointer to the message
+ */
+static void
+queueForMainLoop( messageEventData *message ) {
+    g_mutex_lock( &mMessages );
+    if( queueToMain.pTail )
+        queueToMain.pTail->pNext = message;
+    else
+        queueToMain.pHead = message;
+    queueToMain.pTail = message;
+    queueToMain.length++;
+    g_cond_signal( &cMessages );
+    g_mutex_unlock( &mMessages );
+
+    g_main_context_wakeup( NULL );
+}
+
+/*!     \brief  Take the next message for the main loop from the queue
+ *
+ * \param timeout       : time (us) to wait for a message (0 does not wait)
+ * \return pointer to the message (release with releaseMessage) or NULL if there is none
+ */
+messageEventData *
+getMessageForMainLoop( gint64 timeout ) {
+    gint64 endTime = g_get_monotonic_time() + timeout;
+    messageEventData *message;
+
+    g_mutex_lock( &mMessages );
+    while( queueToMain.pHead == NULL && timeout > 0 )
+        if( !g_cond_wait_until( &cMessages, &mMessages, endTime ) )
+            break;
+    if( (message = queueToMain.pHead) != NULL ) {
+        if( (queueToMain.pHead = message->pNext) == NULL )
+            queueToMain.pTail = NULL;
+        queueToMain.length--;
+    }
+    g_mutex_unlock( &mMessages );
+
+    // a message shown on a status label supersedes the progress events posted before it
+    if( message ) {
+        g_mutex_lock( &progressRing.mRing );
+        switch( message->command ) {
+        case TM_INFO:
+        case TM_INFO_HIGHLIGHT:
+        case TM_ERROR:
+            progressRing.nStaleStatus = message->nProgress;
+            break;
+        case TM_INFO_LO:
+        case TM_ERROR_LO:
+            progressRing.nStaleLO = message->nProgress;
+            break;
+        default:
+            break;
+        }
+        g_mutex_unlock( &progressRing.mRing );
+    }
+
+    return message;
+}
+
+/*!     \brief  Number of messages queued for the main loop
+ *
+ * \return number of messages
+ */
+gint
+nMessagesForMainLoop( void ) {
+    gint length;
+
+    g_mutex_lock( &mMessages );
+    length = queueToMain.length;
+    g_mutex_unlock( &mMessages );
+
+    return length;
+}
+
+/*!     \brief  Return a message (and its text) to the pool
+ *
+ * The data of the message is not freed.
+ *
+ * \param message       : pointer to the message
+ */
+void
+releaseMessage( messageEventData *message ) {
+    if( message->sMessage != message->sText )
+        g_free( message->sMessage );
+
+    if( message->bPooled ) {
+        g_mutex_lock( &mMessages );
+        message->pNext = pFreeMessages;
+        pFreeMessages = message;
+        g_mutex_unlock( &mMessages );
+    } else {
+        g_free( message );
+    }
+}
+
+/*!     \brief  Post the progress of a measurement to the main loop
+ *
+ * If the main loop has fallen behind the oldest event is overwritten.
+ *
+ * \param pEvent        : pointer to the progress event (copied)
+ */
+void
+postProgress( tProgressEvent *pEvent ) {
+    g_mutex_lock( &progressRing.mRing );
+    progressRing.events[ progressRing.nWritten % PROGRESS_RING_SIZE ] = *pEvent;
+    progressRing.nWritten++;
+    if( progressRing.nWritten - progressRing.nRead > PROGRESS_RING_SIZE )
+        progressRing.nRead = progressRing.nWritten - PROGRESS_RING_SIZE;
+    if( pEvent->bRefreshPlot )
+        progressRing.nRefreshPlot++;
+    g_mutex_unlock( &progressRing.mRing );
+
+    g_main_context_wakeup( NULL );
+}
+
+/*!     \brief  Time until the main loop is to take the progress events
+ *
+ * \return time (us) .. 0 if they are due, -1 if there are none
+ */
+static gint64
+progressDue( void ) {
+    gint64 due = -1;
+
+    g_mutex_lock( &progressRing.mRing );
+    if( progressRing.nWritten != progressRing.nRead || progressRing.nRefreshPlot )
+        due = MAX( progressRing.lastShown + PROGRESS_INTERVAL - g_get_monotonic_time(), 0 );
+    g_mutex_unlock( &progressRing.mRing );
+
+    return due;
+}
+
+/*!     \brief  Take the latest progress events (the earlier ones are dropped)
+ *
+ * Events posted before the last message taken for a status label are not returned.
+ *
+ * \param pStatus       : pointer to the latest measurement event (for the status label)
+ * \param pLO           : pointer to the latest LO event (for the LO status label)
+ * \param pnRefreshPlot : pointer to the number of points added to the plot (since last taken)
+ * \return PROGRESS_STATUS and/or PROGRESS_LO if the events were found
+ */
+gint
+takeLatestProgress( tProgressEvent *pStatus, tProgressEvent *pLO, guint *pnRefreshPlot ) {
+    gint found = 0;
+
+    g_mutex_lock( &progressRing.mRing );
+    // newest first .. we only want the first of each
+    for( guint n = progressRing.nWritten; n != progressRing.nRead
+                && found != (PROGRESS_STATUS | PROGRESS_LO); n-- ) {
+        tProgressEvent *pEvent = &progressRing.events[ (n - 1) % PROGRESS_RING_SIZE ];
+
+        if( pEvent->type == eProgressLO ) {
+            if( !(found & PROGRESS_LO) && (gint)(n - 1 - progressRing.nStaleLO) >= 0 ) {
+                *pLO = *pEvent;
+                found |= PROGRESS_LO;
+            }
+        } else if( !(found & PROGRESS_STATUS) && (gint)(n - 1 - progressRing.nStaleStatus) >= 0 ) {
+            *pStatus = *pEvent;
+            found |= PROGRESS_STATUS;
+        }
+    }
+    progressRing.nRead = progressRing.nWritten;
+    *pnRefreshPlot = progressRing.nRefreshPlot;
+    progressRing.nRefreshPlot = 0;
+    progressRing.lastShown = g_get_monotonic_time();
+    g_mutex_unlock( &progressRing.mRing );
+
+    return found;
+}
+
+/*!     \brief  Describe a progress event
+ *
+ * e.g. "Sweep: 1200 MHz  (42% · 3.1 pts/s · ETA 1:05)"
+ *
+ * \param pEvent        : pointer to the progress event
+ * \param sText         : buffer for the description
+ * \param size          : size of the buffer
+ * \return the description (sText)
+ */
+gchar *
+progressText( tProgressEvent *pEvent, gchar *sText, gsize size ) {
+    gint ETA = pEvent->ETA;
+
+    switch( pEvent->type ) {
+    case eProgressSweep:
+        if( pEvent->HP8970error )
+            g_snprintf( sText, size, "Sweep: %.0lf MHz ☠️  %s",
+                        pEvent->freqMHz, HP8970errorString( pEvent->HP8970error ) );
+        else if( ETA >= 3600 )
+            g_snprintf( sText, size, "Sweep: %.0lf MHz  (%d%% · %.1lf pts/s · ETA %d:%02d:%02d)",
+                        pEvent->freqMHz, pEvent->percent, pEvent->pointsPerSec, ETA / 3600, (ETA / 60) % 60, ETA % 60 );
+        else
+            g_snprintf( sText, size, "Sweep: %.0lf MHz  (%d%% · %.1lf pts/s · ETA %d:%02d)",
+                        pEvent->freqMHz, pEvent->percent, pEvent->pointsPerSec, ETA / 60, ETA % 60 );
+        break;
+    case eProgressSpot:
+        if( pEvent->HP8970error )
+            g_snprintf( sText, size, "Spot measurement: %.0lf MHz  %.1lf s  ☠️  %s",
+                        pEvent->freqMHz, pEvent->elapsed, HP8970errorString( pEvent->HP8970error ) );
+        else
+            g_snprintf( sText, size, "Spot measurement: %.0lf MHz  %.1lf s", pEvent->freqMHz, pEvent->elapsed );
+        break;
+    case eProgressCalibration:
+        if( pEvent->HP8970error )
+            g_snprintf( sText, size, "Calibration point %d: %.0lf MHz ☠️  %s",
+                        pEvent->nPoint, pEvent->freqMHz, HP8970errorString( pEvent->HP8970error ) );
+        else
+            g_snprintf( sText, size, "Calibration point %d: %.0lf MHz", pEvent->nPoint, pEvent->freqMHz );
+        break;
+    case eProgressLO:
+    default:
+        g_snprintf( sText, size, "Signal Generator (LO): %.0lf MHz", pEvent->freqMHz );
+        break;
+    }
+
+    return sText;
+}
+
+/*!     \brief  Show progress on a status label
+ *
+ * \param pStatusTimer  : pointer to the label and its timer
+ * \param sText         : text to show
+ */
+static void
+showProgress( tStatusTimer *pStatusTimer, gchar *sText ) {
+    gchar *sMarkup = g_markup_printf_escaped( "<i>%s</i>", sText );
+
+    if( pStatusTimer->timerID != 0 )
+        g_source_remove( pStatusTimer->timerID );
+    pStatusTimer->timerID = g_timeout_add( 10000, clearNotification, pStatusTimer );
+    gtk_label_set_markup( pStatusTimer->wLabel, sMarkup );
+    g_free( sMarkup );
+}
+
+/*!     \brief  Shortest time between frames of the plot
+ *
+ * \param wPlot         : plot drawing area
+ * \return time (us)
+ */
+static gint64
+minimumFrameInterval( GtkWidget *wPlot ) {
+    static GPowerProfileMonitor *powerMonitor = NULL;
+
+    if( !gtk_window_is_active( GTK_WINDOW( gtk_widget_get_root( wPlot ) ) ) )
+        return FRAME_INTERVAL_INACTIVE;
+
+    if( powerMonitor == NULL )
+        powerMonitor = g_power_profile_monitor_dup_default();
+    if( g_power_profile_monitor_get_power_saver_enabled( powerMonitor ) )
+        return FRAME_INTERVAL_POWER_SAVER;
+
+    return 0;
+}
+
+/*!     \brief  Draw the plot if it is dirty (frame clock tick of the plot)
+ *
+ * The callback is removed when there is nothing more to draw and no measurement is being
+ * made (it is added again by requestPlotRefresh). The frames requested and rendered are then logged.
+ *
+ * \param wPlot         : plot drawing area
+ * \param frameClock    : frame clock of the plot
+ * \param gpGlobal      : pointer to global data
+ * \return G_SOURCE_CONTINUE while there is a frame to draw (or a measurement)
+ */
+static gboolean
+plotTick( GtkWidget *wPlot, GdkFrameClock *frameClock, gpointer gpGlobal ) {
+    tGlobal *pGlobal = (tGlobal *)gpGlobal;
+    gint64 frameTime = gdk_frame_clock_get_frame_time( frameClock );
+
+    if( plotRefresh.dirty == 0 ) {
+        if( pGlobal->flags.bGPIBcommsActive )
+            return G_SOURCE_CONTINUE;
+        if( plotRefresh.nRequested )
+            DBG( eDEBUG_INFO, "Plot refresh: %d frames requested, %d rendered (%.1lf : 1)",
+                 plotRefresh.nRequested, plotRefresh.nRendered,
+                 plotRefresh.nRendered ? (gdouble)plotRefresh.nRequested / plotRefresh.nRendered : 0.0 );
+        logPlotDrawTimes();
+        plotRefresh.nRequested = plotRefresh.nRendered = 0;
+        plotRefresh.tickID = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    // not yet .. the plot stays dirty for a later frame
+    if( frameTime - plotRefresh.lastFrameTime < minimumFrameInterval( wPlot ) )
+        return G_SOURCE_CONTINUE;
+
+    // the spin buttons only change with the units of the plot
+    if( (plotRefresh.dirty & PLOT_DIRTY_DATA) && plotRefresh.spinNoiseUnits != pGlobal->plot.noiseUnits ) {
+        setSpinNoiseRange( pGlobal );
+        plotRefresh.spinNoiseUnits = pGlobal->plot.noiseUnits;
+    }
+    // moving the live marker only draws the overlay (the plot draws it when it is drawn)
+    if( plotRefresh.dirty & PLOT_DIRTY_DATA )
+        gtk_widget_queue_draw( wPlot );
+    else
+        gtk_widget_queue_draw( pGlobal->widgets[ eW_drawing_LiveMarker ] );
+    plotRefresh.dirty = 0;
+    plotRefresh.lastFrameTime = frameTime;
+    plotRefresh.nRendered++;
+
+    return G_SOURCE_CONTINUE;
+}
+
+/*!     \brief  Add the frame clock tick callback of the plot (if it is not already there)
+ *
+ * \param pGlobal       : pointer to global data
+ */
+static void
+startPlotTick( tGlobal *pGlobal ) {
+    if( plotRefresh.tickID == 0 )
+        plotRefresh.tickID = gtk_widget_add_tick_callback( pGlobal->widgets[ eW_drawing_Plot ], plotTick, pGlobal, NULL );
+}
+
+/*!     \brief  Ask for the plot to be drawn (at the next frame)
+ *
+ * Only called from the main loop. Any number of requests before the frame are drawn once.
+ *
+ * \param pGlobal       : pointer to global data
+ * \param dirty         : PLOT_DIRTY_DATA (the data has changed) and/or PLOT_DIRTY_MARKER (the live marker moved)
+ */
+void
+requestPlotRefresh( tGlobal *pGlobal, guint dirty ) {
+    plotRefresh.dirty |= dirty;
+    plotRefresh.nRequested++;
+    startPlotTick( pGlobal );
+}
+
+/*!     \brief  Show the latest progress on the status labels (and ask for the plot to be drawn)
+ *
+ * \param pGlobal       : pointer to global data
+ */
+static void
+showLatestProgress( tGlobal *pGlobal ) {
+    tProgressEvent status, LO;
+    guint nRefreshPlot;
+    gchar sText[ MSG_STRING_SIZE ];
+    gint found = takeLatestProgress( &status, &LO, &nRefreshPlot );
+
+    if( found & PROGRESS_STATUS )
+        showProgress( &clearTimer, progressText( &status, sText, MSG_STRING_SIZE ) );
+    if( found & PROGRESS_LO )
+        showProgress( &clearTimer_LO, progressText( &LO, sText, MSG_STRING_SIZE ) );
+    // each point counts as a request (a frame draws all those since the last)
+    if( nRefreshPlot ) {
+        plotRefresh.nRequested += nRefreshPlot - 1;
+        requestPlotRefresh( pGlobal, PLOT_DIRTY_DATA );
+    }
+}
+
 /*!     \brief  Dispatch message posted by a GPIB thread
  *
  * Only the main event loop can update screen widgets.
@@ -63,9 +502,7 @@ messageEventDispatch(GSource *source, GSourceFunc callback, gpointer udata) {
 	}
 	gchar *sMarkup;
 
-
-
-	while ((message = g_async_queue_try_pop(pGlobal->messageQueueToMain))) {
+	while ((message = getMessageForMainLoop( 0 ))) {
 		switch (message->command) {
 		case TM_INFO:
             if( clearTimer.timerID != 0 )
@@ -117,8 +554,20 @@ messageEventDispatch(GSource *source, GSourceFunc callback, gpointer udata) {
 			break;
 
         case TM_REFRESH_PLOT:
-            setSpinNoiseRange( pGlobal );
-            gtk_widget_queue_draw ( pGlobal->widgets[ eW_drawing_Plot ] );
+            requestPlotRefresh( pGlobal, PLOT_DIRTY_DATA );
+            g_free( message->data );
+            break;
+
+        case TM_REFRESH_SETTINGS:
+            setPageExtLOwidgets( pGlobal );
+            refreshPageHP8970( pGlobal );
+            refreshMainDialog( pGlobal );
+            setFixedRangePlotWidgets( pGlobal );
+            requestPlotRefresh( pGlobal, PLOT_DIRTY_DATA );
+            break;
+
+        case TM_CALIBRATED:
+            recordCalibrationInConfigurations( pGlobal, *(guint32 *)message->data );
             g_free( message->data );
             break;
 
@@ -137,10 +586,13 @@ messageEventDispatch(GSource *source, GSourceFunc callback, gpointer udata) {
 			break;
 		}
 
-		g_free(message->sMessage);
-		g_free(message);
+		releaseMessage(message);
 	}
 
+	// after the messages .. those shown on the status labels supersede older progress
+	if( progressDue() == 0 )
+	    showLatestProgress( pGlobal );
+
 	return G_SOURCE_CONTINUE;
 }
 
@@ -151,12 +603,14 @@ messageEventDispatch(GSource *source, GSourceFunc callback, gpointer udata) {
  * We can only (safely) update the widgets from the main tread loop
  *
  * \param source : GSource for the message event
- * \param pTimeout : pointer to return timeout value
- * \return TRUE if we have a message to dispatch
+ * \param pTimeout : pointer to return timeout value (when the progress is next due)
+ * \return TRUE if we have a message (or progress) to dispatch
  */
 gboolean messageEventPrepare(GSource *source, gint *pTimeout) {
-	*pTimeout = -1;
-	return g_async_queue_length(globalData.messageQueueToMain) > 0;
+	gint64 due = progressDue();
+
+	*pTimeout = due < 0 ? -1 : (gint)((due + 999) / 1000);
+	return nMessagesForMainLoop() > 0 || due == 0;
 }
 
 /*!     \brief  Check source event
@@ -166,10 +620,10 @@ gboolean messageEventPrepare(GSource *source, gint *pTimeout) {
  * We can only (safely) update the widgets from the main tread loop
  *
  * \param source : GSource for the message event
- * \return TRUE if we have a message to dispatch
+ * \return TRUE if we have a message (or progress) to dispatch
  */
 gboolean messageEventCheck(GSource *source) {
-	return g_async_queue_length(globalData.messageQueueToMain) > 0;
+	return nMessagesForMainLoop() > 0 || progressDue() == 0;
 }
 
 /*!     \brief  Send status state from thread to the main loop
@@ -183,14 +637,19 @@ void
 postMessageToMainLoop(enum _threadmessage Command, gchar *sMessage) {
 	// sMesaage can be a pointer to a string or a small gint up to PM_MAX (notification message)
 
-	messageEventData *messageData;   // g_free() in threadEventsDispatch
-	messageData = g_malloc0(sizeof(messageEventData));
+	messageEventData *messageData = newMessage( Command );   // releaseMessage() in threadEventsDispatch
 
-	messageData->sMessage = g_strdup(sMessage); // g_free() in threadEventsDispatch
-	messageData->command = Command;
+	// the text is kept in the message (unless it is too long)
+	if( sMessage && strlen( sMessage ) < MSG_STRING_SIZE ) {
+	    g_strlcpy( messageData->sText, sMessage, MSG_STRING_SIZE );
+	    messageData->sMessage = messageData->sText;
+	} else {
+	    messageData->sMessage = g_strdup(sMessage);
+	    if( sMessage )
+	        g_atomic_int_inc( &allocationCounters.heapStrings );
+	}
 
-	g_async_queue_push(globalData.messageQueueToMain, messageData);
-	g_main_context_wakeup( NULL);
+	queueForMainLoop( messageData );
 }
 
 /*!     \brief  Send message with number from thread to the main loop
@@ -203,9 +662,10 @@ postMessageToMainLoop(enum _threadmessage Command, gchar *sMessage) {
  */
 void
 postInfoWithCount(gchar *sMessageWithFormat, gint number, gint number2) {
-	gchar *sLabel = g_strdup_printf( sMessageWithFormat, number, number2 );
+	gchar sLabel[ MSG_STRING_SIZE ];
+
+	g_snprintf( sLabel, MSG_STRING_SIZE, sMessageWithFormat, number, number2 );
 	postMessageToMainLoop( TM_INFO, sLabel );
-	g_free (sLabel);
 
 }
 
@@ -220,14 +680,11 @@ postInfoWithCount(gchar *sMessageWithFormat, gint number, gint number2) {
 void postDataToMainLoop(enum _threadmessage Command, void *data) {
 	// sMesaage can be a pointer to a string or a small gint up to PM_MAX (notification message)
 
-	messageEventData *messageData;   // g_free() in threadEventsDispatch
-	messageData = g_malloc0(sizeof(messageEventData));
+	messageEventData *messageData = newMessage( Command );   // releaseMessage() in threadEventsDispatch
 
 	messageData->data = data;
-	messageData->command = Command;
 
-	g_async_queue_push(globalData.messageQueueToMain, messageData);
-	g_main_context_wakeup( NULL);
+	queueForMainLoop( messageData );
 }
 
 /*!     \brief  Send status state from thread to the main loop
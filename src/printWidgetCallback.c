@@ -32,14 +32,14 @@
  * \param  operation  pointer to GTK print operation structure
  * \param  context    pointer to GTK print context structure
  * \param  pageNo     page number
- * \param  pGlobal    pointer to data
+ * \param  pSnapshot  pointer to the snapshot of the plot
  */
 #define HEADER_HEIGHT 10
 static void
 CB_PrintDrawPage (GtkPrintOperation *operation,
            GtkPrintContext   *context,
            gint               pageNo,
-           tGlobal *          pGlobal)
+           tPlotSnapshot *    pSnapshot)
 {
     cairo_t *cr;
     gdouble height, width;
@@ -62,7 +62,7 @@ CB_PrintDrawPage (GtkPrintOperation *operation,
     extern cairo_user_data_key_t hardcopyKey;
     cairo_set_user_data ( cr, &hardcopyKey, (void *)TRUE, NULL );
 
-    plotNoiseFigureAndGain (cr, width, height, pGlobal, TRUE);
+    plotNoiseFigureAndGain (cr, width, height, &pSnapshot->view, TRUE);
 }
 
 /*!     \brief  Callback when printing commences
@@ -116,6 +116,8 @@ CB_btn_Print ( GtkButton* wBtnOptions, gpointer user_data ) {
     GtkPrintOperationResult res;
 
     tGlobal *pGlobal = (tGlobal *)g_object_get_data(G_OBJECT(wBtnOptions), "data");
+    // print the plot as it is now (the measurement may continue while the dialog is open)
+    tPlotSnapshot *pSnapshot = snapshotPlot( pGlobal );
 
     printOp = gtk_print_operation_new ();
 
@@ -126,7 +128,7 @@ CB_btn_Print ( GtkButton* wBtnOptions, gpointer user_data ) {
           gtk_print_operation_set_default_page_setup (printOp, pGlobal->pageSetup);
 
     g_signal_connect(printOp, "begin_print", G_CALLBACK (CB_PrintBegin), pGlobal);
-    g_signal_connect(printOp, "draw_page", G_CALLBACK (CB_PrintDrawPage), pGlobal);
+    g_signal_connect(printOp, "draw_page", G_CALLBACK (CB_PrintDrawPage), pSnapshot);
     g_signal_connect(printOp, "request-page-setup", G_CALLBACK(CB_PrintRequestPageSetup), pGlobal);
     g_signal_connect(printOp, "done", G_CALLBACK(CB_PrintDone), pGlobal);
 
@@ -149,4 +151,5 @@ CB_btn_Print ( GtkButton* wBtnOptions, gpointer user_data ) {
     }
 
     g_object_unref (printOp);
+    releasePlotSnapshot( pSnapshot );
 }
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Timing of the conversion of linear noise to the units of the plot (make benchNoiseUnits) .. not run by make check
+ *
+ * The noise is held linear, so each change of the noise units (and each redraw) converts a column of it
+ *
+ *   per value          noiseInUnits called for each measurement (the units decided for each)
+ *   column             convertNoiseColumn (HP8970units.c), the units decided once for the column
+ *
+ * The best of a number of repeats is shown (in ms) and the values from the two are compared.
+ *
+ *   benchNoiseUnits [repeats]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+#define BENCH_REPEATS       20
+
+static guint benchSizes[] = { 10000, 100000, 1000000 };
+static tNoiseType benchUnits[] = { eFdB, eF, eTeK };
+static gchar *sBenchUnits[] = { "F dB", "F", "Te K" };
+
+/*!     \brief  Convert a column a value at a time
+ *
+ * \param  pLinear      pointer to the noise factors
+ * \param  pNoise       pointer to the noise in the units (filled)
+ * \param  n            number of values
+ * \param  units        units wanted
+ */
+static void
+perValueConversion( const gdouble *pLinear, gdouble *pNoise, guint n, tNoiseType units ) {
+    for( guint i = 0; i < n; i++ )
+        pNoise[ i ] = noiseInUnits( pLinear[ i ], units );
+}
+
+/*!     \brief  Best time of a number of repeats of a conversion
+ *
+ * \return time in ms
+ */
+static gdouble
+timeConversion( void (*convert)( const gdouble *, gdouble *, guint, tNoiseType ),
+                const gdouble *pLinear, gdouble *pNoise, guint n, tNoiseType units, gint nRepeats ) {
+    gint64 best = G_MAXINT64;
+
+    for( gint i = 0; i < nRepeats; i++ ) {
+        gint64 start = g_get_monotonic_time();
+        convert( pLinear, pNoise, n, units );
+        best = MIN( best, g_get_monotonic_time() - start );
+    }
+    return best / 1000.0;
+}
+
+int
+main( int argc, char *argv[] ) {
+    gint nRepeats = argc > 1 ? atoi( argv[ 1 ] ) : BENCH_REPEATS;
+    gboolean bSame = TRUE;
+
+    if( nRepeats < 1 )
+        nRepeats = 1;
+
+    printf( "units     points     per value      column   (best of %d, ms)\n", nRepeats );
+
+    for( guint unit = 0; unit < G_N_ELEMENTS( benchUnits ); unit++ ) {
+        for( guint size = 0; size < G_N_ELEMENTS( benchSizes ); size++ ) {
+            guint n = benchSizes[ size ];
+            gdouble *pLinear = g_new( gdouble, n );
+            gdouble *pNoise[ 2 ] = { g_new( gdouble, n ), g_new( gdouble, n ) };
+            gdouble perValue, column;
+
+            // a noise figure of about 0 to 12 dB with an occasional error
+            for( guint i = 0; i < n; i++ )
+                pLinear[ i ] = i % 997 == 0 ? ERROR_INDICATOR_HP8970 : 1.0 + 15.0 * (0.5 + 0.5 * sin( i / 50.0 ));
+
+            perValue = timeConversion( perValueConversion, pLinear, pNoise[ 0 ], n, benchUnits[ unit ], nRepeats );
+            column   = timeConversion( convertNoiseColumn, pLinear, pNoise[ 1 ], n, benchUnits[ unit ], nRepeats );
+            printf( "%-9s %7u   %9.3f   %9.3f\n", sBenchUnits[ unit ], n, perValue, column );
+
+            for( guint i = 0; i < n; i++ ) {
+                if( pNoise[ 0 ][ i ] != pNoise[ 1 ][ i ] ) {
+                    printf( "value %u differs\n", i );
+                    bSame = FALSE;
+                    break;
+                }
+            }
+
+            g_free( pLinear );
+            g_free( pNoise[ 0 ] );
+            g_free( pNoise[ 1 ] );
+        }
+    }
+
+    return bSame ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Timing of the transform of a trace to the plot grid (make benchTraceTransform) .. not run by make check
+ *
+ * The gain, or the noise converted to dB, of a trace of n measurements is transformed to positions on the grid
+ *
+ *   per point          as spansToPath did before the chunked kernels: the noise of the run is converted
+ *                      (into a buffer from the heap) and each measurement is placed in turn, the kind of
+ *                      abscissa and the clipping decided for each
+ *   chunked kernels    convertNoiseColumn and transformToGrid (HP8970units.c) a TRACE_CHUNK at a time
+ *
+ * (the conversion of the noise to dB, log10, is the same in both and takes most of the time)
+ *
+ * Making the path (cairo) is not included. The best of a number of repeats is shown (in ms) and the
+ * positions from the two are compared.
+ *
+ *   benchTraceTransform [repeats]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+#define BENCH_REPEATS       20
+#define BENCH_GRID_WIDTH    1000.0
+#define BENCH_GRID_HEIGHT   600.0
+
+static guint benchSizes[] = { 10000, 100000, 1000000 };
+
+/*!     \brief  Clip a coordinate to the axis (as clipData in CairoPlot.c)
+ *
+ * \param  data       coordinate
+ * \param  minimum    bottom of the axis
+ * \param  maximum    top of the axis
+ * \return the coordinate (just outside the axis if beyond it)
+ */
+static gdouble
+clipData( gdouble data, gdouble minimum, gdouble maximum ) {
+    gdouble margin = (maximum - minimum) / 150.0;
+
+    if( data > maximum )
+        data = maximum + margin;
+    else if ( data < minimum )
+        data = minimum - margin;
+
+    return data;
+}
+
+/*!     \brief  Transform a trace a measurement at a time (before the chunked kernels)
+ *
+ * \param  pBuffer      pointer to the measurements
+ * \param  n            number of measurements
+ * \param  bTime        the abscissa is time
+ * \param  bNoise       the coordinate is the noise (dB) rather than the gain
+ * \param  pXaxis       frequency (MHz) or time (s) axis
+ * \param  pYaxis       noise (dB) or gain axis
+ * \param  pX           x positions (filled)
+ * \param  pY           y positions (filled)
+ * \param  pbValid      valid measurements (filled)
+ */
+static void
+perPointTransform( tCircularBuffer *pBuffer, guint n, gboolean bTime, gboolean bNoise, tAxis *pXaxis, tAxis *pYaxis,
+                   gdouble *pX, gdouble *pY, guint8 *pbValid ) {
+    gdouble ordinateScaling = BENCH_GRID_WIDTH / ( pXaxis->max - pXaxis->min );
+    gdouble scale = BENCH_GRID_HEIGHT / ( pYaxis->max - pYaxis->min );
+    gdouble *pConverted = NULL, *pCoordinates = pBuffer->gain;
+
+    if( bNoise ) {
+        pConverted = g_malloc( n * sizeof( gdouble ) );
+        convertNoiseColumn( pBuffer->noise, pConverted, n, eFdB );
+        pCoordinates = pConverted;
+    }
+    for( guint posn = 0; posn < n; posn++ ) {
+        if( bTime )
+            pX[ posn ] = ( GINT_MSTIME_TO_DOUBLE( pBuffer->abscissa[ posn ].time ) - pXaxis->min ) * ordinateScaling;
+        else
+            pX[ posn ] = ( pBuffer->abscissa[ posn ].freq / MHz(1.0) - pXaxis->min ) * ordinateScaling;
+        pY[ posn ] = ( clipData( pCoordinates[ posn ], pYaxis->min, pYaxis->max ) - pYaxis->min ) * scale;
+        pbValid[ posn ] = pBuffer->noise[ posn ] < ERROR_INDICATOR_HP8970;
+    }
+    g_free( pConverted );
+}
+
+/*!     \brief  Transform a trace a chunk at a time (as spansToPath does)
+ *
+ * \param  pBuffer      pointer to the measurements
+ * \param  n            number of measurements
+ * \param  bTime        the abscissa is time
+ * \param  bNoise       the coordinate is the noise (dB) rather than the gain
+ * \param  pXaxis       frequency (MHz) or time (s) axis
+ * \param  pYaxis       noise (dB) or gain axis
+ * \param  pX           x positions (filled)
+ * \param  pY           y positions (filled)
+ * \param  pbValid      valid measurements (filled)
+ */
+static void
+chunkedTransform( tCircularBuffer *pBuffer, guint n, gboolean bTime, gboolean bNoise, tAxis *pXaxis, tAxis *pYaxis,
+                  gdouble *pX, gdouble *pY, guint8 *pbValid ) {
+    gdouble converted[ TRACE_CHUNK ];
+    gdouble ordinateScaling = BENCH_GRID_WIDTH / ( pXaxis->max - pXaxis->min );
+    gdouble xScale = ordinateScaling / (bTime ? 1000.0 : MHz(1.0));
+    gdouble xOffset = -pXaxis->min * ordinateScaling;
+    gdouble yScale = BENCH_GRID_HEIGHT / ( pYaxis->max - pYaxis->min );
+
+    for( guint chunk = 0; chunk < n; chunk += TRACE_CHUNK ) {
+        guint nChunk = MIN( TRACE_CHUNK, n - chunk );
+        const gdouble *pCoordinates = &pBuffer->gain[ chunk ];
+
+        if( bNoise ) {
+            convertNoiseColumn( &pBuffer->noise[ chunk ], converted, nChunk, eFdB );
+            pCoordinates = converted;
+        }
+        transformToGrid( pBuffer, pCoordinates, chunk, nChunk, bTime, xScale, xOffset, pYaxis, yScale,
+                         &pX[ chunk ], &pY[ chunk ], &pbValid[ chunk ] );
+    }
+}
+
+/*!     \brief  Best time of a number of repeats of a transform
+ *
+ * \return time in ms
+ */
+static gdouble
+timeTransform( void (*transform)( tCircularBuffer *, guint, gboolean, gboolean, tAxis *, tAxis *, gdouble *, gdouble *, guint8 * ),
+               tCircularBuffer *pBuffer, guint n, gboolean bTime, gboolean bNoise, tAxis *pXaxis, tAxis *pYaxis,
+               gdouble *pX, gdouble *pY, guint8 *pbValid, gint nRepeats ) {
+    gint64 best = G_MAXINT64;
+
+    for( gint i = 0; i < nRepeats; i++ ) {
+        gint64 start = g_get_monotonic_time();
+        transform( pBuffer, n, bTime, bNoise, pXaxis, pYaxis, pX, pY, pbValid );
+        best = MIN( best, g_get_monotonic_time() - start );
+    }
+    return best / 1000.0;
+}
+
+int
+main( int argc, char *argv[] ) {
+    gint nRepeats = argc > 1 ? atoi( argv[ 1 ] ) : BENCH_REPEATS;
+    gboolean bSame = TRUE;
+
+    if( nRepeats < 1 )
+        nRepeats = 1;
+
+    printf( "abscissa  ordinate   points     per point   chunked kernels   (best of %d, ms)\n", nRepeats );
+
+    // frequency and time abscissa .. gain and noise ordinate
+    for( gint kind = 0; kind < 4; kind++ ) {
+        gboolean bTime = kind / 2, bNoise = kind % 2;
+
+        for( guint size = 0; size < G_N_ELEMENTS( benchSizes ); size++ ) {
+            guint n = benchSizes[ size ];
+            tCircularBuffer buffer = { 0 };
+            tAxis xAxis, yAxis = { .min = 0.0, .max = bNoise ? 10.0 : 30.0 };
+            gdouble *pX[ 2 ], *pY[ 2 ];
+            guint8 *pbValid[ 2 ];
+            gdouble perPoint, chunked;
+
+            buffer.abscissa = g_new( tAbscissaValue, n );
+            buffer.noise = g_new( gdouble, n );
+            buffer.gain = g_new( gdouble, n );
+            // a noise figure of about 0 to 12 dB and a gain of -5 to 35 dB (some beyond the axes)
+            // with an occasional error
+            for( guint i = 0; i < n; i++ ) {
+                if( bTime )
+                    buffer.abscissa[ i ].time = 1700000000000 + i * 250;
+                else
+                    buffer.abscissa[ i ].freq = MHz( 10.0 ) + i * (MHz( 1490.0 ) / n);
+                buffer.noise[ i ] = i % 997 == 0 ? ERROR_INDICATOR_HP8970 : 1.0 + 15.0 * (0.5 + 0.5 * sin( i / 50.0 ));
+                buffer.gain[ i ] = 15.0 + 20.0 * cos( i / 70.0 );
+            }
+            if( bTime ) {
+                xAxis.min = GINT_MSTIME_TO_DOUBLE( buffer.abscissa[ 0 ].time );
+                xAxis.max = GINT_MSTIME_TO_DOUBLE( buffer.abscissa[ n - 1 ].time );
+            } else {
+                xAxis.min = 10.0;
+                xAxis.max = 1500.0;
+            }
+
+            for( gint i = 0; i < 2; i++ ) {
+                pX[ i ] = g_new( gdouble, n );
+                pY[ i ] = g_new( gdouble, n );
+                pbValid[ i ] = g_new( guint8, n );
+            }
+
+            perPoint = timeTransform( perPointTransform, &buffer, n, bTime, bNoise, &xAxis, &yAxis,
+                                      pX[ 0 ], pY[ 0 ], pbValid[ 0 ], nRepeats );
+            chunked  = timeTransform( chunkedTransform, &buffer, n, bTime, bNoise, &xAxis, &yAxis,
+                                      pX[ 1 ], pY[ 1 ], pbValid[ 1 ], nRepeats );
+            printf( "%-9s %-9s %7u   %9.3f     %9.3f\n", bTime ? "time" : "freq", bNoise ? "noise dB" : "gain",
+                    n, perPoint, chunked );
+
+            for( guint i = 0; i < n; i++ ) {
+                if( fabs( pX[ 0 ][ i ] - pX[ 1 ][ i ] ) > 1.0e-6 || fabs( pY[ 0 ][ i ] - pY[ 1 ][ i ] ) > 1.0e-6
+                        || pbValid[ 0 ][ i ] != pbValid[ 1 ][ i ] ) {
+                    printf( "position %u differs\n", i );
+                    bSame = FALSE;
+                    break;
+                }
+            }
+
+            for( gint i = 0; i < 2; i++ ) {
+                g_free( pX[ i ] );
+                g_free( pY[ i ] );
+                g_free( pbValid[ i ] );
+            }
+            g_free( buffer.abscissa );
+            g_free( buffer.noise );
+            g_free( buffer.gain );
+        }
+    }
+
+    return bSame ? EXIT_SUCCESS : EXIT_FAILURE;
+}
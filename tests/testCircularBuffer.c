@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024 Michael G. Katzmann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Stress test of the circular buffer (make check)
+ *
+ * A producer thread adds items to a small buffer as fast as it can (wrapping many times) while
+ * the main thread reads it as the plot does. Item i has time i, noise i and gain -i, so once the
+ * buffer is full every read must show:
+ *
+ *   - the buffer full (never empty or part full)
+ *   - the newest item no older than the last one seen and not torn (its noise and gain those
+ *     of the same item as its time)
+ *   - extremes that were found together (max - min of the noise is the size less one and the
+ *     gain extremes are the noise extremes negated)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glib-2.0/glib.h>
+#include <HP8970.h>
+
+#define TEST_BUFFER_SIZE    64
+#define TEST_ITEMS          2000000
+
+static tCircularBuffer buffer;
+static gint bProducing = TRUE;
+
+/*!     \brief  Add items to the buffer as fast as possible (producer thread)
+ *
+ * \param  data       unused
+ * \return NULL
+ */
+static gpointer
+produceItems( gpointer data ) {
+    tNoiseAndGain item = { 0 };
+
+    for( guint i = 1; i <= TEST_ITEMS; i++ ) {
+        item.abscissa.time = i;
+        item.noise = (gdouble)i;
+        item.gain = -(gdouble)i;
+        addItemToCircularBuffer( &buffer, &item, TRUE );
+    }
+    g_atomic_int_set( &bProducing, FALSE );
+
+    return NULL;
+}
+
+int
+main( int argc, char *argv[] ) {
+    GThread *pProducer;
+    tBufferSpan spans[ 2 ];
+    tNoiseAndGain newest;
+    gint64 lastTime = 0;
+    gdouble minNoise, maxNoise, minGain, maxGain;
+    gboolean bFull = FALSE;
+    guint64 nReads = 0, nEmpty = 0, nPartFull = 0, nOutOfOrder = 0, nTornItems = 0, nTornExtremes = 0;
+
+    g_mutex_init( &buffer.mBuffer );
+    initCircularBuffer( &buffer, TEST_BUFFER_SIZE, eTimeAbscissa );
+
+    pProducer = g_thread_new( "producer", produceItems, NULL );
+
+    while( g_atomic_int_get( &bProducing ) ) {
+        gint nSpans = circularBufferSpans( &buffer, spans );
+        guint nItems = nSpans == 0 ? 0 : spans[ 0 ].count + (nSpans == 2 ? spans[ 1 ].count : 0);
+
+        if( nItems == TEST_BUFFER_SIZE )
+            bFull = TRUE;
+        if( !bFull )
+            continue;
+
+        nReads++;
+        if( nItems == 0 )
+            nEmpty++;
+        else if( nItems != TEST_BUFFER_SIZE || nItemsInCircularBuffer( &buffer ) != TEST_BUFFER_SIZE )
+            nPartFull++;
+
+        if( getItemFromCircularBuffer( &buffer, LAST_ITEM, &newest ) == NULL || newest.abscissa.time < lastTime )
+            nOutOfOrder++;
+        else
+            lastTime = newest.abscissa.time;
+        if( newest.noise != (gdouble)newest.abscissa.time || newest.gain != -newest.noise )
+            nTornItems++;
+
+        circularBufferExtremes( &buffer, &minNoise, &maxNoise, &minGain, &maxGain );
+        if( maxNoise - minNoise != TEST_BUFFER_SIZE - 1 || minGain != -maxNoise || maxGain != -minNoise )
+            nTornExtremes++;
+    }
+    g_thread_join( pProducer );
+
+    printf( "%" G_GUINT64_FORMAT " reads of a full buffer: %" G_GUINT64_FORMAT " empty, %" G_GUINT64_FORMAT
+            " part full, %" G_GUINT64_FORMAT " out of order, %" G_GUINT64_FORMAT " torn items, %" G_GUINT64_FORMAT
+            " torn extremes\n", nReads, nEmpty, nPartFull, nOutOfOrder, nTornItems, nTornExtremes );
+
+    freeCircularBuffer( &buffer );
+
+    if( nReads == 0 ) {
+        printf( "the buffer was never seen full\n" );
+        return EXIT_FAILURE;
+    }
+    return (nEmpty || nPartFull || nOutOfOrder || nTornItems || nTornExtremes) ? EXIT_FAILURE : EXIT_SUCCESS;
+}